@@ -0,0 +1,167 @@
+/**
+ * @file FrameAllocator.hpp
+ * @author Minmin Gong
+ *
+ * @section DESCRIPTION
+ *
+ * This source file is part of KFL, a subproject of KlayGE
+ * For the latest info, see http://www.klayge.org
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * You may alternatively use this source under the terms of
+ * the KlayGE Proprietary License (KPL). You can obtained such a license
+ * from http://www.klayge.org/licensing/.
+ */
+
+
+#ifndef _KFL_FRAME_ALLOCATOR_HPP
+#define _KFL_FRAME_ALLOCATOR_HPP
+
+#pragma once
+
+#include <boost/noncopyable.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace KlayGE
+{
+	// Linear allocator for the temporaries of a frame. Allocating bumps an offset, freeing only takes back the newest
+	// allocation, and reset() releases everything at once at the end of the frame. A frame that doesn't fit in the block
+	// gets more blocks, and they are merged into one at the reset, so a steady frame loop stops calling the heap.
+	class frame_arena final : boost::noncopyable
+	{
+	public:
+		// The arena of the calling thread. The one of the main thread is reset by RenderEngine::EndFrame.
+		static frame_arena& thread_instance();
+
+		explicit frame_arena(size_t block_size = 64 * 1024);
+
+		void* allocate(size_t size, size_t alignment);
+		void deallocate(void* p, size_t size) noexcept;
+
+		// Nothing is destructed at the reset, so only for trivial types
+		template <typename T>
+		T* allocate(size_t count)
+		{
+			static_assert(std::is_trivially_destructible<T>::value, "Objects in frame_arena are never destructed.");
+			return static_cast<T*>(this->allocate(count * sizeof(T), alignof(T)));
+		}
+
+		void reset();
+
+		size_t bytes_used() const noexcept
+		{
+			return used_;
+		}
+		size_t capacity() const noexcept;
+		// Most bytes in use during the last frame, and during any frame so far
+		size_t last_frame_peak() const noexcept
+		{
+			return last_frame_peak_;
+		}
+		size_t high_water_mark() const noexcept
+		{
+			return high_water_mark_;
+		}
+
+	private:
+		struct block
+		{
+			std::unique_ptr<uint8_t[]> data;
+			size_t size;
+		};
+
+		void add_block(size_t size);
+
+	private:
+		std::vector<block> blocks_;
+		size_t curr_block_;
+		size_t offset_;
+
+		size_t used_;
+		size_t peak_;
+		size_t last_frame_peak_;
+		size_t high_water_mark_;
+	};
+
+	// STL allocator on a frame_arena. Containers with it must not live past the reset of the arena.
+	template <typename T>
+	class frame_allocator
+	{
+		template <typename U>
+		friend class frame_allocator;
+
+	public:
+		typedef T value_type;
+
+		frame_allocator() noexcept
+			: arena_(&frame_arena::thread_instance())
+		{
+		}
+
+		explicit frame_allocator(frame_arena& arena) noexcept
+			: arena_(&arena)
+		{
+		}
+
+		template <typename U>
+		frame_allocator(frame_allocator<U> const & rhs) noexcept
+			: arena_(rhs.arena_)
+		{
+		}
+
+		T* allocate(size_t count)
+		{
+			return static_cast<T*>(arena_->allocate(count * sizeof(T), alignof(T)));
+		}
+
+		void deallocate(T* p, size_t count) noexcept
+		{
+			arena_->deallocate(p, count * sizeof(T));
+		}
+
+		frame_arena& arena() const noexcept
+		{
+			return *arena_;
+		}
+
+	private:
+		frame_arena* arena_;
+	};
+
+	template <typename T, typename U>
+	inline bool operator==(frame_allocator<T> const & lhs, frame_allocator<U> const & rhs) noexcept
+	{
+		return &lhs.arena() == &rhs.arena();
+	}
+
+	template <typename T, typename U>
+	inline bool operator!=(frame_allocator<T> const & lhs, frame_allocator<U> const & rhs) noexcept
+	{
+		return !(lhs == rhs);
+	}
+
+	template <typename T>
+	using frame_vector = std::vector<T, frame_allocator<T>>;
+}
+
+#endif		// _KFL_FRAME_ALLOCATOR_HPP
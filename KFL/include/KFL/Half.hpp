@@ -33,6 +33,8 @@
 
 #pragma once
 
+#include <KFL/CXX2a/span.hpp>
+
 #include <boost/operators.hpp>
 #include <limits>
 
@@ -125,6 +127,11 @@ namespace KlayGE
 	private:
 		uint16_t value_;
 	};
+
+	// Bulk conversions of input.size() values, output must be at least as large. They use F16C or NEON when it's enabled
+	// at compile time. Those round to nearest even, so a float exactly between 2 halfs can end up 1 ulp away from half(f).
+	void FloatToHalf(std::span<float const> input, std::span<half> output) noexcept;
+	void HalfToFloat(std::span<half const> input, std::span<float> output) noexcept;
 }
 
 namespace std
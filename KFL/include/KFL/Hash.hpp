@@ -34,7 +34,16 @@
 #pragma once
 
 #include <KFL/PreDeclare.hpp>
+#include <KFL/CXX17.hpp>
 #include <KFL/CXX17/string_view.hpp>
+#include <KFL/CXX2a/endian.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <string>
+#include <type_traits>
+#include <vector>
 
 namespace KlayGE
 {
@@ -44,9 +53,116 @@ namespace KlayGE
 #pragma warning(disable: 4307) // The hash here could cause integral constant overflow
 #endif
 
-	size_t constexpr CTHashImpl(char const * str, size_t seed)
+	namespace Detail
+	{
+		uint64_t constexpr HASH_PRIME64_1 = 0x9E3779B185EBCA87ULL;
+		uint64_t constexpr HASH_PRIME64_2 = 0xC2B2AE3D27D4EB4FULL;
+		uint64_t constexpr HASH_PRIME64_3 = 0x165667B19E3779F9ULL;
+		uint64_t constexpr HASH_PRIME64_4 = 0x85EBCA77C2B2AE63ULL;
+		uint64_t constexpr HASH_PRIME64_5 = 0x27D4EB2F165667C5ULL;
+
+		uint64_t constexpr HashRotl(uint64_t x, int r) noexcept
+		{
+			return (x << r) | (x >> (64 - r));
+		}
+
+		uint64_t constexpr HashLoadLE(char const * p, size_t n) noexcept
+		{
+			uint64_t ret = 0;
+			for (size_t i = 0; i < n; ++ i)
+			{
+				ret |= static_cast<uint64_t>(static_cast<uint8_t>(p[i])) << (i * 8);
+			}
+			return ret;
+		}
+
+		size_t constexpr CTStrLen(char const * str) noexcept
+		{
+			size_t len = 0;
+			while (str[len] != 0)
+			{
+				++ len;
+			}
+			return len;
+		}
+
+		// Byte by byte loads, so it can be evaluated at compile time
+		struct CTHashLoader
+		{
+			static uint64_t constexpr Load8(char const * p) noexcept
+			{
+				return HashLoadLE(p, 8);
+			}
+			static uint64_t constexpr Load4(char const * p) noexcept
+			{
+				return HashLoadLE(p, 4);
+			}
+		};
+
+		struct RTHashLoader
+		{
+			static uint64_t Load8(char const * p) noexcept
+			{
+				KLAYGE_IF_CONSTEXPR (std::endian::native == std::endian::little)
+				{
+					uint64_t ret;
+					std::memcpy(&ret, p, sizeof(ret));
+					return ret;
+				}
+				else
+				{
+					return HashLoadLE(p, 8);
+				}
+			}
+			static uint64_t Load4(char const * p) noexcept
+			{
+				KLAYGE_IF_CONSTEXPR (std::endian::native == std::endian::little)
+				{
+					uint32_t ret;
+					std::memcpy(&ret, p, sizeof(ret));
+					return ret;
+				}
+				else
+				{
+					return HashLoadLE(p, 4);
+				}
+			}
+		};
+
+		// The single lane form of xxHash64. Names are short, so the 4 lanes of the full version don't pay off. It consumes 8
+		// bytes per round, then 4, then the rest one by one.
+		template <typename Loader>
+		uint64_t constexpr HashBytes(char const * str, size_t len, uint64_t seed) noexcept
+		{
+			uint64_t h = seed + HASH_PRIME64_5 + len;
+			for (; len >= 8; str += 8, len -= 8)
+			{
+				uint64_t const k = HashRotl(Loader::Load8(str) * HASH_PRIME64_2, 31) * HASH_PRIME64_1;
+				h = HashRotl(h ^ k, 27) * HASH_PRIME64_1 + HASH_PRIME64_4;
+			}
+			if (len >= 4)
+			{
+				h = HashRotl(h ^ (Loader::Load4(str) * HASH_PRIME64_1), 23) * HASH_PRIME64_2 + HASH_PRIME64_3;
+				str += 4;
+				len -= 4;
+			}
+			for (; len > 0; ++ str, -- len)
+			{
+				h = HashRotl(h ^ (static_cast<uint8_t>(*str) * HASH_PRIME64_5), 11) * HASH_PRIME64_1;
+			}
+
+			h ^= h >> 33;
+			h *= HASH_PRIME64_2;
+			h ^= h >> 29;
+			h *= HASH_PRIME64_3;
+			h ^= h >> 32;
+			return h;
+		}
+	}
+
+	size_t constexpr CTHashImpl(char const * str) noexcept
 	{
-		return 0 == *str ? seed : CTHashImpl(str + 1, seed ^ (static_cast<size_t>(*str) + PRIME_NUM + (seed << 6) + (seed >> 2)));
+		return static_cast<size_t>(Detail::HashBytes<Detail::CTHashLoader>(str, Detail::CTStrLen(str), 0));
 	}
 
 #if defined(KLAYGE_COMPILER_MSVC) && (_MSC_VER < 1914)
@@ -56,9 +172,9 @@ namespace KlayGE
 		static size_t constexpr value = N;
 	};
 
-	#define CT_HASH(x) (EnsureConst<CTHashImpl(x, 0)>::value)
+	#define CT_HASH(x) (EnsureConst<CTHashImpl(x)>::value)
 #else
-	#define CT_HASH(x) (CTHashImpl(x, 0))
+	#define CT_HASH(x) (CTHashImpl(x))
 #endif
 
 	template <typename SizeT>
@@ -67,15 +183,15 @@ namespace KlayGE
 		seed ^= value + PRIME_NUM + (seed << 6) + (seed >> 2);
 	}
 
+	// Same value as CT_HASH, and as HashRange on the characters
+	inline size_t HashString(char const * str, size_t len, size_t seed = 0) noexcept
+	{
+		return static_cast<size_t>(Detail::HashBytes<Detail::RTHashLoader>(str, len, seed));
+	}
+
 	inline size_t RT_HASH(char const * str)
 	{
-		size_t seed = 0;
-		while (*str != 0)
-		{
-			HashCombineImpl(seed, static_cast<size_t>(*str));
-			++ str;
-		}
-		return seed;
+		return HashString(str, std::strlen(str));
 	}
 
 #undef PRIME_NUM
@@ -98,15 +214,43 @@ namespace KlayGE
 		return HashCombineImpl(seed, HashValue(v));
 	}
 
-	template <typename T>
-	inline void HashRange(size_t& seed, T first, T last)
+	namespace Detail
 	{
-		for (; first != last; ++ first)
+		// Only iterators known to point into contiguous chars. Random access alone isn't enough, e.g. deque<char>::iterator and
+		// reverse_iterator<char*>.
+		template <typename T>
+		struct IsCharRange
+			: std::integral_constant<bool, std::is_same<T, char*>::value || std::is_same<T, char const *>::value
+				|| std::is_same<T, std::string::iterator>::value || std::is_same<T, std::string::const_iterator>::value
+				|| std::is_same<T, std::string_view::const_iterator>::value
+				|| std::is_same<T, std::vector<char>::iterator>::value || std::is_same<T, std::vector<char>::const_iterator>::value>
 		{
-			HashCombine(seed, *first);
+		};
+
+		template <typename T>
+		inline void HashRangeImpl(size_t& seed, T first, T last, std::false_type)
+		{
+			for (; first != last; ++ first)
+			{
+				HashCombine(seed, *first);
+			}
+		}
+
+		// Strings and raw bytes are hashed a word at a time. The characters must be contiguous.
+		template <typename T>
+		inline void HashRangeImpl(size_t& seed, T first, T last, std::true_type)
+		{
+			size_t const len = static_cast<size_t>(last - first);
+			seed = HashString(len > 0 ? &*first : nullptr, len, seed);
 		}
 	}
 
+	template <typename T>
+	inline void HashRange(size_t& seed, T first, T last)
+	{
+		Detail::HashRangeImpl(seed, first, last, Detail::IsCharRange<T>());
+	}
+
 	template <typename T>
 	inline size_t HashRange(T first, T last)
 	{
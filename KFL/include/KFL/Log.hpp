@@ -33,12 +33,72 @@
 
 #pragma once
 
+#include <KFL/Config.hpp>
+
+#include <iosfwd>
+
+namespace KlayGE
+{
+	enum LogLevel
+	{
+		LL_Debug,
+		LL_Info,
+		LL_Warn,
+		LL_Error
+	};
+}
+
+// Records below this level are compiled out. By default debug records are only kept in debug builds.
+#ifndef KLAYGE_LOG_LEVEL
+	#ifdef KLAYGE_DEBUG
+		#define KLAYGE_LOG_LEVEL 0
+	#else
+		#define KLAYGE_LOG_LEVEL 1
+	#endif
+#endif
+
 namespace KlayGE
 {
-	std::ostream& LogDebug();
-	std::ostream& LogInfo();
-	std::ostream& LogWarn();
-	std::ostream& LogError();
+	// Each thread formats its records into a stream of its own, and hands the finished ones, at a flush or the next record,
+	// to a background thread that writes them out. Error records wait until they are written.
+	std::ostream& LogStream(LogLevel level);
+	// A stream in a failed state, so nothing written to it is even formatted
+	std::ostream& EmptyLog();
+
+	// Waits until the records finished so far are written out
+	void FlushLog();
+
+	inline std::ostream& LogDebug()
+	{
+#if KLAYGE_LOG_LEVEL <= 0
+		return LogStream(LL_Debug);
+#else
+		return EmptyLog();
+#endif
+	}
+
+	inline std::ostream& LogInfo()
+	{
+#if KLAYGE_LOG_LEVEL <= 1
+		return LogStream(LL_Info);
+#else
+		return EmptyLog();
+#endif
+	}
+
+	inline std::ostream& LogWarn()
+	{
+#if KLAYGE_LOG_LEVEL <= 2
+		return LogStream(LL_Warn);
+#else
+		return EmptyLog();
+#endif
+	}
+
+	inline std::ostream& LogError()
+	{
+		return LogStream(LL_Error);
+	}
 }
 
 #endif		// _KFL_LOG_HPP
@@ -0,0 +1,67 @@
+/**
+ * @file MappedFile.hpp
+ * @author Minmin Gong
+ *
+ * @section DESCRIPTION
+ *
+ * This source file is part of KFL, a subproject of KlayGE
+ * For the latest info, see http://www.klayge.org
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * You may alternatively use this source under the terms of
+ * the KlayGE Proprietary License (KPL). You can obtained such a license
+ * from http://www.klayge.org/licensing/.
+ */
+
+#ifndef _KFL_MAPPED_FILE_HPP
+#define _KFL_MAPPED_FILE_HPP
+
+#pragma once
+
+#include <KFL/CXX2a/span.hpp>
+
+#include <boost/noncopyable.hpp>
+
+#include <cstdint>
+#include <string>
+
+namespace KlayGE
+{
+	// Maps a whole file into memory as read only. The file must not be modified while it's mapped.
+	class MappedFile final : boost::noncopyable
+	{
+	public:
+		MappedFile();
+		~MappedFile();
+
+		// Fails on empty files, and on platforms without file mapping
+		bool Map(std::string const & file_name);
+		void Unmap();
+
+		std::span<uint8_t const> Data() const
+		{
+			return MakeSpan(data_, data_ + size_);
+		}
+
+	private:
+		uint8_t const * data_;
+		size_t size_;
+	};
+}
+
+#endif		// _KFL_MAPPED_FILE_HPP
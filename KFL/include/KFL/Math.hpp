@@ -678,6 +678,15 @@ namespace KlayGE
 		template <typename T>
 		BoundOverlap intersect_frustum_frustum(Frustum_T<T> const & lhs, Frustum_T<T> const & frustum) noexcept;
 
+		// Batch forms of intersect_aabb_frustum. 4 boxes are tested at a time, results[i] is the result of the i-th box.
+		void intersect_aabbs_frustum(float const * min_x, float const * min_y, float const * min_z,
+			float const * max_x, float const * max_y, float const * max_z, size_t num,
+			Frustum const & frustum, BoundOverlap* results) noexcept;
+		void intersect_aabbs_frustum(AABBox const * aabbs, size_t num, Frustum const & frustum, BoundOverlap* results) noexcept;
+		// One box against several frustums, such as the cameras of a viewport. results[i] is the result of the i-th frustum.
+		void intersect_aabb_frustums(AABBox const & aabb, Frustum const * const * frustums, size_t num_frustums,
+			BoundOverlap* results) noexcept;
+
 
 		// 
 		///////////////////////////////////////////////////////////////////////////////
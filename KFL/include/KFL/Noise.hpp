@@ -34,6 +34,7 @@
 #pragma once
 
 #include <KFL/Math.hpp>
+#include <KFL/CXX2a/span.hpp>
 
 namespace KlayGE
 {
@@ -67,12 +68,51 @@ namespace KlayGE
 			T tileable_turbulence(T x, T y, T z,
 				T w, T h, T d, int octaves, T lacunarity = T(2), T gain = T(0.5)) noexcept;
 
+			// Batch versions of the 2D functions. result[i] is the value at (xs[i], ys[i]). Several points are evaluated at
+			// once with SIMD, and the results match the single point ones up to rounding.
+			void noise(std::span<T const> xs, std::span<T const> ys, std::span<T> result) noexcept;
+
+			void fBm(std::span<T const> xs, std::span<T const> ys, std::span<T> result,
+				int octaves, T lacunarity = T(2), T gain = T(0.5)) noexcept;
+			void turbulence(std::span<T const> xs, std::span<T const> ys, std::span<T> result,
+				int octaves, T lacunarity = T(2), T gain = T(0.5)) noexcept;
+
+			void tileable_noise(std::span<T const> xs, std::span<T const> ys, T w, T h, std::span<T> result) noexcept;
+
+			void tileable_fBm(std::span<T const> xs, std::span<T const> ys, T w, T h, std::span<T> result,
+				int octaves, T lacunarity = T(2), T gain = T(0.5)) noexcept;
+			void tileable_turbulence(std::span<T const> xs, std::span<T const> ys, T w, T h, std::span<T> result,
+				int octaves, T lacunarity = T(2), T gain = T(0.5)) noexcept;
+
+			// Fill a width x height image, row by row. Texel (x, y) is sampled at its center, mapped to [0, w) x [0, h).
+			// Rows are spread over the scheduler.
+			void fill_fBm(task_scheduler& scheduler, std::span<T> image, uint32_t width, uint32_t height, T w, T h,
+				int octaves, T lacunarity = T(2), T gain = T(0.5));
+			void fill_turbulence(task_scheduler& scheduler, std::span<T> image, uint32_t width, uint32_t height, T w, T h,
+				int octaves, T lacunarity = T(2), T gain = T(0.5));
+			void fill_tileable_fBm(task_scheduler& scheduler, std::span<T> image, uint32_t width, uint32_t height, T w, T h,
+				int octaves, T lacunarity = T(2), T gain = T(0.5));
+			void fill_tileable_turbulence(task_scheduler& scheduler, std::span<T> image, uint32_t width, uint32_t height,
+				T w, T h, int octaves, T lacunarity = T(2), T gain = T(0.5));
+
 		private:
 			SimplexNoise() noexcept;
 
+			template <bool Tileable, bool Turbulence>
+			void batch(std::span<T const> xs, std::span<T const> ys, T w, T h, std::span<T> result,
+				int octaves, T lacunarity, T gain) noexcept;
+			template <bool Tileable, bool Turbulence>
+			void fill(task_scheduler& scheduler, std::span<T> image, uint32_t width, uint32_t height, T w, T h,
+				int octaves, T lacunarity, T gain);
+
 		private:
 			int p_[512];
 			Vector_T<T, 3> g_[12];
+
+			// p_[i] % 12, and the x and y of g_, for gathering in the batch functions
+			int p_mod12_[512];
+			T gx_[12];
+			T gy_[12];
 		};
 	}
 }
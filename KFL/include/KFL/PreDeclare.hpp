@@ -40,6 +40,8 @@ namespace KlayGE
 	class ResIdentifier;
 	typedef std::shared_ptr<ResIdentifier> ResIdentifierPtr;
 	class DllLoader;
+	class MappedFile;
+	typedef std::shared_ptr<MappedFile> MappedFilePtr;
 
 	class XMLDocument;
 	typedef std::shared_ptr<XMLDocument> XMLDocumentPtr;
@@ -47,12 +49,16 @@ namespace KlayGE
 	typedef std::shared_ptr<XMLNode> XMLNodePtr;
 	class XMLAttribute;
 	typedef std::shared_ptr<XMLAttribute> XMLAttributePtr;
+	class XMLNodeHandle;
+	class XMLAttributeHandle;
 
 	class bad_join;
 	template <typename ResultType>
 	class joiner;
 	class threader;
 	class thread_pool;
+	class task_counter;
+	class task_scheduler;
 
 	class half;
 	template <typename T, int N>
@@ -35,6 +35,8 @@
 
 #include <KFL/PreDeclare.hpp>
 #include <KFL/CXX17/string_view.hpp>
+#include <KFL/CXX2a/span.hpp>
+#include <KFL/CustomizedStreamBuf.hpp>
 #include <istream>
 #include <vector>
 #include <string>
@@ -54,6 +56,15 @@ namespace KlayGE
 			: res_name_(name), timestamp_(timestamp), istream_(is), streambuf_(streambuf)
 		{
 		}
+		// The data stays in place, data_owner keeps it alive. Loaders can parse it directly through Data().
+		ResIdentifier(std::string_view name, uint64_t timestamp,
+				std::span<uint8_t const> data, std::shared_ptr<void> const & data_owner)
+			: res_name_(name), timestamp_(timestamp),
+				streambuf_(MakeSharedPtr<MemInputStreamBuf>(data.data(), data.data() + data.size())),
+				data_(data), data_owner_(data_owner)
+		{
+			istream_ = MakeSharedPtr<std::istream>(streambuf_.get());
+		}
 
 		void ResName(std::string_view name)
 		{
@@ -113,11 +124,19 @@ namespace KlayGE
 			return *istream_;
 		}
 
+		// Whole content of the resource if it's in memory, empty if it can only be streamed
+		std::span<uint8_t const> Data() const
+		{
+			return data_;
+		}
+
 	private:
 		std::string res_name_;
 		uint64_t timestamp_;
 		std::shared_ptr<std::istream> istream_;
 		std::shared_ptr<std::streambuf> streambuf_;
+		std::span<uint8_t const> data_;
+		std::shared_ptr<void> data_owner_;
 	};
 }
 
@@ -34,10 +34,26 @@
 #pragma once
 
 #include <KFL/PreDeclare.hpp>
+#include <KFL/Math.hpp>
+
+#include <algorithm>
 
 #if defined(KLAYGE_SSE_SUPPORT)
 	#define SIMD_MATH_SSE
 	#include <xmmintrin.h>
+	#include <emmintrin.h>
+	#if defined(KLAYGE_SSE4_1_SUPPORT)
+		#define SIMD_MATH_SSE4
+		#include <smmintrin.h>
+	#endif
+	#if defined(KLAYGE_AVX2_SUPPORT) && (defined(KLAYGE_COMPILER_MSVC) || defined(__FMA__))
+		#define SIMD_MATH_FMA
+		#include <immintrin.h>
+	#endif
+#elif defined(KLAYGE_NEON_SUPPORT) && defined(KLAYGE_CPU_ARM64) && !defined(KLAYGE_COMPILER_MSVC)
+	// The lanes of float32x4_t can be indexed in g++ and clang, which the general code paths rely on
+	#define SIMD_MATH_NEON
+	#include <arm_neon.h>
 #else
 	#define SIMD_MATH_GENERAL
 #endif
@@ -47,15 +63,19 @@ namespace KlayGE
 	class SIMDVectorF4;
 	class SIMDMatrixF4;
 
+	// The functions declared inline are the building blocks of the others. They are defined at the end of this file, so the
+	// calls can be inlined.
 	namespace SIMDMathLib
 	{
 		// General Vector
 		///////////////////////////////////////////////////////////////////////////////
-		SIMDVectorF4 Add(SIMDVectorF4 const & lhs, SIMDVectorF4 const & rhs);
-		SIMDVectorF4 Substract(SIMDVectorF4 const & lhs, SIMDVectorF4 const & rhs);
-		SIMDVectorF4 Multiply(SIMDVectorF4 const & lhs, SIMDVectorF4 const & rhs);
-		SIMDVectorF4 Divide(SIMDVectorF4 const & lhs, SIMDVectorF4 const & rhs);
-		SIMDVectorF4 Negative(SIMDVectorF4 const & rhs);
+		inline SIMDVectorF4 Add(SIMDVectorF4 const & lhs, SIMDVectorF4 const & rhs);
+		inline SIMDVectorF4 Substract(SIMDVectorF4 const & lhs, SIMDVectorF4 const & rhs);
+		inline SIMDVectorF4 Multiply(SIMDVectorF4 const & lhs, SIMDVectorF4 const & rhs);
+		inline SIMDVectorF4 Divide(SIMDVectorF4 const & lhs, SIMDVectorF4 const & rhs);
+		inline SIMDVectorF4 Negative(SIMDVectorF4 const & rhs);
+		// lhs * rhs + addend, fused when the CPU can
+		inline SIMDVectorF4 MultiplyAdd(SIMDVectorF4 const & lhs, SIMDVectorF4 const & rhs, SIMDVectorF4 const & addend);
 
 		SIMDVectorF4 BaryCentric(SIMDVectorF4 const & v1, SIMDVectorF4 const & v2, SIMDVectorF4 const & v3,
 			float f, float g);
@@ -69,37 +89,43 @@ namespace KlayGE
 			SIMDVectorF4 const & v2, SIMDVectorF4 const & t2, float s);
 		SIMDVectorF4 Lerp(SIMDVectorF4 const & lhs, SIMDVectorF4 const & rhs, float s);
 
-		SIMDVectorF4 Abs(SIMDVectorF4 const & x);
+		inline SIMDVectorF4 Abs(SIMDVectorF4 const & x);
 		SIMDVectorF4 Sgn(SIMDVectorF4 const & x);
 		SIMDVectorF4 Sqr(SIMDVectorF4 const & x);
 		SIMDVectorF4 Cube(SIMDVectorF4 const & x);
 
-		SIMDVectorF4 LoadVector1(float v);
-		SIMDVectorF4 LoadVector2(float2 const & v);
-		SIMDVectorF4 LoadVector3(float3 const & v);
-		SIMDVectorF4 LoadVector4(float4 const & v);
-		SIMDVectorF4 LoadVector2(float const * v);
-		SIMDVectorF4 LoadVector3(float const * v);
-		SIMDVectorF4 LoadVector4(float const * v);
-		void StoreVector1(float& fs, SIMDVectorF4 const & v);
-		void StoreVector2(float2& fs, SIMDVectorF4 const & v);
-		void StoreVector3(float3& fs, SIMDVectorF4 const & v);
-		void StoreVector4(float4& fs, SIMDVectorF4 const & v);
-		SIMDVectorF4 SetVector(float x, float y, float z, float w);
-		SIMDVectorF4 SetVector(float v);
-		float GetX(SIMDVectorF4 const & rhs);
-		float GetY(SIMDVectorF4 const & rhs);
-		float GetZ(SIMDVectorF4 const & rhs);
-		float GetW(SIMDVectorF4 const & rhs);
-		float GetByIndex(SIMDVectorF4 const & rhs, size_t index);
+		inline SIMDVectorF4 LoadVector1(float v);
+		inline SIMDVectorF4 LoadVector2(float2 const & v);
+		inline SIMDVectorF4 LoadVector3(float3 const & v);
+		inline SIMDVectorF4 LoadVector4(float4 const & v);
+		inline SIMDVectorF4 LoadVector2(float const * v);
+		inline SIMDVectorF4 LoadVector3(float const * v);
+		inline SIMDVectorF4 LoadVector4(float const * v);
+		inline void StoreVector1(float& fs, SIMDVectorF4 const & v);
+		inline void StoreVector2(float2& fs, SIMDVectorF4 const & v);
+		inline void StoreVector3(float3& fs, SIMDVectorF4 const & v);
+		inline void StoreVector4(float4& fs, SIMDVectorF4 const & v);
+		inline void StoreVector4(float* fs, SIMDVectorF4 const & v);
+		inline SIMDVectorF4 SetVector(float x, float y, float z, float w);
+		inline SIMDVectorF4 SetVector(float v);
+		inline float GetX(SIMDVectorF4 const & rhs);
+		inline float GetY(SIMDVectorF4 const & rhs);
+		inline float GetZ(SIMDVectorF4 const & rhs);
+		inline float GetW(SIMDVectorF4 const & rhs);
+		inline float GetByIndex(SIMDVectorF4 const & rhs, size_t index);
 		SIMDVectorF4 SetX(SIMDVectorF4 const & rhs, float v);
 		SIMDVectorF4 SetY(SIMDVectorF4 const & rhs, float v);
 		SIMDVectorF4 SetZ(SIMDVectorF4 const & rhs, float v);
 		SIMDVectorF4 SetW(SIMDVectorF4 const & rhs, float v);
-		SIMDVectorF4 SetByIndex(SIMDVectorF4 const & rhs, float v, size_t index);
+		inline SIMDVectorF4 SetByIndex(SIMDVectorF4 const & rhs, float v, size_t index);
 
-		SIMDVectorF4 Maximize(SIMDVectorF4 const & lhs, SIMDVectorF4 const & rhs);
-		SIMDVectorF4 Minimize(SIMDVectorF4 const & lhs, SIMDVectorF4 const & rhs);
+		inline SIMDVectorF4 Maximize(SIMDVectorF4 const & lhs, SIMDVectorF4 const & rhs);
+		inline SIMDVectorF4 Minimize(SIMDVectorF4 const & lhs, SIMDVectorF4 const & rhs);
+		// Bit i is set when lane i of lhs is less than lane i of rhs
+		inline uint32_t LessMask(SIMDVectorF4 const & lhs, SIMDVectorF4 const & rhs);
+		// Lane i is from if_ge when lane i of lhs is greater than or equal to lane i of rhs, otherwise from if_lt
+		inline SIMDVectorF4 SelectGreaterEqual(SIMDVectorF4 const & lhs, SIMDVectorF4 const & rhs, SIMDVectorF4 const & if_ge,
+			SIMDVectorF4 const & if_lt);
 
 		SIMDVectorF4 Reflect(SIMDVectorF4 const & incident, SIMDVectorF4 const & normal);
 		SIMDVectorF4 Refract(SIMDVectorF4 const & incident, SIMDVectorF4 const & normal, float refraction_index);
@@ -118,12 +144,12 @@ namespace KlayGE
 		///////////////////////////////////////////////////////////////////////////////
 		SIMDVectorF4 Angle(SIMDVectorF4 const & lhs, SIMDVectorF4 const & rhs);
 		SIMDVectorF4 CrossVector3(SIMDVectorF4 const & lhs, SIMDVectorF4 const & rhs);
-		SIMDVectorF4 DotVector3(SIMDVectorF4 const & lhs, SIMDVectorF4 const & rhs);
+		inline SIMDVectorF4 DotVector3(SIMDVectorF4 const & lhs, SIMDVectorF4 const & rhs);
 		SIMDVectorF4 LengthSqVector3(SIMDVectorF4 const & rhs);
 		SIMDVectorF4 LengthVector3(SIMDVectorF4 const & rhs);
 		SIMDVectorF4 NormalizeVector3(SIMDVectorF4 const & rhs);
-		SIMDVectorF4 TransformCoordVector3(SIMDVectorF4 const & v, SIMDMatrixF4 const & mat);
-		SIMDVectorF4 TransformNormalVector3(SIMDVectorF4 const & v, SIMDMatrixF4 const & mat);
+		inline SIMDVectorF4 TransformCoordVector3(SIMDVectorF4 const & v, SIMDMatrixF4 const & mat);
+		inline SIMDVectorF4 TransformNormalVector3(SIMDVectorF4 const & v, SIMDMatrixF4 const & mat);
 		SIMDVectorF4 TransformQuat(SIMDVectorF4 const & v, SIMDVectorF4 const & quat);
 		SIMDVectorF4 Project(SIMDVectorF4 const & vec,
 			SIMDMatrixF4 const & world, SIMDMatrixF4 const & view, SIMDMatrixF4 const & proj,
@@ -135,20 +161,23 @@ namespace KlayGE
 		// 4D Vector
 		///////////////////////////////////////////////////////////////////////////////
 		SIMDVectorF4 CrossVector4(SIMDVectorF4 const & v1, SIMDVectorF4 const & v2, SIMDVectorF4 const & v3);
-		SIMDVectorF4 DotVector4(SIMDVectorF4 const & lhs, SIMDVectorF4 const & rhs);
+		inline SIMDVectorF4 DotVector4(SIMDVectorF4 const & lhs, SIMDVectorF4 const & rhs);
 		SIMDVectorF4 LengthSqVector4(SIMDVectorF4 const & rhs);
 		SIMDVectorF4 LengthVector4(SIMDVectorF4 const & rhs);
 		SIMDVectorF4 NormalizeVector4(SIMDVectorF4 const & rhs);
-		SIMDVectorF4 TransformVector4(SIMDVectorF4 const & v, SIMDMatrixF4 const & mat);
+		inline SIMDVectorF4 TransformVector4(SIMDVectorF4 const & v, SIMDMatrixF4 const & mat);
 
 		// 4D Matrix
 		///////////////////////////////////////////////////////////////////////////////
-		SIMDMatrixF4 Add(SIMDMatrixF4 const & lhs, SIMDMatrixF4 const & rhs);
-		SIMDMatrixF4 Substract(SIMDMatrixF4 const & lhs, SIMDMatrixF4 const & rhs);
-		SIMDMatrixF4 Multiply(SIMDMatrixF4 const & lhs, SIMDMatrixF4 const & rhs);
-		SIMDMatrixF4 Multiply(SIMDMatrixF4 const & lhs, float rhs);
+		inline SIMDMatrixF4 LoadMatrix(float4x4 const & m);
+		inline void StoreMatrix(float4x4& m, SIMDMatrixF4 const & v);
+
+		inline SIMDMatrixF4 Add(SIMDMatrixF4 const & lhs, SIMDMatrixF4 const & rhs);
+		inline SIMDMatrixF4 Substract(SIMDMatrixF4 const & lhs, SIMDMatrixF4 const & rhs);
+		inline SIMDMatrixF4 Multiply(SIMDMatrixF4 const & lhs, SIMDMatrixF4 const & rhs);
+		inline SIMDMatrixF4 Multiply(SIMDMatrixF4 const & lhs, float rhs);
 		SIMDVectorF4 Determinant(SIMDMatrixF4 const & rhs);
-		SIMDMatrixF4 Negative(SIMDMatrixF4 const & rhs);
+		inline SIMDMatrixF4 Negative(SIMDMatrixF4 const & rhs);
 		SIMDMatrixF4 Inverse(SIMDMatrixF4 const & rhs);
 
 		SIMDMatrixF4 LookAtLH(SIMDVectorF4 const & eye, SIMDVectorF4 const & at);
@@ -191,7 +220,7 @@ namespace KlayGE
 		SIMDMatrixF4 Translation(float x, float y, float z);
 		SIMDMatrixF4 Translation(SIMDVectorF4 const & pos);
 
-		SIMDMatrixF4 Transpose(SIMDMatrixF4 const & rhs);
+		inline SIMDMatrixF4 Transpose(SIMDMatrixF4 const & rhs);
 
 		SIMDMatrixF4 LHToRH(SIMDMatrixF4 const & rhs);
 		SIMDMatrixF4 RHToLH(SIMDMatrixF4 const & rhs);
@@ -202,6 +231,9 @@ namespace KlayGE
 
 		// Quaternion
 		///////////////////////////////////////////////////////////////////////////////
+		inline SIMDVectorF4 LoadQuaternion(Quaternion const & q);
+		inline void StoreQuaternion(Quaternion& q, SIMDVectorF4 const & v);
+
 		SIMDVectorF4 Conjugate(SIMDVectorF4 const & rhs);
 
 		SIMDVectorF4 AxisToAxis(SIMDVectorF4 const & from, SIMDVectorF4 const & to);
@@ -215,7 +247,7 @@ namespace KlayGE
 
 		SIMDVectorF4 Inverse(SIMDVectorF4 const & rhs);
 
-		SIMDVectorF4 MultiplyQuat(SIMDVectorF4 const & lhs, SIMDVectorF4 const & rhs);
+		inline SIMDVectorF4 MultiplyQuat(SIMDVectorF4 const & lhs, SIMDVectorF4 const & rhs);
 
 		SIMDVectorF4 RotationAxis(SIMDVectorF4 const & v, float angle);
 		SIMDVectorF4 RotationQuatYawPitchRoll(float yaw, float pitch, float roll);
@@ -262,4 +294,754 @@ namespace KlayGE
 #include <KFL/SIMDVector.hpp>
 #include <KFL/SIMDMatrix.hpp>
 
+namespace KlayGE
+{
+	namespace SIMDMathLib
+	{
+		// General Vector
+		///////////////////////////////////////////////////////////////////////////////
+		inline SIMDVectorF4 Add(SIMDVectorF4 const & lhs, SIMDVectorF4 const & rhs)
+		{
+			SIMDVectorF4 ret;
+#if defined(SIMD_MATH_SSE)
+			ret.Vec() = _mm_add_ps(lhs.Vec(), rhs.Vec());
+#elif defined(SIMD_MATH_NEON)
+			ret.Vec() = vaddq_f32(lhs.Vec(), rhs.Vec());
+#else
+			for (int i = 0; i < 4; ++ i)
+			{
+				ret.Vec()[i] = lhs.Vec()[i] + rhs.Vec()[i];
+			}
+#endif
+			return ret;
+		}
+
+		inline SIMDVectorF4 Substract(SIMDVectorF4 const & lhs, SIMDVectorF4 const & rhs)
+		{
+			SIMDVectorF4 ret;
+#if defined(SIMD_MATH_SSE)
+			ret.Vec() = _mm_sub_ps(lhs.Vec(), rhs.Vec());
+#elif defined(SIMD_MATH_NEON)
+			ret.Vec() = vsubq_f32(lhs.Vec(), rhs.Vec());
+#else
+			for (int i = 0; i < 4; ++ i)
+			{
+				ret.Vec()[i] = lhs.Vec()[i] - rhs.Vec()[i];
+			}
+#endif
+			return ret;
+		}
+
+		inline SIMDVectorF4 Multiply(SIMDVectorF4 const & lhs, SIMDVectorF4 const & rhs)
+		{
+			SIMDVectorF4 ret;
+#if defined(SIMD_MATH_SSE)
+			ret.Vec() = _mm_mul_ps(lhs.Vec(), rhs.Vec());
+#elif defined(SIMD_MATH_NEON)
+			ret.Vec() = vmulq_f32(lhs.Vec(), rhs.Vec());
+#else
+			for (int i = 0; i < 4; ++ i)
+			{
+				ret.Vec()[i] = lhs.Vec()[i] * rhs.Vec()[i];
+			}
+#endif
+			return ret;
+		}
+
+		inline SIMDVectorF4 Divide(SIMDVectorF4 const & lhs, SIMDVectorF4 const & rhs)
+		{
+			SIMDVectorF4 ret;
+#if defined(SIMD_MATH_SSE)
+			ret.Vec() = _mm_div_ps(lhs.Vec(), rhs.Vec());
+#elif defined(SIMD_MATH_NEON)
+			ret.Vec() = vdivq_f32(lhs.Vec(), rhs.Vec());
+#else
+			for (int i = 0; i < 4; ++ i)
+			{
+				ret.Vec()[i] = lhs.Vec()[i] / rhs.Vec()[i];
+			}
+#endif
+			return ret;
+		}
+
+		inline SIMDVectorF4 Negative(SIMDVectorF4 const & rhs)
+		{
+			SIMDVectorF4 ret;
+#if defined(SIMD_MATH_SSE)
+			ret.Vec() = _mm_sub_ps(_mm_setzero_ps(), rhs.Vec());
+#elif defined(SIMD_MATH_NEON)
+			ret.Vec() = vnegq_f32(rhs.Vec());
+#else
+			for (int i = 0; i < 4; ++ i)
+			{
+				ret.Vec()[i] = -rhs.Vec()[i];
+			}
+#endif
+			return ret;
+		}
+
+		inline SIMDVectorF4 MultiplyAdd(SIMDVectorF4 const & lhs, SIMDVectorF4 const & rhs, SIMDVectorF4 const & addend)
+		{
+			SIMDVectorF4 ret;
+#if defined(SIMD_MATH_FMA)
+			ret.Vec() = _mm_fmadd_ps(lhs.Vec(), rhs.Vec(), addend.Vec());
+#elif defined(SIMD_MATH_SSE)
+			ret.Vec() = _mm_add_ps(_mm_mul_ps(lhs.Vec(), rhs.Vec()), addend.Vec());
+#elif defined(SIMD_MATH_NEON)
+			ret.Vec() = vfmaq_f32(addend.Vec(), lhs.Vec(), rhs.Vec());
+#else
+			for (int i = 0; i < 4; ++ i)
+			{
+				ret.Vec()[i] = lhs.Vec()[i] * rhs.Vec()[i] + addend.Vec()[i];
+			}
+#endif
+			return ret;
+		}
+
+		inline SIMDVectorF4 Abs(SIMDVectorF4 const & x)
+		{
+			SIMDVectorF4 ret;
+#if defined(SIMD_MATH_SSE)
+			__m128 res = x.Vec();
+			__m128 data_temp = _mm_sub_ps(_mm_setzero_ps(), res);
+			ret.Vec() = _mm_max_ps(data_temp, res);
+#elif defined(SIMD_MATH_NEON)
+			ret.Vec() = vabsq_f32(x.Vec());
+#else
+			for (int i = 0; i < 4; ++ i)
+			{
+				ret.Vec()[i] = MathLib::abs(x.Vec()[i]);
+			}
+#endif
+			return ret;
+		}
+
+		inline SIMDVectorF4 LoadVector1(float v)
+		{
+			SIMDVectorF4 ret;
+#if defined(SIMD_MATH_SSE)
+			ret.Vec() = _mm_load_ss(&v);
+#elif defined(SIMD_MATH_NEON)
+			ret.Vec() = vsetq_lane_f32(v, vdupq_n_f32(0), 0);
+#else
+			ret.Vec()[0] = v;
+			for (int i = 1; i < 4; ++ i)
+			{
+				ret.Vec()[i] = 0;
+			}
+#endif
+			return ret;
+		}
+
+		inline SIMDVectorF4 LoadVector2(float2 const & v)
+		{
+			return LoadVector2(&v[0]);
+		}
+
+		inline SIMDVectorF4 LoadVector3(float3 const & v)
+		{
+			return LoadVector3(&v[0]);
+		}
+
+		inline SIMDVectorF4 LoadVector4(float4 const & v)
+		{
+			return LoadVector4(&v[0]);
+		}
+
+		inline SIMDVectorF4 LoadVector2(float const * v)
+		{
+			SIMDVectorF4 ret;
+#if defined(SIMD_MATH_SSE)
+			__m128 x = _mm_load_ss(&v[0]);
+			__m128 y = _mm_load_ss(&v[1]);
+			ret.Vec() = _mm_unpacklo_ps(x, y);
+#elif defined(SIMD_MATH_NEON)
+			ret.Vec() = vcombine_f32(vld1_f32(v), vdup_n_f32(0));
+#else
+			for (int i = 0; i < 2; ++ i)
+			{
+				ret.Vec()[i] = v[i];
+			}
+			for (int i = 2; i < 4; ++ i)
+			{
+				ret.Vec()[i] = 0;
+			}
+#endif
+			return ret;
+		}
+
+		inline SIMDVectorF4 LoadVector3(float const * v)
+		{
+			SIMDVectorF4 ret;
+#if defined(SIMD_MATH_SSE)
+			__m128 x = _mm_load_ss(&v[0]);
+			__m128 y = _mm_load_ss(&v[1]);
+			__m128 z = _mm_load_ss(&v[2]);
+			__m128 xy = _mm_unpacklo_ps(x, y);
+			ret.Vec() = _mm_movelh_ps(xy, z);
+#elif defined(SIMD_MATH_NEON)
+			ret.Vec() = vcombine_f32(vld1_f32(v), vset_lane_f32(v[2], vdup_n_f32(0), 0));
+#else
+			for (int i = 0; i < 3; ++ i)
+			{
+				ret.Vec()[i] = v[i];
+			}
+			for (int i = 3; i < 4; ++ i)
+			{
+				ret.Vec()[i] = 0;
+			}
+#endif
+			return ret;
+		}
+
+		// Doesn't need 16-byte alignment. The unaligned load is as fast as the aligned one on aligned data.
+		inline SIMDVectorF4 LoadVector4(float const * v)
+		{
+			SIMDVectorF4 ret;
+#if defined(SIMD_MATH_SSE)
+			ret.Vec() = _mm_loadu_ps(&v[0]);
+#elif defined(SIMD_MATH_NEON)
+			ret.Vec() = vld1q_f32(v);
+#else
+			for (int i = 0; i < 4; ++i)
+			{
+				ret.Vec()[i] = v[i];
+			}
+#endif
+			return ret;
+		}
+
+		inline void StoreVector1(float& fs, SIMDVectorF4 const & v)
+		{
+#if defined(SIMD_MATH_SSE)
+			_mm_store_ss(&fs, v.Vec());
+#elif defined(SIMD_MATH_NEON)
+			fs = vgetq_lane_f32(v.Vec(), 0);
+#else
+			fs = v.Vec()[0];
+#endif
+		}
+
+		inline void StoreVector2(float2& fs, SIMDVectorF4 const & v)
+		{
+#if defined(SIMD_MATH_SSE)
+			__m128 x = v.Vec();
+			__m128 y = _mm_shuffle_ps(x, x, _MM_SHUFFLE(1, 1, 1, 1));
+			_mm_store_ss(&fs[0], x);
+			_mm_store_ss(&fs[1], y);
+#elif defined(SIMD_MATH_NEON)
+			vst1_f32(&fs[0], vget_low_f32(v.Vec()));
+#else
+			for (int i = 0; i < 2; ++ i)
+			{
+				fs[i] = v.Vec()[i];
+			}
+#endif
+		}
+
+		inline void StoreVector3(float3& fs, SIMDVectorF4 const & v)
+		{
+#if defined(SIMD_MATH_SSE)
+			__m128 x = v.Vec();
+			__m128 y = _mm_shuffle_ps(x, x, _MM_SHUFFLE(1, 1, 1, 1));
+			__m128 z = _mm_shuffle_ps(x, x, _MM_SHUFFLE(2, 2, 2, 2));
+			_mm_store_ss(&fs[0], x);
+			_mm_store_ss(&fs[1], y);
+			_mm_store_ss(&fs[2], z);
+#elif defined(SIMD_MATH_NEON)
+			vst1_f32(&fs[0], vget_low_f32(v.Vec()));
+			fs[2] = vgetq_lane_f32(v.Vec(), 2);
+#else
+			for (int i = 0; i < 3; ++ i)
+			{
+				fs[i] = v.Vec()[i];
+			}
+#endif
+		}
+
+		inline void StoreVector4(float4& fs, SIMDVectorF4 const & v)
+		{
+			StoreVector4(&fs[0], v);
+		}
+
+		inline void StoreVector4(float* fs, SIMDVectorF4 const & v)
+		{
+#if defined(SIMD_MATH_SSE)
+			_mm_storeu_ps(fs, v.Vec());
+#elif defined(SIMD_MATH_NEON)
+			vst1q_f32(fs, v.Vec());
+#else
+			for (int i = 0; i < 4; ++ i)
+			{
+				fs[i] = v.Vec()[i];
+			}
+#endif
+		}
+
+		inline SIMDVectorF4 SetVector(float x, float y, float z, float w)
+		{
+			SIMDVectorF4 ret;
+#if defined(SIMD_MATH_SSE)
+			ret.Vec() = _mm_set_ps(w, z, y, x);
+#elif defined(SIMD_MATH_NEON)
+			float const v[] = { x, y, z, w };
+			ret.Vec() = vld1q_f32(v);
+#else
+			ret.Vec()[0] = x;
+			ret.Vec()[1] = y;
+			ret.Vec()[2] = z;
+			ret.Vec()[3] = w;
+#endif
+			return ret;
+		}
+
+		inline SIMDVectorF4 SetVector(float v)
+		{
+			SIMDVectorF4 ret;
+#if defined(SIMD_MATH_SSE)
+			ret.Vec() = _mm_set_ps1(v);
+#elif defined(SIMD_MATH_NEON)
+			ret.Vec() = vdupq_n_f32(v);
+#else
+			ret.Vec()[0] = v;
+			ret.Vec()[1] = v;
+			ret.Vec()[2] = v;
+			ret.Vec()[3] = v;
+#endif
+			return ret;
+		}
+
+		inline float GetX(SIMDVectorF4 const & rhs)
+		{
+#if defined(SIMD_MATH_SSE)
+			return _mm_cvtss_f32(rhs.Vec());
+#elif defined(SIMD_MATH_NEON)
+			return vgetq_lane_f32(rhs.Vec(), 0);
+#else
+			return GetByIndex(rhs, 0);
+#endif
+		}
+
+		inline float GetY(SIMDVectorF4 const & rhs)
+		{
+#if defined(SIMD_MATH_SSE)
+			__m128 tmp = _mm_shuffle_ps(rhs.Vec(), rhs.Vec(), _MM_SHUFFLE(1, 1, 1, 1));
+			return _mm_cvtss_f32(tmp);
+#elif defined(SIMD_MATH_NEON)
+			return vgetq_lane_f32(rhs.Vec(), 1);
+#else
+			return GetByIndex(rhs, 1);
+#endif
+		}
+
+		inline float GetZ(SIMDVectorF4 const & rhs)
+		{
+#if defined(SIMD_MATH_SSE)
+			__m128 tmp = _mm_shuffle_ps(rhs.Vec(), rhs.Vec(), _MM_SHUFFLE(2, 2, 2, 2));
+			return _mm_cvtss_f32(tmp);
+#elif defined(SIMD_MATH_NEON)
+			return vgetq_lane_f32(rhs.Vec(), 2);
+#else
+			return GetByIndex(rhs, 2);
+#endif
+		}
+
+		inline float GetW(SIMDVectorF4 const & rhs)
+		{
+#if defined(SIMD_MATH_SSE)
+			__m128 tmp = _mm_shuffle_ps(rhs.Vec(), rhs.Vec(), _MM_SHUFFLE(3, 3, 3, 3));
+			return _mm_cvtss_f32(tmp);
+#elif defined(SIMD_MATH_NEON)
+			return vgetq_lane_f32(rhs.Vec(), 3);
+#else
+			return GetByIndex(rhs, 3);
+#endif
+		}
+
+		inline float GetByIndex(SIMDVectorF4 const & rhs, size_t index)
+		{
+#if defined(SIMD_MATH_SSE)
+#ifdef KLAYGE_COMPILER_MSVC
+			return rhs.Vec().m128_f32[index];
+#else
+			union
+			{
+				__m128 v;
+				float comp[4];
+			} converter;
+			converter.v = rhs.Vec();
+			return converter.comp[index];
+#endif
+#else
+			return rhs.Vec()[index];
+#endif
+		}
+
+		inline SIMDVectorF4 SetByIndex(SIMDVectorF4 const & rhs, float v, size_t index)
+		{
+			SIMDVectorF4 ret = rhs;
+#if defined(SIMD_MATH_SSE)
+#ifdef KLAYGE_COMPILER_MSVC
+			ret.Vec().m128_f32[index] = v;
+#else
+			union
+			{
+				__m128 v;
+				float comp[4];
+			} converter;
+			converter.v = rhs.Vec();
+			converter.comp[index] = v;
+			ret.Vec() = converter.v;
+#endif
+#else
+			ret.Vec()[index] = v;
+#endif
+			return ret;
+		}
+
+		inline SIMDVectorF4 Maximize(SIMDVectorF4 const & lhs, SIMDVectorF4 const & rhs)
+		{
+			SIMDVectorF4 ret;
+#if defined(SIMD_MATH_SSE)
+			ret.Vec() = _mm_max_ps(lhs.Vec(), rhs.Vec());
+#elif defined(SIMD_MATH_NEON)
+			ret.Vec() = vmaxq_f32(lhs.Vec(), rhs.Vec());
+#else
+			for (int i = 0; i < 4; ++ i)
+			{
+				ret.Vec()[i] = std::max(lhs.Vec()[i], rhs.Vec()[i]);
+			}
+#endif
+			return ret;
+		}
+
+		inline SIMDVectorF4 Minimize(SIMDVectorF4 const & lhs, SIMDVectorF4 const & rhs)
+		{
+			SIMDVectorF4 ret;
+#if defined(SIMD_MATH_SSE)
+			ret.Vec() = _mm_min_ps(lhs.Vec(), rhs.Vec());
+#elif defined(SIMD_MATH_NEON)
+			ret.Vec() = vminq_f32(lhs.Vec(), rhs.Vec());
+#else
+			for (int i = 0; i < 4; ++ i)
+			{
+				ret.Vec()[i] = std::min(lhs.Vec()[i], rhs.Vec()[i]);
+			}
+#endif
+			return ret;
+		}
+
+		inline uint32_t LessMask(SIMDVectorF4 const & lhs, SIMDVectorF4 const & rhs)
+		{
+#if defined(SIMD_MATH_SSE)
+			return static_cast<uint32_t>(_mm_movemask_ps(_mm_cmplt_ps(lhs.Vec(), rhs.Vec())));
+#elif defined(SIMD_MATH_NEON)
+			int32_t const shifts[] = { 0, 1, 2, 3 };
+			uint32x4_t const bits = vshrq_n_u32(vcltq_f32(lhs.Vec(), rhs.Vec()), 31);
+			return vaddvq_u32(vshlq_u32(bits, vld1q_s32(shifts)));
+#else
+			uint32_t ret = 0;
+			for (int i = 0; i < 4; ++ i)
+			{
+				if (lhs.Vec()[i] < rhs.Vec()[i])
+				{
+					ret |= 1U << i;
+				}
+			}
+			return ret;
+#endif
+		}
+
+		inline SIMDVectorF4 SelectGreaterEqual(SIMDVectorF4 const & lhs, SIMDVectorF4 const & rhs, SIMDVectorF4 const & if_ge,
+			SIMDVectorF4 const & if_lt)
+		{
+			SIMDVectorF4 ret;
+#if defined(SIMD_MATH_SSE4)
+			ret.Vec() = _mm_blendv_ps(if_lt.Vec(), if_ge.Vec(), _mm_cmpge_ps(lhs.Vec(), rhs.Vec()));
+#elif defined(SIMD_MATH_SSE)
+			__m128 const mask = _mm_cmpge_ps(lhs.Vec(), rhs.Vec());
+			ret.Vec() = _mm_or_ps(_mm_and_ps(mask, if_ge.Vec()), _mm_andnot_ps(mask, if_lt.Vec()));
+#elif defined(SIMD_MATH_NEON)
+			ret.Vec() = vbslq_f32(vcgeq_f32(lhs.Vec(), rhs.Vec()), if_ge.Vec(), if_lt.Vec());
+#else
+			for (int i = 0; i < 4; ++ i)
+			{
+				ret.Vec()[i] = (lhs.Vec()[i] >= rhs.Vec()[i]) ? if_ge.Vec()[i] : if_lt.Vec()[i];
+			}
+#endif
+			return ret;
+		}
+
+		// 3D Vector
+		///////////////////////////////////////////////////////////////////////////////
+		inline SIMDVectorF4 DotVector3(SIMDVectorF4 const & lhs, SIMDVectorF4 const & rhs)
+		{
+			SIMDVectorF4 ret;
+#if defined(SIMD_MATH_SSE4)
+			ret.Vec() = _mm_dp_ps(lhs.Vec(), rhs.Vec(), 0x7F);
+#elif defined(SIMD_MATH_SSE)
+			__m128 res1 = lhs.Vec();
+			__m128 res2 = rhs.Vec();
+			res1 = _mm_mul_ps(res1, res2);
+			__m128 y = _mm_shuffle_ps(res1, res1, _MM_SHUFFLE(1, 1, 1, 1));
+			__m128 z = _mm_shuffle_ps(res1, res1, _MM_SHUFFLE(2, 2, 2, 2));
+			res1 = _mm_add_ps(res1, y);
+			res1 = _mm_add_ps(res1, z);
+			ret.Vec() = _mm_shuffle_ps(res1, res1, _MM_SHUFFLE(0, 0, 0, 0));
+#elif defined(SIMD_MATH_NEON)
+			float32x4_t const res = vsetq_lane_f32(0, vmulq_f32(lhs.Vec(), rhs.Vec()), 3);
+			ret.Vec() = vdupq_n_f32(vaddvq_f32(res));
+#else
+			ret = SetVector(GetX(lhs) * GetX(rhs) + GetY(lhs) * GetY(rhs)
+				+ GetZ(lhs) * GetZ(rhs));
+#endif
+			return ret;
+		}
+
+		// Unlike the other transforms, w is divided exactly, so bounds built from the results don't shrink
+		inline SIMDVectorF4 TransformCoordVector3(SIMDVectorF4 const & v, SIMDMatrixF4 const & mat)
+		{
+			SIMDVectorF4 ret;
+#if defined(SIMD_MATH_SSE) || defined(SIMD_MATH_NEON)
+			SIMDVectorF4 res = MultiplyAdd(SetVector(GetZ(v)), mat.Row(2), mat.Row(3));
+			res = MultiplyAdd(SetVector(GetY(v)), mat.Row(1), res);
+			res = MultiplyAdd(SetVector(GetX(v)), mat.Row(0), res);
+			ret = Divide(res, SetVector(GetW(res)));
+#else
+			SIMDVectorF4 temp;
+			for (int i = 0; i < 4; ++ i)
+			{
+				temp.Vec()[i] = GetX(v) * mat(0, i) + GetY(v) * mat(1, i)
+					+ GetZ(v) * mat(2, i) + mat(3, i);
+			}
+			if (MathLib::equal(GetW(temp), 0.0f))
+			{
+				ret = SIMDVectorF4::Zero();
+			}
+			else
+			{
+				for (int i = 0; i < 3; ++ i)
+				{
+					ret.Vec()[i] = temp.Vec()[i] / GetW(temp);
+				}
+				for (int i = 3; i < 4; ++ i)
+				{
+					ret.Vec()[i] = 0;
+				}
+			}
+#endif
+			return ret;
+		}
+
+		inline SIMDVectorF4 TransformNormalVector3(SIMDVectorF4 const & v, SIMDMatrixF4 const & mat)
+		{
+			SIMDVectorF4 ret;
+#if defined(SIMD_MATH_SSE) || defined(SIMD_MATH_NEON)
+			ret = Multiply(SetVector(GetZ(v)), mat.Row(2));
+			ret = MultiplyAdd(SetVector(GetY(v)), mat.Row(1), ret);
+			ret = MultiplyAdd(SetVector(GetX(v)), mat.Row(0), ret);
+#else
+			for (int i = 0; i < 3; ++ i)
+			{
+				ret.Vec()[i] = GetX(v) * mat(0, i) + GetY(v) * mat(1, i)
+					+ GetZ(v) * mat(2, i);
+			}
+			for (int i = 3; i < 4; ++ i)
+			{
+				ret.Vec()[i] = 0;
+			}
+#endif
+			return ret;
+		}
+
+		// 4D Vector
+		///////////////////////////////////////////////////////////////////////////////
+		inline SIMDVectorF4 DotVector4(SIMDVectorF4 const & lhs, SIMDVectorF4 const & rhs)
+		{
+			SIMDVectorF4 ret;
+#if defined(SIMD_MATH_SSE4)
+			ret.Vec() = _mm_dp_ps(lhs.Vec(), rhs.Vec(), 0xFF);
+#elif defined(SIMD_MATH_SSE)
+			__m128 res1 = lhs.Vec();
+			__m128 res2 = rhs.Vec();
+			res1 = _mm_mul_ps(res1, res2);
+			__m128 yw = _mm_shuffle_ps(res1, res1, _MM_SHUFFLE(1, 1, 3, 3));
+			res1 = _mm_add_ps(res1, yw);
+			__m128 zw = _mm_shuffle_ps(res1, res1, _MM_SHUFFLE(2, 2, 2, 2));
+			res1 = _mm_add_ps(res1, zw);
+			ret.Vec() = _mm_shuffle_ps(res1, res1, _MM_SHUFFLE(0, 0, 0, 0));
+#elif defined(SIMD_MATH_NEON)
+			ret.Vec() = vdupq_n_f32(vaddvq_f32(vmulq_f32(lhs.Vec(), rhs.Vec())));
+#else
+			ret = SetVector(GetX(lhs) * GetX(rhs) + GetY(lhs) * GetY(rhs)
+				+ GetZ(lhs) * GetZ(rhs) + GetW(lhs) * GetW(rhs));
+#endif
+			return ret;
+		}
+
+		inline SIMDVectorF4 TransformVector4(SIMDVectorF4 const & v, SIMDMatrixF4 const & mat)
+		{
+			SIMDVectorF4 ret;
+#if defined(SIMD_MATH_SSE)
+			__m128 const temp = v.Vec();
+			SIMDVectorF4 x, y, z, w;
+			x.Vec() = _mm_shuffle_ps(temp, temp, _MM_SHUFFLE(0, 0, 0, 0));
+			y.Vec() = _mm_shuffle_ps(temp, temp, _MM_SHUFFLE(1, 1, 1, 1));
+			z.Vec() = _mm_shuffle_ps(temp, temp, _MM_SHUFFLE(2, 2, 2, 2));
+			w.Vec() = _mm_shuffle_ps(temp, temp, _MM_SHUFFLE(3, 3, 3, 3));
+			ret = MultiplyAdd(x, mat.Row(0), MultiplyAdd(y, mat.Row(1), MultiplyAdd(z, mat.Row(2), Multiply(w, mat.Row(3)))));
+#elif defined(SIMD_MATH_NEON)
+			float32x4_t res = vmulq_laneq_f32(mat.Row(3).Vec(), v.Vec(), 3);
+			res = vfmaq_laneq_f32(res, mat.Row(2).Vec(), v.Vec(), 2);
+			res = vfmaq_laneq_f32(res, mat.Row(1).Vec(), v.Vec(), 1);
+			ret.Vec() = vfmaq_laneq_f32(res, mat.Row(0).Vec(), v.Vec(), 0);
+#else
+			for (int i = 0; i < 4; ++ i)
+			{
+				ret.Vec()[i] = GetX(v) * mat(0, i) + GetY(v) * mat(1, i)
+					+ GetZ(v) * mat(2, i) + GetW(v) * mat(3, i);
+			}
+#endif
+			return ret;
+		}
+
+		// 4D Matrix
+		///////////////////////////////////////////////////////////////////////////////
+		inline SIMDMatrixF4 LoadMatrix(float4x4 const & m)
+		{
+			return SIMDMatrixF4(m.data());
+		}
+
+		inline void StoreMatrix(float4x4& m, SIMDMatrixF4 const & v)
+		{
+			float4 row;
+			for (size_t i = 0; i < 4; ++ i)
+			{
+				StoreVector4(row, v.Row(i));
+				m.Row(i, row);
+			}
+		}
+
+		inline SIMDMatrixF4 Add(SIMDMatrixF4 const & lhs, SIMDMatrixF4 const & rhs)
+		{
+			return SIMDMatrixF4(Add(lhs.Row(0), rhs.Row(0)),
+				Add(lhs.Row(1), rhs.Row(1)),
+				Add(lhs.Row(2), rhs.Row(2)),
+				Add(lhs.Row(3), rhs.Row(3)));
+		}
+
+		inline SIMDMatrixF4 Substract(SIMDMatrixF4 const & lhs, SIMDMatrixF4 const & rhs)
+		{
+			return SIMDMatrixF4(Substract(lhs.Row(0), rhs.Row(0)),
+				Substract(lhs.Row(1), rhs.Row(1)),
+				Substract(lhs.Row(2), rhs.Row(2)),
+				Substract(lhs.Row(3), rhs.Row(3)));
+		}
+
+		// Row i of the product is row i of lhs transformed by rhs
+		inline SIMDMatrixF4 Multiply(SIMDMatrixF4 const & lhs, SIMDMatrixF4 const & rhs)
+		{
+			return SIMDMatrixF4(TransformVector4(lhs.Row(0), rhs),
+				TransformVector4(lhs.Row(1), rhs),
+				TransformVector4(lhs.Row(2), rhs),
+				TransformVector4(lhs.Row(3), rhs));
+		}
+
+		inline SIMDMatrixF4 Multiply(SIMDMatrixF4 const & lhs, float rhs)
+		{
+			SIMDVectorF4 r = SetVector(rhs);
+			return SIMDMatrixF4(Multiply(lhs.Row(0), r),
+				Multiply(lhs.Row(1), r),
+				Multiply(lhs.Row(2), r),
+				Multiply(lhs.Row(3), r));
+		}
+
+		inline SIMDMatrixF4 Negative(SIMDMatrixF4 const & rhs)
+		{
+			return SIMDMatrixF4(Negative(rhs.Row(0)),
+				Negative(rhs.Row(1)),
+				Negative(rhs.Row(2)),
+				Negative(rhs.Row(3)));
+		}
+
+		inline SIMDMatrixF4 Transpose(SIMDMatrixF4 const & rhs)
+		{
+#if defined(SIMD_MATH_SSE)
+			SIMDVectorF4 r0 = rhs.Row(0);
+			SIMDVectorF4 r1 = rhs.Row(1);
+			SIMDVectorF4 r2 = rhs.Row(2);
+			SIMDVectorF4 r3 = rhs.Row(3);
+			_MM_TRANSPOSE4_PS(r0.Vec(), r1.Vec(), r2.Vec(), r3.Vec());
+			return SIMDMatrixF4(r0, r1, r2, r3);
+#elif defined(SIMD_MATH_NEON)
+			float32x4_t const t0 = vzip1q_f32(rhs.Row(0).Vec(), rhs.Row(2).Vec());
+			float32x4_t const t1 = vzip1q_f32(rhs.Row(1).Vec(), rhs.Row(3).Vec());
+			float32x4_t const t2 = vzip2q_f32(rhs.Row(0).Vec(), rhs.Row(2).Vec());
+			float32x4_t const t3 = vzip2q_f32(rhs.Row(1).Vec(), rhs.Row(3).Vec());
+			SIMDVectorF4 r0, r1, r2, r3;
+			r0.Vec() = vzip1q_f32(t0, t1);
+			r1.Vec() = vzip2q_f32(t0, t1);
+			r2.Vec() = vzip1q_f32(t2, t3);
+			r3.Vec() = vzip2q_f32(t2, t3);
+			return SIMDMatrixF4(r0, r1, r2, r3);
+#else
+			V4TYPE const & r0 = rhs.Row(0).Vec();
+			V4TYPE const & r1 = rhs.Row(1).Vec();
+			V4TYPE const & r2 = rhs.Row(2).Vec();
+			V4TYPE const & r3 = rhs.Row(3).Vec();
+			return SIMDMatrixF4(
+				r0[0], r1[0], r2[0], r3[0],
+				r0[1], r1[1], r2[1], r3[1],
+				r0[2], r1[2], r2[2], r3[2],
+				r0[3], r1[3], r2[3], r3[3]);
+#endif
+		}
+
+		// Quaternion
+		///////////////////////////////////////////////////////////////////////////////
+		inline SIMDVectorF4 LoadQuaternion(Quaternion const & q)
+		{
+			return LoadVector4(&q[0]);
+		}
+
+		inline void StoreQuaternion(Quaternion& q, SIMDVectorF4 const & v)
+		{
+			float4 tmp;
+			StoreVector4(tmp, v);
+			q = Quaternion(&tmp[0]);
+		}
+
+		// Same as MathLib::mul. Each component of lhs scales a signed permutation of rhs.
+		inline SIMDVectorF4 MultiplyQuat(SIMDVectorF4 const & lhs, SIMDVectorF4 const & rhs)
+		{
+#if defined(SIMD_MATH_SSE) || defined(SIMD_MATH_NEON)
+			SIMDVectorF4 wzyx, zwxy, yxwz;
+#if defined(SIMD_MATH_SSE)
+			wzyx.Vec() = _mm_shuffle_ps(rhs.Vec(), rhs.Vec(), _MM_SHUFFLE(0, 1, 2, 3));
+			zwxy.Vec() = _mm_shuffle_ps(rhs.Vec(), rhs.Vec(), _MM_SHUFFLE(1, 0, 3, 2));
+			yxwz.Vec() = _mm_shuffle_ps(rhs.Vec(), rhs.Vec(), _MM_SHUFFLE(2, 3, 0, 1));
+#else
+			zwxy.Vec() = vextq_f32(rhs.Vec(), rhs.Vec(), 2);
+			wzyx.Vec() = vrev64q_f32(zwxy.Vec());
+			yxwz.Vec() = vrev64q_f32(rhs.Vec());
+#endif
+			float const x = GetX(lhs);
+			float const y = GetY(lhs);
+			float const z = GetZ(lhs);
+			SIMDVectorF4 ret = Multiply(SetVector(GetW(lhs)), rhs);
+			ret = MultiplyAdd(SetVector(x, x, -x, -x), wzyx, ret);
+			ret = MultiplyAdd(SetVector(-y, y, y, -y), zwxy, ret);
+			ret = MultiplyAdd(SetVector(z, -z, z, -z), yxwz, ret);
+			return ret;
+#else
+			return SetVector(
+				GetX(lhs) * GetW(rhs) - GetY(lhs) * GetZ(rhs) + GetZ(lhs) * GetY(rhs) + GetW(lhs) * GetX(rhs),
+				GetX(lhs) * GetZ(rhs) + GetY(lhs) * GetW(rhs) - GetZ(lhs) * GetX(rhs) + GetW(lhs) * GetY(rhs),
+				GetY(lhs) * GetX(rhs) - GetX(lhs) * GetY(rhs) + GetZ(lhs) * GetW(rhs) + GetW(lhs) * GetZ(rhs),
+				GetW(lhs) * GetW(rhs) - GetX(lhs) * GetX(rhs) - GetY(lhs) * GetY(rhs) - GetZ(lhs) * GetZ(rhs));
+#endif
+		}
+	}
+}
+
 #endif		// _KFL_SIMDMATH_HPP
@@ -28,6 +28,10 @@
  * from http://www.klayge.org/licensing/.
  */
 
+// The members are built on SIMDMathLib, which also picks the SIMD instruction set. SIMDMath.hpp declares them and then
+// includes this file, so including it first works either way.
+#include <KFL/SIMDMath.hpp>
+
 #ifndef _KFL_SIMDVECTOR_HPP
 #define _KFL_SIMDVECTOR_HPP
 
@@ -39,6 +43,8 @@ namespace KlayGE
 {
 #if defined(SIMD_MATH_SSE)
 	typedef __m128 V4TYPE;
+#elif defined(SIMD_MATH_NEON)
+	typedef float32x4_t V4TYPE;
 #else
 	typedef std::array<float, 4> V4TYPE;
 #endif
@@ -56,7 +62,10 @@ namespace KlayGE
 		SIMDVectorF4()
 		{
 		}
-		SIMDVectorF4(SIMDVectorF4 const & rhs);
+		SIMDVectorF4(SIMDVectorF4 const & rhs)
+			: vec_(rhs.vec_)
+		{
+		}
 
 		static size_t size()
 		{
@@ -74,21 +83,65 @@ namespace KlayGE
 			return vec_;
 		}
 
-		SIMDVectorF4 const & operator+=(SIMDVectorF4 const & rhs);
-		SIMDVectorF4 const & operator+=(float rhs);
-		SIMDVectorF4 const & operator-=(SIMDVectorF4 const & rhs);
-		SIMDVectorF4 const & operator-=(float rhs);
-		SIMDVectorF4 const & operator*=(SIMDVectorF4 const & rhs);
-		SIMDVectorF4 const & operator*=(float rhs);
-		SIMDVectorF4 const & operator/=(SIMDVectorF4 const & rhs);
-		SIMDVectorF4 const & operator/=(float rhs);
+		SIMDVectorF4 const & operator+=(SIMDVectorF4 const & rhs)
+		{
+			*this = SIMDMathLib::Add(*this, rhs);
+			return *this;
+		}
+		SIMDVectorF4 const & operator+=(float rhs)
+		{
+			*this = SIMDMathLib::Add(*this, SIMDMathLib::SetVector(rhs));
+			return *this;
+		}
+		SIMDVectorF4 const & operator-=(SIMDVectorF4 const & rhs)
+		{
+			*this = SIMDMathLib::Substract(*this, rhs);
+			return *this;
+		}
+		SIMDVectorF4 const & operator-=(float rhs)
+		{
+			*this = SIMDMathLib::Substract(*this, SIMDMathLib::SetVector(rhs));
+			return *this;
+		}
+		SIMDVectorF4 const & operator*=(SIMDVectorF4 const & rhs)
+		{
+			*this = SIMDMathLib::Multiply(*this, rhs);
+			return *this;
+		}
+		SIMDVectorF4 const & operator*=(float rhs)
+		{
+			*this = SIMDMathLib::Multiply(*this, SIMDMathLib::SetVector(rhs));
+			return *this;
+		}
+		SIMDVectorF4 const & operator/=(SIMDVectorF4 const & rhs)
+		{
+			*this = SIMDMathLib::Divide(*this, rhs);
+			return *this;
+		}
+		SIMDVectorF4 const & operator/=(float rhs)
+		{
+			return this->operator*=(1.0f / rhs);
+		}
 
-		SIMDVectorF4& operator=(SIMDVectorF4 const & rhs);
+		SIMDVectorF4& operator=(SIMDVectorF4 const & rhs)
+		{
+			vec_ = rhs.vec_;
+			return *this;
+		}
 
-		SIMDVectorF4 const operator+() const;
-		SIMDVectorF4 const operator-() const;
+		SIMDVectorF4 const operator+() const
+		{
+			return *this;
+		}
+		SIMDVectorF4 const operator-() const
+		{
+			return SIMDMathLib::Negative(*this);
+		}
 
-		void swap(SIMDVectorF4& rhs);
+		void swap(SIMDVectorF4& rhs)
+		{
+			std::swap(vec_, rhs.vec_);
+		}
 
 	private:
 		V4TYPE vec_{};
@@ -0,0 +1,244 @@
+/**
+ * @file TaskScheduler.hpp
+ * @author Minmin Gong
+ *
+ * @section DESCRIPTION
+ *
+ * This source file is part of KFL, a subproject of KlayGE
+ * For the latest info, see http://www.klayge.org
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * You may alternatively use this source under the terms of
+ * the KlayGE Proprietary License (KPL). You can obtained such a license
+ * from http://www.klayge.org/licensing/.
+ */
+
+#ifndef _KFL_TASK_SCHEDULER_HPP
+#define _KFL_TASK_SCHEDULER_HPP
+
+#pragma once
+
+#include <boost/noncopyable.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace KlayGE
+{
+	// Counts the unfinished tasks that are run with it. Waiting on a counter is how one piece of work depends on others.
+	class task_counter final : boost::noncopyable
+	{
+		friend class task_scheduler;
+
+	public:
+		task_counter() noexcept
+			: count_(0)
+		{
+		}
+
+		bool done() const noexcept
+		{
+			return count_.load(std::memory_order_acquire) == 0;
+		}
+
+	private:
+		// Keeps the first exception thrown by the tasks, for the wait to rethrow
+		void capture_exception(std::exception_ptr exception)
+		{
+			std::lock_guard<std::mutex> lock(exception_mutex_);
+			if (!exception_)
+			{
+				exception_ = std::move(exception);
+			}
+		}
+
+	private:
+		std::atomic<uint32_t> count_;
+
+		std::mutex exception_mutex_;
+		std::exception_ptr exception_;
+	};
+
+	// Work stealing task scheduler. Each worker has a deque of its own. It takes the newest task from it, and steals the oldest
+	// tasks of the others when it runs dry. Threads outside the scheduler share one more deque. A task is only a function
+	// pointer, a context and a range, so running one doesn't allocate anything beyond the deque storage.
+	class task_scheduler final : boost::noncopyable
+	{
+	public:
+		typedef void (*task_func)(void* context, uint32_t begin, uint32_t end);
+
+		// 0 means one worker for each hardware thread, except the one that waits for the results
+		explicit task_scheduler(uint32_t num_workers = 0);
+		~task_scheduler();
+
+		uint32_t num_workers() const noexcept
+		{
+			return static_cast<uint32_t>(threads_.size());
+		}
+
+		void run(task_counter& counter, task_func func, void* context, uint32_t begin = 0, uint32_t end = 0);
+
+		// The functor isn't copied. It must outlive the wait on the counter.
+		template <typename Func>
+		void run(task_counter& counter, Func& func)
+		{
+			this->run(counter,
+				[](void* context, uint32_t, uint32_t) {
+					(*static_cast<Func*>(context))();
+				},
+				&func);
+		}
+
+		// Runs the queued tasks of the counter until it reaches 0, so it can also be called inside a task. Tasks of other
+		// counters are left to the workers, so a thread that waits while holding a lock never runs unrelated work. Sleeps when
+		// there is nothing to run. If any of the tasks threw, the first exception is rethrown once all of them are done.
+		void wait(task_counter& counter);
+
+		// Calls func(sub_begin, sub_end) on pieces of [begin, end). The range is split in halves until the pieces are no longer
+		// than grain_size, so idle workers steal big pieces first. If func throws, the other pieces still run, and the first
+		// exception is rethrown after all of them are done.
+		template <typename Func>
+		void parallel_for(uint32_t begin, uint32_t end, uint32_t grain_size, Func const & func)
+		{
+			if (begin >= end)
+			{
+				return;
+			}
+
+			grain_size = std::max(grain_size, 1U);
+			if (threads_.empty() || (end - begin <= grain_size))
+			{
+				func(begin, end);
+				return;
+			}
+
+			task_counter counter;
+			parallel_for_context<Func> context{ this, &counter, &func, grain_size };
+			try
+			{
+				parallel_for_context<Func>::split(&context, begin, end);
+			}
+			catch (...)
+			{
+				// The pieces already handed out point to this stack frame, so they have to finish before it unwinds
+				counter.capture_exception(std::current_exception());
+			}
+			this->wait(counter);
+		}
+
+		// func(sub_begin, sub_end) returns the result of a piece, and reduce(lhs, rhs) combines 2 results. Results are combined
+		// in the order of the pieces, so the result doesn't depend on the scheduling.
+		template <typename T, typename Func, typename Reduce>
+		T parallel_reduce(uint32_t begin, uint32_t end, uint32_t grain_size, T const & identity, Func const & func,
+			Reduce const & reduce)
+		{
+			if (begin >= end)
+			{
+				return identity;
+			}
+
+			grain_size = std::max(grain_size, 1U);
+			uint32_t const max_pieces = (this->num_workers() + 1) * 4;
+			uint32_t const piece_size = std::max(grain_size, (end - begin + max_pieces - 1) / max_pieces);
+			uint32_t const num_pieces = (end - begin + piece_size - 1) / piece_size;
+
+			std::vector<T> results(num_pieces, identity);
+			this->parallel_for(0, num_pieces, 1, [begin, end, piece_size, &results, &func](uint32_t piece_begin, uint32_t piece_end) {
+				for (uint32_t piece = piece_begin; piece < piece_end; ++ piece)
+				{
+					uint32_t const sub_begin = begin + piece * piece_size;
+					results[piece] = func(sub_begin, std::min(sub_begin + piece_size, end));
+				}
+			});
+
+			T ret = identity;
+			for (auto const & result : results)
+			{
+				ret = reduce(ret, result);
+			}
+			return ret;
+		}
+
+	private:
+		struct task
+		{
+			task_func func;
+			void* context;
+			uint32_t begin;
+			uint32_t end;
+			task_counter* counter;
+		};
+
+		struct task_queue
+		{
+			std::mutex mutex;
+			std::deque<task> tasks;
+		};
+
+		template <typename Func>
+		struct parallel_for_context
+		{
+			task_scheduler* scheduler;
+			task_counter* counter;
+			Func const * func;
+			uint32_t grain_size;
+
+			// Keeps the first half, and hands the second half to the scheduler, until the piece is small enough
+			static void split(void* ctx, uint32_t begin, uint32_t end)
+			{
+				auto const & context = *static_cast<parallel_for_context const *>(ctx);
+				while (end - begin > context.grain_size)
+				{
+					uint32_t const mid = begin + (end - begin) / 2;
+					context.scheduler->run(*context.counter, &parallel_for_context::split, ctx, mid, end);
+					end = mid;
+				}
+				(*context.func)(begin, end);
+			}
+		};
+
+		void worker_func(uint32_t index);
+		uint32_t queue_index() const;
+		// A null counter takes any task
+		bool try_pop(uint32_t index, task_counter const * counter, task& t);
+		void execute(task const & t);
+
+	private:
+		// The last one is shared by the threads outside the scheduler
+		std::vector<std::unique_ptr<task_queue>> queues_;
+		std::vector<std::thread> threads_;
+
+		std::atomic<uint32_t> num_pending_;
+		// Bumped by every run, so a sleeping wait can tell that new tasks came in
+		std::atomic<uint32_t> num_pushed_;
+		std::atomic<uint32_t> num_sleeping_;
+		std::mutex sleep_mutex_;
+		std::condition_variable sleep_cond_;
+		std::atomic<bool> quit_;
+	};
+}
+
+#endif		// _KFL_TASK_SCHEDULER_HPP
@@ -33,7 +33,10 @@
 
 #pragma once
 
+#include <cstddef>
 #include <iosfwd>
+#include <iterator>
+#include <string_view>
 #include <vector>
 
 #include <boost/noncopyable.hpp>
@@ -62,6 +65,222 @@ namespace KlayGE
 		XNT_PI
 	};
 
+	// Forward range over a list of sibling nodes or attributes. An empty name visits all of them, otherwise only the ones
+	// with that name.
+	template <typename Handle>
+	class XMLHandleRange final
+	{
+	public:
+		class iterator final
+		{
+		public:
+			typedef std::forward_iterator_tag iterator_category;
+			typedef Handle value_type;
+			typedef std::ptrdiff_t difference_type;
+			typedef Handle const * pointer;
+			typedef Handle const & reference;
+
+			iterator() noexcept = default;
+			iterator(Handle handle, std::string_view name) noexcept
+				: handle_(handle), name_(name)
+			{
+			}
+
+			reference operator*() const noexcept
+			{
+				return handle_;
+			}
+			pointer operator->() const noexcept
+			{
+				return &handle_;
+			}
+
+			iterator& operator++()
+			{
+				handle_ = handle_.Next(name_);
+				return *this;
+			}
+			iterator operator++(int)
+			{
+				iterator ret = *this;
+				++ *this;
+				return ret;
+			}
+
+			bool operator==(iterator const & rhs) const noexcept
+			{
+				return handle_ == rhs.handle_;
+			}
+			bool operator!=(iterator const & rhs) const noexcept
+			{
+				return handle_ != rhs.handle_;
+			}
+
+		private:
+			Handle handle_;
+			std::string_view name_;
+		};
+
+		XMLHandleRange(Handle first, std::string_view name) noexcept
+			: first_(first), name_(name)
+		{
+		}
+
+		iterator begin() const noexcept
+		{
+			return iterator(first_, name_);
+		}
+		iterator end() const noexcept
+		{
+			return iterator(Handle(), name_);
+		}
+		bool empty() const noexcept
+		{
+			return !first_;
+		}
+
+	private:
+		Handle first_;
+		std::string_view name_;
+	};
+
+	// Handle of a node in a document. It's only a pointer, so walking a document with it doesn't allocate anything. It acts
+	// like a XMLNodePtr to a const node, so read-only code works with either of them. Only valid while the document lives.
+	class XMLNodeHandle final
+	{
+	public:
+		XMLNodeHandle() noexcept = default;
+		explicit XMLNodeHandle(rapidxml::xml_node<char>* node) noexcept
+			: node_(node)
+		{
+		}
+
+		explicit operator bool() const noexcept
+		{
+			return node_ != nullptr;
+		}
+		XMLNodeHandle const * operator->() const noexcept
+		{
+			return this;
+		}
+		XMLNodeHandle const & operator*() const noexcept
+		{
+			return *this;
+		}
+
+		bool operator==(XMLNodeHandle const & rhs) const noexcept
+		{
+			return node_ == rhs.node_;
+		}
+		bool operator!=(XMLNodeHandle const & rhs) const noexcept
+		{
+			return node_ != rhs.node_;
+		}
+
+		std::string_view Name() const;
+		XMLNodeType Type() const;
+
+		XMLNodeHandle Parent() const;
+
+		XMLAttributeHandle FirstAttrib(std::string_view name) const;
+		XMLAttributeHandle LastAttrib(std::string_view name) const;
+		XMLAttributeHandle FirstAttrib() const;
+		XMLAttributeHandle LastAttrib() const;
+
+		XMLAttributeHandle Attrib(std::string_view name) const;
+
+		bool TryConvertAttrib(std::string_view name, int32_t& val, int32_t default_val) const;
+		bool TryConvertAttrib(std::string_view name, uint32_t& val, uint32_t default_val) const;
+		bool TryConvertAttrib(std::string_view name, float& val, float default_val) const;
+
+		int32_t AttribInt(std::string_view name, int32_t default_val) const;
+		uint32_t AttribUInt(std::string_view name, uint32_t default_val) const;
+		float AttribFloat(std::string_view name, float default_val) const;
+		std::string_view AttribString(std::string_view name, std::string_view default_val) const;
+
+		XMLNodeHandle FirstNode(std::string_view name) const;
+		XMLNodeHandle LastNode(std::string_view name) const;
+		XMLNodeHandle FirstNode() const;
+		XMLNodeHandle LastNode() const;
+
+		XMLNodeHandle PrevSibling(std::string_view name) const;
+		XMLNodeHandle NextSibling(std::string_view name) const;
+		XMLNodeHandle PrevSibling() const;
+		XMLNodeHandle NextSibling() const;
+
+		XMLHandleRange<XMLNodeHandle> Children() const;
+		XMLHandleRange<XMLNodeHandle> Children(std::string_view name) const;
+		XMLHandleRange<XMLAttributeHandle> Attribs() const;
+
+		// The next sibling, with the given name unless it's empty. Used by XMLHandleRange.
+		XMLNodeHandle Next(std::string_view name) const;
+
+		bool TryConvert(int32_t& val) const;
+		bool TryConvert(uint32_t& val) const;
+		bool TryConvert(float& val) const;
+
+		int32_t ValueInt() const;
+		uint32_t ValueUInt() const;
+		float ValueFloat() const;
+		std::string_view ValueString() const;
+
+	private:
+		rapidxml::xml_node<char>* node_ = nullptr;
+	};
+
+	// Handle of an attribute in a document, see XMLNodeHandle
+	class XMLAttributeHandle final
+	{
+	public:
+		XMLAttributeHandle() noexcept = default;
+		explicit XMLAttributeHandle(rapidxml::xml_attribute<char>* attr) noexcept
+			: attr_(attr)
+		{
+		}
+
+		explicit operator bool() const noexcept
+		{
+			return attr_ != nullptr;
+		}
+		XMLAttributeHandle const * operator->() const noexcept
+		{
+			return this;
+		}
+		XMLAttributeHandle const & operator*() const noexcept
+		{
+			return *this;
+		}
+
+		bool operator==(XMLAttributeHandle const & rhs) const noexcept
+		{
+			return attr_ == rhs.attr_;
+		}
+		bool operator!=(XMLAttributeHandle const & rhs) const noexcept
+		{
+			return attr_ != rhs.attr_;
+		}
+
+		std::string_view Name() const;
+
+		XMLAttributeHandle NextAttrib(std::string_view name) const;
+		XMLAttributeHandle NextAttrib() const;
+
+		// The next attribute, with the given name unless it's empty. Used by XMLHandleRange.
+		XMLAttributeHandle Next(std::string_view name) const;
+
+		bool TryConvert(int32_t& val) const;
+		bool TryConvert(uint32_t& val) const;
+		bool TryConvert(float& val) const;
+
+		int32_t ValueInt() const;
+		uint32_t ValueUInt() const;
+		float ValueFloat() const;
+		std::string_view ValueString() const;
+
+	private:
+		rapidxml::xml_attribute<char>* attr_ = nullptr;
+	};
+
 	class XMLDocument final : boost::noncopyable
 	{
 	public:
@@ -70,6 +289,10 @@ namespace KlayGE
 		XMLNodePtr Parse(ResIdentifier& source);
 		void Print(std::ostream& os);
 
+		// Parse keeps a binary copy of each source in this folder, keyed by the resource name and timestamp. The next parse
+		// of an unchanged source loads the copy instead of the text. An empty folder turns it off.
+		static void CacheFolder(std::string_view folder);
+
 		XMLNodePtr CloneNode(XMLNode const& node);
 
 		XMLNodePtr AllocNode(XMLNodeType type, std::string_view name);
@@ -80,9 +303,14 @@ namespace KlayGE
 
 		void RootNode(XMLNodePtr const & new_node);
 
+	private:
+		bool LoadBinary(std::string const & cache_path, std::string_view res_name, uint64_t timestamp);
+		void SaveBinary(std::ostream& os, std::string_view res_name, uint64_t timestamp) const;
+
 	private:
 		std::shared_ptr<rapidxml::xml_document<char>> doc_;
 		std::unique_ptr<char[]> xml_src_;
+		MappedFilePtr mapped_src_;
 
 		XMLNodePtr root_;
 	};
@@ -95,6 +323,11 @@ namespace KlayGE
 		explicit XMLNode(rapidxml::xml_node<char>* node);
 		XMLNode(rapidxml::xml_document<char>& doc, XMLNodeType type, std::string_view name);
 
+		XMLNodeHandle Handle() const noexcept
+		{
+			return XMLNodeHandle(node_);
+		}
+
 		std::string_view Name() const;
 		XMLNodeType Type() const;
 
@@ -160,6 +393,11 @@ namespace KlayGE
 		explicit XMLAttribute(rapidxml::xml_attribute<char>* attr);
 		XMLAttribute(rapidxml::xml_document<char>& doc, std::string_view name, std::string_view value);
 
+		XMLAttributeHandle Handle() const noexcept
+		{
+			return XMLAttributeHandle(attr_);
+		}
+
 		std::string_view Name() const;
 
 		XMLAttributePtr NextAttrib(std::string_view name) const;
@@ -74,7 +74,7 @@ namespace KlayGE
 
 	std::streamsize MemInputStreamBuf::xsgetn(char_type* s, std::streamsize count)
 	{
-		if (current_ + count >= end_)
+		if (count > end_ - current_)
 		{
 			count = end_ - current_;
 		}
@@ -109,7 +109,7 @@ namespace KlayGE
 		switch (way)
 		{
 		case std::ios_base::beg:
-			if (off <= end_ - begin_)
+			if ((off >= 0) && (off <= end_ - begin_))
 			{
 				current_ = begin_ + off;
 			}
@@ -120,9 +120,9 @@ namespace KlayGE
 			break;
 
 		case std::ios_base::end:
-			if (end_ - off >= begin_)
+			if ((off <= 0) && (off >= begin_ - end_))
 			{
-				current_ = end_ - off;
+				current_ = end_ + off;
 				off = current_ - begin_;
 			}
 			else
@@ -133,7 +133,7 @@ namespace KlayGE
 
 		case std::ios_base::cur:
 		default:
-			if (current_ + off <= end_)
+			if ((off >= begin_ - current_) && (off <= end_ - current_))
 			{
 				current_ += off;
 				off = current_ - begin_;
@@ -153,9 +153,10 @@ namespace KlayGE
 		BOOST_ASSERT(which == std::ios_base::in);
 		KFL_UNUSED(which);
 
-		if (sp < end_ - begin_)
+		off_type const off = sp;
+		if ((off >= 0) && (off <= end_ - begin_))
 		{
-			current_ = begin_ + static_cast<int>(sp);
+			current_ = begin_ + off;
 		}
 		else
 		{
@@ -0,0 +1,133 @@
+/**
+ * @file FrameAllocator.cpp
+ * @author Minmin Gong
+ *
+ * @section DESCRIPTION
+ *
+ * This source file is part of KFL, a subproject of KlayGE
+ * For the latest info, see http://www.klayge.org
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * You may alternatively use this source under the terms of
+ * the KlayGE Proprietary License (KPL). You can obtained such a license
+ * from http://www.klayge.org/licensing/.
+ */
+
+
+#include <KFL/KFL.hpp>
+
+#include <algorithm>
+
+#include <KFL/FrameAllocator.hpp>
+
+namespace KlayGE
+{
+	frame_arena& frame_arena::thread_instance()
+	{
+		thread_local frame_arena arena;
+		return arena;
+	}
+
+	frame_arena::frame_arena(size_t block_size)
+		: curr_block_(0), offset_(0), used_(0), peak_(0), last_frame_peak_(0), high_water_mark_(0)
+	{
+		this->add_block(std::max<size_t>(block_size, 1));
+	}
+
+	void* frame_arena::allocate(size_t size, size_t alignment)
+	{
+		BOOST_ASSERT(0 == (alignment & (alignment - 1)));
+
+		size = std::max<size_t>(size, 1);
+		for (;;)
+		{
+			auto& curr = blocks_[curr_block_];
+			uintptr_t const base = reinterpret_cast<uintptr_t>(curr.data.get());
+			size_t const begin = ((base + offset_ + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1)) - base;
+			if (begin + size <= curr.size)
+			{
+				used_ += begin + size - offset_;
+				peak_ = std::max(peak_, used_);
+				offset_ = begin + size;
+				return curr.data.get() + begin;
+			}
+
+			// The rest of this block is lost for the frame
+			used_ += curr.size - offset_;
+			++ curr_block_;
+			offset_ = 0;
+			if (curr_block_ == blocks_.size())
+			{
+				this->add_block(std::max(size + alignment, blocks_.back().size * 2));
+			}
+		}
+	}
+
+	void frame_arena::deallocate(void* p, size_t size) noexcept
+	{
+		size = std::max<size_t>(size, 1);
+
+		// Only the newest allocation goes back, which is enough for a vector that grows and shrinks at the end
+		auto& curr = blocks_[curr_block_];
+		uint8_t* p8 = static_cast<uint8_t*>(p);
+		if (p8 + size == curr.data.get() + offset_)
+		{
+			offset_ -= size;
+			used_ -= size;
+		}
+	}
+
+	void frame_arena::reset()
+	{
+		last_frame_peak_ = peak_;
+		high_water_mark_ = std::max(high_water_mark_, peak_);
+
+		if (blocks_.size() > 1)
+		{
+			// One block that held the whole last frame
+			size_t size = blocks_[0].size;
+			while (size < peak_)
+			{
+				size *= 2;
+			}
+			block merged{ MakeUniquePtr<uint8_t[]>(size), size };
+			blocks_.clear();
+			blocks_.push_back(std::move(merged));
+		}
+
+		curr_block_ = 0;
+		offset_ = 0;
+		used_ = 0;
+		peak_ = 0;
+	}
+
+	size_t frame_arena::capacity() const noexcept
+	{
+		size_t ret = 0;
+		for (auto const & b : blocks_)
+		{
+			ret += b.size;
+		}
+		return ret;
+	}
+
+	void frame_arena::add_block(size_t size)
+	{
+		blocks_.push_back(block{ MakeUniquePtr<uint8_t[]>(size), size });
+	}
+}
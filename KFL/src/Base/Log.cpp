@@ -1,5 +1,5 @@
 /**
- * @file Log.cpp
+ * @file Log.hpp
  * @author Minmin Gong
  *
  * @section DESCRIPTION
@@ -29,18 +29,26 @@
  */
 
 #include <KFL/KFL.hpp>
-#include <KFL/CXX2a/span.hpp>
 #include <KFL/CustomizedStreamBuf.hpp>
 
-#include <cstdarg>
 #include <cstdio>
 #include <iostream>
+#include <ostream>
 
 #ifdef KLAYGE_PLATFORM_ANDROID
 #include <android/log.h>
 #include <cstring>
 #else
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
 #include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
 #endif
 
 #include <KFL/Log.hpp>
@@ -83,117 +91,438 @@ namespace
 		return log_stream;
 	}
 #else
-	class MultiOStreamsCallback : boost::noncopyable
+	char const * const LOG_LEVEL_NAMES[] = { "DEBUG", "INFO", "WARN", "ERROR" };
+
+	// Records of one thread. Only that thread pushes, and only the flusher pops, so neither side takes a lock. A record is
+	// its size followed by its text, and can wrap around the end.
+	class LogRingBuffer final : boost::noncopyable
 	{
 	public:
-		explicit MultiOStreamsCallback(std::span<std::ostream*> oss)
-			: oss_(oss)
+		static uint32_t constexpr CAPACITY = 64 * 1024;
+		static uint32_t constexpr MAX_RECORD_SIZE = CAPACITY - sizeof(uint32_t);
+
+		LogRingBuffer()
+			: buff_(MakeUniquePtr<char[]>(CAPACITY)), head_(0), tail_(0), orphaned_(false)
 		{
 		}
-		MultiOStreamsCallback(MultiOStreamsCallback&& rhs) noexcept
-			: oss_(std::move(rhs.oss_))
+
+		bool TryPush(char const * record, uint32_t size)
 		{
+			BOOST_ASSERT(size <= MAX_RECORD_SIZE);
+
+			uint64_t const head = head_.load(std::memory_order_relaxed);
+			if (head + sizeof(size) + size - tail_.load(std::memory_order_acquire) > CAPACITY)
+			{
+				return false;
+			}
+
+			this->CopyIn(head, &size, sizeof(size));
+			this->CopyIn(head + sizeof(size), record, size);
+			head_.store(head + sizeof(size) + size, std::memory_order_release);
+			return true;
 		}
 
-		std::streambuf::int_type operator()(void const * buff, std::streamsize count)
+		// Hands the text of every queued record to the sink, in at most 2 pieces each
+		template <typename Sink>
+		void Drain(Sink const & sink)
 		{
-			for (auto& os : oss_)
+			uint64_t const head = head_.load(std::memory_order_acquire);
+			uint64_t tail = tail_.load(std::memory_order_relaxed);
+			while (tail != head)
 			{
-				os->write(static_cast<char const *>(buff), count);
+				uint32_t size;
+				this->CopyOut(tail, &size, sizeof(size));
+				tail += sizeof(size);
+
+				uint32_t const offset = static_cast<uint32_t>(tail % CAPACITY);
+				uint32_t const first = std::min(size, CAPACITY - offset);
+				sink(&buff_[offset], first);
+				if (first < size)
+				{
+					sink(&buff_[0], size - first);
+				}
+				tail += size;
 			}
-			return static_cast<std::streambuf::int_type>(count);
+			tail_.store(tail, std::memory_order_release);
+		}
+
+		// The owning thread has exited, nothing more will be pushed
+		void Orphan()
+		{
+			orphaned_.store(true, std::memory_order_release);
+		}
+		bool Orphaned() const
+		{
+			return orphaned_.load(std::memory_order_acquire);
+		}
+
+	private:
+		void CopyIn(uint64_t pos, void const * src, uint32_t size)
+		{
+			uint32_t const offset = static_cast<uint32_t>(pos % CAPACITY);
+			uint32_t const first = std::min(size, CAPACITY - offset);
+			std::memcpy(&buff_[offset], src, first);
+			std::memcpy(&buff_[0], static_cast<char const *>(src) + first, size - first);
+		}
+
+		void CopyOut(uint64_t pos, void* dst, uint32_t size) const
+		{
+			uint32_t const offset = static_cast<uint32_t>(pos % CAPACITY);
+			uint32_t const first = std::min(size, CAPACITY - offset);
+			std::memcpy(dst, &buff_[offset], first);
+			std::memcpy(static_cast<char*>(dst) + first, &buff_[0], size - first);
 		}
 
 	private:
-		std::span<std::ostream*> oss_;
+		std::unique_ptr<char[]> buff_;
+		std::atomic<uint64_t> head_;
+		std::atomic<uint64_t> tail_;
+		std::atomic<bool> orphaned_;
+	};
+
+	enum LoggerState
+	{
+		LS_NotCreated,
+		LS_Alive,
+		LS_Destroyed
 	};
 
-	std::ostream& Log()
+	// Lives outside the logger, so it can still be checked while static objects are destroyed
+	std::atomic<LoggerState> logger_state(LS_NotCreated);
+
+	class AsyncLogger final : boost::noncopyable
 	{
+	public:
+		static AsyncLogger& Instance()
+		{
+			static AsyncLogger logger;
+			return logger;
+		}
+
+		AsyncLogger()
+			: start_time_(std::chrono::steady_clock::now()),
 #ifdef KLAYGE_DEBUG
-		static std::ofstream log_file("KlayGE.log");
+				log_file_("KlayGE.log"),
 #endif
+				next_thread_id_(0), flush_requested_(0), flush_done_(0), quit_(false)
+		{
+			thread_ = std::thread([this] { this->FlusherFunc(); });
+			logger_state = LS_Alive;
+		}
+
+		~AsyncLogger()
+		{
+			logger_state = LS_Destroyed;
+			{
+				std::lock_guard<std::mutex> lock(flush_mutex_);
+				quit_ = true;
+			}
+			flush_cond_.notify_one();
+			thread_.join();
+		}
 
-		static std::ostream* oss[] =
+		std::shared_ptr<LogRingBuffer> Register(uint32_t& thread_id)
+		{
+			auto ring = MakeSharedPtr<LogRingBuffer>();
+
+			std::lock_guard<std::mutex> lock(rings_mutex_);
+			rings_.push_back(ring);
+			thread_id = next_thread_id_;
+			++ next_thread_id_;
+			return ring;
+		}
+
+		double Time() const
+		{
+			return std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time_).count();
+		}
+
+		// For the records that don't fit in a ring
+		void Write(char const * text, size_t size)
+		{
+			std::lock_guard<std::mutex> lock(sinks_mutex_);
+			this->WriteSinks(text, size);
+			this->FlushSinks();
+		}
+
+		// Doesn't take the lock, so a wake up can be missed. The flusher polls anyway.
+		void Wake()
+		{
+			flush_cond_.notify_one();
+		}
+
+		void Flush()
+		{
+			std::unique_lock<std::mutex> lock(flush_mutex_);
+			++ flush_requested_;
+			uint64_t const ticket = flush_requested_;
+			flush_cond_.notify_one();
+			done_cond_.wait(lock, [this, ticket] { return flush_done_ >= ticket; });
+		}
+
+	private:
+		void FlusherFunc()
+		{
+			std::unique_lock<std::mutex> lock(flush_mutex_);
+			for (;;)
+			{
+				flush_cond_.wait_for(lock, std::chrono::milliseconds(20),
+					[this] { return quit_ || (flush_requested_ != flush_done_); });
+
+				uint64_t const ticket = flush_requested_;
+				bool const quit = quit_;
+				lock.unlock();
+
+				this->DrainAll();
+
+				lock.lock();
+				flush_done_ = ticket;
+				done_cond_.notify_all();
+				if (quit)
+				{
+					break;
+				}
+			}
+		}
+
+		// Only called on the flusher thread. The rings are drained from a copy of the list, so registering a new thread never
+		// waits for the sinks.
+		void DrainAll()
+		{
+			{
+				std::lock_guard<std::mutex> rings_lock(rings_mutex_);
+				draining_rings_ = rings_;
+			}
+
+			bool written = false;
+			bool any_orphaned = false;
+			{
+				std::lock_guard<std::mutex> sinks_lock(sinks_mutex_);
+
+				auto const sink = [this, &written](char const * text, uint32_t size)
+				{
+					this->WriteSinks(text, size);
+					written = true;
+				};
+				for (auto& ring : draining_rings_)
+				{
+					// Checked before draining, so the last records of an exited thread are still written
+					bool const orphaned = ring->Orphaned();
+					ring->Drain(sink);
+					if (orphaned)
+					{
+						any_orphaned = true;
+					}
+					else
+					{
+						ring.reset();
+					}
+				}
+
+				if (written)
+				{
+					this->FlushSinks();
+				}
+			}
+
+			// The copy now only holds the orphaned rings, which are all drained
+			if (any_orphaned)
+			{
+				std::lock_guard<std::mutex> rings_lock(rings_mutex_);
+				for (auto const & ring : draining_rings_)
+				{
+					if (ring)
+					{
+						rings_.erase(std::find(rings_.begin(), rings_.end(), ring));
+					}
+				}
+			}
+			draining_rings_.clear();
+		}
+
+		void WriteSinks(char const * text, size_t size)
 		{
 #ifdef KLAYGE_DEBUG
-			&log_file,
+			log_file_.write(text, size);
 #endif
-			&std::clog
-		};
-		static CallbackOutputStreamBuf<MultiOStreamsCallback> log_stream_buff((MultiOStreamsCallback(oss)));
-		static std::ostream log_stream(&log_stream_buff);
-		return log_stream;
-	}
+			std::clog.write(text, size);
+		}
+
+		void FlushSinks()
+		{
+#ifdef KLAYGE_DEBUG
+			log_file_.flush();
 #endif
+			std::clog.flush();
+		}
 
-#ifndef KLAYGE_DEBUG
-	class EmptyOStreamsCallback : boost::noncopyable
+	private:
+		std::chrono::steady_clock::time_point const start_time_;
+
+		std::mutex sinks_mutex_;
+#ifdef KLAYGE_DEBUG
+		std::ofstream log_file_;
+#endif
+
+		std::mutex rings_mutex_;
+		std::vector<std::shared_ptr<LogRingBuffer>> rings_;
+		std::vector<std::shared_ptr<LogRingBuffer>> draining_rings_;
+		uint32_t next_thread_id_;
+
+		std::thread thread_;
+		std::mutex flush_mutex_;
+		std::condition_variable flush_cond_;
+		std::condition_variable done_cond_;
+		uint64_t flush_requested_;
+		uint64_t flush_done_;
+		bool quit_;
+	};
+
+	// The log stream of one thread. Text goes into the current record, and a record is pushed to the ring of the thread
+	// when the stream is flushed or the next record begins.
+	class ThreadLog final : public std::streambuf, boost::noncopyable
 	{
 	public:
-		EmptyOStreamsCallback()
+		ThreadLog()
+			: stream_(this), level_(LL_Info)
 		{
+			ring_ = AsyncLogger::Instance().Register(thread_id_);
 		}
-		EmptyOStreamsCallback(EmptyOStreamsCallback&& rhs) noexcept
+
+		~ThreadLog() override
 		{
-			KFL_UNUSED(rhs);
+			this->Commit();
+			ring_->Orphan();
 		}
 
-		std::streambuf::int_type operator()(void const * buff, std::streamsize count)
+		std::ostream& Begin(LogLevel level)
 		{
-			KFL_UNUSED(buff);
-			return static_cast<std::streambuf::int_type>(count);
+			// The previous record wasn't ended with a flush
+			this->Commit();
+
+			level_ = level;
+
+			char prefix[64];
+			int const len = std::snprintf(prefix, sizeof(prefix), "[%10.3f T%u] (%s) KlayGE: ", AsyncLogger::Instance().Time(),
+				thread_id_, LOG_LEVEL_NAMES[level]);
+			record_.append(prefix, std::max(len, 0));
+			return stream_;
 		}
-	};
 
-	std::ostream& EmptyLog()
-	{
-		static CallbackOutputStreamBuf<EmptyOStreamsCallback> empty_stream_buff((EmptyOStreamsCallback()));
-		static std::ostream empty_stream(&empty_stream_buff);
-		return empty_stream;
-	}
+	protected:
+		std::streamsize xsputn(char_type const * s, std::streamsize count) override
+		{
+			record_.append(s, static_cast<size_t>(count));
+			return count;
+		}
+
+		int_type overflow(int_type ch = traits_type::eof()) override
+		{
+			if (!traits_type::eq_int_type(ch, traits_type::eof()))
+			{
+				record_.push_back(traits_type::to_char_type(ch));
+			}
+			return traits_type::not_eof(ch);
+		}
+
+		int sync() override
+		{
+			this->Commit();
+			return 0;
+		}
+
+	private:
+		void Commit()
+		{
+			if (record_.empty())
+			{
+				return;
+			}
+
+			if (logger_state != LS_Alive)
+			{
+				// Static objects are being destroyed, nobody drains the rings any more
+				std::clog.write(record_.data(), record_.size());
+			}
+			else
+			{
+				auto& logger = AsyncLogger::Instance();
+				if (record_.size() > LogRingBuffer::MAX_RECORD_SIZE)
+				{
+					// Keeps the order with the records queued before it
+					logger.Flush();
+					logger.Write(record_.data(), record_.size());
+				}
+				else
+				{
+					while (!ring_->TryPush(record_.data(), static_cast<uint32_t>(record_.size())))
+					{
+						logger.Wake();
+						std::this_thread::yield();
+					}
+				}
+
+				// Errors are written out before anything else can go wrong
+				if (level_ == LL_Error)
+				{
+					logger.Flush();
+				}
+			}
+
+			record_.clear();
+		}
+
+	private:
+		std::ostream stream_;
+		std::string record_;
+		LogLevel level_;
+		uint32_t thread_id_;
+		std::shared_ptr<LogRingBuffer> ring_;
+	};
 #endif
 }
 
 namespace KlayGE
 {
-	std::ostream& LogDebug()
+	std::ostream& LogStream(LogLevel level)
 	{
-#ifdef KLAYGE_DEBUG
 #ifdef KLAYGE_PLATFORM_ANDROID
-		return AndroidLog<ANDROID_LOG_DEBUG>();
-#else
-		return Log() << "(DEBUG) KlayGE: ";
-#endif
+		switch (level)
+		{
+		case LL_Debug:
+			return AndroidLog<ANDROID_LOG_DEBUG>();
+		case LL_Info:
+			return AndroidLog<ANDROID_LOG_INFO>();
+		case LL_Warn:
+			return AndroidLog<ANDROID_LOG_WARN>();
+		default:
+			return AndroidLog<ANDROID_LOG_ERROR>();
+		}
 #else
-		return EmptyLog();
-#endif
-	}
+		if (logger_state == LS_Destroyed)
+		{
+			return std::clog << "(" << LOG_LEVEL_NAMES[level] << ") KlayGE: ";
+		}
 
-	std::ostream& LogInfo()
-	{
-#ifdef KLAYGE_PLATFORM_ANDROID
-		return AndroidLog<ANDROID_LOG_INFO>();
-#else
-		return Log() << "(INFO) KlayGE: ";
+		static thread_local ThreadLog thread_log;
+		return thread_log.Begin(level);
 #endif
 	}
 
-	std::ostream& LogWarn()
+	std::ostream& EmptyLog()
 	{
-#ifdef KLAYGE_PLATFORM_ANDROID
-		return AndroidLog<ANDROID_LOG_WARN>();
-#else
-		return Log() << "(WARN) KlayGE: ";
-#endif
+		// Without a stream buffer it's always bad
+		static std::ostream empty_stream(nullptr);
+		return empty_stream;
 	}
 
-	std::ostream& LogError()
+	void FlushLog()
 	{
-#ifdef KLAYGE_PLATFORM_ANDROID
-		return AndroidLog<ANDROID_LOG_ERROR>();
-#else
-		return Log() << "(ERROR) KlayGE: ";
+#ifndef KLAYGE_PLATFORM_ANDROID
+		if (logger_state == LS_Alive)
+		{
+			AsyncLogger::Instance().Flush();
+		}
 #endif
 	}
 }
@@ -0,0 +1,224 @@
+/**
+ * @file TaskScheduler.cpp
+ * @author Minmin Gong
+ *
+ * @section DESCRIPTION
+ *
+ * This source file is part of KFL, a subproject of KlayGE
+ * For the latest info, see http://www.klayge.org
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * You may alternatively use this source under the terms of
+ * the KlayGE Proprietary License (KPL). You can obtained such a license
+ * from http://www.klayge.org/licensing/.
+ */
+
+#include <KFL/KFL.hpp>
+
+#include <KFL/TaskScheduler.hpp>
+
+#include <iterator>
+
+namespace
+{
+	using namespace KlayGE;
+
+	// Which scheduler the current thread works for, and its queue there
+	thread_local task_scheduler const * tls_scheduler = nullptr;
+	thread_local uint32_t tls_queue_index = 0;
+}
+
+namespace KlayGE
+{
+	task_scheduler::task_scheduler(uint32_t num_workers)
+		: num_pending_(0), num_pushed_(0), num_sleeping_(0), quit_(false)
+	{
+		if (0 == num_workers)
+		{
+			num_workers = std::max(std::thread::hardware_concurrency(), 2U) - 1;
+		}
+
+		queues_.resize(num_workers + 1);
+		for (auto& queue : queues_)
+		{
+			queue = MakeUniquePtr<task_queue>();
+		}
+
+		threads_.reserve(num_workers);
+		for (uint32_t i = 0; i < num_workers; ++ i)
+		{
+			threads_.emplace_back([this, i] { this->worker_func(i); });
+		}
+	}
+
+	task_scheduler::~task_scheduler()
+	{
+		{
+			std::lock_guard<std::mutex> lock(sleep_mutex_);
+			quit_ = true;
+		}
+		sleep_cond_.notify_all();
+
+		for (auto& thread : threads_)
+		{
+			thread.join();
+		}
+	}
+
+	void task_scheduler::run(task_counter& counter, task_func func, void* context, uint32_t begin, uint32_t end)
+	{
+		counter.count_.fetch_add(1, std::memory_order_relaxed);
+
+		auto& queue = *queues_[this->queue_index()];
+		{
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			queue.tasks.push_back(task{ func, context, begin, end, &counter });
+		}
+
+		++ num_pending_;
+		++ num_pushed_;
+		if (num_sleeping_ > 0)
+		{
+			// The waits only take the tasks of their own counters, so all the sleepers have to look at the new task
+			std::lock_guard<std::mutex> lock(sleep_mutex_);
+			sleep_cond_.notify_all();
+		}
+	}
+
+	void task_scheduler::wait(task_counter& counter)
+	{
+		uint32_t const index = this->queue_index();
+		while (!counter.done())
+		{
+			uint32_t const num_pushed = num_pushed_;
+
+			task t;
+			if (this->try_pop(index, &counter, t))
+			{
+				this->execute(t);
+			}
+			else
+			{
+				// The remaining tasks are running on other threads. Sleeps until one of them finishes or a new one comes in.
+				std::unique_lock<std::mutex> lock(sleep_mutex_);
+				++ num_sleeping_;
+				sleep_cond_.wait(lock, [this, &counter, num_pushed] { return counter.done() || (num_pushed_ != num_pushed); });
+				-- num_sleeping_;
+			}
+		}
+
+		std::exception_ptr exception;
+		{
+			std::lock_guard<std::mutex> lock(counter.exception_mutex_);
+			exception = std::move(counter.exception_);
+			counter.exception_ = nullptr;
+		}
+		if (exception)
+		{
+			std::rethrow_exception(exception);
+		}
+	}
+
+	void task_scheduler::worker_func(uint32_t index)
+	{
+		tls_scheduler = this;
+		tls_queue_index = index;
+
+		while (!quit_)
+		{
+			task t;
+			if (this->try_pop(index, nullptr, t))
+			{
+				this->execute(t);
+			}
+			else
+			{
+				std::unique_lock<std::mutex> lock(sleep_mutex_);
+				++ num_sleeping_;
+				sleep_cond_.wait(lock, [this] { return quit_ || (num_pending_ > 0); });
+				-- num_sleeping_;
+			}
+		}
+	}
+
+	uint32_t task_scheduler::queue_index() const
+	{
+		return (tls_scheduler == this) ? tls_queue_index : static_cast<uint32_t>(queues_.size() - 1);
+	}
+
+	// Newest task of the own queue first, then the oldest task of the others
+	bool task_scheduler::try_pop(uint32_t index, task_counter const * counter, task& t)
+	{
+		if (0 == num_pending_)
+		{
+			return false;
+		}
+
+		auto const match = [counter](task const & queued) { return (nullptr == counter) || (queued.counter == counter); };
+
+		{
+			auto& queue = *queues_[index];
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			auto const iter = std::find_if(queue.tasks.rbegin(), queue.tasks.rend(), match);
+			if (iter != queue.tasks.rend())
+			{
+				t = *iter;
+				queue.tasks.erase(std::next(iter).base());
+				-- num_pending_;
+				return true;
+			}
+		}
+
+		uint32_t const num_queues = static_cast<uint32_t>(queues_.size());
+		for (uint32_t i = 1; i < num_queues; ++ i)
+		{
+			auto& queue = *queues_[(index + i) % num_queues];
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			auto const iter = std::find_if(queue.tasks.begin(), queue.tasks.end(), match);
+			if (iter != queue.tasks.end())
+			{
+				t = *iter;
+				queue.tasks.erase(iter);
+				-- num_pending_;
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	void task_scheduler::execute(task const & t)
+	{
+		// An exception must not skip the decrement, or the wait would never return
+		try
+		{
+			t.func(t.context, t.begin, t.end);
+		}
+		catch (...)
+		{
+			t.counter->capture_exception(std::current_exception());
+		}
+
+		// The counter can be gone as soon as it reaches 0, so it's not touched after that
+		if (t.counter->count_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+		{
+			std::lock_guard<std::mutex> lock(sleep_mutex_);
+			sleep_cond_.notify_all();
+		}
+	}
+}
@@ -30,9 +30,18 @@
 
 #include <KFL/KFL.hpp>
 #include <KFL/Util.hpp>
+#include <KFL/Hash.hpp>
+#include <KFL/MappedFile.hpp>
 #include <KFL/ResIdentifier.hpp>
+#include <KFL/CXX17/filesystem.hpp>
 
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <unordered_map>
 #ifdef KLAYGE_CXX17_LIBRARY_CHARCONV_SUPPORT
 #include <charconv>
 #endif
@@ -59,6 +68,115 @@
 
 #include <KFL/XMLDom.hpp>
 
+namespace
+{
+	using namespace KlayGE;
+
+	uint32_t constexpr XML_BINARY_VERSION = 1;
+	uint32_t constexpr XML_BINARY_NO_PARENT = 0xFFFFFFFFU;
+
+	// A binary document is the header, the nodes, the attributes and the string table, all little endian. Nodes are in
+	// depth first order, so a parent always comes before its children. Strings are offsets into the table, each of them
+	// followed by a 0.
+	struct XMLBinaryHeader
+	{
+		uint32_t fourcc;
+		uint32_t version;
+		uint64_t timestamp;
+		uint32_t res_name;
+		uint32_t res_name_size;
+		uint32_t num_nodes;
+		uint32_t num_attrs;
+		uint32_t str_table_size;
+		uint32_t reserved;
+	};
+
+	struct XMLBinaryNode
+	{
+		uint32_t type;
+		uint32_t parent;
+		uint32_t name;
+		uint32_t name_size;
+		uint32_t value;
+		uint32_t value_size;
+		uint32_t first_attr;
+		uint32_t num_attrs;
+	};
+
+	struct XMLBinaryAttrib
+	{
+		uint32_t name;
+		uint32_t name_size;
+		uint32_t value;
+		uint32_t value_size;
+	};
+
+	// Swaps between native and little endian, in both directions
+	void SwapLE(XMLBinaryHeader& header)
+	{
+		header.fourcc = Native2LE(header.fourcc);
+		header.version = Native2LE(header.version);
+		header.timestamp = Native2LE(header.timestamp);
+		header.res_name = Native2LE(header.res_name);
+		header.res_name_size = Native2LE(header.res_name_size);
+		header.num_nodes = Native2LE(header.num_nodes);
+		header.num_attrs = Native2LE(header.num_attrs);
+		header.str_table_size = Native2LE(header.str_table_size);
+		header.reserved = Native2LE(header.reserved);
+	}
+
+	void SwapLE(XMLBinaryNode& node)
+	{
+		node.type = Native2LE(node.type);
+		node.parent = Native2LE(node.parent);
+		node.name = Native2LE(node.name);
+		node.name_size = Native2LE(node.name_size);
+		node.value = Native2LE(node.value);
+		node.value_size = Native2LE(node.value_size);
+		node.first_attr = Native2LE(node.first_attr);
+		node.num_attrs = Native2LE(node.num_attrs);
+	}
+
+	void SwapLE(XMLBinaryAttrib& attr)
+	{
+		attr.name = Native2LE(attr.name);
+		attr.name_size = Native2LE(attr.name_size);
+		attr.value = Native2LE(attr.value);
+		attr.value_size = Native2LE(attr.value_size);
+	}
+
+	// Set by XMLDocument::CacheFolder, read by every parse on the loading threads
+	struct XMLCacheFolderState
+	{
+		std::mutex mutex;
+		std::string folder;
+	};
+
+	XMLCacheFolderState& XMLCacheFolder()
+	{
+		static XMLCacheFolderState state;
+		return state;
+	}
+
+	std::string XMLCachePath(ResIdentifier const & source)
+	{
+		std::string folder;
+		{
+			auto& state = XMLCacheFolder();
+			std::lock_guard<std::mutex> lock(state.mutex);
+			folder = state.folder;
+		}
+
+		std::string const & res_name = source.ResName();
+		if (folder.empty() || res_name.empty() || (source.Timestamp() == 0))
+		{
+			return std::string();
+		}
+
+		return folder + std::to_string(HashRange(res_name.begin(), res_name.end())) + ".kxmlb";
+	}
+}
+
 namespace KlayGE
 {
 	XMLDocument::XMLDocument()
@@ -68,9 +186,16 @@ namespace KlayGE
 
 	XMLNodePtr XMLDocument::Parse(ResIdentifier& source)
 	{
+		std::string const cache_path = XMLCachePath(source);
+		if (!cache_path.empty() && this->LoadBinary(cache_path, source.ResName(), source.Timestamp()))
+		{
+			return root_;
+		}
+
 		source.seekg(0, std::ios_base::end);
 		int len = static_cast<int>(source.tellg());
 		source.seekg(0, std::ios_base::beg);
+		mapped_src_.reset();
 		xml_src_ = MakeUniquePtr<char[]>(len + 1);
 		source.read(&xml_src_[0], len);
 		xml_src_[len] = 0;
@@ -78,9 +203,251 @@ namespace KlayGE
 		doc_->parse<0>(xml_src_.get());
 		root_ = MakeSharedPtr<XMLNode>(doc_->first_node());
 
+		if (!cache_path.empty())
+		{
+			// Written to a file of this thread first, so other threads never see a partial cache
+			std::string const tmp_path = cache_path + '.' + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()));
+			{
+				std::ofstream ofs(tmp_path, std::ios_base::binary);
+				if (ofs)
+				{
+					this->SaveBinary(ofs, source.ResName(), source.Timestamp());
+				}
+			}
+
+			std::error_code ec;
+			std::filesystem::rename(tmp_path, cache_path, ec);
+			if (ec)
+			{
+				std::filesystem::remove(tmp_path, ec);
+			}
+		}
+
 		return root_;
 	}
 
+	void XMLDocument::CacheFolder(std::string_view folder)
+	{
+		std::string cache_folder(folder);
+		if (!cache_folder.empty())
+		{
+			if ((cache_folder.back() != '/') && (cache_folder.back() != '\\'))
+			{
+				cache_folder += '/';
+			}
+
+			std::error_code ec;
+			std::filesystem::create_directories(cache_folder, ec);
+		}
+
+		auto& state = XMLCacheFolder();
+		std::lock_guard<std::mutex> lock(state.mutex);
+		state.folder = std::move(cache_folder);
+	}
+
+	bool XMLDocument::LoadBinary(std::string const & cache_path, std::string_view res_name, uint64_t timestamp)
+	{
+		// The copy is mapped and walked in place. Where mapping isn't available, it's read into one buffer.
+		auto mapped_file = MakeSharedPtr<MappedFile>();
+		std::unique_ptr<char[]> buff;
+		char const * data;
+		uint64_t size;
+		if (mapped_file->Map(cache_path))
+		{
+			data = reinterpret_cast<char const *>(mapped_file->Data().data());
+			size = mapped_file->Data().size();
+		}
+		else
+		{
+			mapped_file.reset();
+
+			std::ifstream ifs(cache_path, std::ios_base::binary);
+			if (!ifs)
+			{
+				return false;
+			}
+			ifs.seekg(0, std::ios_base::end);
+			size = static_cast<uint64_t>(ifs.tellg());
+			ifs.seekg(0, std::ios_base::beg);
+			buff = MakeUniquePtr<char[]>(static_cast<size_t>(size));
+			ifs.read(buff.get(), size);
+			if (static_cast<uint64_t>(ifs.gcount()) != size)
+			{
+				return false;
+			}
+			data = buff.get();
+		}
+
+		XMLBinaryHeader header;
+		if (size < sizeof(header))
+		{
+			return false;
+		}
+		std::memcpy(&header, data, sizeof(header));
+		SwapLE(header);
+		if ((header.fourcc != MakeFourCC<'K', 'X', 'M', 'L'>::value) || (header.version != XML_BINARY_VERSION)
+			|| (header.timestamp != timestamp))
+		{
+			return false;
+		}
+
+		uint64_t const nodes_offset = sizeof(header);
+		uint64_t const attrs_offset = nodes_offset + static_cast<uint64_t>(header.num_nodes) * sizeof(XMLBinaryNode);
+		uint64_t const str_table_offset = attrs_offset + static_cast<uint64_t>(header.num_attrs) * sizeof(XMLBinaryAttrib);
+		if (size < str_table_offset + header.str_table_size)
+		{
+			return false;
+		}
+
+		// rapidxml takes char*, but the names and values are never written through
+		char* const str_table = const_cast<char*>(data + str_table_offset);
+		auto const valid_string = [&header, str_table](uint32_t offset, uint32_t str_size) {
+			return (offset < header.str_table_size) && (str_size < header.str_table_size - offset) && (str_table[offset + str_size] == 0);
+		};
+		if (!valid_string(header.res_name, header.res_name_size)
+			|| (std::string_view(str_table + header.res_name, header.res_name_size) != res_name))
+		{
+			return false;
+		}
+
+		// The nodes point to the strings in the table, nothing is copied or parsed
+		doc_->clear();
+		std::vector<rapidxml::xml_node<char>*> nodes(header.num_nodes);
+		for (uint32_t i = 0; i < header.num_nodes; ++ i)
+		{
+			XMLBinaryNode bin_node;
+			std::memcpy(&bin_node, data + nodes_offset + i * sizeof(bin_node), sizeof(bin_node));
+			SwapLE(bin_node);
+			if ((bin_node.type == rapidxml::node_document) || (bin_node.type > rapidxml::node_pi)
+				|| ((bin_node.parent != XML_BINARY_NO_PARENT) && (bin_node.parent >= i))
+				|| !valid_string(bin_node.name, bin_node.name_size) || !valid_string(bin_node.value, bin_node.value_size)
+				|| (bin_node.first_attr > header.num_attrs) || (bin_node.num_attrs > header.num_attrs - bin_node.first_attr))
+			{
+				doc_->clear();
+				return false;
+			}
+
+			nodes[i] = doc_->allocate_node(static_cast<rapidxml::node_type>(bin_node.type), str_table + bin_node.name,
+				str_table + bin_node.value, bin_node.name_size, bin_node.value_size);
+			for (uint32_t j = bin_node.first_attr; j < bin_node.first_attr + bin_node.num_attrs; ++ j)
+			{
+				XMLBinaryAttrib bin_attr;
+				std::memcpy(&bin_attr, data + attrs_offset + j * sizeof(bin_attr), sizeof(bin_attr));
+				SwapLE(bin_attr);
+				if (!valid_string(bin_attr.name, bin_attr.name_size) || !valid_string(bin_attr.value, bin_attr.value_size))
+				{
+					doc_->clear();
+					return false;
+				}
+
+				nodes[i]->append_attribute(doc_->allocate_attribute(str_table + bin_attr.name, str_table + bin_attr.value,
+					bin_attr.name_size, bin_attr.value_size));
+			}
+
+			rapidxml::xml_node<char>* parent = doc_.get();
+			if (bin_node.parent != XML_BINARY_NO_PARENT)
+			{
+				parent = nodes[bin_node.parent];
+			}
+			parent->append_node(nodes[i]);
+		}
+
+		// Keeps the string table alive as long as the nodes
+		mapped_src_ = std::move(mapped_file);
+		xml_src_ = std::move(buff);
+		root_ = MakeSharedPtr<XMLNode>(doc_->first_node());
+
+		return true;
+	}
+
+	void XMLDocument::SaveBinary(std::ostream& os, std::string_view res_name, uint64_t timestamp) const
+	{
+		std::vector<char> str_table;
+		std::unordered_map<std::string_view, uint32_t> str_offsets;
+		auto const add_string = [&str_table, &str_offsets](std::string_view str) {
+			auto iter = str_offsets.find(str);
+			if (iter != str_offsets.end())
+			{
+				return iter->second;
+			}
+
+			uint32_t const offset = static_cast<uint32_t>(str_table.size());
+			str_table.insert(str_table.end(), str.begin(), str.end());
+			str_table.push_back(0);
+			str_offsets.emplace(str, offset);
+			return offset;
+		};
+
+		XMLBinaryHeader header;
+		header.fourcc = MakeFourCC<'K', 'X', 'M', 'L'>::value;
+		header.version = XML_BINARY_VERSION;
+		header.timestamp = timestamp;
+		header.res_name = add_string(res_name);
+		header.res_name_size = static_cast<uint32_t>(res_name.size());
+		header.reserved = 0;
+
+		std::vector<XMLBinaryNode> nodes;
+		std::vector<XMLBinaryAttrib> attrs;
+		std::vector<std::pair<rapidxml::xml_node<char>*, uint32_t>> stack;
+		// last_node() can't be called on a node without children
+		for (auto* child = doc_->first_node() ? doc_->last_node() : nullptr; child != nullptr; child = child->previous_sibling())
+		{
+			stack.emplace_back(child, XML_BINARY_NO_PARENT);
+		}
+		while (!stack.empty())
+		{
+			auto const * node = stack.back().first;
+			uint32_t const parent = stack.back().second;
+			stack.pop_back();
+
+			XMLBinaryNode bin_node;
+			bin_node.type = static_cast<uint32_t>(node->type());
+			bin_node.parent = parent;
+			bin_node.name = add_string(std::string_view(node->name(), node->name_size()));
+			bin_node.name_size = static_cast<uint32_t>(node->name_size());
+			bin_node.value = add_string(std::string_view(node->value(), node->value_size()));
+			bin_node.value_size = static_cast<uint32_t>(node->value_size());
+			bin_node.first_attr = static_cast<uint32_t>(attrs.size());
+			for (auto* attr = node->first_attribute(); attr != nullptr; attr = attr->next_attribute())
+			{
+				XMLBinaryAttrib bin_attr;
+				bin_attr.name = add_string(std::string_view(attr->name(), attr->name_size()));
+				bin_attr.name_size = static_cast<uint32_t>(attr->name_size());
+				bin_attr.value = add_string(std::string_view(attr->value(), attr->value_size()));
+				bin_attr.value_size = static_cast<uint32_t>(attr->value_size());
+				attrs.push_back(bin_attr);
+			}
+			bin_node.num_attrs = static_cast<uint32_t>(attrs.size()) - bin_node.first_attr;
+
+			uint32_t const index = static_cast<uint32_t>(nodes.size());
+			nodes.push_back(bin_node);
+
+			// Pushed in reverse, so the children are popped in order
+			for (auto* child = node->first_node() ? node->last_node() : nullptr; child != nullptr; child = child->previous_sibling())
+			{
+				stack.emplace_back(child, index);
+			}
+		}
+
+		header.num_nodes = static_cast<uint32_t>(nodes.size());
+		header.num_attrs = static_cast<uint32_t>(attrs.size());
+		header.str_table_size = static_cast<uint32_t>(str_table.size());
+
+		SwapLE(header);
+		os.write(reinterpret_cast<char const *>(&header), sizeof(header));
+		for (auto& bin_node : nodes)
+		{
+			SwapLE(bin_node);
+		}
+		os.write(reinterpret_cast<char const *>(nodes.data()), nodes.size() * sizeof(nodes[0]));
+		for (auto& bin_attr : attrs)
+		{
+			SwapLE(bin_attr);
+		}
+		os.write(reinterpret_cast<char const *>(attrs.data()), attrs.size() * sizeof(attrs[0]));
+		os.write(str_table.data(), str_table.size());
+	}
+
 	void XMLDocument::Print(std::ostream& os)
 	{
 		os << "<?xml version=\"1.0\"?>" << std::endl << std::endl;
@@ -185,33 +552,7 @@ namespace KlayGE
 
 	XMLNodeType XMLNode::Type() const
 	{
-		switch (node_->type())
-		{
-		case rapidxml::node_document:
-			return XNT_Document;
-
-		case rapidxml::node_element:
-			return XNT_Element;
-
-		case rapidxml::node_data:
-			return XNT_Data;
-
-		case rapidxml::node_cdata:
-			return XNT_CData;
-
-		case rapidxml::node_comment:
-			return XNT_Comment;
-
-		case rapidxml::node_declaration:
-			return XNT_Declaration;
-
-		case rapidxml::node_doctype:
-			return XNT_Doctype;
-
-		case rapidxml::node_pi:
-		default:
-			return XNT_PI;
-		}
+		return this->Handle().Type();
 	}
 
 	XMLNodePtr XMLNode::Parent() const
@@ -286,50 +627,37 @@ namespace KlayGE
 
 	bool XMLNode::TryConvertAttrib(std::string_view name, int32_t& val, int32_t default_val) const
 	{
-		val = default_val;
-
-		auto attr = this->Attrib(name);
-		return attr ? attr->TryConvert(val) : true;
+		return this->Handle().TryConvertAttrib(name, val, default_val);
 	}
 
 	bool XMLNode::TryConvertAttrib(std::string_view name, uint32_t& val, uint32_t default_val) const
 	{
-		val = default_val;
-
-		auto attr = this->Attrib(name);
-		return attr ? attr->TryConvert(val) : true;
+		return this->Handle().TryConvertAttrib(name, val, default_val);
 	}
 
 	bool XMLNode::TryConvertAttrib(std::string_view name, float& val, float default_val) const
 	{
-		val = default_val;
-
-		auto attr = this->Attrib(name);
-		return attr ? attr->TryConvert(val) : true;
+		return this->Handle().TryConvertAttrib(name, val, default_val);
 	}
 
 	int32_t XMLNode::AttribInt(std::string_view name, int32_t default_val) const
 	{
-		auto attr = this->Attrib(name);
-		return attr ? attr->ValueInt() : default_val;
+		return this->Handle().AttribInt(name, default_val);
 	}
 
 	uint32_t XMLNode::AttribUInt(std::string_view name, uint32_t default_val) const
 	{
-		auto attr = this->Attrib(name);
-		return attr ? attr->ValueUInt() : default_val;
+		return this->Handle().AttribUInt(name, default_val);
 	}
 
 	float XMLNode::AttribFloat(std::string_view name, float default_val) const
 	{
-		auto attr = this->Attrib(name);
-		return attr ? attr->ValueFloat() : default_val;
+		return this->Handle().AttribFloat(name, default_val);
 	}
 
 	std::string_view XMLNode::AttribString(std::string_view name, std::string_view default_val) const
 	{
-		auto attr = this->Attrib(name);
-		return attr ? attr->ValueString() : default_val;
+		return this->Handle().AttribString(name, default_val);
 	}
 
 	XMLNodePtr XMLNode::FirstNode(std::string_view name) const
@@ -501,6 +829,300 @@ namespace KlayGE
 	}
 
 	bool XMLNode::TryConvert(int32_t& val) const
+	{
+		return this->Handle().TryConvert(val);
+	}
+
+	bool XMLNode::TryConvert(uint32_t& val) const
+	{
+		return this->Handle().TryConvert(val);
+	}
+
+	bool XMLNode::TryConvert(float& val) const
+	{
+		return this->Handle().TryConvert(val);
+	}
+
+	int32_t XMLNode::ValueInt() const
+	{
+		return this->Handle().ValueInt();
+	}
+
+	uint32_t XMLNode::ValueUInt() const
+	{
+		return this->Handle().ValueUInt();
+	}
+
+	float XMLNode::ValueFloat() const
+	{
+		return this->Handle().ValueFloat();
+	}
+
+	std::string_view XMLNode::ValueString() const
+	{
+		return this->Handle().ValueString();
+	}
+
+
+	XMLAttribute::XMLAttribute(rapidxml::xml_attribute<char>* attr)
+		: attr_(attr)
+	{
+		if (attr_ != nullptr)
+		{
+			auto const * xml_attr = attr_;
+			name_ = std::string_view(xml_attr->name(), xml_attr->name_size());
+			value_ = std::string_view(xml_attr->value(), xml_attr->value_size());
+		}
+	}
+
+	XMLAttribute::XMLAttribute(rapidxml::xml_document<char>& doc, std::string_view name, std::string_view value)
+		: name_(name), value_(value)
+	{
+		attr_ = doc.allocate_attribute(name.data(), value.data(), name.size(), value.size());
+	}
+
+	std::string_view XMLAttribute::Name() const
+	{
+		return name_;
+	}
+
+	XMLAttributePtr XMLAttribute::NextAttrib(std::string_view name) const
+	{
+		auto* attr = attr_->next_attribute(name.data(), name.size());
+		if (attr)
+		{
+			return MakeSharedPtr<XMLAttribute>(attr);
+		}
+		else
+		{
+			return XMLAttributePtr();
+		}
+	}
+
+	XMLAttributePtr XMLAttribute::NextAttrib() const
+	{
+		auto* attr = attr_->next_attribute();
+		if (attr)
+		{
+			return MakeSharedPtr<XMLAttribute>(attr);
+		}
+		else
+		{
+			return XMLAttributePtr();
+		}
+	}
+
+	bool XMLAttribute::TryConvert(int32_t& val) const
+	{
+		return this->Handle().TryConvert(val);
+	}
+
+	bool XMLAttribute::TryConvert(uint32_t& val) const
+	{
+		return this->Handle().TryConvert(val);
+	}
+
+	bool XMLAttribute::TryConvert(float& val) const
+	{
+		return this->Handle().TryConvert(val);
+	}
+
+	int32_t XMLAttribute::ValueInt() const
+	{
+		return this->Handle().ValueInt();
+	}
+
+	uint32_t XMLAttribute::ValueUInt() const
+	{
+		return this->Handle().ValueUInt();
+	}
+
+	float XMLAttribute::ValueFloat() const
+	{
+		return this->Handle().ValueFloat();
+	}
+
+	std::string_view XMLAttribute::ValueString() const
+	{
+		return value_;
+	}
+
+
+	std::string_view XMLNodeHandle::Name() const
+	{
+		return std::string_view(node_->name(), node_->name_size());
+	}
+
+	XMLNodeType XMLNodeHandle::Type() const
+	{
+		switch (node_->type())
+		{
+		case rapidxml::node_document:
+			return XNT_Document;
+
+		case rapidxml::node_element:
+			return XNT_Element;
+
+		case rapidxml::node_data:
+			return XNT_Data;
+
+		case rapidxml::node_cdata:
+			return XNT_CData;
+
+		case rapidxml::node_comment:
+			return XNT_Comment;
+
+		case rapidxml::node_declaration:
+			return XNT_Declaration;
+
+		case rapidxml::node_doctype:
+			return XNT_Doctype;
+
+		case rapidxml::node_pi:
+		default:
+			return XNT_PI;
+		}
+	}
+
+	XMLNodeHandle XMLNodeHandle::Parent() const
+	{
+		return XMLNodeHandle(node_->parent());
+	}
+
+	XMLAttributeHandle XMLNodeHandle::FirstAttrib(std::string_view name) const
+	{
+		return XMLAttributeHandle(node_->first_attribute(name.data(), name.size()));
+	}
+
+	XMLAttributeHandle XMLNodeHandle::LastAttrib(std::string_view name) const
+	{
+		return XMLAttributeHandle(node_->last_attribute(name.data(), name.size()));
+	}
+
+	XMLAttributeHandle XMLNodeHandle::FirstAttrib() const
+	{
+		return XMLAttributeHandle(node_->first_attribute());
+	}
+
+	XMLAttributeHandle XMLNodeHandle::LastAttrib() const
+	{
+		return XMLAttributeHandle(node_->last_attribute());
+	}
+
+	XMLAttributeHandle XMLNodeHandle::Attrib(std::string_view name) const
+	{
+		return this->FirstAttrib(name);
+	}
+
+	bool XMLNodeHandle::TryConvertAttrib(std::string_view name, int32_t& val, int32_t default_val) const
+	{
+		val = default_val;
+
+		auto attr = this->Attrib(name);
+		return attr ? attr->TryConvert(val) : true;
+	}
+
+	bool XMLNodeHandle::TryConvertAttrib(std::string_view name, uint32_t& val, uint32_t default_val) const
+	{
+		val = default_val;
+
+		auto attr = this->Attrib(name);
+		return attr ? attr->TryConvert(val) : true;
+	}
+
+	bool XMLNodeHandle::TryConvertAttrib(std::string_view name, float& val, float default_val) const
+	{
+		val = default_val;
+
+		auto attr = this->Attrib(name);
+		return attr ? attr->TryConvert(val) : true;
+	}
+
+	int32_t XMLNodeHandle::AttribInt(std::string_view name, int32_t default_val) const
+	{
+		auto attr = this->Attrib(name);
+		return attr ? attr->ValueInt() : default_val;
+	}
+
+	uint32_t XMLNodeHandle::AttribUInt(std::string_view name, uint32_t default_val) const
+	{
+		auto attr = this->Attrib(name);
+		return attr ? attr->ValueUInt() : default_val;
+	}
+
+	float XMLNodeHandle::AttribFloat(std::string_view name, float default_val) const
+	{
+		auto attr = this->Attrib(name);
+		return attr ? attr->ValueFloat() : default_val;
+	}
+
+	std::string_view XMLNodeHandle::AttribString(std::string_view name, std::string_view default_val) const
+	{
+		auto attr = this->Attrib(name);
+		return attr ? attr->ValueString() : default_val;
+	}
+
+	XMLNodeHandle XMLNodeHandle::FirstNode(std::string_view name) const
+	{
+		return XMLNodeHandle(node_->first_node(name.data(), name.size()));
+	}
+
+	XMLNodeHandle XMLNodeHandle::LastNode(std::string_view name) const
+	{
+		return XMLNodeHandle(node_->last_node(name.data(), name.size()));
+	}
+
+	XMLNodeHandle XMLNodeHandle::FirstNode() const
+	{
+		return XMLNodeHandle(node_->first_node());
+	}
+
+	XMLNodeHandle XMLNodeHandle::LastNode() const
+	{
+		return XMLNodeHandle(node_->last_node());
+	}
+
+	XMLNodeHandle XMLNodeHandle::PrevSibling(std::string_view name) const
+	{
+		return XMLNodeHandle(node_->previous_sibling(name.data(), name.size()));
+	}
+
+	XMLNodeHandle XMLNodeHandle::NextSibling(std::string_view name) const
+	{
+		return XMLNodeHandle(node_->next_sibling(name.data(), name.size()));
+	}
+
+	XMLNodeHandle XMLNodeHandle::PrevSibling() const
+	{
+		return XMLNodeHandle(node_->previous_sibling());
+	}
+
+	XMLNodeHandle XMLNodeHandle::NextSibling() const
+	{
+		return XMLNodeHandle(node_->next_sibling());
+	}
+
+	XMLHandleRange<XMLNodeHandle> XMLNodeHandle::Children() const
+	{
+		return XMLHandleRange<XMLNodeHandle>(this->FirstNode(), std::string_view());
+	}
+
+	XMLHandleRange<XMLNodeHandle> XMLNodeHandle::Children(std::string_view name) const
+	{
+		return XMLHandleRange<XMLNodeHandle>(this->FirstNode(name), name);
+	}
+
+	XMLHandleRange<XMLAttributeHandle> XMLNodeHandle::Attribs() const
+	{
+		return XMLHandleRange<XMLAttributeHandle>(this->FirstAttrib(), std::string_view());
+	}
+
+	XMLNodeHandle XMLNodeHandle::Next(std::string_view name) const
+	{
+		return name.empty() ? this->NextSibling() : this->NextSibling(name);
+	}
+
+	bool XMLNodeHandle::TryConvert(int32_t& val) const
 	{
 		std::string_view const value_str = this->ValueString();
 
@@ -521,7 +1143,7 @@ namespace KlayGE
 #endif
 	}
 
-	bool XMLNode::TryConvert(uint32_t& val) const
+	bool XMLNodeHandle::TryConvert(uint32_t& val) const
 	{
 		std::string_view const value_str = this->ValueString();
 
@@ -542,7 +1164,7 @@ namespace KlayGE
 #endif
 	}
 
-	bool XMLNode::TryConvert(float& val) const
+	bool XMLNodeHandle::TryConvert(float& val) const
 	{
 		std::string_view const value_str = this->ValueString();
 
@@ -563,76 +1185,48 @@ namespace KlayGE
 #endif
 	}
 
-	int32_t XMLNode::ValueInt() const
+	int32_t XMLNodeHandle::ValueInt() const
 	{
 		return std::stol(std::string(this->ValueString()));
 	}
 
-	uint32_t XMLNode::ValueUInt() const
+	uint32_t XMLNodeHandle::ValueUInt() const
 	{
 		return std::stoul(std::string(this->ValueString()));
 	}
 
-	float XMLNode::ValueFloat() const
+	float XMLNodeHandle::ValueFloat() const
 	{
 		return std::stof(std::string(this->ValueString()));
 	}
 
-	std::string_view XMLNode::ValueString() const
+	std::string_view XMLNodeHandle::ValueString() const
 	{
 		return std::string_view(node_->value(), node_->value_size());
 	}
 
 
-	XMLAttribute::XMLAttribute(rapidxml::xml_attribute<char>* attr)
-		: attr_(attr)
+	std::string_view XMLAttributeHandle::Name() const
 	{
-		if (attr_ != nullptr)
-		{
-			auto const * xml_attr = attr_;
-			name_ = std::string_view(xml_attr->name(), xml_attr->name_size());
-			value_ = std::string_view(xml_attr->value(), xml_attr->value_size());
-		}
+		return std::string_view(attr_->name(), attr_->name_size());
 	}
 
-	XMLAttribute::XMLAttribute(rapidxml::xml_document<char>& doc, std::string_view name, std::string_view value)
-		: name_(name), value_(value)
+	XMLAttributeHandle XMLAttributeHandle::NextAttrib(std::string_view name) const
 	{
-		attr_ = doc.allocate_attribute(name.data(), value.data(), name.size(), value.size());
+		return XMLAttributeHandle(attr_->next_attribute(name.data(), name.size()));
 	}
 
-	std::string_view XMLAttribute::Name() const
+	XMLAttributeHandle XMLAttributeHandle::NextAttrib() const
 	{
-		return name_;
+		return XMLAttributeHandle(attr_->next_attribute());
 	}
 
-	XMLAttributePtr XMLAttribute::NextAttrib(std::string_view name) const
+	XMLAttributeHandle XMLAttributeHandle::Next(std::string_view name) const
 	{
-		auto* attr = attr_->next_attribute(name.data(), name.size());
-		if (attr)
-		{
-			return MakeSharedPtr<XMLAttribute>(attr);
-		}
-		else
-		{
-			return XMLAttributePtr();
-		}
+		return name.empty() ? this->NextAttrib() : this->NextAttrib(name);
 	}
 
-	XMLAttributePtr XMLAttribute::NextAttrib() const
-	{
-		auto* attr = attr_->next_attribute();
-		if (attr)
-		{
-			return MakeSharedPtr<XMLAttribute>(attr);
-		}
-		else
-		{
-			return XMLAttributePtr();
-		}
-	}
-
-	bool XMLAttribute::TryConvert(int32_t& val) const
+	bool XMLAttributeHandle::TryConvert(int32_t& val) const
 	{
 		std::string_view const value_str = this->ValueString();
 
@@ -653,7 +1247,7 @@ namespace KlayGE
 #endif
 	}
 
-	bool XMLAttribute::TryConvert(uint32_t& val) const
+	bool XMLAttributeHandle::TryConvert(uint32_t& val) const
 	{
 		std::string_view const value_str = this->ValueString();
 
@@ -674,7 +1268,7 @@ namespace KlayGE
 #endif
 	}
 
-	bool XMLAttribute::TryConvert(float& val) const
+	bool XMLAttributeHandle::TryConvert(float& val) const
 	{
 		std::string_view const value_str = this->ValueString();
 
@@ -695,23 +1289,23 @@ namespace KlayGE
 #endif
 	}
 
-	int32_t XMLAttribute::ValueInt() const
+	int32_t XMLAttributeHandle::ValueInt() const
 	{
 		return std::stol(std::string(this->ValueString()));
 	}
 
-	uint32_t XMLAttribute::ValueUInt() const
+	uint32_t XMLAttributeHandle::ValueUInt() const
 	{
 		return std::stoul(std::string(this->ValueString()));
 	}
 
-	float XMLAttribute::ValueFloat() const
+	float XMLAttributeHandle::ValueFloat() const
 	{
 		return std::stof(std::string(this->ValueString()));
 	}
 
-	std::string_view XMLAttribute::ValueString() const
+	std::string_view XMLAttributeHandle::ValueString() const
 	{
-		return value_;
+		return std::string_view(attr_->value(), attr_->value_size());
 	}
 }
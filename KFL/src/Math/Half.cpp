@@ -30,6 +30,16 @@
 
 #include <KFL/KFL.hpp>
 
+#include <algorithm>
+
+#if defined(KLAYGE_AVX2_SUPPORT) && (defined(KLAYGE_COMPILER_MSVC) || defined(__F16C__))
+	#define HALF_CONVERT_F16C
+	#include <immintrin.h>
+#elif defined(KLAYGE_NEON_SUPPORT) && defined(KLAYGE_CPU_ARM64)
+	#define HALF_CONVERT_NEON
+	#include <arm_neon.h>
+#endif
+
 #include <KFL/Half.hpp>
 
 namespace KlayGE
@@ -71,6 +81,10 @@ namespace KlayGE
 			if (0xFF - (127 - 15) == e)
 			{
 				e = 31;
+				if (m != 0)
+				{
+					m |= 0x00400000;	// keep a Nan a Nan
+				}
 			}
 			else
 			{
@@ -84,6 +98,12 @@ namespace KlayGE
 						e += 1;		// adjust exponent
 					}
 				}
+
+				if (e > 30)
+				{
+					e = 31;		// overflow to infinity
+					m = 0;
+				}
 			}
 
 			value_ = static_cast<uint16_t>(s | (e << 10) | (m >> 13));
@@ -113,16 +133,18 @@ namespace KlayGE
 				e += 1;
 				m &= ~0x00000400;
 			}
+			else
+			{
+				// Zero
+				e = -(127 - 15);
+			}
 		}
 		else
 		{
 			if (31 == e)
 			{
-				if (m != 0)
-				{
-					// Nan -- preserve sign and significand bits
-					e = 0xFF - (127 - 15);
-				}
+				// Infinity or Nan -- preserve sign and significand bits
+				e = 0xFF - (127 - 15);
 			}
 		}
 
@@ -220,4 +242,78 @@ namespace KlayGE
 	{
 		return value_ == rhs.value_;
 	}
+
+	void FloatToHalf(std::span<float const> input, std::span<half> output) noexcept
+	{
+		size_t const num = static_cast<size_t>(input.size());
+		BOOST_ASSERT(static_cast<size_t>(output.size()) >= num);
+
+		float const * src = input.data();
+		half* dst = output.data();
+		size_t i = 0;
+#if defined(HALF_CONVERT_F16C)
+		for (; i + 8 <= num; i += 8)
+		{
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i),
+				_mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT));
+		}
+		for (; i + 4 <= num; i += 4)
+		{
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(dst + i), _mm_cvtps_ph(_mm_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT));
+		}
+#elif defined(HALF_CONVERT_NEON)
+		for (; i + 4 <= num; i += 4)
+		{
+			vst1_u16(reinterpret_cast<uint16_t*>(dst + i), vreinterpret_u16_f16(vcvt_f16_f32(vld1q_f32(src + i))));
+		}
+#endif
+
+#if defined(HALF_CONVERT_F16C) || defined(HALF_CONVERT_NEON)
+		// The tail goes through the same instructions, so every value is rounded the same way
+		if (i < num)
+		{
+			float tail_src[4] = { 0, 0, 0, 0 };
+			half tail_dst[4];
+			std::copy(src + i, src + num, tail_src);
+			FloatToHalf(std::span<float const>(tail_src, 4), std::span<half>(tail_dst, 4));
+			std::copy(tail_dst, tail_dst + (num - i), dst + i);
+		}
+#else
+		for (; i < num; ++ i)
+		{
+			dst[i] = half(src[i]);
+		}
+#endif
+	}
+
+	void HalfToFloat(std::span<half const> input, std::span<float> output) noexcept
+	{
+		size_t const num = static_cast<size_t>(input.size());
+		BOOST_ASSERT(static_cast<size_t>(output.size()) >= num);
+
+		half const * src = input.data();
+		float* dst = output.data();
+		size_t i = 0;
+#if defined(HALF_CONVERT_F16C)
+		for (; i + 8 <= num; i += 8)
+		{
+			_mm256_storeu_ps(dst + i, _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<__m128i const *>(src + i))));
+		}
+		for (; i + 4 <= num; i += 4)
+		{
+			_mm_storeu_ps(dst + i, _mm_cvtph_ps(_mm_loadl_epi64(reinterpret_cast<__m128i const *>(src + i))));
+		}
+#elif defined(HALF_CONVERT_NEON)
+		for (; i + 4 <= num; i += 4)
+		{
+			vst1q_f32(dst + i, vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(reinterpret_cast<uint16_t const *>(src + i)))));
+		}
+#endif
+
+		// Widening is exact, the scalar code gives the same results
+		for (; i < num; ++ i)
+		{
+			dst[i] = src[i];
+		}
+	}
 }
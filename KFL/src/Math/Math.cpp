@@ -32,6 +32,107 @@
 #include <KFL/Detail/MathHelper.hpp>
 
 #include <KFL/Math.hpp>
+#include <KFL/SIMDMath.hpp>
+
+namespace
+{
+	using namespace KlayGE;
+
+	template <typename T>
+	AABBox_T<T> TransformAABBCorners(AABBox_T<T> const & aabb, Matrix4_T<T> const & mat) noexcept
+	{
+		Vector_T<T, 3> min, max;
+		min = max = MathLib::transform_coord(aabb.Corner(0), mat);
+		for (size_t j = 1; j < 8; ++j)
+		{
+			Vector_T<T, 3> const vec = MathLib::transform_coord(aabb.Corner(j), mat);
+			min = MathLib::minimize(min, vec);
+			max = MathLib::maximize(max, vec);
+		}
+
+		return AABBox_T<T>(min, max);
+	}
+
+	// Each corner is the sum of one of the 2 scaled rows for every axis, so the 8 corners take only 6 products
+	AABBox TransformAABBCorners(AABBox const & aabb, float4x4 const & mat) noexcept
+	{
+		SIMDMatrixF4 const m = SIMDMathLib::LoadMatrix(mat);
+		float3 const & aabb_min = aabb.Min();
+		float3 const & aabb_max = aabb.Max();
+
+		SIMDVectorF4 const x0 = SIMDMathLib::Multiply(SIMDMathLib::SetVector(aabb_min.x()), m.Row(0));
+		SIMDVectorF4 const x1 = SIMDMathLib::Multiply(SIMDMathLib::SetVector(aabb_max.x()), m.Row(0));
+		SIMDVectorF4 const y0 = SIMDMathLib::MultiplyAdd(SIMDMathLib::SetVector(aabb_min.y()), m.Row(1), m.Row(3));
+		SIMDVectorF4 const y1 = SIMDMathLib::MultiplyAdd(SIMDMathLib::SetVector(aabb_max.y()), m.Row(1), m.Row(3));
+		SIMDVectorF4 const z0 = SIMDMathLib::Multiply(SIMDMathLib::SetVector(aabb_min.z()), m.Row(2));
+		SIMDVectorF4 const z1 = SIMDMathLib::Multiply(SIMDMathLib::SetVector(aabb_max.z()), m.Row(2));
+
+		SIMDVectorF4 const xys[] =
+		{
+			SIMDMathLib::Add(x0, y0), SIMDMathLib::Add(x1, y0), SIMDMathLib::Add(x0, y1), SIMDMathLib::Add(x1, y1)
+		};
+
+		SIMDVectorF4 min = SIMDMathLib::SetVector(+std::numeric_limits<float>::max());
+		SIMDVectorF4 max = SIMDMathLib::SetVector(-std::numeric_limits<float>::max());
+		for (auto const & xy : xys)
+		{
+			for (auto const & z : { z0, z1 })
+			{
+				SIMDVectorF4 corner = SIMDMathLib::Add(xy, z);
+				corner = SIMDMathLib::Divide(corner, SIMDMathLib::SetVector(SIMDMathLib::GetW(corner)));
+				min = SIMDMathLib::Minimize(min, corner);
+				max = SIMDMathLib::Maximize(max, corner);
+			}
+		}
+
+		float3 ret_min, ret_max;
+		SIMDMathLib::StoreVector3(ret_min, min);
+		SIMDMathLib::StoreVector3(ret_max, max);
+		return AABBox(ret_min, ret_max);
+	}
+
+	// The p-vertex/n-vertex test of MathLib::intersect_aabb_frustum on 4 boxes in SoA form. The choice of vertex only depends
+	// on the plane, so it's made once for all lanes, and every lane does the same arithmetic as the single box version.
+	void IntersectAABBsFrustum(SIMDVectorF4 const (&min_pt)[3], SIMDVectorF4 const (&max_pt)[3], uint32_t num,
+		Frustum const & frustum, BoundOverlap* results) noexcept
+	{
+		SIMDVectorF4 const zero = SIMDVectorF4::Zero();
+
+		uint32_t outside = 0;
+		uint32_t intersect = 0;
+		for (uint32_t i = 0; (i < 6) && (outside != 0xF); ++ i)
+		{
+			Plane const & plane = frustum.FrustumPlane(i);
+			SIMDVectorF4 const a = SIMDMathLib::SetVector(plane.a());
+			SIMDVectorF4 const b = SIMDMathLib::SetVector(plane.b());
+			SIMDVectorF4 const c = SIMDMathLib::SetVector(plane.c());
+			SIMDVectorF4 const d = SIMDMathLib::SetVector(plane.d());
+
+			// v1 is diagonally opposed to v0
+			SIMDVectorF4 const & v0x = (plane.a() < 0) ? min_pt[0] : max_pt[0];
+			SIMDVectorF4 const & v0y = (plane.b() < 0) ? min_pt[1] : max_pt[1];
+			SIMDVectorF4 const & v0z = (plane.c() < 0) ? min_pt[2] : max_pt[2];
+			SIMDVectorF4 const & v1x = (plane.a() < 0) ? max_pt[0] : min_pt[0];
+			SIMDVectorF4 const & v1y = (plane.b() < 0) ? max_pt[1] : min_pt[1];
+			SIMDVectorF4 const & v1z = (plane.c() < 0) ? max_pt[2] : min_pt[2];
+
+			outside |= SIMDMathLib::LessMask(a * v0x + b * v0y + c * v0z + d, zero);
+			intersect |= SIMDMathLib::LessMask(a * v1x + b * v1y + c * v1z + d, zero);
+		}
+
+		for (uint32_t i = 0; i < num; ++ i)
+		{
+			if (outside & (1U << i))
+			{
+				results[i] = BoundOverlap::No;
+			}
+			else
+			{
+				results[i] = (intersect & (1U << i)) ? BoundOverlap::Partial : BoundOverlap::Yes;
+			}
+		}
+	}
+}
 
 namespace KlayGE
 {
@@ -2324,16 +2425,7 @@ namespace KlayGE
 		template <typename T>
 		AABBox_T<T> transform_aabb(AABBox_T<T> const & aabb, Matrix4_T<T> const & mat) noexcept
 		{
-			Vector_T<T, 3> min, max;
-			min = max = transform_coord(aabb.Corner(0), mat);
-			for (size_t j = 1; j < 8; ++j)
-			{
-				Vector_T<T, 3> const vec = transform_coord(aabb.Corner(j), mat);
-				min = minimize(min, vec);
-				max = maximize(max, vec);
-			}
-
-			return AABBox_T<T>(min, max);
+			return TransformAABBCorners(aabb, mat);
 		}
 
 		template AABBox transform_aabb(AABBox const & aabb, float3 const & scale, Quaternion const & rot, float3 const & trans) noexcept;
@@ -3000,6 +3092,112 @@ namespace KlayGE
 			return BoundOverlap::Partial;
 		}
 
+		void intersect_aabbs_frustum(float const * min_x, float const * min_y, float const * min_z,
+			float const * max_x, float const * max_y, float const * max_z, size_t num,
+			Frustum const & frustum, BoundOverlap* results) noexcept
+		{
+			size_t i = 0;
+			for (; i + 4 <= num; i += 4)
+			{
+				SIMDVectorF4 const min_pt[] = { SIMDMathLib::LoadVector4(&min_x[i]), SIMDMathLib::LoadVector4(&min_y[i]),
+					SIMDMathLib::LoadVector4(&min_z[i]) };
+				SIMDVectorF4 const max_pt[] = { SIMDMathLib::LoadVector4(&max_x[i]), SIMDMathLib::LoadVector4(&max_y[i]),
+					SIMDMathLib::LoadVector4(&max_z[i]) };
+				IntersectAABBsFrustum(min_pt, max_pt, 4, frustum, &results[i]);
+			}
+			if (i < num)
+			{
+				// The lanes beyond the end repeat the last box
+				float tail[6][4];
+				for (size_t j = 0; j < 4; ++ j)
+				{
+					size_t const index = std::min(i + j, num - 1);
+					tail[0][j] = min_x[index];
+					tail[1][j] = min_y[index];
+					tail[2][j] = min_z[index];
+					tail[3][j] = max_x[index];
+					tail[4][j] = max_y[index];
+					tail[5][j] = max_z[index];
+				}
+				SIMDVectorF4 const min_pt[] = { SIMDMathLib::LoadVector4(tail[0]), SIMDMathLib::LoadVector4(tail[1]),
+					SIMDMathLib::LoadVector4(tail[2]) };
+				SIMDVectorF4 const max_pt[] = { SIMDMathLib::LoadVector4(tail[3]), SIMDMathLib::LoadVector4(tail[4]),
+					SIMDMathLib::LoadVector4(tail[5]) };
+				IntersectAABBsFrustum(min_pt, max_pt, static_cast<uint32_t>(num - i), frustum, &results[i]);
+			}
+		}
+
+		void intersect_aabbs_frustum(AABBox const * aabbs, size_t num, Frustum const & frustum, BoundOverlap* results) noexcept
+		{
+			for (size_t i = 0; i < num; i += 4)
+			{
+				AABBox const & aabb0 = aabbs[i];
+				AABBox const & aabb1 = aabbs[std::min(i + 1, num - 1)];
+				AABBox const & aabb2 = aabbs[std::min(i + 2, num - 1)];
+				AABBox const & aabb3 = aabbs[std::min(i + 3, num - 1)];
+
+				SIMDVectorF4 min_pt[3];
+				SIMDVectorF4 max_pt[3];
+				for (size_t j = 0; j < 3; ++ j)
+				{
+					min_pt[j] = SIMDMathLib::SetVector(aabb0.Min()[j], aabb1.Min()[j], aabb2.Min()[j], aabb3.Min()[j]);
+					max_pt[j] = SIMDMathLib::SetVector(aabb0.Max()[j], aabb1.Max()[j], aabb2.Max()[j], aabb3.Max()[j]);
+				}
+				IntersectAABBsFrustum(min_pt, max_pt, static_cast<uint32_t>(std::min<size_t>(num - i, 4)), frustum, &results[i]);
+			}
+		}
+
+		// Center-extent form, so the planes can be in the lanes instead of the boxes
+		void intersect_aabb_frustums(AABBox const & aabb, Frustum const * const * frustums, size_t num_frustums,
+			BoundOverlap* results) noexcept
+		{
+			float3 const center = aabb.Center();
+			float3 const extent = aabb.HalfSize();
+			SIMDVectorF4 const cx = SIMDMathLib::SetVector(center.x());
+			SIMDVectorF4 const cy = SIMDMathLib::SetVector(center.y());
+			SIMDVectorF4 const cz = SIMDMathLib::SetVector(center.z());
+			SIMDVectorF4 const ex = SIMDMathLib::SetVector(extent.x());
+			SIMDVectorF4 const ey = SIMDMathLib::SetVector(extent.y());
+			SIMDVectorF4 const ez = SIMDMathLib::SetVector(extent.z());
+			SIMDVectorF4 const zero = SIMDVectorF4::Zero();
+
+			// The 2nd group repeats the last 2 planes
+			static uint32_t const plane_groups[2][4] = { { 0, 1, 2, 3 }, { 4, 5, 4, 5 } };
+
+			for (size_t i = 0; i < num_frustums; ++ i)
+			{
+				Frustum const & frustum = *frustums[i];
+
+				uint32_t outside = 0;
+				uint32_t intersect = 0;
+				for (auto const & group : plane_groups)
+				{
+					Plane const & p0 = frustum.FrustumPlane(group[0]);
+					Plane const & p1 = frustum.FrustumPlane(group[1]);
+					Plane const & p2 = frustum.FrustumPlane(group[2]);
+					Plane const & p3 = frustum.FrustumPlane(group[3]);
+					SIMDVectorF4 const a = SIMDMathLib::SetVector(p0.a(), p1.a(), p2.a(), p3.a());
+					SIMDVectorF4 const b = SIMDMathLib::SetVector(p0.b(), p1.b(), p2.b(), p3.b());
+					SIMDVectorF4 const c = SIMDMathLib::SetVector(p0.c(), p1.c(), p2.c(), p3.c());
+					SIMDVectorF4 const d = SIMDMathLib::SetVector(p0.d(), p1.d(), p2.d(), p3.d());
+
+					SIMDVectorF4 const dist = a * cx + b * cy + c * cz + d;
+					SIMDVectorF4 const radius = SIMDMathLib::Abs(a) * ex + SIMDMathLib::Abs(b) * ey + SIMDMathLib::Abs(c) * ez;
+					outside |= SIMDMathLib::LessMask(dist + radius, zero);
+					intersect |= SIMDMathLib::LessMask(dist - radius, zero);
+				}
+
+				if (outside)
+				{
+					results[i] = BoundOverlap::No;
+				}
+				else
+				{
+					results[i] = intersect ? BoundOverlap::Partial : BoundOverlap::Yes;
+				}
+			}
+		}
+
 
 		template void intersect(float3 const & v0, float3 const & v1, float3 const & v2,
 						float3 const & ray_orig, float3 const & ray_dir,
@@ -30,8 +30,521 @@
 
 #include <KFL/KFL.hpp>
 
+#include <algorithm>
+#include <vector>
+
+#if defined(KLAYGE_AVX2_SUPPORT)
+	#define NOISE_BATCH_AVX2
+	#include <immintrin.h>
+#elif defined(KLAYGE_SSE2_SUPPORT)
+	#define NOISE_BATCH_SSE
+	#include <emmintrin.h>
+#elif defined(KLAYGE_NEON_SUPPORT) && defined(KLAYGE_CPU_ARM64)
+	#define NOISE_BATCH_NEON
+	#include <arm_neon.h>
+#endif
+
+#include <KFL/TaskScheduler.hpp>
+
 #include <KFL/Noise.hpp>
 
+namespace
+{
+	using namespace KlayGE;
+
+	// Lanes of the batch functions. The primary template has only one, float gets a whole SIMD register.
+	template <typename T>
+	struct NoiseLanes
+	{
+		static uint32_t constexpr NUM = 1;
+
+		typedef T Float;
+		typedef int Int;
+		typedef bool Mask;
+
+		static Float Load(T const * p)
+		{
+			return *p;
+		}
+		static void Store(T* p, Float v)
+		{
+			*p = v;
+		}
+		static Float Set(T v)
+		{
+			return v;
+		}
+		static Int SetInt(int v)
+		{
+			return v;
+		}
+
+		static Float Add(Float lhs, Float rhs)
+		{
+			return lhs + rhs;
+		}
+		static Float Sub(Float lhs, Float rhs)
+		{
+			return lhs - rhs;
+		}
+		static Float Mul(Float lhs, Float rhs)
+		{
+			return lhs * rhs;
+		}
+		static Float Div(Float lhs, Float rhs)
+		{
+			return lhs / rhs;
+		}
+		static Float Abs(Float v)
+		{
+			return MathLib::abs(v);
+		}
+
+		static Mask Greater(Float lhs, Float rhs)
+		{
+			return lhs > rhs;
+		}
+		static Float And(Mask mask, Float v)
+		{
+			return mask ? v : T(0);
+		}
+
+		// The same rounding as MathLib::floor, which the single point functions use
+		static Int Floor(Float v)
+		{
+			return static_cast<int>(MathLib::floor(v));
+		}
+		static Int ToInt(Float v)
+		{
+			return static_cast<int>(v);
+		}
+		static Float ToFloat(Int v)
+		{
+			return static_cast<T>(v);
+		}
+		static Int AddInt(Int lhs, Int rhs)
+		{
+			return lhs + rhs;
+		}
+		static Int AndInt(Int v, int mask)
+		{
+			return v & mask;
+		}
+
+		static Int Gather(int const * table, Int index)
+		{
+			return table[index];
+		}
+		static Float Gather(T const * table, Int index)
+		{
+			return table[index];
+		}
+	};
+
+#if defined(NOISE_BATCH_AVX2)
+	template <>
+	struct NoiseLanes<float>
+	{
+		static uint32_t constexpr NUM = 8;
+
+		typedef __m256 Float;
+		typedef __m256i Int;
+		typedef __m256 Mask;
+
+		static Float Load(float const * p)
+		{
+			return _mm256_loadu_ps(p);
+		}
+		static void Store(float* p, Float v)
+		{
+			_mm256_storeu_ps(p, v);
+		}
+		static Float Set(float v)
+		{
+			return _mm256_set1_ps(v);
+		}
+		static Int SetInt(int v)
+		{
+			return _mm256_set1_epi32(v);
+		}
+
+		static Float Add(Float lhs, Float rhs)
+		{
+			return _mm256_add_ps(lhs, rhs);
+		}
+		static Float Sub(Float lhs, Float rhs)
+		{
+			return _mm256_sub_ps(lhs, rhs);
+		}
+		static Float Mul(Float lhs, Float rhs)
+		{
+			return _mm256_mul_ps(lhs, rhs);
+		}
+		static Float Div(Float lhs, Float rhs)
+		{
+			return _mm256_div_ps(lhs, rhs);
+		}
+		static Float Abs(Float v)
+		{
+			return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), v);
+		}
+
+		static Mask Greater(Float lhs, Float rhs)
+		{
+			return _mm256_cmp_ps(lhs, rhs, _CMP_GT_OQ);
+		}
+		static Float And(Mask mask, Float v)
+		{
+			return _mm256_and_ps(mask, v);
+		}
+
+		static Int Floor(Float v)
+		{
+			Float const v_1 = _mm256_sub_ps(v, _mm256_set1_ps(1));
+			return _mm256_cvttps_epi32(_mm256_blendv_ps(v_1, v, Greater(v, _mm256_setzero_ps())));
+		}
+		static Int ToInt(Float v)
+		{
+			return _mm256_cvttps_epi32(v);
+		}
+		static Float ToFloat(Int v)
+		{
+			return _mm256_cvtepi32_ps(v);
+		}
+		static Int AddInt(Int lhs, Int rhs)
+		{
+			return _mm256_add_epi32(lhs, rhs);
+		}
+		static Int AndInt(Int v, int mask)
+		{
+			return _mm256_and_si256(v, _mm256_set1_epi32(mask));
+		}
+
+		static Int Gather(int const * table, Int index)
+		{
+			return _mm256_i32gather_epi32(table, index, 4);
+		}
+		static Float Gather(float const * table, Int index)
+		{
+			return _mm256_i32gather_ps(table, index, 4);
+		}
+	};
+#elif defined(NOISE_BATCH_SSE)
+	template <>
+	struct NoiseLanes<float>
+	{
+		static uint32_t constexpr NUM = 4;
+
+		typedef __m128 Float;
+		typedef __m128i Int;
+		typedef __m128 Mask;
+
+		static Float Load(float const * p)
+		{
+			return _mm_loadu_ps(p);
+		}
+		static void Store(float* p, Float v)
+		{
+			_mm_storeu_ps(p, v);
+		}
+		static Float Set(float v)
+		{
+			return _mm_set1_ps(v);
+		}
+		static Int SetInt(int v)
+		{
+			return _mm_set1_epi32(v);
+		}
+
+		static Float Add(Float lhs, Float rhs)
+		{
+			return _mm_add_ps(lhs, rhs);
+		}
+		static Float Sub(Float lhs, Float rhs)
+		{
+			return _mm_sub_ps(lhs, rhs);
+		}
+		static Float Mul(Float lhs, Float rhs)
+		{
+			return _mm_mul_ps(lhs, rhs);
+		}
+		static Float Div(Float lhs, Float rhs)
+		{
+			return _mm_div_ps(lhs, rhs);
+		}
+		static Float Abs(Float v)
+		{
+			return _mm_andnot_ps(_mm_set1_ps(-0.0f), v);
+		}
+
+		static Mask Greater(Float lhs, Float rhs)
+		{
+			return _mm_cmpgt_ps(lhs, rhs);
+		}
+		static Float And(Mask mask, Float v)
+		{
+			return _mm_and_ps(mask, v);
+		}
+
+		static Int Floor(Float v)
+		{
+			Mask const positive = Greater(v, _mm_setzero_ps());
+			Float const v_1 = _mm_sub_ps(v, _mm_set1_ps(1));
+			return _mm_cvttps_epi32(_mm_or_ps(_mm_and_ps(positive, v), _mm_andnot_ps(positive, v_1)));
+		}
+		static Int ToInt(Float v)
+		{
+			return _mm_cvttps_epi32(v);
+		}
+		static Float ToFloat(Int v)
+		{
+			return _mm_cvtepi32_ps(v);
+		}
+		static Int AddInt(Int lhs, Int rhs)
+		{
+			return _mm_add_epi32(lhs, rhs);
+		}
+		static Int AndInt(Int v, int mask)
+		{
+			return _mm_and_si128(v, _mm_set1_epi32(mask));
+		}
+
+		// No gather instruction before AVX2
+		static Int Gather(int const * table, Int index)
+		{
+			alignas(16) int i[4];
+			_mm_store_si128(reinterpret_cast<__m128i*>(i), index);
+			return _mm_setr_epi32(table[i[0]], table[i[1]], table[i[2]], table[i[3]]);
+		}
+		static Float Gather(float const * table, Int index)
+		{
+			alignas(16) int i[4];
+			_mm_store_si128(reinterpret_cast<__m128i*>(i), index);
+			return _mm_setr_ps(table[i[0]], table[i[1]], table[i[2]], table[i[3]]);
+		}
+	};
+#elif defined(NOISE_BATCH_NEON)
+	template <>
+	struct NoiseLanes<float>
+	{
+		static uint32_t constexpr NUM = 4;
+
+		typedef float32x4_t Float;
+		typedef int32x4_t Int;
+		typedef uint32x4_t Mask;
+
+		static Float Load(float const * p)
+		{
+			return vld1q_f32(p);
+		}
+		static void Store(float* p, Float v)
+		{
+			vst1q_f32(p, v);
+		}
+		static Float Set(float v)
+		{
+			return vdupq_n_f32(v);
+		}
+		static Int SetInt(int v)
+		{
+			return vdupq_n_s32(v);
+		}
+
+		static Float Add(Float lhs, Float rhs)
+		{
+			return vaddq_f32(lhs, rhs);
+		}
+		static Float Sub(Float lhs, Float rhs)
+		{
+			return vsubq_f32(lhs, rhs);
+		}
+		static Float Mul(Float lhs, Float rhs)
+		{
+			return vmulq_f32(lhs, rhs);
+		}
+		static Float Div(Float lhs, Float rhs)
+		{
+			return vdivq_f32(lhs, rhs);
+		}
+		static Float Abs(Float v)
+		{
+			return vabsq_f32(v);
+		}
+
+		static Mask Greater(Float lhs, Float rhs)
+		{
+			return vcgtq_f32(lhs, rhs);
+		}
+		static Float And(Mask mask, Float v)
+		{
+			return vreinterpretq_f32_u32(vandq_u32(mask, vreinterpretq_u32_f32(v)));
+		}
+
+		static Int Floor(Float v)
+		{
+			Float const v_1 = vsubq_f32(v, vdupq_n_f32(1));
+			return vcvtq_s32_f32(vbslq_f32(Greater(v, vdupq_n_f32(0)), v, v_1));
+		}
+		static Int ToInt(Float v)
+		{
+			return vcvtq_s32_f32(v);
+		}
+		static Float ToFloat(Int v)
+		{
+			return vcvtq_f32_s32(v);
+		}
+		static Int AddInt(Int lhs, Int rhs)
+		{
+			return vaddq_s32(lhs, rhs);
+		}
+		static Int AndInt(Int v, int mask)
+		{
+			return vandq_s32(v, vdupq_n_s32(mask));
+		}
+
+		static Int Gather(int const * table, Int index)
+		{
+			int32_t i[4];
+			vst1q_s32(i, index);
+			int32_t const ret[] = { table[i[0]], table[i[1]], table[i[2]], table[i[3]] };
+			return vld1q_s32(ret);
+		}
+		static Float Gather(float const * table, Int index)
+		{
+			int32_t i[4];
+			vst1q_s32(i, index);
+			float const ret[] = { table[i[0]], table[i[1]], table[i[2]], table[i[3]] };
+			return vld1q_f32(ret);
+		}
+	};
+#endif
+
+	template <typename T>
+	struct NoiseTables
+	{
+		int const * perm;
+		int const * perm_mod12;
+		T const * grad_x;
+		T const * grad_y;
+	};
+
+	template <typename T>
+	typename NoiseLanes<T>::Float SimplexCorner(NoiseTables<T> const & tables, typename NoiseLanes<T>::Int grad_index,
+		typename NoiseLanes<T>::Float x, typename NoiseLanes<T>::Float y)
+	{
+		typedef NoiseLanes<T> Lanes;
+
+		typename Lanes::Float t = Lanes::Sub(Lanes::Sub(Lanes::Set(T(0.5)), Lanes::Mul(x, x)), Lanes::Mul(y, y));
+		typename Lanes::Mask const inside = Lanes::Greater(t, Lanes::Set(T(0)));
+		t = Lanes::Mul(t, t);
+		typename Lanes::Float const d = Lanes::Add(Lanes::Mul(Lanes::Gather(tables.grad_x, grad_index), x),
+			Lanes::Mul(Lanes::Gather(tables.grad_y, grad_index), y));
+		return Lanes::And(inside, Lanes::Mul(Lanes::Mul(t, t), d));
+	}
+
+	// Follows SimplexNoise<T>::noise(x, y) step by step
+	template <typename T>
+	typename NoiseLanes<T>::Float SimplexNoise2D(NoiseTables<T> const & tables,
+		typename NoiseLanes<T>::Float x, typename NoiseLanes<T>::Float y)
+	{
+		typedef NoiseLanes<T> Lanes;
+		typedef typename Lanes::Float Float;
+		typedef typename Lanes::Int Int;
+
+		T const F2 = T(0.366025403784);//(sqrt(3) - 1) / 2
+		T const G2 = T(0.211324865405);//(3 - sqrt(3)) / 6
+
+		Float const s = Lanes::Mul(Lanes::Add(x, y), Lanes::Set(F2));
+		Int const i = Lanes::Floor(Lanes::Add(x, s));
+		Int const j = Lanes::Floor(Lanes::Add(y, s));
+		Float const t = Lanes::Mul(Lanes::ToFloat(Lanes::AddInt(i, j)), Lanes::Set(G2));
+		Float const x0 = Lanes::Sub(x, Lanes::Sub(Lanes::ToFloat(i), t));
+		Float const y0 = Lanes::Sub(y, Lanes::Sub(Lanes::ToFloat(j), t));
+
+		Float const one = Lanes::Set(T(1));
+		Float const i1 = Lanes::And(Lanes::Greater(x0, y0), one);
+		Float const j1 = Lanes::Sub(one, i1);
+
+		Float const x1 = Lanes::Add(Lanes::Sub(x0, i1), Lanes::Set(G2));
+		Float const y1 = Lanes::Add(Lanes::Sub(y0, j1), Lanes::Set(G2));
+		Float const x2 = Lanes::Add(Lanes::Sub(x0, one), Lanes::Set(2 * G2));
+		Float const y2 = Lanes::Add(Lanes::Sub(y0, one), Lanes::Set(2 * G2));
+
+		Int const ii = Lanes::AndInt(i, 255);
+		Int const jj = Lanes::AndInt(j, 255);
+		Int const one_int = Lanes::SetInt(1);
+
+		Int const gi0 = Lanes::Gather(tables.perm_mod12, Lanes::AddInt(ii, Lanes::Gather(tables.perm, jj)));
+		Int const gi1 = Lanes::Gather(tables.perm_mod12, Lanes::AddInt(Lanes::AddInt(ii, Lanes::ToInt(i1)),
+			Lanes::Gather(tables.perm, Lanes::AddInt(jj, Lanes::ToInt(j1)))));
+		Int const gi2 = Lanes::Gather(tables.perm_mod12, Lanes::AddInt(Lanes::AddInt(ii, one_int),
+			Lanes::Gather(tables.perm, Lanes::AddInt(jj, one_int))));
+
+		Float n = SimplexCorner(tables, gi0, x0, y0);
+		n = Lanes::Add(n, SimplexCorner(tables, gi1, x1, y1));
+		n = Lanes::Add(n, SimplexCorner(tables, gi2, x2, y2));
+
+		return Lanes::Mul(Lanes::Set(T(70)), n);
+	}
+
+	template <typename T>
+	typename NoiseLanes<T>::Float TileableSimplexNoise2D(NoiseTables<T> const & tables,
+		typename NoiseLanes<T>::Float x, typename NoiseLanes<T>::Float y, T w, T h)
+	{
+		typedef NoiseLanes<T> Lanes;
+		typedef typename Lanes::Float Float;
+
+		Float const w_x = Lanes::Sub(Lanes::Set(w), x);
+		Float const h_y = Lanes::Sub(Lanes::Set(h), y);
+		Float const x_w = Lanes::Sub(x, Lanes::Set(w));
+		Float const y_h = Lanes::Sub(y, Lanes::Set(h));
+
+		Float n = Lanes::Mul(Lanes::Mul(SimplexNoise2D(tables, x, y), w_x), h_y);
+		n = Lanes::Add(n, Lanes::Mul(Lanes::Mul(SimplexNoise2D(tables, x_w, y), x), h_y));
+		n = Lanes::Add(n, Lanes::Mul(Lanes::Mul(SimplexNoise2D(tables, x, y_h), w_x), y));
+		n = Lanes::Add(n, Lanes::Mul(Lanes::Mul(SimplexNoise2D(tables, x_w, y_h), x), y));
+		return Lanes::Div(n, Lanes::Set(w * h));
+	}
+
+	// All the octaves of one set of lanes, so the coordinates stay in registers
+	template <typename T, bool Tileable, bool Turbulence>
+	typename NoiseLanes<T>::Float SimplexNoiseOctaves(NoiseTables<T> const & tables,
+		typename NoiseLanes<T>::Float x, typename NoiseLanes<T>::Float y, T w, T h, int octaves, T lacunarity, T gain)
+	{
+		typedef NoiseLanes<T> Lanes;
+		typedef typename Lanes::Float Float;
+
+		Float const lacunarities = Lanes::Set(lacunarity);
+		Float sum = Lanes::Set(T(0));
+		T amp = 1;
+		T amp_sum = 0;
+		for (int i = 0; i < octaves; ++ i)
+		{
+			Float n;
+			KLAYGE_IF_CONSTEXPR (Tileable)
+			{
+				n = TileableSimplexNoise2D(tables, x, y, w, h);
+			}
+			else
+			{
+				n = SimplexNoise2D(tables, x, y);
+			}
+			KLAYGE_IF_CONSTEXPR (Turbulence)
+			{
+				n = Lanes::Abs(n);
+			}
+			sum = Lanes::Add(sum, Lanes::Mul(n, Lanes::Set(amp)));
+			amp_sum += amp;
+			x = Lanes::Mul(x, lacunarities);
+			y = Lanes::Mul(y, lacunarities);
+			w *= lacunarity;
+			h *= lacunarity;
+			amp *= gain;
+		}
+		return Lanes::Div(sum, Lanes::Set(amp_sum));
+	}
+}
+
 namespace KlayGE
 {
 	namespace MathLib
@@ -72,6 +585,16 @@ namespace KlayGE
 			g_[9] = Vector_T<T, 3>(0, -1, 1);
 			g_[10] = Vector_T<T, 3>(0, 1, -1);
 			g_[11] = Vector_T<T, 3>(0, -1, -1);
+
+			for (int i = 0; i < 512; ++ i)
+			{
+				p_mod12_[i] = p_[i] % 12;
+			}
+			for (int i = 0; i < 12; ++ i)
+			{
+				gx_[i] = g_[i].x();
+				gy_[i] = g_[i].y();
+			}
 		}
 
 		template <typename T>
@@ -447,6 +970,144 @@ namespace KlayGE
 			return sum / amp_sum;
 		}
 
+		template <typename T>
+		void SimplexNoise<T>::noise(std::span<T const> xs, std::span<T const> ys, std::span<T> result) noexcept
+		{
+			this->batch<false, false>(xs, ys, T(1), T(1), result, 1, T(1), T(1));
+		}
+
+		template <typename T>
+		void SimplexNoise<T>::fBm(std::span<T const> xs, std::span<T const> ys, std::span<T> result,
+			int octaves, T lacunarity, T gain) noexcept
+		{
+			this->batch<false, false>(xs, ys, T(1), T(1), result, octaves, lacunarity, gain);
+		}
+
+		template <typename T>
+		void SimplexNoise<T>::turbulence(std::span<T const> xs, std::span<T const> ys, std::span<T> result,
+			int octaves, T lacunarity, T gain) noexcept
+		{
+			this->batch<false, true>(xs, ys, T(1), T(1), result, octaves, lacunarity, gain);
+		}
+
+		template <typename T>
+		void SimplexNoise<T>::tileable_noise(std::span<T const> xs, std::span<T const> ys, T w, T h, std::span<T> result) noexcept
+		{
+			this->batch<true, false>(xs, ys, w, h, result, 1, T(1), T(1));
+		}
+
+		template <typename T>
+		void SimplexNoise<T>::tileable_fBm(std::span<T const> xs, std::span<T const> ys, T w, T h, std::span<T> result,
+			int octaves, T lacunarity, T gain) noexcept
+		{
+			this->batch<true, false>(xs, ys, w, h, result, octaves, lacunarity, gain);
+		}
+
+		template <typename T>
+		void SimplexNoise<T>::tileable_turbulence(std::span<T const> xs, std::span<T const> ys, T w, T h, std::span<T> result,
+			int octaves, T lacunarity, T gain) noexcept
+		{
+			this->batch<true, true>(xs, ys, w, h, result, octaves, lacunarity, gain);
+		}
+
+		template <typename T>
+		void SimplexNoise<T>::fill_fBm(task_scheduler& scheduler, std::span<T> image, uint32_t width, uint32_t height, T w, T h,
+			int octaves, T lacunarity, T gain)
+		{
+			this->fill<false, false>(scheduler, image, width, height, w, h, octaves, lacunarity, gain);
+		}
+
+		template <typename T>
+		void SimplexNoise<T>::fill_turbulence(task_scheduler& scheduler, std::span<T> image, uint32_t width, uint32_t height,
+			T w, T h, int octaves, T lacunarity, T gain)
+		{
+			this->fill<false, true>(scheduler, image, width, height, w, h, octaves, lacunarity, gain);
+		}
+
+		template <typename T>
+		void SimplexNoise<T>::fill_tileable_fBm(task_scheduler& scheduler, std::span<T> image, uint32_t width, uint32_t height,
+			T w, T h, int octaves, T lacunarity, T gain)
+		{
+			this->fill<true, false>(scheduler, image, width, height, w, h, octaves, lacunarity, gain);
+		}
+
+		template <typename T>
+		void SimplexNoise<T>::fill_tileable_turbulence(task_scheduler& scheduler, std::span<T> image, uint32_t width,
+			uint32_t height, T w, T h, int octaves, T lacunarity, T gain)
+		{
+			this->fill<true, true>(scheduler, image, width, height, w, h, octaves, lacunarity, gain);
+		}
+
+		template <typename T>
+		template <bool Tileable, bool Turbulence>
+		void SimplexNoise<T>::batch(std::span<T const> xs, std::span<T const> ys, T w, T h, std::span<T> result,
+			int octaves, T lacunarity, T gain) noexcept
+		{
+			typedef NoiseLanes<T> Lanes;
+
+			size_t const num = static_cast<size_t>(xs.size());
+			BOOST_ASSERT(static_cast<size_t>(ys.size()) >= num);
+			BOOST_ASSERT(static_cast<size_t>(result.size()) >= num);
+
+			NoiseTables<T> const tables = { p_, p_mod12_, gx_, gy_ };
+
+			T const * x = xs.data();
+			T const * y = ys.data();
+			T* n = result.data();
+			size_t i = 0;
+			for (; i + Lanes::NUM <= num; i += Lanes::NUM)
+			{
+				Lanes::Store(n + i, SimplexNoiseOctaves<T, Tileable, Turbulence>(tables, Lanes::Load(x + i), Lanes::Load(y + i),
+					w, h, octaves, lacunarity, gain));
+			}
+
+			// The tail is padded to all the lanes, so every point goes through the same instructions
+			if (i < num)
+			{
+				T tail_x[Lanes::NUM] = {};
+				T tail_y[Lanes::NUM] = {};
+				T tail_n[Lanes::NUM];
+				std::copy(x + i, x + num, tail_x);
+				std::copy(y + i, y + num, tail_y);
+				Lanes::Store(tail_n, SimplexNoiseOctaves<T, Tileable, Turbulence>(tables, Lanes::Load(tail_x), Lanes::Load(tail_y),
+					w, h, octaves, lacunarity, gain));
+				std::copy(tail_n, tail_n + (num - i), n + i);
+			}
+		}
+
+		template <typename T>
+		template <bool Tileable, bool Turbulence>
+		void SimplexNoise<T>::fill(task_scheduler& scheduler, std::span<T> image, uint32_t width, uint32_t height, T w, T h,
+			int octaves, T lacunarity, T gain)
+		{
+			BOOST_ASSERT(static_cast<size_t>(image.size()) >= static_cast<size_t>(width) * height);
+
+			if ((0 == width) || (0 == height))
+			{
+				return;
+			}
+
+			std::vector<T> xs(width);
+			for (uint32_t x = 0; x < width; ++ x)
+			{
+				xs[x] = (x + T(0.5)) / width * w;
+			}
+
+			// About 16K samples in a task
+			uint32_t const grain_size = std::max(16384 / width, 1U);
+			scheduler.parallel_for(0, height, grain_size,
+				[this, image, width, height, w, h, octaves, lacunarity, gain, &xs](uint32_t begin, uint32_t end)
+				{
+					std::vector<T> ys(width);
+					for (uint32_t y = begin; y < end; ++ y)
+					{
+						std::fill(ys.begin(), ys.end(), (y + T(0.5)) / height * h);
+						this->batch<Tileable, Turbulence>(std::span<T const>(xs.data(), width), std::span<T const>(ys.data(), width),
+							w, h, std::span<T>(image.data() + static_cast<size_t>(y) * width, width), octaves, lacunarity, gain);
+					}
+				});
+		}
+
 
 		template class SimplexNoise<float>;
 	}
@@ -41,76 +41,6 @@ namespace KlayGE
 	{
 		// General Vector
 		///////////////////////////////////////////////////////////////////////////////
-		SIMDVectorF4 Add(SIMDVectorF4 const & lhs, SIMDVectorF4 const & rhs)
-		{
-			SIMDVectorF4 ret;
-#if defined(SIMD_MATH_SSE)
-			ret.Vec() = _mm_add_ps(lhs.Vec(), rhs.Vec());
-#else
-			for (int i = 0; i < 4; ++ i)
-			{
-				ret.Vec()[i] = lhs.Vec()[i] + rhs.Vec()[i];
-			}
-#endif
-			return ret;
-		}
-
-		SIMDVectorF4 Substract(SIMDVectorF4 const & lhs, SIMDVectorF4 const & rhs)
-		{
-			SIMDVectorF4 ret;
-#if defined(SIMD_MATH_SSE)
-			ret.Vec() = _mm_sub_ps(lhs.Vec(), rhs.Vec());
-#else
-			for (int i = 0; i < 4; ++ i)
-			{
-				ret.Vec()[i] = lhs.Vec()[i] - rhs.Vec()[i];
-			}
-#endif
-			return ret;
-		}
-
-		SIMDVectorF4 Multiply(SIMDVectorF4 const & lhs, SIMDVectorF4 const & rhs)
-		{
-			SIMDVectorF4 ret;
-#if defined(SIMD_MATH_SSE)
-			ret.Vec() = _mm_mul_ps(lhs.Vec(), rhs.Vec());
-#else
-			for (int i = 0; i < 4; ++ i)
-			{
-				ret.Vec()[i] = lhs.Vec()[i] * rhs.Vec()[i];
-			}
-#endif
-			return ret;
-		}
-
-		SIMDVectorF4 Divide(SIMDVectorF4 const & lhs, SIMDVectorF4 const & rhs)
-		{
-			SIMDVectorF4 ret;
-#if defined(SIMD_MATH_SSE)
-			ret.Vec() = _mm_div_ps(lhs.Vec(), rhs.Vec());
-#else
-			for (int i = 0; i < 4; ++ i)
-			{
-				ret.Vec()[i] = lhs.Vec()[i] / rhs.Vec()[i];
-			}
-#endif
-			return ret;
-		}
-
-		SIMDVectorF4 Negative(SIMDVectorF4 const & rhs)
-		{
-			SIMDVectorF4 ret;
-#if defined(SIMD_MATH_SSE)
-			ret.Vec() = _mm_sub_ps(_mm_setzero_ps(), rhs.Vec());
-#else
-			for (int i = 0; i < 4; ++ i)
-			{
-				ret.Vec()[i] = -rhs.Vec()[i];
-			}
-#endif
-			return ret;
-		}
-
 		SIMDVectorF4 BaryCentric(SIMDVectorF4 const & v1, SIMDVectorF4 const & v2, SIMDVectorF4 const & v3,
 			float f, float g)
 		{
@@ -165,22 +95,6 @@ namespace KlayGE
 			return lhs + (rhs - lhs) * s;
 		}
 
-		SIMDVectorF4 Abs(SIMDVectorF4 const & x)
-		{
-			SIMDVectorF4 ret;
-#if defined(SIMD_MATH_SSE)
-			__m128 res = x.Vec();
-			__m128 data_temp = _mm_sub_ps(_mm_setzero_ps(), res);
-			ret.Vec() = _mm_max_ps(data_temp, res);
-#else
-			for (int i = 0; i < 4; ++ i)
-			{
-				ret.Vec()[i] = MathLib::abs(x.Vec()[i]);
-			}
-#endif
-			return ret;
-		}
-
 		SIMDVectorF4 Sgn(SIMDVectorF4 const & x)
 		{
 			SIMDVectorF4 ret;
@@ -212,231 +126,6 @@ namespace KlayGE
 			return Sqr(x) * x;
 		}
 
-		SIMDVectorF4 LoadVector1(float v)
-		{
-			SIMDVectorF4 ret;
-#if defined(SIMD_MATH_SSE)
-			ret.Vec() = _mm_load_ss(&v);
-#else
-			ret.Vec()[0] = v;
-			for (int i = 1; i < 4; ++ i)
-			{
-				ret.Vec()[i] = 0;
-			}
-#endif
-			return ret;
-		}
-
-		SIMDVectorF4 LoadVector2(float2 const & v)
-		{
-			return LoadVector2(&v[0]);
-		}
-
-		SIMDVectorF4 LoadVector3(float3 const & v)
-		{
-			return LoadVector3(&v[0]);
-		}
-
-		SIMDVectorF4 LoadVector4(float4 const & v)
-		{
-			return LoadVector4(&v[0]);
-		}
-
-		SIMDVectorF4 LoadVector2(float const * v)
-		{
-			SIMDVectorF4 ret;
-#if defined(SIMD_MATH_SSE)
-			__m128 x = _mm_load_ss(&v[0]);
-			__m128 y = _mm_load_ss(&v[1]);
-			ret.Vec() = _mm_unpacklo_ps(x, y);
-#else
-			for (int i = 0; i < 2; ++ i)
-			{
-				ret.Vec()[i] = v[i];
-			}
-			for (int i = 2; i < 4; ++ i)
-			{
-				ret.Vec()[i] = 0;
-			}
-#endif
-			return ret;
-		}
-
-		SIMDVectorF4 LoadVector3(float const * v)
-		{
-			SIMDVectorF4 ret;
-#if defined(SIMD_MATH_SSE)
-			__m128 x = _mm_load_ss(&v[0]);
-			__m128 y = _mm_load_ss(&v[1]);
-			__m128 z = _mm_load_ss(&v[2]);
-			__m128 xy = _mm_unpacklo_ps(x, y);
-			ret.Vec() = _mm_movelh_ps(xy, z);
-#else
-			for (int i = 0; i < 3; ++ i)
-			{
-				ret.Vec()[i] = v[i];
-			}
-			for (int i = 3; i < 4; ++ i)
-			{
-				ret.Vec()[i] = 0;
-			}
-#endif
-			return ret;
-		}
-
-		SIMDVectorF4 LoadVector4(float const * v)
-		{
-			SIMDVectorF4 ret;
-#if defined(SIMD_MATH_SSE)
-			ret.Vec() = _mm_load_ps(&v[0]);
-#else
-			for (int i = 0; i < 4; ++i)
-			{
-				ret.Vec()[i] = v[i];
-			}
-#endif
-			return ret;
-		}
-
-		void StoreVector1(float& fs, SIMDVectorF4 const & v)
-		{
-#if defined(SIMD_MATH_SSE)
-			_mm_store_ss(&fs, v.Vec());
-#else
-			fs = v.Vec()[0];
-#endif
-		}
-
-		void StoreVector2(float2& fs, SIMDVectorF4 const & v)
-		{
-#if defined(SIMD_MATH_SSE)
-			__m128 x = v.Vec();
-			__m128 y = _mm_shuffle_ps(x, x, _MM_SHUFFLE(1, 1, 1, 1));
-			_mm_store_ss(&fs[0], x);
-			_mm_store_ss(&fs[1], y);
-#else
-			for (int i = 0; i < 2; ++ i)
-			{
-				fs[i] = v.Vec()[i];
-			}
-#endif
-		}
-
-		void StoreVector3(float3& fs, SIMDVectorF4 const & v)
-		{
-#if defined(SIMD_MATH_SSE)
-			__m128 x = v.Vec();
-			__m128 y = _mm_shuffle_ps(x, x, _MM_SHUFFLE(1, 1, 1, 1));
-			__m128 z = _mm_shuffle_ps(x, x, _MM_SHUFFLE(2, 2, 2, 2));
-			_mm_store_ss(&fs[0], x);
-			_mm_store_ss(&fs[1], y);
-			_mm_store_ss(&fs[2], z);
-#else
-			for (int i = 0; i < 3; ++ i)
-			{
-				fs[i] = v.Vec()[i];
-			}
-#endif
-		}
-
-		void StoreVector4(float4& fs, SIMDVectorF4 const & v)
-		{
-#if defined(SIMD_MATH_SSE)
-			_mm_store_ps(&fs[0], v.Vec());
-#else
-			for (int i = 0; i < 4; ++ i)
-			{
-				fs[i] = v.Vec()[i];
-			}
-#endif
-		}
-
-		SIMDVectorF4 SetVector(float x, float y, float z, float w)
-		{
-			SIMDVectorF4 ret;
-#if defined(SIMD_MATH_SSE)
-			ret.Vec() = _mm_set_ps(w, z, y, x);
-#else
-			ret.Vec()[0] = x;
-			ret.Vec()[1] = y;
-			ret.Vec()[2] = z;
-			ret.Vec()[3] = w;
-#endif
-			return ret;
-		}
-
-		SIMDVectorF4 SetVector(float v)
-		{
-			SIMDVectorF4 ret;
-#if defined(SIMD_MATH_SSE)
-			ret.Vec() = _mm_set_ps1(v);
-#else
-			ret.Vec()[0] = v;
-			ret.Vec()[1] = v;
-			ret.Vec()[2] = v;
-			ret.Vec()[3] = v;
-#endif
-			return ret;
-		}
-
-		float GetX(SIMDVectorF4 const & rhs)
-		{
-#if defined(SIMD_MATH_SSE)
-			return _mm_cvtss_f32(rhs.Vec());
-#else
-			return GetByIndex(rhs, 0);
-#endif
-		}
-
-		float GetY(SIMDVectorF4 const & rhs)
-		{
-#if defined(SIMD_MATH_SSE)
-			__m128 tmp = _mm_shuffle_ps(rhs.Vec(), rhs.Vec(), _MM_SHUFFLE(1, 1, 1, 1));
-			return _mm_cvtss_f32(tmp);
-#else
-			return GetByIndex(rhs, 1);
-#endif
-		}
-
-		float GetZ(SIMDVectorF4 const & rhs)
-		{
-#if defined(SIMD_MATH_SSE)
-			__m128 tmp = _mm_shuffle_ps(rhs.Vec(), rhs.Vec(), _MM_SHUFFLE(2, 2, 2, 2));
-			return _mm_cvtss_f32(tmp);
-#else
-			return GetByIndex(rhs, 2);
-#endif
-		}
-
-		float GetW(SIMDVectorF4 const & rhs)
-		{
-#if defined(SIMD_MATH_SSE)
-			__m128 tmp = _mm_shuffle_ps(rhs.Vec(), rhs.Vec(), _MM_SHUFFLE(3, 3, 3, 3));
-			return _mm_cvtss_f32(tmp);
-#else
-			return GetByIndex(rhs, 3);
-#endif
-		}
-
-		float GetByIndex(SIMDVectorF4 const & rhs, size_t index)
-		{
-#if defined(SIMD_MATH_SSE)
-#ifdef KLAYGE_COMPILER_MSVC
-			return rhs.Vec().m128_f32[index];
-#else
-			union
-			{
-				__m128 v;
-				float comp[4];
-			} converter;
-			converter.v = rhs.Vec();
-			return converter.comp[index];
-#endif
-#else
-			return rhs.Vec()[index];
-#endif
-		}
-
 		SIMDVectorF4 SetX(SIMDVectorF4 const & rhs, float v)
 		{
 #if defined(SIMD_MATH_SSE)
@@ -487,56 +176,6 @@ namespace KlayGE
 #endif
 		}
 
-		SIMDVectorF4 SetByIndex(SIMDVectorF4 const & rhs, float v, size_t index)
-		{
-			SIMDVectorF4 ret = rhs;
-#if defined(SIMD_MATH_SSE)
-#ifdef KLAYGE_COMPILER_MSVC
-			ret.Vec().m128_f32[index] = v;
-#else
-			union
-			{
-				__m128 v;
-				float comp[4];
-			} converter;
-			converter.v = rhs.Vec();
-			converter.comp[index] = v;
-			ret.Vec() = converter.v;
-#endif
-#else
-			ret.Vec()[index] = v;
-#endif
-			return ret;
-		}
-
-		SIMDVectorF4 Maximize(SIMDVectorF4 const & lhs, SIMDVectorF4 const & rhs)
-		{
-			SIMDVectorF4 ret;
-#if defined(SIMD_MATH_SSE)
-			ret.Vec() = _mm_max_ps(lhs.Vec(), rhs.Vec());
-#else
-			for (int i = 0; i < 4; ++ i)
-			{
-				ret.Vec()[i] = std::max(lhs.Vec()[i], rhs.Vec()[i]);
-			}
-#endif
-			return ret;
-		}
-
-		SIMDVectorF4 Minimize(SIMDVectorF4 const & lhs, SIMDVectorF4 const & rhs)
-		{
-			SIMDVectorF4 ret;
-#if defined(SIMD_MATH_SSE)
-			ret.Vec() = _mm_min_ps(lhs.Vec(), rhs.Vec());
-#else
-			for (int i = 0; i < 4; ++ i)
-			{
-				ret.Vec()[i] = std::min(lhs.Vec()[i], rhs.Vec()[i]);
-			}
-#endif
-			return ret;
-		}
-
 		SIMDVectorF4 Reflect(SIMDVectorF4 const & incident, SIMDVectorF4 const & normal)
 		{
 			return incident - 2 * DotVector3(incident, normal) * normal;
@@ -708,25 +347,6 @@ namespace KlayGE
 			return ret;
 		}
 
-		SIMDVectorF4 DotVector3(SIMDVectorF4 const & lhs, SIMDVectorF4 const & rhs)
-		{
-			SIMDVectorF4 ret;
-#if defined(SIMD_MATH_SSE)
-			__m128 res1 = lhs.Vec();
-			__m128 res2 = rhs.Vec();
-			res1 = _mm_mul_ps(res1, res2);
-			__m128 y = _mm_shuffle_ps(res1, res1, _MM_SHUFFLE(1, 1, 1, 1));
-			__m128 z = _mm_shuffle_ps(res1, res1, _MM_SHUFFLE(2, 2, 2, 2));
-			res1 = _mm_add_ps(res1, y);
-			res1 = _mm_add_ps(res1, z);
-			ret.Vec() = _mm_shuffle_ps(res1, res1, _MM_SHUFFLE(0, 0, 0, 0));
-#else
-			ret = SetVector(GetX(lhs) * GetX(rhs) + GetY(lhs) * GetY(rhs)
-				+ GetZ(lhs) * GetZ(rhs));
-#endif
-			return ret;
-		}
-
 		SIMDVectorF4 LengthSqVector3(SIMDVectorF4 const & rhs)
 		{
 			return DotVector3(rhs, rhs);
@@ -756,70 +376,6 @@ namespace KlayGE
 			return ret;
 		}
 
-		SIMDVectorF4 TransformCoordVector3(SIMDVectorF4 const & v, SIMDMatrixF4 const & mat)
-		{
-			SIMDVectorF4 ret;
-#if defined(SIMD_MATH_SSE)
-			__m128 temp = v.Vec();
-			__m128 res1 = _mm_mul_ps(_mm_shuffle_ps(temp, temp, _MM_SHUFFLE(0, 0, 0, 0)), mat.Row(0).Vec());
-			__m128 res2 = _mm_mul_ps(_mm_shuffle_ps(temp, temp, _MM_SHUFFLE(1, 1, 1, 1)), mat.Row(1).Vec());
-			res1 = _mm_add_ps(res1, res2);
-			res2 = _mm_mul_ps(_mm_shuffle_ps(temp, temp, _MM_SHUFFLE(2, 2, 2, 2)), mat.Row(2).Vec());
-			res2 = _mm_add_ps(res2, mat.Row(3).Vec());
-			res1 = _mm_add_ps(res1, res2);
-			__m128 w = _mm_shuffle_ps(res1, res1, _MM_SHUFFLE(3, 3, 3, 3));
-			__m128 inv_w = _mm_rcp_ps(w);
-			ret.Vec() = _mm_mul_ps(res1, inv_w);
-#else
-			SIMDVectorF4 temp;
-			for (int i = 0; i < 4; ++ i)
-			{
-				temp.Vec()[i] = GetX(v) * mat(0, i) + GetY(v) * mat(1, i)
-					+ GetZ(v) * mat(2, i) + mat(3, i);
-			}
-			if (MathLib::equal(GetW(temp), 0.0f))
-			{
-				ret = SIMDVectorF4::Zero();
-			}
-			else
-			{
-				for (int i = 0; i < 3; ++ i)
-				{
-					ret.Vec()[i] = temp.Vec()[i] / GetW(temp);
-				}
-				for (int i = 3; i < 4; ++ i)
-				{
-					ret.Vec()[i] = 0;
-				}
-			}
-#endif
-			return ret;
-		}
-
-		SIMDVectorF4 TransformNormalVector3(SIMDVectorF4 const & v, SIMDMatrixF4 const & mat)
-		{
-			SIMDVectorF4 ret;
-#if defined(SIMD_MATH_SSE)
-			__m128 temp = v.Vec();
-			__m128 res1 = _mm_mul_ps(_mm_shuffle_ps(temp, temp, _MM_SHUFFLE(0, 0, 0, 0)), mat.Row(0).Vec());
-			__m128 res2 = _mm_mul_ps(_mm_shuffle_ps(temp, temp, _MM_SHUFFLE(1, 1, 1, 1)), mat.Row(1).Vec());
-			res1 = _mm_add_ps(res1, res2);
-			res2 = _mm_mul_ps(_mm_shuffle_ps(temp, temp, _MM_SHUFFLE(2, 2, 2, 2)), mat.Row(2).Vec());
-			ret.Vec() = _mm_add_ps(res1, res2);
-#else
-			for (int i = 0; i < 3; ++ i)
-			{
-				ret.Vec()[i] = GetX(v) * mat(0, i) + GetY(v) * mat(1, i)
-					+ GetZ(v) * mat(2, i);
-			}
-			for (int i = 3; i < 4; ++ i)
-			{
-				ret.Vec()[i] = 0;
-			}
-#endif
-			return ret;
-		}
-
 		SIMDVectorF4 TransformQuat(SIMDVectorF4 const & v, SIMDVectorF4 const & quat)
 		{
 			SIMDVectorF4 ret;
@@ -914,25 +470,6 @@ namespace KlayGE
 			return ret;
 		}
 
-		SIMDVectorF4 DotVector4(SIMDVectorF4 const & lhs, SIMDVectorF4 const & rhs)
-		{
-			SIMDVectorF4 ret;
-#if defined(SIMD_MATH_SSE)
-			__m128 res1 = lhs.Vec();
-			__m128 res2 = rhs.Vec();
-			res1 = _mm_mul_ps(res1, res2);
-			__m128 yw = _mm_shuffle_ps(res1, res1, _MM_SHUFFLE(1, 1, 3, 3));
-			res1 = _mm_add_ps(res1, yw);
-			__m128 zw = _mm_shuffle_ps(res1, res1, _MM_SHUFFLE(2, 2, 2, 2));
-			res1 = _mm_add_ps(res1, zw);
-			ret.Vec() = _mm_shuffle_ps(res1, res1, _MM_SHUFFLE(0, 0, 0, 0));
-#else
-			ret = SetVector(GetX(lhs) * GetX(rhs) + GetY(lhs) * GetY(rhs)
-				+ GetZ(lhs) * GetZ(rhs) + GetW(lhs) * GetW(rhs));
-#endif
-			return ret;
-		}
-
 		SIMDVectorF4 LengthSqVector4(SIMDVectorF4 const & rhs)
 		{
 			return DotVector4(rhs, rhs);
@@ -962,132 +499,8 @@ namespace KlayGE
 			return ret;
 		}
 
-		SIMDVectorF4 TransformVector4(SIMDVectorF4 const & v, SIMDMatrixF4 const & mat)
-		{
-			SIMDVectorF4 ret;
-#if defined(SIMD_MATH_SSE)
-			__m128 temp = v.Vec();
-			__m128 res1 = _mm_mul_ps(_mm_shuffle_ps(temp, temp, _MM_SHUFFLE(0, 0, 0, 0)), mat.Row(0).Vec());
-			__m128 res2 = _mm_mul_ps(_mm_shuffle_ps(temp, temp, _MM_SHUFFLE(1, 1, 1, 1)), mat.Row(1).Vec());
-			res1 = _mm_add_ps(res1, res2);
-			res2 = _mm_mul_ps(_mm_shuffle_ps(temp, temp, _MM_SHUFFLE(2, 2, 2, 2)), mat.Row(2).Vec());
-			res1 = _mm_add_ps(res1, res2);
-			res2 = _mm_mul_ps(_mm_shuffle_ps(temp, temp, _MM_SHUFFLE(3, 3, 3, 3)), mat.Row(3).Vec());
-			ret.Vec() = _mm_add_ps(res1, res2);
-#else
-			for (int i = 0; i < 4; ++ i)
-			{
-				ret.Vec()[i] = GetX(v) * mat(0, i) + GetY(v) * mat(1, i)
-					+ GetZ(v) * mat(2, i) + GetW(v) * mat(3, i);
-			}
-#endif
-			return ret;
-		}
-
 		// 4D Matrix
 		///////////////////////////////////////////////////////////////////////////////
-		SIMDMatrixF4 Add(SIMDMatrixF4 const & lhs, SIMDMatrixF4 const & rhs)
-		{
-			return SIMDMatrixF4(Add(lhs.Row(0), rhs.Row(0)),
-				Add(lhs.Row(1), rhs.Row(1)),
-				Add(lhs.Row(2), rhs.Row(2)),
-				Add(lhs.Row(3), rhs.Row(3)));
-		}
-
-		SIMDMatrixF4 Substract(SIMDMatrixF4 const & lhs, SIMDMatrixF4 const & rhs)
-		{
-			return SIMDMatrixF4(Substract(lhs.Row(0), rhs.Row(0)),
-				Substract(lhs.Row(1), rhs.Row(1)),
-				Substract(lhs.Row(2), rhs.Row(2)),
-				Substract(lhs.Row(3), rhs.Row(3)));
-		}
-#if defined(SIMD_MATH_SSE)
-		#define GetVector(v, i) _mm_shuffle_ps(v, v, _MM_SHUFFLE(i, i, i, i))
-#endif
-
-		SIMDMatrixF4 Multiply(SIMDMatrixF4 const & lhs, SIMDMatrixF4 const & rhs)
-		{
-#if defined(SIMD_MATH_SSE)
-			V4TYPE const & l0 = lhs.Row(0).Vec();
-			V4TYPE const & l1 = lhs.Row(1).Vec();
-			V4TYPE const & l2 = lhs.Row(2).Vec();
-			V4TYPE const & l3 = lhs.Row(3).Vec();
-
-			V4TYPE const & t0 = rhs.Row(0).Vec();
-			V4TYPE const & t1 = rhs.Row(1).Vec();
-			V4TYPE const & t2 = rhs.Row(2).Vec();
-			V4TYPE const & t3 = rhs.Row(3).Vec();
-
-			SIMDVectorF4 row1;			
-			SIMDVectorF4 row2;			
-			SIMDVectorF4 row3;	
-			SIMDVectorF4 row4;
-			row1.Vec() = _mm_mul_ps(t0, GetVector(l0, 0));
-			row2.Vec() = _mm_mul_ps(t0, GetVector(l1, 0));
-			row3.Vec() = _mm_mul_ps(t0, GetVector(l2, 0));
-			row4.Vec() = _mm_mul_ps(t0, GetVector(l3, 0));
-
-			row1.Vec() = _mm_add_ps(row1.Vec(), _mm_mul_ps(t1, GetVector(l0, 1)));
-			row2.Vec() = _mm_add_ps(row2.Vec(), _mm_mul_ps(t1, GetVector(l1, 1)));
-			row3.Vec() = _mm_add_ps(row3.Vec(), _mm_mul_ps(t1, GetVector(l2, 1)));
-			row4.Vec() = _mm_add_ps(row4.Vec(), _mm_mul_ps(t1, GetVector(l3, 1)));
-
-			row1.Vec() = _mm_add_ps(row1.Vec(), _mm_mul_ps(t2, GetVector(l0, 2)));
-			row2.Vec() = _mm_add_ps(row2.Vec(), _mm_mul_ps(t2, GetVector(l1, 2)));
-			row3.Vec() = _mm_add_ps(row3.Vec(), _mm_mul_ps(t2, GetVector(l2, 2)));
-			row4.Vec() = _mm_add_ps(row4.Vec(), _mm_mul_ps(t2, GetVector(l3, 2)));
-
-			row1.Vec() = _mm_add_ps(row1.Vec(), _mm_mul_ps(t3, GetVector(l0, 3)));
-			row2.Vec() = _mm_add_ps(row2.Vec(), _mm_mul_ps(t3, GetVector(l1, 3)));
-			row3.Vec() = _mm_add_ps(row3.Vec(), _mm_mul_ps(t3, GetVector(l2, 3)));
-			row4.Vec() = _mm_add_ps(row4.Vec(), _mm_mul_ps(t3, GetVector(l3, 3)));
-
-			return SIMDMatrixF4(row1, row2,row3,row4);
-#else
-			SIMDMatrixF4 const tmp = Transpose(rhs);
-
-			V4TYPE const & l0 = lhs.Row(0).Vec();
-			V4TYPE const & l1 = lhs.Row(1).Vec();
-			V4TYPE const & l2 = lhs.Row(2).Vec();
-			V4TYPE const & l3 = lhs.Row(3).Vec();
-
-			V4TYPE const & t0 = tmp.Row(0).Vec();
-			V4TYPE const & t1 = tmp.Row(1).Vec();
-			V4TYPE const & t2 = tmp.Row(2).Vec();
-			V4TYPE const & t3 = tmp.Row(3).Vec();
-
-			return SIMDMatrixF4(
-				l0[0] * t0[0] + l0[1] * t0[1] + l0[2] * t0[2] + l0[3] * t0[3],
-				l0[0] * t1[0] + l0[1] * t1[1] + l0[2] * t1[2] + l0[3] * t1[3],
-				l0[0] * t2[0] + l0[1] * t2[1] + l0[2] * t2[2] + l0[3] * t2[3],
-				l0[0] * t3[0] + l0[1] * t3[1] + l0[2] * t3[2] + l0[3] * t3[3],
-
-				l1[0] * t0[0] + l1[1] * t0[1] + l1[2] * t0[2] + l1[3] * t0[3],
-				l1[0] * t1[0] + l1[1] * t1[1] + l1[2] * t1[2] + l1[3] * t1[3],
-				l1[0] * t2[0] + l1[1] * t2[1] + l1[2] * t2[2] + l1[3] * t2[3],
-				l1[0] * t3[0] + l1[1] * t3[1] + l1[2] * t3[2] + l1[3] * t3[3],
-
-				l2[0] * t0[0] + l2[1] * t0[1] + l2[2] * t0[2] + l2[3] * t0[3],
-				l2[0] * t1[0] + l2[1] * t1[1] + l2[2] * t1[2] + l2[3] * t1[3],
-				l2[0] * t2[0] + l2[1] * t2[1] + l2[2] * t2[2] + l2[3] * t2[3],
-				l2[0] * t3[0] + l2[1] * t3[1] + l2[2] * t3[2] + l2[3] * t3[3],
-
-				l3[0] * t0[0] + l3[1] * t0[1] + l3[2] * t0[2] + l3[3] * t0[3],
-				l3[0] * t1[0] + l3[1] * t1[1] + l3[2] * t1[2] + l3[3] * t1[3],
-				l3[0] * t2[0] + l3[1] * t2[1] + l3[2] * t2[2] + l3[3] * t2[3],
-				l3[0] * t3[0] + l3[1] * t3[1] + l3[2] * t3[2] + l3[3] * t3[3]);
-#endif
-		}
-
-		SIMDMatrixF4 Multiply(SIMDMatrixF4 const & lhs, float rhs)
-		{
-			SIMDVectorF4 r = SetVector(rhs, rhs, rhs, rhs);
-			return SIMDMatrixF4(Multiply(lhs.Row(0), r),
-				Multiply(lhs.Row(1), r),
-				Multiply(lhs.Row(2), r),
-				Multiply(lhs.Row(3), r));
-		}
-
 		SIMDVectorF4 Determinant(SIMDMatrixF4 const & rhs)
 		{
 			SIMDVectorF4 ret;
@@ -1163,14 +576,6 @@ namespace KlayGE
 			return ret;
 		}
 
-		SIMDMatrixF4 Negative(SIMDMatrixF4 const & rhs)
-		{
-			return SIMDMatrixF4(Negative(rhs.Row(0)),
-				Negative(rhs.Row(1)),
-				Negative(rhs.Row(2)),
-				Negative(rhs.Row(3)));
-		}
-
 		SIMDMatrixF4 Inverse(SIMDMatrixF4 const & rhs)
 		{
 			SIMDMatrixF4 ret;
@@ -1602,32 +1007,6 @@ namespace KlayGE
 			return Translation(GetX(pos), GetY(pos), GetZ(pos));
 		}
 
-		SIMDMatrixF4 Transpose(SIMDMatrixF4 const & rhs)
-		{
-#if defined(SIMD_MATH_SSE)
-			SIMDVectorF4 r0;
-			SIMDVectorF4 r1;
-			SIMDVectorF4 r2;
-			SIMDVectorF4 r3;
-			r0.Vec() = rhs.Row(0).Vec();
-			r1.Vec() = rhs.Row(1).Vec();
-			r2.Vec() = rhs.Row(2).Vec();
-			r3.Vec() = rhs.Row(3).Vec();
-			_MM_TRANSPOSE4_PS(r0.Vec(), r1.Vec(), r2.Vec(), r3.Vec());
-			return SIMDMatrixF4(r0, r1, r2, r3);
-#else
-			V4TYPE const & r0 = rhs.Row(0).Vec();
-			V4TYPE const & r1 = rhs.Row(1).Vec();
-			V4TYPE const & r2 = rhs.Row(2).Vec();
-			V4TYPE const & r3 = rhs.Row(3).Vec();
-			return SIMDMatrixF4(
-				r0[0], r1[0], r2[0], r3[0],
-				r0[1], r1[1], r2[1], r3[1],
-				r0[2], r1[2], r2[2], r3[2],
-				r0[3], r1[3], r2[3], r3[3]);
-#endif
-		}
-
 		SIMDMatrixF4 LHToRH(SIMDMatrixF4 const & rhs)
 		{
 			SIMDMatrixF4 ret = rhs;
@@ -1806,15 +1185,6 @@ namespace KlayGE
 			return SetVector(-GetX(rhs), -GetY(rhs), -GetZ(rhs), GetW(rhs)) * inv;
 		}
 
-		SIMDVectorF4 MultiplyQuat(SIMDVectorF4 const & lhs, SIMDVectorF4 const & rhs)
-		{
-			return SetVector(
-				GetX(lhs) * GetW(rhs) - GetY(lhs) * GetZ(rhs) + GetZ(lhs) * GetY(rhs) + GetW(lhs) * GetX(rhs),
-				GetX(lhs) * GetZ(rhs) + GetY(lhs) * GetW(rhs) - GetZ(lhs) * GetX(rhs) + GetW(lhs) * GetY(rhs),
-				GetY(lhs) * GetX(rhs) - GetX(lhs) * GetY(rhs) + GetZ(lhs) * GetW(rhs) + GetW(lhs) * GetZ(rhs),
-				GetW(lhs) * GetW(rhs) - GetX(lhs) * GetX(rhs) - GetY(lhs) * GetY(rhs) - GetZ(lhs) * GetZ(rhs));
-		}
-
 		SIMDVectorF4 RotationAxis(SIMDVectorF4 const & v, float angle)
 		{
 			float sa, ca;
@@ -169,6 +169,10 @@ namespace KlayGE
 		{
 			return *gtp_instance_;
 		}
+		task_scheduler& TaskScheduler()
+		{
+			return *gts_instance_;
+		}
 
 	private:
 		void DestroyAll();
@@ -211,6 +215,7 @@ namespace KlayGE
 #endif
 
 		std::unique_ptr<thread_pool> gtp_instance_;
+		std::unique_ptr<task_scheduler> gts_instance_;
 	};
 }
 
@@ -40,6 +40,7 @@
 
 #include <KFL/Rect.hpp>
 #include <KlayGE/Renderable.hpp>
+#include <KlayGE/ResLoader.hpp>
 
 #include <list>
 #include <vector>
@@ -90,7 +91,8 @@ namespace KlayGE
 	};
 
 	KLAYGE_CORE_API FontPtr SyncLoadFont(std::string_view font_name, uint32_t flags = 0);
-	KLAYGE_CORE_API FontPtr ASyncLoadFont(std::string_view font_name, uint32_t flags = 0);
+	KLAYGE_CORE_API FontPtr ASyncLoadFont(std::string_view font_name, uint32_t flags = 0,
+		ResLoadingPriority priority = ResLoadingPriority::Prefetch);
 }
 
 #endif		// _FONT_HPP
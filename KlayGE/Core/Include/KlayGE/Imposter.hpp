@@ -34,6 +34,7 @@
 #pragma once
 
 #include <KlayGE/PreDeclare.hpp>
+#include <KlayGE/ResLoader.hpp>
 
 namespace KlayGE
 {
@@ -84,7 +85,8 @@ namespace KlayGE
 	};
 
 	KLAYGE_CORE_API ImposterPtr SyncLoadImposter(std::string_view impml_name);
-	KLAYGE_CORE_API ImposterPtr ASyncLoadImposter(std::string_view impml_name);
+	KLAYGE_CORE_API ImposterPtr ASyncLoadImposter(std::string_view impml_name,
+		ResLoadingPriority priority = ResLoadingPriority::Prefetch);
 }
 
 #endif		// _IMPOSTER_HPP
@@ -31,6 +31,7 @@
 #include <KFL/CXX17/string_view.hpp>
 #include <KlayGE/Renderable.hpp>
 #include <KlayGE/RenderLayout.hpp>
+#include <KlayGE/ResLoader.hpp>
 #include <KFL/Math.hpp>
 #include <KlayGE/SceneNode.hpp>
 #include <KlayGE/SceneComponent.hpp>
@@ -430,7 +431,8 @@ namespace KlayGE
 		uint32_t node_attrib,
 		std::function<void(RenderModel&)> OnFinishLoading = nullptr,
 		std::function<RenderModelPtr(std::wstring_view, uint32_t)> CreateModelFactoryFunc = CreateModelFactory<RenderModel>,
-		std::function<StaticMeshPtr(std::wstring_view)> CreateMeshFactoryFunc = CreateMeshFactory<StaticMesh>);
+		std::function<StaticMeshPtr(std::wstring_view)> CreateMeshFactoryFunc = CreateMeshFactory<StaticMesh>,
+		ResLoadingPriority priority = ResLoadingPriority::Prefetch);
 	KLAYGE_CORE_API RenderModelPtr LoadSoftwareModel(std::string_view model_name);
 
 	KLAYGE_CORE_API void SaveModel(RenderModel const & model, std::string_view model_name);
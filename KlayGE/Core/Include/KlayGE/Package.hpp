@@ -36,6 +36,9 @@
 #include <KlayGE/PreDeclare.hpp>
 #include <KFL/CXX17/string_view.hpp>
 
+#include <string>
+#include <unordered_map>
+
 struct IInArchive;
 
 namespace KlayGE
@@ -64,6 +67,8 @@ namespace KlayGE
 		std::string password_;
 
 		uint32_t num_items_;
+		// Lower case paths of the files in the archive, to the index of their first item
+		std::unordered_map<std::string, uint32_t> file_indices_;
 	};
 }
 
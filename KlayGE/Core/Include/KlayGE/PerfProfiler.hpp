@@ -66,6 +66,23 @@ namespace KlayGE
 		bool dirty_;
 	};
 
+	// A value sampled once a frame, such as the length of a queue
+	class KLAYGE_CORE_API PerfCounter final : boost::noncopyable
+	{
+	public:
+		PerfCounter();
+
+		void Value(double value);
+		double Value() const;
+
+		void CollectData();
+		bool Dirty() const;
+
+	private:
+		double value_;
+		bool dirty_;
+	};
+
 	class KLAYGE_CORE_API PerfProfiler final : boost::noncopyable
 	{
 	public:
@@ -78,6 +95,7 @@ namespace KlayGE
 		void Resume();
 
 		PerfRangePtr CreatePerfRange(int category, std::string const & name);
+		PerfCounterPtr CreatePerfCounter(int category, std::string const & name);
 		void CollectData();
 
 		void ExportToCSV(std::string const & file_name) const;
@@ -87,6 +105,8 @@ namespace KlayGE
 
 		std::vector<std::tuple<int, std::string, PerfRangePtr,
 			std::vector<std::tuple<uint32_t, double, double>>>> perf_ranges_;
+		std::vector<std::tuple<int, std::string, PerfCounterPtr,
+			std::vector<std::tuple<uint32_t, double>>>> perf_counters_;
 		uint32_t frame_id_;
 	};
 }
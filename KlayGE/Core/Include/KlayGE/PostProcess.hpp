@@ -34,6 +34,7 @@
 #include <KlayGE/FrameBuffer.hpp>
 #include <KlayGE/RenderableHelper.hpp>
 #include <KlayGE/RenderView.hpp>
+#include <KlayGE/ResLoader.hpp>
 
 namespace KlayGE
 {
@@ -193,7 +194,8 @@ namespace KlayGE
 	};
 
 	KLAYGE_CORE_API PostProcessPtr SyncLoadPostProcess(std::string_view ppml_name, std::string_view pp_name);
-	KLAYGE_CORE_API PostProcessPtr ASyncLoadPostProcess(std::string_view ppml_name, std::string_view pp_name);
+	KLAYGE_CORE_API PostProcessPtr ASyncLoadPostProcess(std::string_view ppml_name, std::string_view pp_name,
+		ResLoadingPriority priority = ResLoadingPriority::Prefetch);
 
 
 	class KLAYGE_CORE_API PostProcessChain : public PostProcess
@@ -42,6 +42,8 @@ namespace KlayGE
 	class ResLoader;
 	class PerfRange;
 	typedef std::shared_ptr<PerfRange> PerfRangePtr;
+	class PerfCounter;
+	typedef std::shared_ptr<PerfCounter> PerfCounterPtr;
 	class PerfProfiler;
 	typedef std::shared_ptr<PerfProfiler> PerfProfilerPtr;
 
@@ -50,6 +52,7 @@ namespace KlayGE
 	using SceneComponentPtr = std::shared_ptr<SceneComponent>;
 	class SceneNode;
 	using SceneNodePtr = std::shared_ptr<SceneNode>;
+	class SoftwareOcclusionCuller;
 	class SceneObjectLightSourceProxy;
 	using SceneObjectLightSourceProxyPtr = std::shared_ptr<SceneObjectLightSourceProxy>;
 	class SceneObjectCameraProxy;
@@ -61,6 +61,7 @@
 #include <algorithm>
 
 #include <KlayGE/RenderEngine.hpp>
+#include <KlayGE/ResLoader.hpp>
 #include <KlayGE/Texture.hpp>
 #include <KlayGE/ShaderObject.hpp>
 #include <KFL/Math.hpp>
@@ -272,7 +273,7 @@ namespace KlayGE
 	{
 	public:
 #if KLAYGE_IS_DEV_PLATFORM
-		void Load(RenderEffect const& effect, XMLNode const& node);
+		void Load(RenderEffect const& effect, XMLNodeHandle node);
 #endif
 
 		void StreamIn(RenderEffect const& effect, ResIdentifier& res);
@@ -306,7 +307,7 @@ namespace KlayGE
 	{
 	public:
 #if KLAYGE_IS_DEV_PLATFORM
-		void Load(XMLNode const& node);
+		void Load(XMLNodeHandle node);
 #endif
 
 		void StreamIn(ResIdentifier& res);
@@ -339,7 +340,7 @@ namespace KlayGE
 	{
 	public:
 #if KLAYGE_IS_DEV_PLATFORM
-		void Load(XMLNode const& node);
+		void Load(XMLNodeHandle node);
 #endif
 
 		void StreamIn(ResIdentifier& res);
@@ -399,7 +400,7 @@ namespace KlayGE
 	{
 	public:
 #if KLAYGE_IS_DEV_PLATFORM
-		void Load(RenderEffect const& effect, XMLNode const& node);
+		void Load(RenderEffect const& effect, XMLNodeHandle node);
 #endif
 
 		void StreamIn(ResIdentifier& res);
@@ -618,7 +619,7 @@ namespace KlayGE
 		XMLNodePtr ResolveInheritTechNode(XMLDocument& doc, XMLNode& root, XMLNodePtr const & tech_node);
 		void ResolveOverrideTechs(XMLDocument& doc, XMLNode& root);
 
-		void Load(XMLNode const & root, RenderEffect& effect);
+		void Load(XMLNodeHandle root, RenderEffect& effect);
 #endif
 
 	private:
@@ -650,7 +651,7 @@ namespace KlayGE
 	{
 	public:
 #if KLAYGE_IS_DEV_PLATFORM
-		void Load(RenderEffect& effect, XMLNode const& node, uint32_t tech_index);
+		void Load(RenderEffect& effect, XMLNodeHandle node, uint32_t tech_index);
 		void CompileShaders(RenderEffect& effect, uint32_t tech_index);
 #endif
 		void CreateHwShaders(RenderEffect& effect, uint32_t tech_index);
@@ -745,7 +746,7 @@ namespace KlayGE
 	{
 	public:
 #if KLAYGE_IS_DEV_PLATFORM
-		void Load(RenderEffect& effect, XMLNode const& node, uint32_t tech_index, uint32_t pass_index, RenderPass const* inherit_pass);
+		void Load(RenderEffect& effect, XMLNodeHandle node, uint32_t tech_index, uint32_t pass_index, RenderPass const* inherit_pass);
 		void Load(RenderEffect& effect, uint32_t tech_index, uint32_t pass_index, RenderPass const* inherit_pass);
 		void CompileShaders(RenderEffect& effect, uint32_t tech_index, uint32_t pass_index);
 #endif
@@ -921,7 +922,7 @@ namespace KlayGE
 	{
 	public:
 #if KLAYGE_IS_DEV_PLATFORM
-		void Load(RenderEffect const& effect, XMLNode const& node);
+		void Load(RenderEffect const& effect, XMLNodeHandle node);
 #endif
 
 		void StreamIn(RenderEffect const& effect, ResIdentifier& res);
@@ -1037,8 +1038,10 @@ namespace KlayGE
 
 	KLAYGE_CORE_API RenderEffectPtr SyncLoadRenderEffect(std::string_view effect_names);
 	KLAYGE_CORE_API RenderEffectPtr SyncLoadRenderEffects(std::span<std::string const> effect_names);
-	KLAYGE_CORE_API RenderEffectPtr ASyncLoadRenderEffect(std::string_view effect_name);
-	KLAYGE_CORE_API RenderEffectPtr ASyncLoadRenderEffects(std::span<std::string const> effect_names);
+	KLAYGE_CORE_API RenderEffectPtr ASyncLoadRenderEffect(std::string_view effect_name,
+		ResLoadingPriority priority = ResLoadingPriority::Prefetch);
+	KLAYGE_CORE_API RenderEffectPtr ASyncLoadRenderEffects(std::span<std::string const> effect_names,
+		ResLoadingPriority priority = ResLoadingPriority::Prefetch);
 }
 
 #endif		// _RENDEREFFECT_HPP
@@ -204,6 +204,15 @@ namespace KlayGE
 			return instances_[index];
 		}
 
+		// Draws all instances with one instanced draw, instead of one draw per scene node. The world matrices of this and the
+		// previous frame are packed into an instance stream, as the first 3 rows of the transposed matrices in TEXCOORD1-3 and
+		// TEXCOORD4-6. The techniques of the renderable must read them from there.
+		void AutoInstancing(bool auto_inst);
+		bool AutoInstancing() const
+		{
+			return auto_instancing_;
+		}
+
 		virtual void ModelMatrix(float4x4 const & mat);
 		virtual void InverseModelMatrix(float4x4 const& mat);
 		virtual void PrevModelMatrix(float4x4 const& mat);
@@ -212,6 +221,9 @@ namespace KlayGE
 		{
 			return curr_node_;
 		}
+		// Whether the draws go to the camera_index-th camera of the viewport. With auto instancing, all the instances share one
+		// draw, so it goes to every camera that sees any of them.
+		bool VisibleInCamera(uint32_t camera_index) const;
 
 		virtual bool HWResourceReady() const
 		{
@@ -278,6 +290,7 @@ namespace KlayGE
 
 	protected:
 		virtual void UpdateInstanceStream();
+		RenderLayout const & UpdateAutoInstanceLayout(uint32_t lod, uint32_t num_camera_instances);
 		virtual void UpdateBoundBox();
 
 		float CalcLod(float3 const & eye_pos, float fov_scale) const;
@@ -301,6 +314,11 @@ namespace KlayGE
 
 		std::vector<RenderLayoutPtr> rls_;
 
+		bool auto_instancing_ = false;
+		// Same geometry as the layout of each lod, plus the auto instance stream
+		std::vector<RenderLayoutPtr> auto_inst_rls_;
+		GraphicsBufferPtr auto_inst_stream_;
+
 		int32_t active_lod_ = 0;
 
 		// For select mode
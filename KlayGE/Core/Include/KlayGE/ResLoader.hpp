@@ -34,8 +34,13 @@
 #pragma once
 
 #include <KlayGE/PreDeclare.hpp>
+#include <array>
+#include <atomic>
+#include <deque>
 #include <istream>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include <KFL/ResIdentifier.hpp>
@@ -47,6 +52,17 @@ struct AAsset;
 
 namespace KlayGE
 {
+	// The order in which the loading threads pick up the queued resources
+	enum class ResLoadingPriority
+	{
+		VisibleNow,
+		Prefetch,
+		Background,
+
+		NumPriorities,
+	};
+	uint32_t constexpr NumResLoadingPriorities = static_cast<uint32_t>(ResLoadingPriority::NumPriorities);
+
 	class KLAYGE_CORE_API ResLoadingDesc : boost::noncopyable
 	{
 	public:
@@ -65,6 +81,8 @@ namespace KlayGE
 
 		virtual bool HasSubThreadStage() const = 0;
 
+		// Descs that match have the same hash. Match is only called on the ones with the same hash.
+		virtual size_t Hash() const = 0;
 		virtual bool Match(ResLoadingDesc const & rhs) const = 0;
 		virtual void CopyDataFrom(ResLoadingDesc const & rhs) = 0;
 		virtual std::shared_ptr<void> CloneResourceFrom(std::shared_ptr<void> const & resource) = 0;
@@ -100,10 +118,28 @@ namespace KlayGE
 		uint64_t Timestamp(std::string_view name);
 		std::string AbsPath(std::string_view path);
 
+		// Files are looked up in cached directory listings, falling back to the file system when they are missing from there.
+		// Writers in the engine report the files they create with NotifyFileWritten to skip that. Call InvalidateIndex when
+		// files are removed outside the engine, e.g. from a directory watcher.
+		void NotifyFileWritten(std::string_view path);
+		void InvalidateIndex();
+
 		std::shared_ptr<void> SyncQuery(ResLoadingDescPtr const & res_desc);
-		std::shared_ptr<void> ASyncQuery(ResLoadingDescPtr const & res_desc);
+		// The loading is cancelled if all the returned pointers of a resource are released before its sub thread stage starts
+		std::shared_ptr<void> ASyncQuery(ResLoadingDescPtr const & res_desc,
+			ResLoadingPriority priority = ResLoadingPriority::Prefetch);
 		void Unload(std::shared_ptr<void> const & res);
 
+		// Moves a resource returned by ASyncQuery to another priority, if it's still in the queue
+		void Reprioritize(std::shared_ptr<void> const & res, ResLoadingPriority priority);
+
+		// Call it from the main thread only. The queued resources are kept.
+		void NumLoadingThreads(uint32_t num);
+		uint32_t NumLoadingThreads() const
+		{
+			return static_cast<uint32_t>(loading_threads_.size());
+		}
+
 		template <typename T>
 		std::shared_ptr<T> SyncQueryT(ResLoadingDescPtr const & res_desc)
 		{
@@ -111,9 +147,10 @@ namespace KlayGE
 		}
 
 		template <typename T>
-		std::shared_ptr<T> ASyncQueryT(ResLoadingDescPtr const & res_desc)
+		std::shared_ptr<T> ASyncQueryT(ResLoadingDescPtr const & res_desc,
+			ResLoadingPriority priority = ResLoadingPriority::Prefetch)
 		{
-			return std::static_pointer_cast<T>(this->ASyncQuery(res_desc));
+			return std::static_pointer_cast<T>(this->ASyncQuery(res_desc, priority));
 		}
 
 		template <typename T>
@@ -122,8 +159,16 @@ namespace KlayGE
 			this->Unload(std::static_pointer_cast<void>(res));
 		}
 
+		// Runs the main thread stages of the loaded resources, by priority, until the budget of this frame runs out
 		void Update();
 
+		// In seconds. 0 means all the main thread stages run in the first Update after their sub thread stages.
+		void MainThreadStageBudget(double budget);
+		double MainThreadStageBudget() const
+		{
+			return main_thread_stage_budget_;
+		}
+
 		uint32_t NumLoadingResources() const
 		{
 			return static_cast<uint32_t>(loading_res_.size());
@@ -136,10 +181,14 @@ namespace KlayGE
 		void DecomposePackageName(std::string_view path,
 			std::string& package_path, std::string& password, std::string& path_in_package);
 
+		std::string LocateNoLock(std::string_view name, PackagePtr& package, std::string& path_in_package);
+		bool IndexedExists(std::string const & res_name);
+
 		void AddLoadedResource(ResLoadingDescPtr const & res_desc, std::shared_ptr<void> const & res);
 		std::shared_ptr<void> FindMatchLoadedResource(ResLoadingDescPtr const & res_desc);
-		void RemoveUnrefResources();
 
+		void StartLoadingThreads(uint32_t num);
+		void StopLoadingThreads();
 		void LoadingThreadFunc();
 
 #if defined(KLAYGE_PLATFORM_ANDROID)
@@ -156,27 +205,76 @@ namespace KlayGE
 		enum LoadingStatus
 		{
 			LS_Loading,
+			LS_SubThreadStage,
 			LS_Complete,
 			LS_CanBeRemoved
 		};
 
+		// Shared by all the descs that wait for the same loading
+		struct LoadingJob
+		{
+			LoadingJob(ResLoadingDescPtr const & res_desc, ResLoadingPriority init_priority)
+				: desc(res_desc), status(LS_Loading), priority(init_priority)
+			{
+			}
+
+			// The one that runs the sub thread stage
+			ResLoadingDescPtr desc;
+			std::atomic<LoadingStatus> status;
+			std::atomic<ResLoadingPriority> priority;
+			// The owners of the pointers returned by ASyncQuery. Guarded by loading_mutex_.
+			std::vector<std::weak_ptr<void>> tickets;
+		};
+		typedef std::pair<ResLoadingDescPtr, std::shared_ptr<LoadingJob>> LoadingRes;
+
+		std::shared_ptr<void> AddLoadingTicket(LoadingJob& job, std::shared_ptr<void> const & res);
+		bool IsAbandoned(LoadingJob const & job) const;
+		void RaisePriority(std::shared_ptr<LoadingJob> const & job, ResLoadingPriority priority);
+
 		std::string exe_path_;
 		std::string local_path_;
-		std::vector<std::tuple<uint64_t, uint32_t, std::string, PackagePtr>> paths_;
+		// Hash and length of the virtual path, the real path, the package and the path inside the package
+		std::vector<std::tuple<uint64_t, uint32_t, std::string, PackagePtr, std::string>> paths_;
 		std::mutex paths_mutex_;
+		// File names in the directories under the paths, listed the first time a file is looked up in them. Guarded by
+		// paths_mutex_.
+		std::unordered_map<std::string, std::unordered_set<std::string>> dir_listings_;
+
+		// Loaded resources by the hash of their descs. Each shard has a lock of its own, so queries of different resources
+		// seldom wait for each other.
+		struct LoadedResShard
+		{
+			std::mutex mutex;
+			std::unordered_multimap<size_t, std::pair<ResLoadingDescPtr, std::weak_ptr<void>>> res;
+			// The expired ones are removed when the shard gets twice as large as after the last sweep
+			size_t swept_size = 0;
+		};
+		static uint32_t constexpr LOADED_RES_SHARD_BITS = 4;
+		std::array<LoadedResShard, 1U << LOADED_RES_SHARD_BITS> loaded_res_;
 
-		std::mutex loaded_mutex_;
 		std::mutex loading_mutex_;
-		std::vector<std::pair<ResLoadingDescPtr, std::weak_ptr<void>>> loaded_res_;
-		std::vector<std::pair<ResLoadingDescPtr, std::shared_ptr<volatile LoadingStatus>>> loading_res_;
+		// In the order of the queries, and by hash for the lookups
+		std::vector<LoadingRes> loading_res_;
+		std::unordered_multimap<size_t, LoadingRes> loading_res_index_;
 
-		bool non_empty_loading_res_queue_ = false;
+		// One queue for each priority. A reprioritized resource is queued again, and the entry left in the old queue is skipped.
 		std::condition_variable loading_res_queue_cv_;
 		std::mutex loading_res_queue_mutex_;
-		std::vector<std::pair<ResLoadingDescPtr, std::shared_ptr<volatile LoadingStatus>>> loading_res_queue_;
-
-		std::unique_ptr<joiner<void>> loading_thread_;
-		volatile bool quit_{false};
+		std::array<std::deque<std::shared_ptr<LoadingJob>>, NumResLoadingPriorities> loading_res_queues_;
+		bool quit_ = false;
+
+		std::vector<std::unique_ptr<joiner<void>>> loading_threads_;
+
+		double main_thread_stage_budget_ = 0.004;
+#ifndef KLAYGE_SHIP
+		PerfRangePtr main_thread_stage_perf_;
+		PerfCounterPtr pending_main_thread_stage_counter_;
+		PerfCounterPtr loading_res_counter_;
+		PerfCounterPtr loaded_res_lookup_counter_;
+		PerfCounterPtr loaded_res_lookup_time_counter_;
+		std::atomic<uint32_t> num_loaded_res_lookups_{0};
+		std::atomic<uint64_t> loaded_res_lookup_time_ns_{0};
+#endif
 	};
 }
 
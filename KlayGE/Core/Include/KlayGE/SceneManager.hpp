@@ -43,9 +43,25 @@ namespace KlayGE
 		void Resume();
 
 		void SmallObjectThreshold(float area);
+		// Culling results of nodes that didn't move are kept for each camera across frames. They are reused while the camera
+		// stays within these thresholds of where the results were made, except for the ones partially in the frustum. With the
+		// default 0, they are only reused when the camera doesn't move at all.
+		void VisibilityCacheThreshold(float move_dist, float rotate_angle);
 		void SceneUpdateElapse(float elapse);
+		// Runs the sub thread updates of the top level subtrees as parallel jobs, without holding MutexForUpdate. The handlers
+		// see the transforms of the nodes as they were when the step began, plus their own writes, which are published to the
+		// nodes when the step ends. Anything else they touch, including other subtrees, must be guarded by the handlers.
+		void ParallelSubThreadUpdate(bool parallel);
+		bool ParallelSubThreadUpdate() const;
+		void NumCullingThreads(uint32_t num);
+		uint32_t NumCullingThreads() const;
 		virtual void ClipScene();
 
+		// Off by default. Only passes with a single non omni-directional camera are occlusion culled.
+		void OcclusionCulling(bool enable);
+		bool OcclusionCulling() const;
+		SoftwareOcclusionCuller& OcclusionCuller();
+
 		uint32_t NumFrameCameras() const;
 		Camera* GetFrameCamera(uint32_t index);
 		Camera const* GetFrameCamera(uint32_t index) const;
@@ -89,11 +105,14 @@ namespace KlayGE
 		void Update();
 
 		uint32_t NumObjectsRendered() const;
+		uint32_t NumObjectsOccluded() const;
 		uint32_t NumRenderablesRendered() const;
 		uint32_t NumPrimitivesRendered() const;
 		uint32_t NumVerticesRendered() const;
 		uint32_t NumDrawCalls() const;
 		uint32_t NumDispatchCalls() const;
+		uint32_t NumTransformsUpdated() const;
+		uint32_t NumBoundsUpdated() const;
 
 		virtual void OnSceneChanged() = 0;
 
@@ -102,6 +121,45 @@ namespace KlayGE
 			return nodes_updated_;
 		}
 
+	protected:
+		// Structure-of-arrays copy of the scene tree in pre-order, so transform, bound and culling passes stream over
+		// contiguous memory instead of hopping between nodes. The index of a node is its SceneNode::Handle().
+		struct SceneNodeArrays
+		{
+			std::vector<SceneNode*> nodes;
+			// Tell a node from a new one at the same address
+			std::vector<uint64_t> serials;
+			std::vector<uint32_t> parents;
+			std::vector<uint32_t> attribs;
+			std::vector<uint8_t> flags;
+			std::vector<float4x4> xforms_to_parent;
+			std::vector<float4x4> xforms_to_world;
+			std::vector<AABBox> component_aabbs_os;
+			std::vector<AABBox> pos_aabbs_os;
+			std::vector<AABBox> pos_aabbs_ws;
+			std::vector<std::array<BoundOverlap, RenderEngine::PredefinedCameraCBuffer::max_num_cameras>> visible_marks;
+			// Value of stamp when the world space bound last changed
+			std::vector<uint32_t> bound_stamps;
+			// Increased by every culling pass that reads the visibility caches
+			uint32_t stamp = 1;
+
+			enum Flag : uint8_t
+			{
+				F_HasPosBound = 1U << 0,
+				F_Updated = 1U << 1,
+				F_XformDirty = 1U << 2,
+				F_BoundDirty = 1U << 3,
+				F_WorldDirty = 1U << 4,
+				F_PrevDirty = 1U << 5
+			};
+
+			void Clear();
+			void Resize(uint32_t num);
+			uint32_t Append(SceneNode& node);
+			void Refresh(uint32_t handle);
+			void RefreshComponentBound(uint32_t handle);
+		};
+
 	protected:
 		void Flush(uint32_t urt);
 
@@ -112,6 +170,11 @@ namespace KlayGE
 
 		BoundOverlap VisibleTestFromParent(SceneNode const & node, uint32_t camera_index);
 
+		// Runs [0, num_nodes) as a parallel_for on the task scheduler, split into ranges. Each range must only write its own nodes.
+		void ParallelForNodes(size_t num_nodes, std::function<void(size_t begin, size_t end)> const & func);
+		// Copies node_arrays_.visible_marks back to the scene nodes
+		void WriteBackVisibleMarks();
+
 	protected:
 		std::vector<CameraPtr> frame_cameras_;
 		std::vector<Frustum const*> camera_frustums_;
@@ -125,29 +188,115 @@ namespace KlayGE
 
 		float small_obj_threshold_;
 		float update_elapse_;
+		uint32_t num_culling_threads_ = 1;
 
 		std::vector<SceneNode*> all_scene_nodes_;
 		std::vector<SceneNode*> all_overlay_nodes_;
 
+		// Always matches all_scene_nodes_ during ClipScene
+		SceneNodeArrays node_arrays_;
+
 	private:
 		void FlushScene();
+		void ParallelClipScene();
+		void UpdateNodeArrays();
+		void SyncNodeArrays();
+		void OcclusionCullScene();
+		void BuildSubThreadUpdateJobs();
+		void SubThreadUpdateStep(float app_time, float elapsed_time);
+
+		struct CachedCullingResult
+		{
+			BoundOverlap frustum;
+			bool small_obj;
+			uint32_t stamp;
+		};
+
+		void AcquireVisibilityCaches(Viewport const & viewport);
+		void RefreshVisibilityCaches(size_t begin, size_t end, uint32_t num_cameras);
 
 	private:
 		uint32_t urt_;
 
-		std::vector<std::pair<RenderTechnique const *, std::vector<Renderable*>>> render_queue_;
+		// Flat render queue. Flush packs technique rank and quantized view depth into each key and radix sorts it.
+		struct RenderQueueItem
+		{
+			uint64_t key;
+			Renderable* renderable;
+		};
+		struct RenderTechSlot
+		{
+			RenderTechnique const * tech;
+			uint32_t rank;
+			bool active;
+		};
+		std::vector<RenderQueueItem> render_queue_;
+		std::vector<RenderQueueItem> render_queue_sort_buff_;
+		std::unordered_map<RenderTechnique const *, uint32_t> render_tech_slot_map_;
+		std::vector<RenderTechSlot> render_techs_;
+		std::vector<uint32_t> active_render_tech_slots_;
+
+		// Per-node culling results of ParallelClipScene, indexed the same as all_scene_nodes_
+		std::vector<std::array<BoundOverlap, RenderEngine::PredefinedCameraCBuffer::max_num_cameras>> node_culling_results_;
+		std::vector<uint32_t> node_small_obj_masks_;
+
+		// Own culling results of each node for one camera. Results are valid while their stamp is newer than the bound stamp
+		// of the node.
+		struct VisibilityCache
+		{
+			Camera const * camera;
+			int32_t cascade_index;
+			bool omni_directional;
+			float4x4 proj;
+			float4x4 crop;
+			float4x4 view_proj;
+			float3 eye_pos;
+			float3 forward_vec;
+			float3 up_vec;
+			uint32_t last_used;
+
+			// False if the camera moved a little since the results were made. Partial results must be tested again.
+			bool exact;
+
+			std::vector<CachedCullingResult> results;
+		};
+		std::vector<std::unique_ptr<VisibilityCache>> visibility_caches_;
+		std::vector<VisibilityCache*> curr_visibility_caches_;
+		float cache_move_threshold_ = 0;
+		float cache_cos_rotate_threshold_ = 1;
+
+		std::unique_ptr<SoftwareOcclusionCuller> occlusion_culler_;
+		bool occlusion_culling_ = false;
 
 		uint32_t num_objects_rendered_;
+		uint32_t num_objects_occluded_ = 0;
 		uint32_t num_renderables_rendered_;
 		uint32_t num_primitives_rendered_;
 		uint32_t num_vertices_rendered_;
 		uint32_t num_draw_calls_;
 		uint32_t num_dispatch_calls_;
+		uint32_t num_xforms_updated_ = 0;
+		uint32_t num_bounds_updated_ = 0;
 
 		std::mutex update_mutex_;
 		std::unique_ptr<joiner<void>> update_thread_;
 		volatile bool quit_;
 
+		// Nodes of the top level subtrees in tree order, grouped into jobs of about the same size. nodes[job_begins[i],
+		// job_begins[i + 1]) is job i.
+		struct SubThreadUpdateJobs
+		{
+			std::vector<SceneNodePtr> nodes;
+			std::vector<uint32_t> job_begins;
+		};
+		// Update writes the pending one under update_mutex_ when the tree structure changes, and the update thread swaps it in
+		// under the same lock before the next step. The jobs keep their nodes alive, so the pass never walks the live tree.
+		SubThreadUpdateJobs sub_update_jobs_;
+		SubThreadUpdateJobs pending_sub_update_jobs_;
+		bool sub_update_jobs_pending_ = false;
+		bool sub_update_jobs_dirty_ = false;
+		bool parallel_sub_thread_update_ = false;
+
 		bool deferred_mode_;
 
 		bool nodes_updated_ = false;
@@ -44,6 +44,11 @@ namespace KlayGE
 {
 	class KLAYGE_CORE_API SceneNode final : boost::noncopyable, public std::enable_shared_from_this<SceneNode>
 	{
+		friend class SceneManager;
+
+	public:
+		static constexpr uint32_t InvalidHandle = 0xFFFFFFFFU;
+
 	public:
 		enum SOAttrib
 		{
@@ -153,6 +158,8 @@ namespace KlayGE
 		void UpdateTransforms();
 		void UpdatePosBoundSubtree();
 		bool Updated() const;
+		// Index of this node in the scene manager's node arrays. Only valid for nodes under the scene root.
+		uint32_t Handle() const;
 		void FillVisibleMark(BoundOverlap vm);
 		void VisibleMark(uint32_t camera_index, BoundOverlap vm);
 		BoundOverlap VisibleMark(uint32_t camera_index) const;
@@ -200,6 +207,14 @@ namespace KlayGE
 		void Parent(SceneNode* so);
 		void EmitSceneChanged();
 
+		// For the parallel sub thread update. While it's used on a thread, the transforms of the nodes are read from and written
+		// to their sub thread states, and the components are the ones snapshotted with them.
+		static void UseSubThreadState(bool use);
+		struct SubThreadState;
+		SubThreadState* ActiveSubThreadState() const;
+		void BeginSubThreadState();
+		void EndSubThreadState();
+
 	protected:
 		std::wstring name_;
 
@@ -209,6 +224,7 @@ namespace KlayGE
 		std::vector<SceneNodePtr> children_;
 
 		std::vector<SceneComponentPtr> components_;
+		uint32_t components_version_ = 1;
 		std::vector<VertexElement> instance_format_;
 		void* instance_data_;
 
@@ -220,12 +236,19 @@ namespace KlayGE
 		std::unique_ptr<AABBox> pos_aabb_os_;
 		std::unique_ptr<AABBox> pos_aabb_ws_;
 		bool pos_aabb_dirty_ = true;
+		bool xform_dirty_ = true;
 		std::array<BoundOverlap, RenderEngine::PredefinedCameraCBuffer::max_num_cameras> visible_marks_;
 
 		UpdateEvent sub_thread_update_event_;
 		UpdateEvent main_thread_update_event_;
 
 		bool updated_ = false;
+
+		uint32_t handle_ = InvalidHandle;
+		// Unique over the whole run. A new node can reuse the address of a destroyed one, but never its serial.
+		uint64_t serial_;
+
+		std::unique_ptr<SubThreadState> sub_state_;
 	};
 }
 
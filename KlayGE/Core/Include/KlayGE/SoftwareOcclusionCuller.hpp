@@ -0,0 +1,97 @@
+/**
+ * @file SoftwareOcclusionCuller.hpp
+ * @author Minmin Gong
+ *
+ * @section DESCRIPTION
+ *
+ * This source file is part of KlayGE
+ * For the latest info, see http://www.klayge.org
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * You may alternatively use this source under the terms of
+ * the KlayGE Proprietary License (KPL). You can obtained such a license
+ * from http://www.klayge.org/licensing/.
+ */
+
+#ifndef KLAYGE_CORE_SOFTWARE_OCCLUSION_CULLER_HPP
+#define KLAYGE_CORE_SOFTWARE_OCCLUSION_CULLER_HPP
+
+#pragma once
+
+#include <KlayGE/PreDeclare.hpp>
+#include <KFL/AABBox.hpp>
+#include <KFL/CXX2a/span.hpp>
+#include <KFL/Matrix.hpp>
+#include <KFL/Vector.hpp>
+
+#include <vector>
+
+namespace KlayGE
+{
+	// Occlusion culling on the CPU. Occluder meshes are rasterized into a low resolution depth buffer, and bounds are tested
+	// against a max-depth pyramid built from it. Nothing touches the GPU, so it works with any render engine.
+	class KLAYGE_CORE_API SoftwareOcclusionCuller final : boost::noncopyable
+	{
+	public:
+		SoftwareOcclusionCuller();
+
+		void Resize(uint32_t width, uint32_t height);
+		uint32_t Width() const;
+		uint32_t Height() const;
+
+		// Positions and indices are in the object space of the node. Occluders should be inside their visible geometry,
+		// such as the walls of a building without windows, or they would hide objects that can be seen.
+		void AddOccluder(SceneNodePtr const & node, std::span<float3 const> positions, std::span<uint32_t const> indices);
+		void RemoveOccluder(SceneNode const & node);
+		void ClearOccluders();
+		uint32_t NumOccluders() const;
+
+		// Rasterizes the occluders whose nodes are visible to the camera. Must be called before IsOccluded.
+		void Render(float4x4 const & view_proj, uint32_t camera_index);
+		bool IsOccluded(AABBox const & aabb_ws) const;
+
+		uint32_t NumTrianglesRasterized() const;
+
+	private:
+		void RasterizeTriangle(float4 const & v0, float4 const & v1, float4 const & v2);
+		void RasterizeScreenTriangle(float3 const & s0, float3 const & s1, float3 const & s2);
+		void BuildDepthPyramid();
+
+	private:
+		struct Occluder
+		{
+			std::weak_ptr<SceneNode> node;
+			std::vector<float3> positions;
+			std::vector<uint32_t> indices;
+		};
+		std::vector<Occluder> occluders_;
+
+		uint32_t width_;
+		uint32_t height_;
+
+		// Level 0 has the nearest occluder depth of each pixel. Each texel of the higher levels is the farthest of the 2x2 texels
+		// below it.
+		std::vector<std::vector<float>> depth_levels_;
+
+		float4x4 view_proj_;
+		std::vector<float4> clip_positions_;
+		uint32_t num_tris_rasterized_;
+	};
+} // namespace KlayGE
+
+#endif // KLAYGE_CORE_SOFTWARE_OCCLUSION_CULLER_HPP
@@ -52,6 +52,7 @@
 
 #include <KlayGE/PreDeclare.hpp>
 #include <KlayGE/ElementFormat.hpp>
+#include <KlayGE/ResLoader.hpp>
 #include <KFL/CXX2a/span.hpp>
 
 #include <atomic>
@@ -381,7 +382,8 @@ namespace KlayGE
 
 	KLAYGE_CORE_API TexturePtr LoadSoftwareTexture(std::string_view tex_name);
 	KLAYGE_CORE_API TexturePtr SyncLoadTexture(std::string_view tex_name, uint32_t access_hint);
-	KLAYGE_CORE_API TexturePtr ASyncLoadTexture(std::string_view tex_name, uint32_t access_hint);
+	KLAYGE_CORE_API TexturePtr ASyncLoadTexture(std::string_view tex_name, uint32_t access_hint,
+		ResLoadingPriority priority = ResLoadingPriority::Prefetch);
 
 	KLAYGE_CORE_API void SaveTexture(TexturePtr const & texture, std::string const & tex_name);
 
@@ -39,6 +39,7 @@
 #include <KlayGE/PerfProfiler.hpp>
 #include <KlayGE/UI.hpp>
 #include <KFL/Hash.hpp>
+#include <KFL/TaskScheduler.hpp>
 
 #include <fstream>
 #include <mutex>
@@ -130,6 +131,7 @@ namespace KlayGE
 #endif
 
 		gtp_instance_ = MakeUniquePtr<thread_pool>(1, 16);
+		gts_instance_ = MakeUniquePtr<task_scheduler>();
 	}
 
 	Context::~Context()
@@ -158,6 +160,7 @@ namespace KlayGE
 
 		app_ = nullptr;
 
+		gts_instance_.reset();
 		gtp_instance_.reset();
 	}
 
@@ -311,7 +314,11 @@ namespace KlayGE
 		static char const * available_sfs_array[] = { "NullShow" };
 		static char const * available_scfs_array[] = { "Python" };
 #endif
+#ifdef KLAYGE_STATIC_LINK_PLUGINS
 		static char const * available_sms_array[] = { "OCTree" };
+#else
+		static char const * available_sms_array[] = { "OCTree", "BVH" };
+#endif
 
 		int width = 800;
 		int height = 600;
@@ -936,8 +943,11 @@ namespace KlayGE
 		}
 		root->AppendNode(graphics_node);
 
-		std::ofstream ofs(cfg_file.c_str());
-		cfg_doc.Print(ofs);
+		{
+			std::ofstream ofs(cfg_file.c_str());
+			cfg_doc.Print(ofs);
+		}
+		ResLoader::Instance().NotifyFileWritten(cfg_file);
 	}
 
 	void Context::Config(ContextCfg const & cfg)
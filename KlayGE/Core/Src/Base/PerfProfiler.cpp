@@ -110,6 +110,36 @@ namespace KlayGE
 	}
 
 
+	PerfCounter::PerfCounter()
+		: value_(0), dirty_(false)
+	{
+	}
+
+	void PerfCounter::Value(double value)
+	{
+		if (Context::Instance().Config().perf_profiler)
+		{
+			value_ = value;
+			dirty_ = true;
+		}
+	}
+
+	double PerfCounter::Value() const
+	{
+		return value_;
+	}
+
+	void PerfCounter::CollectData()
+	{
+		dirty_ = false;
+	}
+
+	bool PerfCounter::Dirty() const
+	{
+		return dirty_;
+	}
+
+
 	PerfProfiler::PerfProfiler()
 		: frame_id_(0)
 	{
@@ -150,6 +180,14 @@ namespace KlayGE
 		return range;
 	}
 
+	PerfCounterPtr PerfProfiler::CreatePerfCounter(int category, std::string const & name)
+	{
+		PerfCounterPtr counter = MakeSharedPtr<PerfCounter>();
+		typedef std::remove_reference<decltype(std::get<3>(perf_counters_[0]))>::type PerfDataType;
+		perf_counters_.push_back(std::make_tuple(category, name, counter, PerfDataType()));
+		return counter;
+	}
+
 	void PerfProfiler::CollectData()
 	{
 		if (Context::Instance().Config().perf_profiler)
@@ -163,6 +201,14 @@ namespace KlayGE
 						std::get<2>(range)->CPUTime(), std::get<2>(range)->GPUTime()));
 				}
 			}
+			for (auto& counter : perf_counters_)
+			{
+				if (std::get<2>(counter)->Dirty())
+				{
+					std::get<2>(counter)->CollectData();
+					std::get<3>(counter).push_back(std::make_tuple(frame_id_, std::get<2>(counter)->Value()));
+				}
+			}
 
 			++ frame_id_;
 		}
@@ -191,6 +237,22 @@ namespace KlayGE
 			}
 
 			ofs << std::endl;
+
+			if (!perf_counters_.empty())
+			{
+				ofs << "Frame" << ',' << "Category" << ',' << "Name" << ',' << "Value" << std::endl;
+
+				for (auto const & counter : perf_counters_)
+				{
+					for (auto const & data : std::get<3>(counter))
+					{
+						ofs << std::get<0>(data) << ',' << std::get<0>(counter) << ',' << std::get<1>(counter) << ','
+							<< std::get<1>(data) << std::endl;
+					}
+				}
+
+				ofs << std::endl;
+			}
 		}
 	}
 }
@@ -30,14 +30,21 @@
 
 #include <KlayGE/KlayGE.hpp>
 #include <KFL/Hash.hpp>
+#include <KFL/MappedFile.hpp>
+#include <KFL/StringUtil.hpp>
 #include <KFL/Util.hpp>
+#include <KFL/XMLDom.hpp>
 #include <KlayGE/Package.hpp>
+#include <KlayGE/PerfProfiler.hpp>
+#include <KFL/Timer.hpp>
 #include <KFL/CXX17/filesystem.hpp>
 
 #if defined KLAYGE_PLATFORM_LINUX
 #include <cstring>
 #endif
+#include <algorithm>
 #include <fstream>
+#include <limits>
 #include <sstream>
 
 #if defined KLAYGE_PLATFORM_WINDOWS_DESKTOP
@@ -92,6 +99,55 @@ namespace
 	private:
 		AAsset* asset_;
 	};
+#else
+	// File names in the directory listings. They are case insensitive on Windows.
+	std::string ListingName(std::string name)
+	{
+#if defined KLAYGE_PLATFORM_WINDOWS
+		KlayGE::StringUtil::ToLower(name);
+#endif
+		return name;
+	}
+
+	// Loose files are mapped, so that loaders can parse them in place. Empty files can't be mapped, they are streamed.
+	KlayGE::ResIdentifierPtr OpenLooseFile(std::string_view name, std::string const & res_name)
+	{
+		uint64_t const timestamp = std::filesystem::last_write_time(res_name).time_since_epoch().count();
+
+		auto mapped_file = KlayGE::MakeSharedPtr<KlayGE::MappedFile>();
+		if (mapped_file->Map(res_name))
+		{
+			return KlayGE::MakeSharedPtr<KlayGE::ResIdentifier>(name, timestamp, mapped_file->Data(), mapped_file);
+		}
+		else
+		{
+			return KlayGE::MakeSharedPtr<KlayGE::ResIdentifier>(name, timestamp,
+				KlayGE::MakeSharedPtr<std::ifstream>(res_name.c_str(), std::ios_base::binary));
+		}
+	}
+#endif
+
+#ifndef KLAYGE_SHIP
+	// Counts a lookup in the loaded resources, and adds the time it took, waiting for the lock included
+	class LoadedResLookupScope final : boost::noncopyable
+	{
+	public:
+		LoadedResLookupScope(std::atomic<uint32_t>& num_lookups, std::atomic<uint64_t>& lookup_time_ns)
+			: num_lookups_(num_lookups), lookup_time_ns_(lookup_time_ns)
+		{
+		}
+
+		~LoadedResLookupScope()
+		{
+			num_lookups_.fetch_add(1, std::memory_order_relaxed);
+			lookup_time_ns_.fetch_add(static_cast<uint64_t>(timer_.elapsed() * 1e9), std::memory_order_relaxed);
+		}
+
+	private:
+		std::atomic<uint32_t>& num_lookups_;
+		std::atomic<uint64_t>& lookup_time_ns_;
+		KlayGE::Timer timer_;
+	};
 #endif
 }
 
@@ -171,7 +227,7 @@ namespace KlayGE
 		local_path_ = exe_path_;
 #endif
 
-		paths_.push_back(std::make_tuple(CT_HASH(""), 0, "", PackagePtr()));
+		paths_.push_back(std::make_tuple(CT_HASH(""), 0, "", PackagePtr(), ""));
 
 #if defined KLAYGE_PLATFORM_WINDOWS_STORE
 		this->AddPath("Assets/");
@@ -203,21 +259,18 @@ namespace KlayGE
 #endif
 #endif
 
-		loading_thread_ = MakeUniquePtr<joiner<void>>(Context::Instance().ThreadPool()(
-			[this] { this->LoadingThreadFunc(); }));
+#if KLAYGE_IS_DEV_PLATFORM
+		// Effects, configs and UIs are loaded from binary copies of their XML after the first run
+		XMLDocument::CacheFolder((std::filesystem::path(local_path_) / "XMLCache").string());
+#endif
+
+		// Leave most of the cores to the main thread, the render thread and the task scheduler
+		this->StartLoadingThreads(std::min(std::max(std::thread::hardware_concurrency() / 4, 1U), 4U));
 	}
 
 	ResLoader::~ResLoader()
 	{
-		quit_ = true;
-
-		{
-			std::unique_lock<std::mutex> lock(loading_res_queue_mutex_, std::try_to_lock);
-			non_empty_loading_res_queue_ = true;
-			loading_res_queue_cv_.notify_one();
-		}
-
-		(*loading_thread_)();
+		this->StopLoadingThreads();
 	}
 
 	ResLoader& ResLoader::Instance()
@@ -465,6 +518,11 @@ namespace KlayGE
 				PackagePtr package;
 				if (!package_path.empty())
 				{
+					if (!path_in_package.empty() && (path_in_package.back() != '/'))
+					{
+						path_in_package.push_back('/');
+					}
+
 					for (auto const & path : paths_)
 					{
 						auto const & p = std::get<3>(path);
@@ -484,7 +542,8 @@ namespace KlayGE
 					}
 				}
 
-				paths_.push_back(std::make_tuple(virtual_path_hash, static_cast<uint32_t>(virtual_path_str.size()), real_path, package));
+				paths_.push_back(std::make_tuple(virtual_path_hash, static_cast<uint32_t>(virtual_path_str.size()), real_path, package,
+					path_in_package));
 			}
 		}
 	}
@@ -511,9 +570,49 @@ namespace KlayGE
 					break;
 				}
 			}
+
+			for (auto iter = dir_listings_.begin(); iter != dir_listings_.end();)
+			{
+				if (iter->first.compare(0, real_path.size(), real_path) == 0)
+				{
+					iter = dir_listings_.erase(iter);
+				}
+				else
+				{
+					++ iter;
+				}
+			}
+		}
+	}
+
+	void ResLoader::NotifyFileWritten(std::string_view path)
+	{
+		std::error_code ec;
+		auto const file_path = std::filesystem::absolute(std::filesystem::path(path.begin(), path.end()), ec).lexically_normal();
+		if (ec)
+		{
+			return;
+		}
+		auto const dir_path = ListingName((file_path.parent_path() / "").lexically_normal().string());
+		std::string const file_name = ListingName(file_path.filename().string());
+
+		std::lock_guard<std::mutex> lock(paths_mutex_);
+		for (auto& listing : dir_listings_)
+		{
+			auto const listed_path = std::filesystem::absolute(listing.first.empty() ? std::string(".") : listing.first, ec);
+			if (!ec && (ListingName((listed_path / "").lexically_normal().string()) == dir_path))
+			{
+				listing.second.insert(file_name);
+			}
 		}
 	}
 
+	void ResLoader::InvalidateIndex()
+	{
+		std::lock_guard<std::mutex> lock(paths_mutex_);
+		dir_listings_.clear();
+	}
+
 	std::string ResLoader::Locate(std::string_view name)
 	{
 		if (name.empty())
@@ -533,41 +632,13 @@ namespace KlayGE
 #else
 		{
 			std::lock_guard<std::mutex> lock(paths_mutex_);
-			for (auto const & path : paths_)
-			{
-				if ((std::get<1>(path) != 0) || (HashRange(name.begin(), name.begin() + std::get<1>(path)) == std::get<0>(path)))
-				{
-					std::string res_name(std::get<2>(path) + std::string(name.substr(std::get<1>(path))));
-#if defined KLAYGE_PLATFORM_WINDOWS
-					std::replace(res_name.begin(), res_name.end(), '\\', '/');
-#endif
 
-					std::error_code ec;
-					if (std::filesystem::exists(std::filesystem::path(res_name), ec))
-					{
-						return res_name;
-					}
-					else
-					{
-						std::string package_path;
-						std::string password;
-						std::string path_in_package;
-						this->DecomposePackageName(res_name, package_path, password, path_in_package);
-						auto const & package = std::get<3>(path);
-						if (!package_path.empty() && package && (package_path == package->ArchiveStream()->ResName()))
-						{
-							if (package->Locate(path_in_package))
-							{
-								return res_name;
-							}
-						}
-					}
-				}
-
-				if ((std::get<1>(path) == 0) && std::filesystem::path(name.begin(), name.end()).is_absolute())
-				{
-					break;
-				}
+			PackagePtr package;
+			std::string path_in_package;
+			std::string res_name = this->LocateNoLock(name, package, path_in_package);
+			if (!res_name.empty())
+			{
+				return res_name;
 			}
 		}
 #if defined KLAYGE_PLATFORM_WINDOWS_STORE
@@ -601,52 +672,35 @@ namespace KlayGE
 		std::string const & res_name = this->LocateFileIOS(name);
 		if (!res_name.empty())
 		{
-			std::filesystem::path res_path(res_name);
-			uint64_t const timestamp = std::filesystem::last_write_time(res_path).time_since_epoch().count();
-			return MakeSharedPtr<ResIdentifier>(name, timestamp,
-				MakeSharedPtr<std::ifstream>(res_name.c_str(), std::ios_base::binary));
+			return OpenLooseFile(name, res_name);
 		}
 #else
 		{
 			std::lock_guard<std::mutex> lock(paths_mutex_);
-			for (auto const & path : paths_)
+
+			PackagePtr package;
+			std::string path_in_package;
+			std::string res_name = this->LocateNoLock(name, package, path_in_package);
+			if (!res_name.empty() && !package)
 			{
-				if ((std::get<1>(path) != 0) || (HashRange(name.begin(), name.begin() + std::get<1>(path)) == std::get<0>(path)))
+				std::error_code ec;
+				if (!std::filesystem::exists(res_name, ec))
 				{
-					std::string res_name(std::get<2>(path) + std::string(name.substr(std::get<1>(path))));
-#if defined KLAYGE_PLATFORM_WINDOWS
-					std::replace(res_name.begin(), res_name.end(), '\\', '/');
-#endif
-
-					std::filesystem::path res_path(res_name);
-					std::error_code ec;
-					if (std::filesystem::exists(res_path, ec))
-					{
-						uint64_t const timestamp = std::filesystem::last_write_time(res_path).time_since_epoch().count();
-						return MakeSharedPtr<ResIdentifier>(
-							name, timestamp, MakeSharedPtr<std::ifstream>(res_name.c_str(), std::ios_base::binary));
-					}
-					else
-					{
-						std::string package_path;
-						std::string password;
-						std::string path_in_package;
-						this->DecomposePackageName(res_name, package_path, password, path_in_package);
-						auto const & package = std::get<3>(path);
-						if (!package_path.empty() && package && (package_path == package->ArchiveStream()->ResName()))
-						{
-							auto res = package->Extract(path_in_package, name);
-							if (res)
-							{
-								return res;
-							}
-						}
-					}
+					// Removed after its directory was listed
+					dir_listings_.clear();
+					res_name = this->LocateNoLock(name, package, path_in_package);
 				}
+			}
 
-				if ((std::get<1>(path) == 0) && std::filesystem::path(name.begin(), name.end()).is_absolute())
+			if (!res_name.empty())
+			{
+				if (package)
 				{
-					break;
+					return package->Extract(path_in_package, name);
+				}
+				else
+				{
+					return OpenLooseFile(name, res_name);
 				}
 			}
 		}
@@ -662,6 +716,87 @@ namespace KlayGE
 		return ResIdentifierPtr();
 	}
 
+	// Files in directories are looked up in the listings of their directories, so a lookup only touches the file system the first
+	// time a directory is used. Packages don't change, so their own indices are enough.
+	std::string ResLoader::LocateNoLock(std::string_view name, PackagePtr& package, std::string& path_in_package)
+	{
+		bool const is_absolute = std::filesystem::path(name.begin(), name.end()).is_absolute();
+
+		for (auto const & path : paths_)
+		{
+			if ((std::get<1>(path) != 0) || (HashRange(name.begin(), name.begin() + std::get<1>(path)) == std::get<0>(path)))
+			{
+				std::string sub_name(name.substr(std::get<1>(path)));
+#if defined KLAYGE_PLATFORM_WINDOWS
+				std::replace(sub_name.begin(), sub_name.end(), '\\', '/');
+#endif
+
+				auto const & path_package = std::get<3>(path);
+				if (path_package)
+				{
+					std::string name_in_package = std::get<4>(path) + sub_name;
+					if (path_package->Locate(name_in_package))
+					{
+						package = path_package;
+						path_in_package = std::move(name_in_package);
+						return std::get<2>(path) + sub_name;
+					}
+				}
+				else
+				{
+					std::string res_name = std::get<2>(path) + sub_name;
+					if (this->IndexedExists(res_name))
+					{
+						return res_name;
+					}
+				}
+			}
+
+			if ((std::get<1>(path) == 0) && is_absolute)
+			{
+				break;
+			}
+		}
+
+		return "";
+	}
+
+	// A directory is listed the first time a file is looked up in it. Sub directories are in the listing as well.
+	bool ResLoader::IndexedExists(std::string const & res_name)
+	{
+		size_t const name_end = ((res_name.size() > 1) && (res_name.back() == '/')) ? res_name.size() - 1 : res_name.size();
+		auto const slash = res_name.rfind('/', name_end - 1);
+		std::string const dir_name = (slash == std::string::npos) ? std::string() : res_name.substr(0, slash + 1);
+
+		auto iter = dir_listings_.find(dir_name);
+		if (iter == dir_listings_.end())
+		{
+			std::unordered_set<std::string> listing;
+			std::error_code ec;
+			for (std::filesystem::directory_iterator dir_iter(dir_name.empty() ? std::string(".") : dir_name, ec), dir_end;
+				!ec && (dir_iter != dir_end); dir_iter.increment(ec))
+			{
+				listing.insert(ListingName(dir_iter->path().filename().string()));
+			}
+			iter = dir_listings_.emplace(dir_name, std::move(listing)).first;
+		}
+
+		std::string file_name = ListingName(res_name.substr(slash + 1, name_end - slash - 1));
+		if (iter->second.find(file_name) != iter->second.end())
+		{
+			return true;
+		}
+
+		// Could be written after the listing by someone not calling NotifyFileWritten
+		std::error_code ec;
+		if (std::filesystem::exists(res_name, ec))
+		{
+			iter->second.insert(std::move(file_name));
+			return true;
+		}
+		return false;
+	}
+
 	uint64_t ResLoader::Timestamp(std::string_view name)
 	{
 		uint64_t timestamp = 0;
@@ -669,7 +804,13 @@ namespace KlayGE
 		if (!res_path.empty())
 		{
 #if !defined(KLAYGE_PLATFORM_ANDROID)
-			timestamp = std::filesystem::last_write_time(res_path).time_since_epoch().count();
+			// Could be removed after its directory was listed
+			std::error_code ec;
+			auto const last_write_time = std::filesystem::last_write_time(res_path, ec);
+			if (!ec)
+			{
+				timestamp = last_write_time.time_since_epoch().count();
+			}
 #endif
 		}
 
@@ -678,8 +819,6 @@ namespace KlayGE
 
 	std::shared_ptr<void> ResLoader::SyncQuery(ResLoadingDescPtr const & res_desc)
 	{
-		this->RemoveUnrefResources();
-
 		std::shared_ptr<void> loaded_res = this->FindMatchLoadedResource(res_desc);
 		std::shared_ptr<void> res;
 		if (loaded_res)
@@ -699,26 +838,34 @@ namespace KlayGE
 		}
 		else
 		{
-			std::shared_ptr<volatile LoadingStatus> async_is_done;
-			bool found = false;
+			std::shared_ptr<LoadingJob> job;
 			{
 				std::lock_guard<std::mutex> lock(loading_mutex_);
 
-				for (auto const & lrq : loading_res_)
+				auto const range = loading_res_index_.equal_range(res_desc->Hash());
+				for (auto iter = range.first; iter != range.second; ++ iter)
 				{
-					if (lrq.first->Match(*res_desc))
+					if ((iter->second.second->status != LS_CanBeRemoved) && iter->second.first->Match(*res_desc))
 					{
-						res_desc->CopyDataFrom(*lrq.first);
-						async_is_done = lrq.second;
-						found = true;
+						res_desc->CopyDataFrom(*iter->second.first);
+						job = iter->second.second;
 						break;
 					}
 				}
 			}
 
-			if (found)
+			if (job)
 			{
-				*async_is_done = LS_Complete;
+				// Takes it from the queue. If a loading thread is already running its sub thread stage, wait for that instead of
+				// running it twice at the same time.
+				LoadingStatus status = LS_Loading;
+				if (!job->status.compare_exchange_strong(status, LS_Complete))
+				{
+					while (LS_SubThreadStage == job->status)
+					{
+						Sleep(1);
+					}
+				}
 			}
 			else
 			{
@@ -738,10 +885,8 @@ namespace KlayGE
 		return res;
 	}
 
-	std::shared_ptr<void> ResLoader::ASyncQuery(ResLoadingDescPtr const & res_desc)
+	std::shared_ptr<void> ResLoader::ASyncQuery(ResLoadingDescPtr const & res_desc, ResLoadingPriority priority)
 	{
-		this->RemoveUnrefResources();
-
 		std::shared_ptr<void> loaded_res = this->FindMatchLoadedResource(res_desc);
 		std::shared_ptr<void> res;
 		if (loaded_res)
@@ -761,51 +906,50 @@ namespace KlayGE
 		}
 		else
 		{
-			std::shared_ptr<volatile LoadingStatus> async_is_done;
+			size_t const hash = res_desc->Hash();
 			bool found = false;
 			{
 				std::lock_guard<std::mutex> lock(loading_mutex_);
 
-				for (auto const & lrq : loading_res_)
+				auto const range = loading_res_index_.equal_range(hash);
+				for (auto iter = range.first; iter != range.second; ++ iter)
 				{
-					if (lrq.first->Match(*res_desc))
+					if ((iter->second.second->status != LS_CanBeRemoved) && iter->second.first->Match(*res_desc))
 					{
-						res_desc->CopyDataFrom(*lrq.first);
-						async_is_done = lrq.second;
+						res_desc->CopyDataFrom(*iter->second.first);
+						auto const job = iter->second.second;
+						res = this->AddLoadingTicket(*job, res_desc->Resource());
+
+						if (!res_desc->StateLess())
+						{
+							loading_res_.emplace_back(res_desc, job);
+							loading_res_index_.emplace(hash, std::make_pair(res_desc, job));
+						}
+						this->RaisePriority(job, priority);
+
 						found = true;
 						break;
 					}
 				}
 			}
 
-			if (found)
-			{
-				res = res_desc->Resource();
-
-				if (!res_desc->StateLess())
-				{
-					std::lock_guard<std::mutex> lock(loading_mutex_);
-					loading_res_.emplace_back(res_desc, async_is_done);
-				}
-			}
-			else
+			if (!found)
 			{
 				if (res_desc->HasSubThreadStage())
 				{
-					res = res_desc->CreateResource();
-
-					async_is_done = MakeSharedPtr<LoadingStatus>(LS_Loading);
-
+					std::shared_ptr<void> const created_res = res_desc->CreateResource();
+					auto const job = MakeSharedPtr<LoadingJob>(res_desc, priority);
 					{
 						std::lock_guard<std::mutex> lock(loading_mutex_);
-						loading_res_.emplace_back(res_desc, async_is_done);
+						res = this->AddLoadingTicket(*job, created_res);
+						loading_res_.emplace_back(res_desc, job);
+						loading_res_index_.emplace(hash, std::make_pair(res_desc, job));
 					}
 					{
-						std::unique_lock<std::mutex> lock(loading_res_queue_mutex_, std::try_to_lock);
-						loading_res_queue_.emplace_back(res_desc, async_is_done);
-						non_empty_loading_res_queue_ = true;
-						loading_res_queue_cv_.notify_one();
+						std::lock_guard<std::mutex> lock(loading_res_queue_mutex_);
+						loading_res_queues_[static_cast<uint32_t>(priority)].push_back(job);
 					}
+					loading_res_queue_cv_.notify_one();
 				}
 				else
 				{
@@ -818,122 +962,274 @@ namespace KlayGE
 		return res;
 	}
 
+	// There is no desc to hash, but it's only a pointer comparison for each resource, one shard at a time
 	void ResLoader::Unload(std::shared_ptr<void> const & res)
 	{
-		std::lock_guard<std::mutex> lock(loaded_mutex_);
-
-		for (auto iter = loaded_res_.begin(); iter != loaded_res_.end(); ++ iter)
+		for (auto& shard : loaded_res_)
 		{
-			if (res == iter->second.lock())
+			std::lock_guard<std::mutex> lock(shard.mutex);
+
+			for (auto iter = shard.res.begin(); iter != shard.res.end(); ++ iter)
 			{
-				loaded_res_.erase(iter);
-				break;
+				if (res == iter->second.second.lock())
+				{
+					shard.res.erase(iter);
+					return;
+				}
 			}
 		}
 	}
 
 	void ResLoader::AddLoadedResource(ResLoadingDescPtr const & res_desc, std::shared_ptr<void> const & res)
 	{
-		std::lock_guard<std::mutex> lock(loaded_mutex_);
+#ifndef KLAYGE_SHIP
+		LoadedResLookupScope const lookup_scope(num_loaded_res_lookups_, loaded_res_lookup_time_ns_);
+#endif
+
+		size_t const hash = res_desc->Hash();
+		auto& shard = loaded_res_[hash >> (std::numeric_limits<size_t>::digits - LOADED_RES_SHARD_BITS)];
+		std::lock_guard<std::mutex> lock(shard.mutex);
 
-		bool found = false;
-		for (auto& c_desc : loaded_res_)
+		auto const range = shard.res.equal_range(hash);
+		for (auto iter = range.first; iter != range.second; ++ iter)
 		{
-			if (c_desc.first == res_desc)
+			if (iter->second.first == res_desc)
 			{
-				c_desc.second = std::weak_ptr<void>(res);
-				found = true;
-				break;
+				iter->second.second = std::weak_ptr<void>(res);
+				return;
 			}
 		}
-		if (!found)
+
+		shard.res.emplace(hash, std::make_pair(res_desc, std::weak_ptr<void>(res)));
+		if (shard.res.size() >= std::max<size_t>(shard.swept_size * 2, 64))
 		{
-			loaded_res_.emplace_back(res_desc, std::weak_ptr<void>(res));
+			for (auto iter = shard.res.begin(); iter != shard.res.end();)
+			{
+				if (iter->second.second.expired())
+				{
+					iter = shard.res.erase(iter);
+				}
+				else
+				{
+					++ iter;
+				}
+			}
+			shard.swept_size = shard.res.size();
 		}
 	}
 
 	std::shared_ptr<void> ResLoader::FindMatchLoadedResource(ResLoadingDescPtr const & res_desc)
 	{
-		std::lock_guard<std::mutex> lock(loaded_mutex_);
+#ifndef KLAYGE_SHIP
+		LoadedResLookupScope const lookup_scope(num_loaded_res_lookups_, loaded_res_lookup_time_ns_);
+#endif
 
-		std::shared_ptr<void> loaded_res;
-		for (auto const & lr : loaded_res_)
+		size_t const hash = res_desc->Hash();
+		// The high bits pick the shard, the low ones pick the buckets inside it
+		auto& shard = loaded_res_[hash >> (std::numeric_limits<size_t>::digits - LOADED_RES_SHARD_BITS)];
+		std::lock_guard<std::mutex> lock(shard.mutex);
+
+		auto const range = shard.res.equal_range(hash);
+		for (auto iter = range.first; iter != range.second;)
 		{
-			if (lr.first->Match(*res_desc))
+			std::shared_ptr<void> loaded_res = iter->second.second.lock();
+			if (!loaded_res)
 			{
-				loaded_res = lr.second.lock();
-				break;
+				iter = shard.res.erase(iter);
+			}
+			else if (iter->second.first->Match(*res_desc))
+			{
+				return loaded_res;
+			}
+			else
+			{
+				++ iter;
 			}
 		}
-		return loaded_res;
+		return std::shared_ptr<void>();
 	}
 
-	void ResLoader::RemoveUnrefResources()
+	void ResLoader::Reprioritize(std::shared_ptr<void> const & res, ResLoadingPriority priority)
 	{
-		std::lock_guard<std::mutex> lock(loaded_mutex_);
+		if (!res)
+		{
+			return;
+		}
 
-		for (auto iter = loaded_res_.begin(); iter != loaded_res_.end();)
+		std::lock_guard<std::mutex> lock(loading_mutex_);
+
+		for (auto const & lr : loading_res_)
 		{
-			if (iter->second.lock())
+			auto const & job = lr.second;
+			if (LS_Loading == job->status)
 			{
-				++ iter;
+				for (auto const & ticket : job->tickets)
+				{
+					// The returned pointers share the ownership of their tickets, even after a cast
+					if (!ticket.owner_before(res) && !res.owner_before(ticket))
+					{
+						if (job->priority != priority)
+						{
+							job->priority = priority;
+							{
+								std::lock_guard<std::mutex> queue_lock(loading_res_queue_mutex_);
+								loading_res_queues_[static_cast<uint32_t>(priority)].push_back(job);
+							}
+							loading_res_queue_cv_.notify_one();
+						}
+						return;
+					}
+				}
 			}
-			else
+		}
+	}
+
+	void ResLoader::NumLoadingThreads(uint32_t num)
+	{
+		num = std::max(num, 1U);
+		if (num != loading_threads_.size())
+		{
+			this->StopLoadingThreads();
+			this->StartLoadingThreads(num);
+		}
+	}
+
+	// Called with loading_mutex_ locked. The returned pointer points to the resource, but owns a ticket that owns the resource.
+	// So the job knows when all of its requesters are gone.
+	std::shared_ptr<void> ResLoader::AddLoadingTicket(LoadingJob& job, std::shared_ptr<void> const & res)
+	{
+		if (!res)
+		{
+			return res;
+		}
+
+		job.tickets.erase(std::remove_if(job.tickets.begin(), job.tickets.end(),
+			[](std::weak_ptr<void> const & ticket) { return ticket.expired(); }), job.tickets.end());
+
+		auto ticket = MakeSharedPtr<std::shared_ptr<void>>(res);
+		job.tickets.push_back(ticket);
+		return std::shared_ptr<void>(ticket, res.get());
+	}
+
+	// Called with loading_mutex_ locked
+	bool ResLoader::IsAbandoned(LoadingJob const & job) const
+	{
+		return !job.tickets.empty()
+			&& std::all_of(job.tickets.begin(), job.tickets.end(), [](std::weak_ptr<void> const & ticket) { return ticket.expired(); });
+	}
+
+	// Called with loading_mutex_ locked
+	void ResLoader::RaisePriority(std::shared_ptr<LoadingJob> const & job, ResLoadingPriority priority)
+	{
+		if ((LS_Loading == job->status) && (priority < job->priority))
+		{
+			job->priority = priority;
 			{
-				iter = loaded_res_.erase(iter);
+				std::lock_guard<std::mutex> lock(loading_res_queue_mutex_);
+				loading_res_queues_[static_cast<uint32_t>(priority)].push_back(job);
 			}
+			loading_res_queue_cv_.notify_one();
 		}
 	}
 
 	void ResLoader::Update()
 	{
-		std::vector<std::pair<ResLoadingDescPtr, std::shared_ptr<volatile LoadingStatus>>> tmp_loading_res;
+#ifndef KLAYGE_SHIP
+		if (!main_thread_stage_perf_)
 		{
-			std::lock_guard<std::mutex> lock(loading_mutex_);
-			tmp_loading_res = loading_res_;
+			PerfProfiler& profiler = PerfProfiler::Instance();
+			main_thread_stage_perf_ = profiler.CreatePerfRange(0, "ResLoader main thread stages");
+			pending_main_thread_stage_counter_ = profiler.CreatePerfCounter(0, "ResLoader pending main thread stages");
+			loading_res_counter_ = profiler.CreatePerfCounter(0, "ResLoader loading resources");
+			loaded_res_lookup_counter_ = profiler.CreatePerfCounter(0, "ResLoader loaded resource lookups");
+			loaded_res_lookup_time_counter_ = profiler.CreatePerfCounter(0, "ResLoader loaded resource lookup time (ms)");
 		}
+		main_thread_stage_perf_->Begin();
+#endif
 
-		for (auto& lrq : tmp_loading_res)
+		std::vector<LoadingRes> ready_res;
 		{
-			if (LS_Complete == *lrq.second)
+			std::lock_guard<std::mutex> lock(loading_mutex_);
+			for (auto const & lr : loading_res_)
 			{
-				ResLoadingDescPtr const & res_desc = lrq.first;
-
-				std::shared_ptr<void> res;
-				std::shared_ptr<void> loaded_res = this->FindMatchLoadedResource(res_desc);
-				if (loaded_res)
+				if (LS_Complete == lr.second->status)
 				{
-					if (!res_desc->StateLess())
+					// Nobody waits for it any more, so skip its main thread stage
+					if (this->IsAbandoned(*lr.second))
 					{
-						res = res_desc->CloneResourceFrom(loaded_res);
-						if (res != loaded_res)
-						{
-							this->AddLoadedResource(res_desc, res);
-						}
+						lr.second->status = LS_CanBeRemoved;
+					}
+					else
+					{
+						ready_res.push_back(lr);
 					}
-				}
-				else
-				{
-					res_desc->MainThreadStage();
-					res = res_desc->Resource();
-					this->AddLoadedResource(res_desc, res);
 				}
 			}
 		}
-		for (auto& lrq : tmp_loading_res)
+
+		// The descs of a job keep their query order, so the one that loaded the data goes first
+		std::stable_sort(ready_res.begin(), ready_res.end(), [](LoadingRes const & lhs, LoadingRes const & rhs) {
+			return lhs.second->priority < rhs.second->priority;
+		});
+
+		// At least one is done every frame, even if it's over the budget
+		Timer timer;
+		size_t num_done = 0;
+		for (; num_done < ready_res.size(); ++ num_done)
 		{
-			if (LS_Complete == *lrq.second)
+			if ((num_done > 0) && (main_thread_stage_budget_ > 0) && (timer.elapsed() >= main_thread_stage_budget_))
 			{
-				*lrq.second = LS_CanBeRemoved;
+				break;
 			}
+
+			ResLoadingDescPtr const & res_desc = ready_res[num_done].first;
+
+			std::shared_ptr<void> res;
+			std::shared_ptr<void> loaded_res = this->FindMatchLoadedResource(res_desc);
+			if (loaded_res)
+			{
+				if (!res_desc->StateLess())
+				{
+					res = res_desc->CloneResourceFrom(loaded_res);
+					if (res != loaded_res)
+					{
+						this->AddLoadedResource(res_desc, res);
+					}
+				}
+			}
+			else
+			{
+				res_desc->MainThreadStage();
+				res = res_desc->Resource();
+				this->AddLoadedResource(res_desc, res);
+			}
+		}
+
+		std::vector<ResLoadingDesc const *> done_descs(num_done);
+		for (size_t i = 0; i < num_done; ++ i)
+		{
+			done_descs[i] = ready_res[i].first.get();
 		}
+		std::sort(done_descs.begin(), done_descs.end());
 
+		size_t num_loading_res;
 		{
 			std::lock_guard<std::mutex> lock(loading_mutex_);
 			for (auto iter = loading_res_.begin(); iter != loading_res_.end();)
 			{
-				if (LS_CanBeRemoved == *(iter->second))
+				if ((LS_CanBeRemoved == iter->second->status)
+					|| std::binary_search(done_descs.begin(), done_descs.end(), iter->first.get()))
 				{
+					auto const range = loading_res_index_.equal_range(iter->first->Hash());
+					for (auto index_iter = range.first; index_iter != range.second; ++ index_iter)
+					{
+						if (index_iter->second == *iter)
+						{
+							loading_res_index_.erase(index_iter);
+							break;
+						}
+					}
+
 					iter = loading_res_.erase(iter);
 				}
 				else
@@ -941,33 +1237,106 @@ namespace KlayGE
 					++ iter;
 				}
 			}
+			num_loading_res = loading_res_.size();
+		}
+
+#ifndef KLAYGE_SHIP
+		main_thread_stage_perf_->End();
+		pending_main_thread_stage_counter_->Value(static_cast<double>(ready_res.size() - num_done));
+		loading_res_counter_->Value(static_cast<double>(num_loading_res));
+		// Lookups from all threads since the last frame
+		loaded_res_lookup_counter_->Value(num_loaded_res_lookups_.exchange(0, std::memory_order_relaxed));
+		loaded_res_lookup_time_counter_->Value(loaded_res_lookup_time_ns_.exchange(0, std::memory_order_relaxed) * 1e-6);
+#else
+		KFL_UNUSED(num_loading_res);
+#endif
+	}
+
+	void ResLoader::MainThreadStageBudget(double budget)
+	{
+		main_thread_stage_budget_ = budget;
+	}
+
+	void ResLoader::StartLoadingThreads(uint32_t num)
+	{
+		quit_ = false;
+		for (uint32_t i = 0; i < num; ++ i)
+		{
+			loading_threads_.push_back(MakeUniquePtr<joiner<void>>(Context::Instance().ThreadPool()(
+				[this] { this->LoadingThreadFunc(); })));
 		}
 	}
 
-	void ResLoader::LoadingThreadFunc()
+	void ResLoader::StopLoadingThreads()
 	{
-		while (!quit_)
 		{
-			std::vector<std::pair<ResLoadingDescPtr, std::shared_ptr<volatile LoadingStatus>>> loading_res_queue_copy;
+			std::lock_guard<std::mutex> lock(loading_res_queue_mutex_);
+			quit_ = true;
+		}
+		loading_res_queue_cv_.notify_all();
+
+		for (auto& thread : loading_threads_)
+		{
+			(*thread)();
+		}
+		loading_threads_.clear();
+	}
 
+	void ResLoader::LoadingThreadFunc()
+	{
+		for (;;)
+		{
+			std::shared_ptr<LoadingJob> job;
 			{
 				std::unique_lock<std::mutex> lock(loading_res_queue_mutex_);
-				loading_res_queue_cv_.wait(lock, [this] { return non_empty_loading_res_queue_; });
+				loading_res_queue_cv_.wait(lock, [this] {
+					return quit_ || std::any_of(loading_res_queues_.begin(), loading_res_queues_.end(),
+						[](std::deque<std::shared_ptr<LoadingJob>> const & queue) { return !queue.empty(); });
+				});
+				if (quit_)
+				{
+					break;
+				}
 
-				loading_res_queue_copy.swap(loading_res_queue_);
-				non_empty_loading_res_queue_ = false;
+				for (uint32_t i = 0; i < NumResLoadingPriorities; ++ i)
+				{
+					auto& queue = loading_res_queues_[i];
+					if (!queue.empty())
+					{
+						// Entries left behind by Reprioritize are dropped
+						if (static_cast<uint32_t>(queue.front()->priority.load()) == i)
+						{
+							job = queue.front();
+						}
+						queue.pop_front();
+						break;
+					}
+				}
 			}
 
-			for (auto& res_pair : loading_res_queue_copy)
+			if (job)
 			{
-				if (LS_Loading == *res_pair.second)
+				bool claimed = false;
 				{
-					res_pair.first->SubThreadStage();
-					*res_pair.second = LS_Complete;
+					std::lock_guard<std::mutex> lock(loading_mutex_);
+
+					LoadingStatus status = LS_Loading;
+					if (this->IsAbandoned(*job))
+					{
+						job->status.compare_exchange_strong(status, LS_CanBeRemoved);
+					}
+					else
+					{
+						claimed = job->status.compare_exchange_strong(status, LS_SubThreadStage);
+					}
 				}
-			}
 
-			Sleep(10);
+				if (claimed)
+				{
+					job->desc->SubThreadStage();
+					job->status = LS_Complete;
+				}
+			}
 		}
 	}
 
@@ -33,7 +33,6 @@
 #include <KlayGE/ResLoader.hpp>
 #include <KFL/DllLoader.hpp>
 
-#include <cstring>
 #include <mutex>
 
 #include <C/LzmaLib.h>
@@ -199,16 +198,14 @@ namespace KlayGE
 
 	void LZMACodec::Decode(void* output, std::span<uint8_t const> input, uint64_t original_len)
 	{
+		// The input is only read, so it's decoded right where it is, a mapped file for example
 		uint8_t const * p = static_cast<uint8_t const *>(input.data());
 
-		auto in_data = MakeUniquePtr<uint8_t[]>(static_cast<size_t>(input.size()));
-		std::memcpy(in_data.get(), p, static_cast<std::streamsize>(input.size()));
-
 		SizeT s_out_len = static_cast<SizeT>(original_len);
 
 		SizeT s_src_len = static_cast<SizeT>(input.size() - LZMA_PROPS_SIZE);
-		int res = LZMALoader::Instance().LzmaUncompress(static_cast<Byte*>(output), &s_out_len, &in_data[LZMA_PROPS_SIZE], &s_src_len,
-			&in_data[0], LZMA_PROPS_SIZE);
+		int res = LZMALoader::Instance().LzmaUncompress(static_cast<Byte*>(output), &s_out_len, p + LZMA_PROPS_SIZE, &s_src_len,
+			p, LZMA_PROPS_SIZE);
 		Verify(0 == res);
 	}
 }
@@ -164,6 +164,21 @@ namespace KlayGE
 		TIFHR(archive->GetNumberOfItems(&num_items_));
 
 		archive_ = std::shared_ptr<IInArchive>(archive.detach(), std::mem_fn(&IInArchive::Release));
+
+		file_indices_.reserve(num_items_);
+		for (uint32_t i = 0; i < num_items_; ++ i)
+		{
+			bool is_folder = true;
+			TIFHR(IsArchiveItemFolder(archive_.get(), i, is_folder));
+			if (!is_folder)
+			{
+				std::string file_path;
+				TIFHR(GetArchiveItemPath(archive_.get(), i, file_path));
+				std::replace(file_path.begin(), file_path.end(), '\\', '/');
+				StringUtil::ToLower(file_path);
+				file_indices_.emplace(std::move(file_path), i);
+			}
+		}
 	}
 
 	bool Package::Locate(std::string_view extract_file_path)
@@ -206,22 +221,12 @@ namespace KlayGE
 	{
 		uint32_t real_index = 0xFFFFFFFF;
 
-		for (uint32_t i = 0; i < num_items_; ++ i)
+		std::string file_path(extract_file_path);
+		StringUtil::ToLower(file_path);
+		auto const iter = file_indices_.find(file_path);
+		if (iter != file_indices_.end())
 		{
-			bool is_folder = true;
-			TIFHR(IsArchiveItemFolder(archive_.get(), i, is_folder));
-			if (!is_folder)
-			{
-				std::string file_path;
-				TIFHR(GetArchiveItemPath(archive_.get(), i, file_path));
-				std::replace(file_path.begin(), file_path.end(), '\\', '/');
-				if (!StringUtil::CaseInsensitiveLexicographicalCompare(extract_file_path, file_path) &&
-					!StringUtil::CaseInsensitiveLexicographicalCompare(file_path, extract_file_path))
-				{
-					real_index = i;
-					break;
-				}
-			}
+			real_index = iter->second;
 		}
 		if (real_index != 0xFFFFFFFF)
 		{
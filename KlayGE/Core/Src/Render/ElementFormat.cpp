@@ -37,6 +37,59 @@
 #include <KFL/Math.hpp>
 #include <KFL/Half.hpp>
 
+#include <algorithm>
+
+namespace
+{
+	using namespace KlayGE;
+
+	static_assert(sizeof(Color) == sizeof(float) * 4, "Colors are converted as arrays of floats");
+
+	uint32_t const HALF_BATCH_SIZE = 256;
+
+	// Missing channels are 0, and alpha is 1
+	void HalfsToABGR32F(half const * input, uint32_t num_channels, uint32_t num_elems, Color* output)
+	{
+		if (num_channels == 4)
+		{
+			HalfToFloat(std::span<half const>(input, num_elems * 4), std::span<float>(&output->r(), num_elems * 4));
+			return;
+		}
+
+		float buff[HALF_BATCH_SIZE * 3];
+		for (uint32_t i = 0; i < num_elems; i += HALF_BATCH_SIZE)
+		{
+			uint32_t const n = std::min(HALF_BATCH_SIZE, num_elems - i);
+			HalfToFloat(std::span<half const>(input + i * num_channels, n * num_channels), std::span<float>(buff, n * num_channels));
+			for (uint32_t j = 0; j < n; ++ j)
+			{
+				float const * s = &buff[j * num_channels];
+				output[i + j] = Color(s[0], (num_channels > 1) ? s[1] : 0, (num_channels > 2) ? s[2] : 0, 1);
+			}
+		}
+	}
+
+	void ABGR32FToHalfs(Color const * input, uint32_t num_channels, uint32_t num_elems, half* output)
+	{
+		if (num_channels == 4)
+		{
+			FloatToHalf(std::span<float const>(&input->r(), num_elems * 4), std::span<half>(output, num_elems * 4));
+			return;
+		}
+
+		float buff[HALF_BATCH_SIZE * 3];
+		for (uint32_t i = 0; i < num_elems; i += HALF_BATCH_SIZE)
+		{
+			uint32_t const n = std::min(HALF_BATCH_SIZE, num_elems - i);
+			for (uint32_t j = 0; j < n; ++ j)
+			{
+				std::copy(input[i + j].begin(), input[i + j].begin() + num_channels, &buff[j * num_channels]);
+			}
+			FloatToHalf(std::span<float const>(buff, n * num_channels), std::span<half>(output + i * num_channels, n * num_channels));
+		}
+	}
+}
+
 namespace KlayGE
 {
 	void ConvertToABGR32F(ElementFormat fmt, void const * input, uint32_t num_elems, Color* output)
@@ -544,19 +597,11 @@ namespace KlayGE
 
 
 		case EF_R16F:
-			for (uint32_t i = 0; i < num_elems; ++ i, p += elem_size, ++ output)
-			{
-				half const s = *reinterpret_cast<half const *>(p);
-				*output = Color(s, 0, 0, 1);
-			}
+			HalfsToABGR32F(reinterpret_cast<half const *>(p), 1, num_elems, output);
 			break;
 
 		case EF_GR16F:
-			for (uint32_t i = 0; i < num_elems; ++ i, p += elem_size, ++ output)
-			{
-				half const * s = reinterpret_cast<half const *>(p);
-				*output = Color(s[0], s[1], 0, 1);
-			}
+			HalfsToABGR32F(reinterpret_cast<half const *>(p), 2, num_elems, output);
 			break;
 
 		case EF_B10G11R11F:
@@ -652,19 +697,11 @@ namespace KlayGE
 			break;
 
 		case EF_BGR16F:
-			for (uint32_t i = 0; i < num_elems; ++ i, p += elem_size, ++ output)
-			{
-				half const * s = reinterpret_cast<half const *>(p);
-				*output = Color(s[0], s[1], s[2], 1);
-			}
+			HalfsToABGR32F(reinterpret_cast<half const *>(p), 3, num_elems, output);
 			break;
 
 		case EF_ABGR16F:
-			for (uint32_t i = 0; i < num_elems; ++ i, p += elem_size, ++ output)
-			{
-				half const * s = reinterpret_cast<half const *>(p);
-				*output = Color(s[0], s[1], s[2], s[3]);
-			}
+			HalfsToABGR32F(reinterpret_cast<half const *>(p), 4, num_elems, output);
 			break;
 
 		case EF_R32F:
@@ -1318,20 +1355,11 @@ namespace KlayGE
 
 
 		case EF_R16F:
-			for (uint32_t i = 0; i < num_elems; ++ i, ++ input, p += elem_size)
-			{
-				half* s = reinterpret_cast<half*>(p);
-				*s = half(input->r());
-			}
+			ABGR32FToHalfs(input, 1, num_elems, reinterpret_cast<half*>(p));
 			break;
 
 		case EF_GR16F:
-			for (uint32_t i = 0; i < num_elems; ++ i, ++ input, p += elem_size)
-			{
-				half* s = reinterpret_cast<half*>(p);
-				s[0] = half(input->r());
-				s[1] = half(input->g());
-			}
+			ABGR32FToHalfs(input, 2, num_elems, reinterpret_cast<half*>(p));
 			break;
 
 		case EF_B10G11R11F:
@@ -1452,24 +1480,11 @@ namespace KlayGE
 			break;
 
 		case EF_BGR16F:
-			for (uint32_t i = 0; i < num_elems; ++ i, ++ input, p += elem_size)
-			{
-				half* s = reinterpret_cast<half*>(p);
-				s[0] = half(input->r());
-				s[1] = half(input->g());
-				s[2] = half(input->b());
-			}
+			ABGR32FToHalfs(input, 3, num_elems, reinterpret_cast<half*>(p));
 			break;
 
 		case EF_ABGR16F:
-			for (uint32_t i = 0; i < num_elems; ++ i, ++ input, p += elem_size)
-			{
-				half* s = reinterpret_cast<half*>(p);
-				s[0] = half(input->r());
-				s[1] = half(input->g());
-				s[2] = half(input->b());
-				s[3] = half(input->a());
-			}
+			ABGR32FToHalfs(input, 4, num_elems, reinterpret_cast<half*>(p));
 			break;
 
 		case EF_R32F:
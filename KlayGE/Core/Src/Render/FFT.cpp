@@ -178,7 +178,9 @@ namespace KlayGE
 
 	void GpuFftPS::CreateButterflyLookups(std::vector<half>& lookup_i_wr_wi, int log_n, int n)
 	{
-		half* ptr = &lookup_i_wr_wi[0];
+		// Filled in floats, and converted to halfs in one go
+		std::vector<float> lookup_f32(lookup_i_wr_wi.size());
+		float* ptr = &lookup_f32[0];
 
 		for (int i = 0; i < log_n; ++ i)
 		{
@@ -205,20 +207,22 @@ namespace KlayGE
 					float wr, wi;
 					this->ComputeWeight(wr, wi, n, k * blocks);
 
-					ptr[i1 * 4 + 0] = half((j1 + 0.5f) / n);
-					ptr[i1 * 4 + 1] = half((j2 + 0.5f) / n);
-					ptr[i1 * 4 + 2] = half(+wr);
-					ptr[i1 * 4 + 3] = half(+wi);
+					ptr[i1 * 4 + 0] = (j1 + 0.5f) / n;
+					ptr[i1 * 4 + 1] = (j2 + 0.5f) / n;
+					ptr[i1 * 4 + 2] = +wr;
+					ptr[i1 * 4 + 3] = +wi;
 
-					ptr[i2 * 4 + 0] = half((j1 + 0.5f) / n);
-					ptr[i2 * 4 + 1] = half((j2 + 0.5f) / n);
-					ptr[i2 * 4 + 2] = half(-wr);
-					ptr[i2 * 4 + 3] = half(-wi);
+					ptr[i2 * 4 + 0] = (j1 + 0.5f) / n;
+					ptr[i2 * 4 + 1] = (j2 + 0.5f) / n;
+					ptr[i2 * 4 + 2] = -wr;
+					ptr[i2 * 4 + 3] = -wi;
 				}
 			}
 
 			ptr += n * 4;
 		}
+
+		FloatToHalf(lookup_f32, lookup_i_wr_wi);
 	}
 	
 
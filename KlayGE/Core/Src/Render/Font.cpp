@@ -774,6 +774,14 @@ namespace
 			return true;
 		}
 
+		size_t Hash() const override
+		{
+			size_t seed = HashRange(font_desc_.res_name.begin(), font_desc_.res_name.end());
+			HashCombine(seed, font_desc_.flag);
+			HashCombine(seed, this->Type());
+			return seed;
+		}
+
 		bool Match(ResLoadingDesc const & rhs) const override
 		{
 			if (this->Type() == rhs.Type())
@@ -910,9 +918,10 @@ namespace KlayGE
 		return ResLoader::Instance().SyncQueryT<Font>(MakeSharedPtr<FontLoadingDesc>(font_name, flags));
 	}
 
-	FontPtr ASyncLoadFont(std::string_view font_name, uint32_t flags)
+	FontPtr ASyncLoadFont(std::string_view font_name, uint32_t flags, ResLoadingPriority priority)
 	{
 		// TODO: Make it really async
+		KFL_UNUSED(priority);
 		return ResLoader::Instance().SyncQueryT<Font>(MakeSharedPtr<FontLoadingDesc>(font_name, flags));
 	}
 }
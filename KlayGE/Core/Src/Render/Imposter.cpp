@@ -124,6 +124,13 @@ namespace KlayGE
 			return true;
 		}
 
+		size_t Hash() const override
+		{
+			size_t seed = HashRange(imposter_desc_.res_name.begin(), imposter_desc_.res_name.end());
+			HashCombine(seed, this->Type());
+			return seed;
+		}
+
 		bool Match(ResLoadingDesc const & rhs) const override
 		{
 			if (this->Type() == rhs.Type())
@@ -163,9 +170,9 @@ namespace KlayGE
 		return ResLoader::Instance().SyncQueryT<Imposter>(MakeSharedPtr<ImposterLoadingDesc>(tex_name));
 	}
 
-	ImposterPtr ASyncLoadImposter(std::string_view tex_name)
+	ImposterPtr ASyncLoadImposter(std::string_view tex_name, ResLoadingPriority priority)
 	{
-		return ResLoader::Instance().ASyncQueryT<Imposter>(MakeSharedPtr<ImposterLoadingDesc>(tex_name));
+		return ResLoader::Instance().ASyncQueryT<Imposter>(MakeSharedPtr<ImposterLoadingDesc>(tex_name), priority);
 	}
 
 
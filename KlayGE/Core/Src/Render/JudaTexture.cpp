@@ -1131,6 +1131,8 @@ namespace KlayGE
 
 		ofs->seekp(block_start_offset_pos, std::ios_base::beg);
 		ofs->write(reinterpret_cast<char const *>(&block_start_pos[0]), block_start_pos.size() * sizeof(block_start_pos[0]));
+
+		ResLoader::Instance().NotifyFileWritten(file_name);
 	}
 
 	void JudaTexture::CacheProperty(uint32_t pages, ElementFormat format, uint32_t border_size, uint32_t cache_tile_size)
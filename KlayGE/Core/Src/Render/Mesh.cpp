@@ -39,6 +39,7 @@
 #include <KFL/Hash.hpp>
 #include <KlayGE/DeferredRenderingLayer.hpp>
 #include <KlayGE/SceneManager.hpp>
+#include <KFL/SIMDMath.hpp>
 
 #include <algorithm>
 #include <fstream>
@@ -136,6 +137,13 @@ namespace
 			return true;
 		}
 
+		size_t Hash() const override
+		{
+			size_t seed = HashRange(model_desc_.res_name.begin(), model_desc_.res_name.end());
+			HashCombine(seed, this->Type());
+			return seed;
+		}
+
 		bool Match(ResLoadingDesc const & rhs) const override
 		{
 			KFL_UNUSED(rhs);
@@ -341,6 +349,20 @@ namespace
 		ModelDesc model_desc_;
 		std::mutex main_thread_stage_mutex_;
 	};
+
+	// MathLib::mul_real and MathLib::mul_dual in one go, sharing the loads
+	std::pair<Quaternion, Quaternion> MulDualQuat(Quaternion const & lhs_real, Quaternion const & lhs_dual,
+		Quaternion const & rhs_real, Quaternion const & rhs_dual)
+	{
+		SIMDVectorF4 const lr = SIMDMathLib::LoadQuaternion(lhs_real);
+		SIMDVectorF4 const rr = SIMDMathLib::LoadQuaternion(rhs_real);
+
+		std::pair<Quaternion, Quaternion> ret;
+		SIMDMathLib::StoreQuaternion(ret.first, SIMDMathLib::MultiplyQuat(lr, rr));
+		SIMDMathLib::StoreQuaternion(ret.second, SIMDMathLib::Add(SIMDMathLib::MultiplyQuat(lr, SIMDMathLib::LoadQuaternion(rhs_dual)),
+			SIMDMathLib::MultiplyQuat(SIMDMathLib::LoadQuaternion(lhs_dual), rr)));
+		return ret;
+	}
 }
 
 namespace KlayGE
@@ -756,10 +778,9 @@ namespace KlayGE
 
 				if ((MathLib::SignBit(std::get<2>(key_dq)) > 0) && (MathLib::SignBit(parent.BindScale()) > 0))
 				{
-					joint.BindParams(MathLib::mul_real(std::get<0>(key_dq), parent.BindReal()),
-						MathLib::mul_dual(
-							std::get<0>(key_dq), std::get<1>(key_dq) * parent.BindScale(), parent.BindReal(), parent.BindDual()),
-						std::get<2>(key_dq) * parent.BindScale());
+					auto const dq = MulDualQuat(
+						std::get<0>(key_dq), std::get<1>(key_dq) * parent.BindScale(), parent.BindReal(), parent.BindDual());
+					joint.BindParams(dq.first, dq.second, std::get<2>(key_dq) * parent.BindScale());
 				}
 				else
 				{
@@ -808,8 +829,7 @@ namespace KlayGE
 			float bind_scale;
 			if ((MathLib::SignBit(joint.InverseOriginScale()) > 0) && (MathLib::SignBit(joint.BindScale()) > 0))
 			{
-				bind_real = MathLib::mul_real(joint.InverseOriginReal(), joint.BindReal());
-				bind_dual = MathLib::mul_dual(joint.InverseOriginReal(), joint.InverseOriginDual(),
+				std::tie(bind_real, bind_dual) = MulDualQuat(joint.InverseOriginReal(), joint.InverseOriginDual(),
 					joint.BindReal(), joint.BindDual());
 				bind_scale = joint.InverseOriginScale() * joint.BindScale();
 
@@ -1048,7 +1068,8 @@ namespace KlayGE
 	RenderModelPtr ASyncLoadModel(std::string_view model_name, uint32_t access_hint, uint32_t node_attrib,
 		std::function<void(RenderModel&)> OnFinishLoading,
 		std::function<RenderModelPtr(std::wstring_view, uint32_t)> CreateModelFactoryFunc,
-		std::function<StaticMeshPtr(std::wstring_view)> CreateMeshFactoryFunc)
+		std::function<StaticMeshPtr(std::wstring_view)> CreateMeshFactoryFunc,
+		ResLoadingPriority priority)
 	{
 		BOOST_ASSERT(CreateModelFactoryFunc);
 		BOOST_ASSERT(CreateMeshFactoryFunc);
@@ -1060,7 +1081,7 @@ namespace KlayGE
 		if (caps.multithread_res_creating_support)
 		{
 			return ResLoader::Instance().ASyncQueryT<RenderModel>(MakeSharedPtr<RenderModelLoadingDesc>(model_name,
-				access_hint, node_attrib, OnFinishLoading, CreateModelFactoryFunc, CreateMeshFactoryFunc));
+				access_hint, node_attrib, OnFinishLoading, CreateModelFactoryFunc, CreateMeshFactoryFunc), priority);
 		}
 		else
 		{
@@ -1164,18 +1185,30 @@ namespace KlayGE
 		ver = LE2Native(ver);
 		BOOST_ASSERT(MODEL_BIN_VERSION == ver);
 
-		std::shared_ptr<std::stringstream> ss = MakeSharedPtr<std::stringstream>();
-
 		uint64_t original_len, len;
 		runtime_file->read(&original_len, sizeof(original_len));
 		original_len = LE2Native(original_len);
 		runtime_file->read(&len, sizeof(len));
 		len = LE2Native(len);
 
+		// A mapped file is decoded without reading it into a temporary buffer first. The decoded data is parsed in place.
+		auto decoded_data = MakeSharedPtr<std::vector<uint8_t>>();
 		LZMACodec lzma;
-		lzma.Decode(*ss, runtime_file, len, original_len);
+		std::span<uint8_t const> const runtime_data = runtime_file->Data();
+		int64_t const offset = runtime_file->tellg();
+		if (!runtime_data.empty() && (offset >= 0) && (len <= runtime_data.size() - static_cast<uint64_t>(offset)))
+		{
+			lzma.Decode(*decoded_data,
+				runtime_data.subspan(static_cast<size_t>(offset), static_cast<size_t>(len)), original_len);
+		}
+		else
+		{
+			// Not mapped, or truncated. The stream handles both.
+			lzma.Decode(*decoded_data, runtime_file, len, original_len);
+		}
 
-		ResIdentifierPtr decoded = MakeSharedPtr<ResIdentifier>(runtime_file->ResName(), runtime_file->Timestamp(), ss);
+		ResIdentifierPtr decoded = MakeSharedPtr<ResIdentifier>(runtime_file->ResName(), runtime_file->Timestamp(),
+			MakeSpan(*decoded_data), decoded_data);
 
 		uint32_t num_mtls;
 		decoded->read(&num_mtls, sizeof(num_mtls));
@@ -2138,6 +2171,8 @@ namespace KlayGE
 		ofs.seekp(p, std::ios_base::beg);
 		len = Native2LE(len);
 		ofs.write(reinterpret_cast<char*>(&len), sizeof(len));
+
+		ResLoader::Instance().NotifyFileWritten(jit_name);
 	}
 
 	void SaveModel(RenderModel const & model, std::string_view model_name)
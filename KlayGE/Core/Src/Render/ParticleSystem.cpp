@@ -341,6 +341,13 @@ namespace
 			return true;
 		}
 
+		size_t Hash() const override
+		{
+			size_t seed = HashRange(ps_desc_.res_name.begin(), ps_desc_.res_name.end());
+			HashCombine(seed, this->Type());
+			return seed;
+		}
+
 		bool Match(ResLoadingDesc const & rhs) const override
 		{
 			if (this->Type() == rhs.Type())
@@ -951,9 +958,10 @@ namespace KlayGE
 		return ResLoader::Instance().SyncQueryT<ParticleSystem>(MakeSharedPtr<ParticleSystemLoadingDesc>(psml_name));
 	}
 
-	ParticleSystemPtr ASyncLoadParticleSystem(std::string_view psml_name)
+	ParticleSystemPtr ASyncLoadParticleSystem(std::string_view psml_name, ResLoadingPriority priority)
 	{
 		// TODO: Make it really async
+		KFL_UNUSED(priority);
 		return ResLoader::Instance().SyncQueryT<ParticleSystem>(MakeSharedPtr<ParticleSystemLoadingDesc>(psml_name));
 	}
 
@@ -1088,12 +1096,15 @@ namespace KlayGE
 			root->AppendNode(updater_node);
 		}
 
-		std::ofstream ofs(psml_name.c_str());
+		std::string file_name = psml_name;
+		std::ofstream ofs(file_name.c_str());
 		if (!ofs)
 		{
-			ofs.open((ResLoader::Instance().LocalFolder() + psml_name).c_str());
+			file_name = ResLoader::Instance().LocalFolder() + psml_name;
+			ofs.open(file_name.c_str());
 		}
 		doc.Print(ofs);
+		ResLoader::Instance().NotifyFileWritten(file_name);
 	}
 
 
@@ -190,6 +190,14 @@ namespace
 			return true;
 		}
 
+		size_t Hash() const override
+		{
+			size_t seed = HashRange(pp_desc_.res_name.begin(), pp_desc_.res_name.end());
+			HashRange(seed, pp_desc_.pp_name.begin(), pp_desc_.pp_name.end());
+			HashCombine(seed, this->Type());
+			return seed;
+		}
+
 		bool Match(ResLoadingDesc const & rhs) const override
 		{
 			if (this->Type() == rhs.Type())
@@ -895,9 +903,10 @@ namespace KlayGE
 		return ResLoader::Instance().SyncQueryT<PostProcess>(MakeSharedPtr<PostProcessLoadingDesc>(ppml_name, pp_name));
 	}
 
-	PostProcessPtr ASyncLoadPostProcess(std::string_view ppml_name, std::string_view pp_name)
+	PostProcessPtr ASyncLoadPostProcess(std::string_view ppml_name, std::string_view pp_name, ResLoadingPriority priority)
 	{
 		// TODO: Make it really async
+		KFL_UNUSED(priority);
 		return ResLoader::Instance().SyncQueryT<PostProcess>(MakeSharedPtr<PostProcessLoadingDesc>(ppml_name, pp_name));
 	}
 
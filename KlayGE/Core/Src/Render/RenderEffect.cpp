@@ -77,11 +77,11 @@ namespace
 {
 	using namespace KlayGE;
 
-	uint32_t const KFX_VERSION = 0x0150;
+	uint32_t const KFX_VERSION = 0x0151;
 
 #if KLAYGE_IS_DEV_PLATFORM
 	std::unique_ptr<RenderVariable> LoadVariable(
-		RenderEffect const& effect, XMLNode const& node, RenderEffectDataType type, uint32_t array_size);
+		RenderEffect const& effect, XMLNodeHandle node, RenderEffectDataType type, uint32_t array_size);
 #endif
 	std::unique_ptr<RenderVariable> StreamInVariable(
 		RenderEffect const& effect, ResIdentifier& res, RenderEffectDataType type, uint32_t array_size);
@@ -468,10 +468,10 @@ namespace
 		}
 	}
 
-	int RetrieveIndex(XMLNode const & node)
+	int RetrieveIndex(XMLNodeHandle node)
 	{
 		int index = 0;
-		XMLAttributePtr attr = node.Attrib("index");
+		XMLAttributeHandle attr = node.Attrib("index");
 		if (attr)
 		{
 			index = attr->ValueInt();
@@ -479,9 +479,9 @@ namespace
 		return index;
 	}
 
-	std::string RetrieveProfile(XMLNode const & node)
+	std::string RetrieveProfile(XMLNodeHandle node)
 	{
-		XMLAttributePtr attr = node.Attrib("profile");
+		XMLAttributeHandle attr = node.Attrib("profile");
 		if (attr)
 		{
 			return std::string(attr->ValueString());
@@ -492,7 +492,7 @@ namespace
 		}
 	}
 
-	std::string RetrieveFuncName(XMLNode const & node)
+	std::string RetrieveFuncName(XMLNodeHandle node)
 	{
 		std::string_view value = node.Attrib("value")->ValueString();
 		return std::string(value.substr(0, value.find("(")));
@@ -503,7 +503,7 @@ namespace
 	{
 	public:
 #if KLAYGE_IS_DEV_PLATFORM
-		virtual void Load(RenderEffect const& effect, XMLNode const& node, uint32_t array_size) = 0;
+		virtual void Load(RenderEffect const& effect, XMLNodeHandle node, uint32_t array_size) = 0;
 #endif
 
 		virtual void StreamIn(RenderEffect const& effect, ResIdentifier& res) = 0;
@@ -681,7 +681,7 @@ namespace
 		}
 
 #if KLAYGE_IS_DEV_PLATFORM
-		void Load(RenderEffect const& effect, XMLNode const& node, uint32_t array_size) override
+		void Load(RenderEffect const& effect, XMLNodeHandle node, uint32_t array_size) override
 		{
 			KFL_UNUSED(effect);
 			KFL_UNUSED(array_size);
@@ -731,7 +731,7 @@ namespace
 		}
 
 #if KLAYGE_IS_DEV_PLATFORM
-		void Load(RenderEffect const& effect, XMLNode const& node, uint32_t array_size) override
+		void Load(RenderEffect const& effect, XMLNodeHandle node, uint32_t array_size) override
 		{
 			KFL_UNUSED(effect);
 			KFL_UNUSED(array_size);
@@ -782,7 +782,7 @@ namespace
 		}
 
 #if KLAYGE_IS_DEV_PLATFORM
-		void Load(RenderEffect const& effect, XMLNode const& node, uint32_t array_size) override
+		void Load(RenderEffect const& effect, XMLNodeHandle node, uint32_t array_size) override
 		{
 			KFL_UNUSED(effect);
 			KFL_UNUSED(array_size);
@@ -833,7 +833,7 @@ namespace
 		}
 
 #if KLAYGE_IS_DEV_PLATFORM
-		void Load(RenderEffect const& effect, XMLNode const& node, uint32_t array_size) override
+		void Load(RenderEffect const& effect, XMLNodeHandle node, uint32_t array_size) override
 		{
 			KFL_UNUSED(effect);
 			KFL_UNUSED(array_size);
@@ -884,7 +884,7 @@ namespace
 		}
 
 #if KLAYGE_IS_DEV_PLATFORM
-		void Load(RenderEffect const& effect, XMLNode const& node, uint32_t array_size) override
+		void Load(RenderEffect const& effect, XMLNodeHandle node, uint32_t array_size) override
 		{
 			KFL_UNUSED(effect);
 			KFL_UNUSED(array_size);
@@ -946,7 +946,7 @@ namespace
 		}
 
 #if KLAYGE_IS_DEV_PLATFORM
-		void Load(RenderEffect const& effect, XMLNode const& node, uint32_t array_size) override
+		void Load(RenderEffect const& effect, XMLNodeHandle node, uint32_t array_size) override
 		{
 			KFL_UNUSED(effect);
 			KFL_UNUSED(array_size);
@@ -1012,7 +1012,7 @@ namespace
 		}
 
 #if KLAYGE_IS_DEV_PLATFORM
-		void Load(RenderEffect const& effect, XMLNode const& node, uint32_t array_size) override
+		void Load(RenderEffect const& effect, XMLNodeHandle node, uint32_t array_size) override
 		{
 			KFL_UNUSED(effect);
 			KFL_UNUSED(array_size);
@@ -1082,7 +1082,7 @@ namespace
 		}
 
 #if KLAYGE_IS_DEV_PLATFORM
-		void Load(RenderEffect const& effect, XMLNode const& node, uint32_t array_size) override
+		void Load(RenderEffect const& effect, XMLNodeHandle node, uint32_t array_size) override
 		{
 			KFL_UNUSED(effect);
 			KFL_UNUSED(array_size);
@@ -1144,7 +1144,7 @@ namespace
 		}
 
 #if KLAYGE_IS_DEV_PLATFORM
-		void Load(RenderEffect const& effect, XMLNode const& node, uint32_t array_size) override
+		void Load(RenderEffect const& effect, XMLNodeHandle node, uint32_t array_size) override
 		{
 			KFL_UNUSED(effect);
 			KFL_UNUSED(array_size);
@@ -1210,7 +1210,7 @@ namespace
 		}
 
 #if KLAYGE_IS_DEV_PLATFORM
-		void Load(RenderEffect const& effect, XMLNode const& node, uint32_t array_size) override
+		void Load(RenderEffect const& effect, XMLNodeHandle node, uint32_t array_size) override
 		{
 			KFL_UNUSED(effect);
 			KFL_UNUSED(array_size);
@@ -1280,7 +1280,7 @@ namespace
 		}
 
 #if KLAYGE_IS_DEV_PLATFORM
-		void Load(RenderEffect const& effect, XMLNode const& node, uint32_t array_size) override
+		void Load(RenderEffect const& effect, XMLNodeHandle node, uint32_t array_size) override
 		{
 			KFL_UNUSED(effect);
 			KFL_UNUSED(array_size);
@@ -1342,7 +1342,7 @@ namespace
 		}
 
 #if KLAYGE_IS_DEV_PLATFORM
-		void Load(RenderEffect const& effect, XMLNode const& node, uint32_t array_size) override
+		void Load(RenderEffect const& effect, XMLNodeHandle node, uint32_t array_size) override
 		{
 			KFL_UNUSED(effect);
 			KFL_UNUSED(array_size);
@@ -1408,7 +1408,7 @@ namespace
 		}
 
 #if KLAYGE_IS_DEV_PLATFORM
-		void Load(RenderEffect const& effect, XMLNode const& node, uint32_t array_size) override
+		void Load(RenderEffect const& effect, XMLNodeHandle node, uint32_t array_size) override
 		{
 			KFL_UNUSED(effect);
 			KFL_UNUSED(array_size);
@@ -1496,7 +1496,7 @@ namespace
 		}
 
 #if KLAYGE_IS_DEV_PLATFORM
-		void Load(RenderEffect const& effect, XMLNode const& node, uint32_t array_size) override
+		void Load(RenderEffect const& effect, XMLNodeHandle node, uint32_t array_size) override
 		{
 			KFL_UNUSED(effect);
 			KFL_UNUSED(array_size);
@@ -1565,18 +1565,18 @@ namespace
 	{
 	public:
 #if KLAYGE_IS_DEV_PLATFORM
-		void Load(RenderEffect const& effect, XMLNode const& node, uint32_t array_size) override
+		void Load(RenderEffect const& effect, XMLNodeHandle node, uint32_t array_size) override
 		{
 			KFL_UNUSED(effect);
 			KFL_UNUSED(array_size);
 
 			SamplerStateDesc desc;
-			for (XMLNodePtr state_node = node.FirstNode("state"); state_node; state_node = state_node->NextSibling("state"))
+			for (XMLNodeHandle state_node = node.FirstNode("state"); state_node; state_node = state_node->NextSibling("state"))
 			{
 				std::string_view const name = state_node->Attrib("name")->ValueString();
 				size_t const name_hash = HashRange(name.begin(), name.end());
 
-				XMLAttributePtr const value_attr = state_node->Attrib("value");
+				XMLAttributeHandle const value_attr = state_node->Attrib("value");
 				std::string_view value_str;
 				if (value_attr)
 				{
@@ -1706,7 +1706,7 @@ namespace
 	{
 	public:
 #if KLAYGE_IS_DEV_PLATFORM
-		void Load(RenderEffect const& effect, XMLNode const& node, uint32_t array_size) override
+		void Load(RenderEffect const& effect, XMLNodeHandle node, uint32_t array_size) override
 		{
 			KFL_UNUSED(effect);
 			KFL_UNUSED(array_size);
@@ -1750,7 +1750,7 @@ namespace
 	{
 	public:
 #if KLAYGE_IS_DEV_PLATFORM
-		void Load(RenderEffect const& effect, XMLNode const& node, uint32_t array_size) override
+		void Load(RenderEffect const& effect, XMLNodeHandle node, uint32_t array_size) override
 		{
 			KFL_UNUSED(effect);
 			KFL_UNUSED(array_size);
@@ -1897,11 +1897,11 @@ namespace
 		}
 
 #if KLAYGE_IS_DEV_PLATFORM
-		void Load(RenderEffect const& effect, XMLNode const& node, uint32_t array_size) override
+		void Load(RenderEffect const& effect, XMLNodeHandle node, uint32_t array_size) override
 		{
 			KFL_UNUSED(effect);
 
-			if (XMLNodePtr value_node = node.FirstNode("value"))
+			if (XMLNodeHandle value_node = node.FirstNode("value"))
 			{
 				value_node = value_node->FirstNode();
 				if (value_node && (XNT_CData == value_node->Type()))
@@ -2038,11 +2038,11 @@ namespace
 		}
 
 #if KLAYGE_IS_DEV_PLATFORM
-		void Load(RenderEffect const& effect, XMLNode const& node, uint32_t array_size) override
+		void Load(RenderEffect const& effect, XMLNodeHandle node, uint32_t array_size) override
 		{
 			KFL_UNUSED(effect);
 
-			if (XMLNodePtr value_node = node.FirstNode("value"))
+			if (XMLNodeHandle value_node = node.FirstNode("value"))
 			{
 				value_node = value_node->FirstNode();
 				if (value_node && (XNT_CData == value_node->Type()))
@@ -2121,11 +2121,11 @@ namespace
 		}
 
 #if KLAYGE_IS_DEV_PLATFORM
-		void Load(RenderEffect const& effect, XMLNode const& node, uint32_t array_size) override
+		void Load(RenderEffect const& effect, XMLNodeHandle node, uint32_t array_size) override
 		{
 			KFL_UNUSED(effect);
 
-			if (XMLNodePtr value_node = node.FirstNode("value"))
+			if (XMLNodeHandle value_node = node.FirstNode("value"))
 			{
 				value_node = value_node->FirstNode();
 				if (value_node && (XNT_CData == value_node->Type()))
@@ -2204,11 +2204,11 @@ namespace
 		}
 
 #if KLAYGE_IS_DEV_PLATFORM
-		void Load(RenderEffect const& effect, XMLNode const& node, uint32_t array_size) override
+		void Load(RenderEffect const& effect, XMLNodeHandle node, uint32_t array_size) override
 		{
 			KFL_UNUSED(effect);
 
-			if (XMLNodePtr value_node = node.FirstNode("value"))
+			if (XMLNodeHandle value_node = node.FirstNode("value"))
 			{
 				value_node = value_node->FirstNode();
 				if (value_node && (XNT_CData == value_node->Type()))
@@ -2287,11 +2287,11 @@ namespace
 		}
 
 #if KLAYGE_IS_DEV_PLATFORM
-		void Load(RenderEffect const& effect, XMLNode const& node, uint32_t array_size) override
+		void Load(RenderEffect const& effect, XMLNodeHandle node, uint32_t array_size) override
 		{
 			KFL_UNUSED(effect);
 
-			if (XMLNodePtr value_node = node.FirstNode("value"))
+			if (XMLNodeHandle value_node = node.FirstNode("value"))
 			{
 				value_node = value_node->FirstNode();
 				if (value_node && (XNT_CData == value_node->Type()))
@@ -2382,11 +2382,11 @@ namespace
 		}
 
 #if KLAYGE_IS_DEV_PLATFORM
-		void Load(RenderEffect const& effect, XMLNode const& node, uint32_t array_size) override
+		void Load(RenderEffect const& effect, XMLNodeHandle node, uint32_t array_size) override
 		{
 			KFL_UNUSED(effect);
 
-			if (XMLNodePtr value_node = node.FirstNode("value"))
+			if (XMLNodeHandle value_node = node.FirstNode("value"))
 			{
 				value_node = value_node->FirstNode();
 				if (value_node && (XNT_CData == value_node->Type()))
@@ -2477,11 +2477,11 @@ namespace
 		}
 
 #if KLAYGE_IS_DEV_PLATFORM
-		void Load(RenderEffect const& effect, XMLNode const& node, uint32_t array_size) override
+		void Load(RenderEffect const& effect, XMLNodeHandle node, uint32_t array_size) override
 		{
 			KFL_UNUSED(effect);
 
-			if (XMLNodePtr value_node = node.FirstNode("value"))
+			if (XMLNodeHandle value_node = node.FirstNode("value"))
 			{
 				value_node = value_node->FirstNode();
 				if (value_node && (XNT_CData == value_node->Type()))
@@ -2572,11 +2572,11 @@ namespace
 		}
 
 #if KLAYGE_IS_DEV_PLATFORM
-		void Load(RenderEffect const& effect, XMLNode const& node, uint32_t array_size) override
+		void Load(RenderEffect const& effect, XMLNodeHandle node, uint32_t array_size) override
 		{
 			KFL_UNUSED(effect);
 
-			if (XMLNodePtr value_node = node.FirstNode("value"))
+			if (XMLNodeHandle value_node = node.FirstNode("value"))
 			{
 				value_node = value_node->FirstNode();
 				if (value_node && (XNT_CData == value_node->Type()))
@@ -2667,11 +2667,11 @@ namespace
 		}
 
 #if KLAYGE_IS_DEV_PLATFORM
-		void Load(RenderEffect const& effect, XMLNode const& node, uint32_t array_size) override
+		void Load(RenderEffect const& effect, XMLNodeHandle node, uint32_t array_size) override
 		{
 			KFL_UNUSED(effect);
 
-			if (XMLNodePtr value_node = node.FirstNode("value"))
+			if (XMLNodeHandle value_node = node.FirstNode("value"))
 			{
 				value_node = value_node->FirstNode();
 				if (value_node && (XNT_CData == value_node->Type()))
@@ -2762,11 +2762,11 @@ namespace
 		}
 
 #if KLAYGE_IS_DEV_PLATFORM
-		void Load(RenderEffect const& effect, XMLNode const& node, uint32_t array_size) override
+		void Load(RenderEffect const& effect, XMLNodeHandle node, uint32_t array_size) override
 		{
 			KFL_UNUSED(effect);
 
-			if (XMLNodePtr value_node = node.FirstNode("value"))
+			if (XMLNodeHandle value_node = node.FirstNode("value"))
 			{
 				value_node = value_node->FirstNode();
 				if (value_node && (XNT_CData == value_node->Type()))
@@ -2857,11 +2857,11 @@ namespace
 		}
 
 #if KLAYGE_IS_DEV_PLATFORM
-		void Load(RenderEffect const& effect, XMLNode const& node, uint32_t array_size) override
+		void Load(RenderEffect const& effect, XMLNodeHandle node, uint32_t array_size) override
 		{
 			KFL_UNUSED(effect);
 
-			if (XMLNodePtr value_node = node.FirstNode("value"))
+			if (XMLNodeHandle value_node = node.FirstNode("value"))
 			{
 				value_node = value_node->FirstNode();
 				if (value_node && (XNT_CData == value_node->Type()))
@@ -2952,11 +2952,11 @@ namespace
 		}
 
 #if KLAYGE_IS_DEV_PLATFORM
-		void Load(RenderEffect const& effect, XMLNode const& node, uint32_t array_size) override
+		void Load(RenderEffect const& effect, XMLNodeHandle node, uint32_t array_size) override
 		{
 			KFL_UNUSED(effect);
 
-			if (XMLNodePtr value_node = node.FirstNode("value"))
+			if (XMLNodeHandle value_node = node.FirstNode("value"))
 			{
 				value_node = value_node->FirstNode();
 				if (value_node && (XNT_CData == value_node->Type()))
@@ -3047,11 +3047,11 @@ namespace
 		}
 
 #if KLAYGE_IS_DEV_PLATFORM
-		void Load(RenderEffect const& effect, XMLNode const& node, uint32_t array_size) override
+		void Load(RenderEffect const& effect, XMLNodeHandle node, uint32_t array_size) override
 		{
 			KFL_UNUSED(effect);
 
-			if (XMLNodePtr value_node = node.FirstNode("value"))
+			if (XMLNodeHandle value_node = node.FirstNode("value"))
 			{
 				value_node = value_node->FirstNode();
 				if (value_node && (XNT_CData == value_node->Type()))
@@ -3167,11 +3167,11 @@ namespace
 		}
 
 #if KLAYGE_IS_DEV_PLATFORM
-		void Load(RenderEffect const& effect, XMLNode const& node, uint32_t array_size) override
+		void Load(RenderEffect const& effect, XMLNodeHandle node, uint32_t array_size) override
 		{
 			KFL_UNUSED(effect);
 
-			if (XMLNodePtr value_node = node.FirstNode("value"))
+			if (XMLNodeHandle value_node = node.FirstNode("value"))
 			{
 				value_node = value_node->FirstNode();
 				if (value_node && (XNT_CData == value_node->Type()))
@@ -3325,7 +3325,7 @@ namespace
 		}
 
 #if KLAYGE_IS_DEV_PLATFORM
-		void Load(RenderEffect const& effect, XMLNode const& node, uint32_t array_size) override
+		void Load(RenderEffect const& effect, XMLNodeHandle node, uint32_t array_size) override
 		{
 			KFL_UNUSED(effect);
 			KFL_UNUSED(array_size);
@@ -3444,7 +3444,7 @@ namespace
 		}
 
 #if KLAYGE_IS_DEV_PLATFORM
-		void Load(RenderEffect const& effect, XMLNode const& node, uint32_t array_size) override
+		void Load(RenderEffect const& effect, XMLNodeHandle node, uint32_t array_size) override
 		{
 			KFL_UNUSED(effect);
 			KFL_UNUSED(array_size);
@@ -3551,7 +3551,7 @@ namespace
 		}
 
 #if KLAYGE_IS_DEV_PLATFORM
-		void Load(RenderEffect const& effect, XMLNode const& node, uint32_t array_size) override
+		void Load(RenderEffect const& effect, XMLNodeHandle node, uint32_t array_size) override
 		{
 			KFL_UNUSED(effect);
 			KFL_UNUSED(array_size);
@@ -3629,7 +3629,7 @@ namespace
 		}
 
 #if KLAYGE_IS_DEV_PLATFORM
-		void Load(RenderEffect const& effect, XMLNode const& node, uint32_t array_size) override
+		void Load(RenderEffect const& effect, XMLNodeHandle node, uint32_t array_size) override
 		{
 			KFL_UNUSED(effect);
 			KFL_UNUSED(array_size);
@@ -3704,7 +3704,7 @@ namespace
 		}
 
 #if KLAYGE_IS_DEV_PLATFORM
-		void Load(RenderEffect const& effect, XMLNode const& node, uint32_t array_size) override
+		void Load(RenderEffect const& effect, XMLNodeHandle node, uint32_t array_size) override
 		{
 			KFL_UNUSED(effect);
 			KFL_UNUSED(node);
@@ -3755,7 +3755,7 @@ namespace
 		}
 
 #if KLAYGE_IS_DEV_PLATFORM
-		void Load(RenderEffect const& effect, XMLNode const& node, uint32_t array_size) override
+		void Load(RenderEffect const& effect, XMLNodeHandle node, uint32_t array_size) override
 		{
 			KFL_UNUSED(effect);
 			KFL_UNUSED(node);
@@ -3817,7 +3817,7 @@ namespace
 		}
 
 #if KLAYGE_IS_DEV_PLATFORM
-		void Load(RenderEffect const& effect, XMLNode const& node, uint32_t array_size) override
+		void Load(RenderEffect const& effect, XMLNodeHandle node, uint32_t array_size) override
 		{
 			KFL_UNUSED(array_size);
 
@@ -4085,7 +4085,7 @@ namespace
 
 #if KLAYGE_IS_DEV_PLATFORM
 	std::unique_ptr<RenderVariable> LoadVariable(
-		RenderEffect const& effect, XMLNode const& node, RenderEffectDataType type, uint32_t array_size)
+		RenderEffect const& effect, XMLNodeHandle node, RenderEffectDataType type, uint32_t array_size)
 	{
 		auto ret = RenderVariableFactory(type, array_size != 0);
 		ret->Load(effect, node, array_size);
@@ -4179,6 +4179,17 @@ namespace KlayGE
 			return true;
 		}
 
+		size_t Hash() const override
+		{
+			size_t seed = 0;
+			for (auto const & name : effect_desc_.res_name)
+			{
+				HashCombine(seed, HashRange(name.begin(), name.end()));
+			}
+			HashCombine(seed, this->Type());
+			return seed;
+		}
+
 		bool Match(ResLoadingDesc const & rhs) const override
 		{
 			if (this->Type() == rhs.Type())
@@ -4235,7 +4246,7 @@ namespace KlayGE
 
 
 #if KLAYGE_IS_DEV_PLATFORM
-	void RenderEffectAnnotation::Load(RenderEffect const& effect, XMLNode const& node)
+	void RenderEffectAnnotation::Load(RenderEffect const& effect, XMLNodeHandle node)
 	{
 		type_ = TypeFromName(node.Attrib("type")->ValueString());
 		name_ = std::string(node.Attrib("name")->ValueString());
@@ -4263,12 +4274,12 @@ namespace KlayGE
 
 
 #if KLAYGE_IS_DEV_PLATFORM
-	void RenderEffectStructType::Load(RenderEffect const& effect, XMLNode const& node)
+	void RenderEffectStructType::Load(RenderEffect const& effect, XMLNodeHandle node)
 	{
 		name_ = std::string(node.Attrib("name")->ValueString());
 		name_hash_ = HashRange(name_.begin(), name_.end());
 
-		for (XMLNodePtr member_node = node.FirstNode("member"); member_node; member_node = member_node->NextSibling("member"))
+		for (XMLNodeHandle member_node = node.FirstNode("member"); member_node; member_node = member_node->NextSibling("member"))
 		{
 			RenderEffectDataType member_type;
 			auto member_type_name = member_node->Attrib("type")->ValueString();
@@ -4847,24 +4858,24 @@ namespace KlayGE
 		}
 	}
 
-	void RenderEffectTemplate::Load(XMLNode const & root, RenderEffect& effect)
+	void RenderEffectTemplate::Load(XMLNodeHandle root, RenderEffect& effect)
 	{
 		{
-			XMLNodePtr macro_node = root.FirstNode("macro");
+			XMLNodeHandle macro_node = root.FirstNode("macro");
 			for (; macro_node; macro_node = macro_node->NextSibling("macro"))
 			{
 				macros_.emplace_back(std::make_pair(macro_node->Attrib("name")->ValueString(), macro_node->Attrib("value")->ValueString()), true);
 			}
 		}
 
-		for (XMLNodePtr node = root.FirstNode("struct"); node; node = node->NextSibling("struct"))
+		for (XMLNodeHandle node = root.FirstNode("struct"); node; node = node->NextSibling("struct"))
 		{
 			struct_types_.push_back(MakeUniquePtr<RenderEffectStructType>());
 			struct_types_.back()->Load(effect, *node);
 		}
 
-		std::vector<XMLNodePtr> parameter_nodes;
-		for (XMLNodePtr node = root.FirstNode(); node; node = node->NextSibling())
+		std::vector<XMLNodeHandle> parameter_nodes;
+		for (XMLNodeHandle node = root.FirstNode(); node; node = node->NextSibling())
 		{
 			if ("parameter" == node->Name())
 			{
@@ -4872,7 +4883,7 @@ namespace KlayGE
 			}
 			else if ("cbuffer" == node->Name())
 			{
-				for (XMLNodePtr sub_node = node->FirstNode("parameter"); sub_node; sub_node = sub_node->NextSibling("parameter"))
+				for (XMLNodeHandle sub_node = node->FirstNode("parameter"); sub_node; sub_node = sub_node->NextSibling("parameter"))
 				{
 					parameter_nodes.push_back(sub_node);
 				}
@@ -4881,7 +4892,7 @@ namespace KlayGE
 
 		for (uint32_t param_index = 0; param_index < parameter_nodes.size(); ++ param_index)
 		{
-			XMLNode const& node = *parameter_nodes[param_index];
+			XMLNodeHandle const node = parameter_nodes[param_index];
 
 			RenderEffectDataType type = REDT_count;
 			auto type_name = node.Attrib("type")->ValueString();
@@ -4916,7 +4927,7 @@ namespace KlayGE
 				&& (type != REDT_rasterizer_ordered_texture3D))
 			{
 				RenderEffectConstantBuffer* cbuff = nullptr;
-				XMLNodePtr parent_node = node.Parent();
+				XMLNodeHandle parent_node = node.Parent();
 				std::string const cbuff_name = std::string(parent_node->AttribString("name", "global_cb"));
 				size_t const cbuff_name_hash = RT_HASH(cbuff_name.c_str());
 
@@ -4945,10 +4956,10 @@ namespace KlayGE
 			effect.params_.back()->Load(effect, node);
 		}
 
-		for (XMLNodePtr shader_graph_nodes_node = root.FirstNode("shader_graph_nodes"); shader_graph_nodes_node;
+		for (XMLNodeHandle shader_graph_nodes_node = root.FirstNode("shader_graph_nodes"); shader_graph_nodes_node;
 			shader_graph_nodes_node = shader_graph_nodes_node->NextSibling("shader_graph_nodes"))
 		{
-			for (XMLNodePtr shader_node = shader_graph_nodes_node->FirstNode("node"); shader_node;
+			for (XMLNodeHandle shader_node = shader_graph_nodes_node->FirstNode("node"); shader_node;
 				shader_node = shader_node->NextSibling("node"))
 			{
 				auto name_attr = shader_node->Attrib("name");
@@ -4975,7 +4986,7 @@ namespace KlayGE
 			}
 		}
 
-		for (XMLNodePtr shader_node = root.FirstNode("shader"); shader_node; shader_node = shader_node->NextSibling("shader"))
+		for (XMLNodeHandle shader_node = root.FirstNode("shader"); shader_node; shader_node = shader_node->NextSibling("shader"))
 		{
 			shader_frags_.push_back(RenderShaderFragment());
 			shader_frags_.back().Load(*shader_node);
@@ -4984,7 +4995,7 @@ namespace KlayGE
 		this->GenHLSLShaderText(effect);
 
 		uint32_t index = 0;
-		for (XMLNodePtr node = root.FirstNode("technique"); node; node = node->NextSibling("technique"), ++ index)
+		for (XMLNodeHandle node = root.FirstNode("technique"); node; node = node->NextSibling("technique"), ++ index)
 		{
 			techniques_.push_back(MakeUniquePtr<RenderTechnique>());
 			techniques_.back()->Load(effect, *node, index);
@@ -5088,7 +5099,7 @@ namespace KlayGE
 
 				this->ResolveOverrideTechs(*frag_docs[0], *root);
 
-				this->Load(*root, effect);
+				this->Load(root->Handle(), effect);
 
 				kfx_name_ = kfx_name;
 				need_compile_ = true;
@@ -5111,6 +5122,7 @@ namespace KlayGE
 
 			std::ofstream ofs(kfx_name_.c_str(), std::ios_base::binary | std::ios_base::out);
 			this->StreamOut(ofs, effect);
+			ResLoader::Instance().NotifyFileWritten(kfx_name_);
 		}
 	}
 #endif
@@ -5884,13 +5896,13 @@ namespace KlayGE
 
 
 #if KLAYGE_IS_DEV_PLATFORM
-	void RenderTechnique::Load(RenderEffect& effect, XMLNode const& node, uint32_t tech_index)
+	void RenderTechnique::Load(RenderEffect& effect, XMLNodeHandle node, uint32_t tech_index)
 	{
 		name_ = std::string(node.Attrib("name")->ValueString());
 		name_hash_ = HashRange(name_.begin(), name_.end());
 
 		RenderTechnique* parent_tech = nullptr;
-		XMLAttributePtr inherit_attr = node.Attrib("inherit");
+		XMLAttributeHandle inherit_attr = node.Attrib("inherit");
 		if (inherit_attr)
 		{
 			std::string_view const inherit = inherit_attr->ValueString();
@@ -5901,7 +5913,7 @@ namespace KlayGE
 		}
 
 		{
-			XMLNodePtr anno_node = node.FirstNode("annotation");
+			XMLNodeHandle anno_node = node.FirstNode("annotation");
 			if (anno_node)
 			{
 				annotations_ = MakeSharedPtr<std::remove_reference<decltype(*annotations_)>::type>();
@@ -5924,7 +5936,7 @@ namespace KlayGE
 		}
 
 		{
-			XMLNodePtr macro_node = node.FirstNode("macro");
+			XMLNodeHandle macro_node = node.FirstNode("macro");
 			if (macro_node)
 			{
 				macros_ = MakeSharedPtr<std::remove_reference<decltype(*macros_)>::type>();
@@ -6001,7 +6013,7 @@ namespace KlayGE
 			}
 		
 			uint32_t index = 0;
-			for (XMLNodePtr pass_node = node.FirstNode("pass"); pass_node; pass_node = pass_node->NextSibling("pass"), ++ index)
+			for (XMLNodeHandle pass_node = node.FirstNode("pass"); pass_node; pass_node = pass_node->NextSibling("pass"), ++ index)
 			{
 				RenderPassPtr pass = MakeSharedPtr<RenderPass>();
 				passes_.push_back(pass);
@@ -6016,7 +6028,7 @@ namespace KlayGE
 
 				is_validate_ &= pass->Validate();
 
-				for (XMLNodePtr state_node = pass_node->FirstNode("state"); state_node; state_node = state_node->NextSibling("state"))
+				for (XMLNodeHandle state_node = pass_node->FirstNode("state"); state_node; state_node = state_node->NextSibling("state"))
 				{
 					++ weight_;
 
@@ -6209,13 +6221,13 @@ namespace KlayGE
 
 #if KLAYGE_IS_DEV_PLATFORM
 	void RenderPass::Load(
-		RenderEffect& effect, XMLNode const& node, uint32_t tech_index, uint32_t pass_index, RenderPass const* inherit_pass)
+		RenderEffect& effect, XMLNodeHandle node, uint32_t tech_index, uint32_t pass_index, RenderPass const* inherit_pass)
 	{
 		name_ = std::string(node.Attrib("name")->ValueString());
 		name_hash_ = HashRange(name_.begin(), name_.end());
 
 		{
-			XMLNodePtr anno_node = node.FirstNode("annotation");
+			XMLNodeHandle anno_node = node.FirstNode("annotation");
 			if (anno_node)
 			{
 				annotations_ = MakeSharedPtr<std::remove_reference<decltype(*annotations_)>::type>();
@@ -6238,7 +6250,7 @@ namespace KlayGE
 		}
 
 		{
-			XMLNodePtr macro_node = node.FirstNode("macro");
+			XMLNodeHandle macro_node = node.FirstNode("macro");
 			if (macro_node)
 			{
 				macros_ = MakeSharedPtr<std::remove_reference<decltype(*macros_)>::type>();
@@ -6307,12 +6319,12 @@ namespace KlayGE
 			shader_desc_ids_ = inherit_pass->shader_desc_ids_;
 		}
 
-		for (XMLNodePtr state_node = node.FirstNode("state"); state_node; state_node = state_node->NextSibling("state"))
+		for (XMLNodeHandle state_node = node.FirstNode("state"); state_node; state_node = state_node->NextSibling("state"))
 		{
 			std::string_view const name = state_node->Attrib("name")->ValueString();
 			size_t const state_name_hash = HashRange(name.begin(), name.end());
 
-			XMLAttributePtr const value_attr = state_node->Attrib("value");
+			XMLAttributeHandle const value_attr = state_node->Attrib("value");
 			std::string_view value_str;
 			if (value_attr)
 			{
@@ -6415,7 +6427,7 @@ namespace KlayGE
 			}
 			else if (CT_HASH("blend_factor") == state_name_hash)
 			{
-				XMLAttributePtr attr = state_node->Attrib("r");
+				XMLAttributeHandle attr = state_node->Attrib("r");
 				if (attr)
 				{
 					bs_desc.blend_factor.r() = attr->ValueFloat();
@@ -6554,16 +6566,16 @@ namespace KlayGE
 
 				if ((ShaderStage::Vertex == stage) || (ShaderStage::Geometry == stage))
 				{
-					XMLNodePtr so_node = state_node->FirstNode("stream_output");
+					XMLNodeHandle so_node = state_node->FirstNode("stream_output");
 					if (so_node)
 					{
-						for (XMLNodePtr entry_node = so_node->FirstNode("entry"); entry_node; entry_node = entry_node->NextSibling("entry"))
+						for (XMLNodeHandle entry_node = so_node->FirstNode("entry"); entry_node; entry_node = entry_node->NextSibling("entry"))
 						{
 							ShaderDesc::StreamOutputDecl decl;
 
 							std::string_view const usage_str = entry_node->Attrib("usage")->ValueString();
 							size_t const usage_str_hash = HashRange(usage_str.begin(), usage_str.end());
-							XMLAttributePtr attr = entry_node->Attrib("usage_index");
+							XMLAttributeHandle attr = entry_node->Attrib("usage_index");
 							if (attr)
 							{
 								decl.usage_index = static_cast<uint8_t>(attr->ValueInt());
@@ -7172,7 +7184,7 @@ namespace KlayGE
 
 
 #if KLAYGE_IS_DEV_PLATFORM
-	void RenderEffectParameter::Load(RenderEffect const& effect, XMLNode const& node)
+	void RenderEffectParameter::Load(RenderEffect const& effect, XMLNodeHandle node)
 	{
 		auto type_name = node.Attrib("type")->ValueString();
 		auto* struct_type = effect.StructTypeByName(type_name);
@@ -7189,7 +7201,7 @@ namespace KlayGE
 		name_->first = std::string(node.Attrib("name")->ValueString());
 		name_->second = HashRange(name_->first.begin(), name_->first.end());
 
-		XMLAttributePtr attr = node.Attrib("semantic");
+		XMLAttributeHandle attr = node.Attrib("semantic");
 		if (attr)
 		{
 			semantic_ = MakeSharedPtr<std::remove_reference<decltype(*semantic_)>::type>();
@@ -7215,7 +7227,7 @@ namespace KlayGE
 		var_ = LoadVariable(effect, node, type_, as);
 
 		{
-			XMLNodePtr anno_node = node.FirstNode("annotation");
+			XMLNodeHandle anno_node = node.FirstNode("annotation");
 			if (anno_node)
 			{
 				annotations_ = MakeSharedPtr<std::remove_reference<decltype(*annotations_)>::type>();
@@ -7433,10 +7445,10 @@ namespace KlayGE
 
 
 #if KLAYGE_IS_DEV_PLATFORM
-	void RenderShaderFragment::Load(XMLNode const& node)
+	void RenderShaderFragment::Load(XMLNodeHandle node)
 	{
 		stage_ = ShaderStage::NumStages;
-		XMLAttributePtr attr = node.Attrib("type");
+		XMLAttributeHandle attr = node.Attrib("type");
 		if (attr)
 		{
 			std::string_view const type_str = attr->ValueString();
@@ -7473,7 +7485,7 @@ namespace KlayGE
 		if (attr)
 		{
 			uint8_t minor_ver = 0;
-			XMLAttributePtr minor_attr = node.Attrib("minor_version");
+			XMLAttributeHandle minor_attr = node.Attrib("minor_version");
 			if (minor_attr)
 			{
 				minor_ver = static_cast<uint8_t>(minor_attr->ValueInt());
@@ -7489,7 +7501,7 @@ namespace KlayGE
 			}
 		}
 
-		for (XMLNodePtr shader_text_node = node.FirstNode(); shader_text_node; shader_text_node = shader_text_node->NextSibling())
+		for (XMLNodeHandle shader_text_node = node.FirstNode(); shader_text_node; shader_text_node = shader_text_node->NextSibling())
 		{
 			if ((XNT_Comment == shader_text_node->Type()) || (XNT_CData == shader_text_node->Type()))
 			{
@@ -7530,9 +7542,9 @@ namespace KlayGE
 
 
 #if KLAYGE_IS_DEV_PLATFORM
-	void RenderShaderGraphNode::Load(XMLNode const& node)
+	void RenderShaderGraphNode::Load(XMLNodeHandle node)
 	{
-		XMLAttributePtr attr = node.Attrib("name");
+		XMLAttributeHandle attr = node.Attrib("name");
 		BOOST_ASSERT(attr);
 
 		if (!name_.empty())
@@ -7554,10 +7566,10 @@ namespace KlayGE
 				return_type_ = "void";
 			}
 
-			for (XMLNodePtr param_node = node.FirstNode(); param_node; param_node = param_node->NextSibling())
+			for (XMLNodeHandle param_node = node.FirstNode(); param_node; param_node = param_node->NextSibling())
 			{
-				XMLAttributePtr type_attr = param_node->Attrib("type");
-				XMLAttributePtr name_attr = param_node->Attrib("name");
+				XMLAttributeHandle type_attr = param_node->Attrib("type");
+				XMLAttributeHandle name_attr = param_node->Attrib("name");
 				BOOST_ASSERT(type_attr);
 				BOOST_ASSERT(name_attr);
 
@@ -8148,13 +8160,14 @@ namespace KlayGE
 		return ResLoader::Instance().SyncQueryT<RenderEffect>(MakeSharedPtr<EffectLoadingDesc>(effect_names));
 	}
 
-	RenderEffectPtr ASyncLoadRenderEffect(std::string_view effect_name)
+	RenderEffectPtr ASyncLoadRenderEffect(std::string_view effect_name, ResLoadingPriority priority)
 	{
-		return ResLoader::Instance().ASyncQueryT<RenderEffect>(MakeSharedPtr<EffectLoadingDesc>(MakeSpan<1>(std::string(effect_name))));
+		return ResLoader::Instance().ASyncQueryT<RenderEffect>(
+			MakeSharedPtr<EffectLoadingDesc>(MakeSpan<1>(std::string(effect_name))), priority);
 	}
 
-	RenderEffectPtr ASyncLoadRenderEffects(std::span<std::string const> effect_names)
+	RenderEffectPtr ASyncLoadRenderEffects(std::span<std::string const> effect_names, ResLoadingPriority priority)
 	{
-		return ResLoader::Instance().ASyncQueryT<RenderEffect>(MakeSharedPtr<EffectLoadingDesc>(effect_names));
+		return ResLoader::Instance().ASyncQueryT<RenderEffect>(MakeSharedPtr<EffectLoadingDesc>(effect_names), priority);
 	}
 }
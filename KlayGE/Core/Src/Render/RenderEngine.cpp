@@ -40,6 +40,7 @@
 
 #include <KFL/CXX2a/format.hpp>
 #include <KFL/ErrorHandling.hpp>
+#include <KFL/FrameAllocator.hpp>
 #include <KFL/Util.hpp>
 #include <KFL/Math.hpp>
 #include <KlayGE/Context.hpp>
@@ -113,6 +114,15 @@ namespace KlayGE
 
 	void RenderEngine::EndFrame()
 	{
+		// The temporaries of this frame are all gone
+		auto& arena = frame_arena::thread_instance();
+		size_t const high_water_mark = arena.high_water_mark();
+		arena.reset();
+		if (arena.high_water_mark() > high_water_mark)
+		{
+			LogDebug() << "Frame arena high-water mark: " << arena.high_water_mark() << " bytes, capacity "
+				<< arena.capacity() << " bytes" << std::endl;
+		}
 	}
 
 	// Ⱦ
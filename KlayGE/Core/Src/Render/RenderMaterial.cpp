@@ -411,6 +411,13 @@ namespace
 			return true;
 		}
 
+		size_t Hash() const override
+		{
+			size_t seed = HashRange(mtl_desc_.res_name.begin(), mtl_desc_.res_name.end());
+			HashCombine(seed, this->Type());
+			return seed;
+		}
+
 		bool Match(ResLoadingDesc const & rhs) const override
 		{
 			if (this->Type() == rhs.Type())
@@ -1055,9 +1062,10 @@ namespace KlayGE
 		return ResLoader::Instance().SyncQueryT<RenderMaterial>(MakeSharedPtr<RenderMaterialLoadingDesc>(mtlml_name));
 	}
 
-	RenderMaterialPtr ASyncLoadRenderMaterial(std::string_view mtlml_name)
+	RenderMaterialPtr ASyncLoadRenderMaterial(std::string_view mtlml_name, ResLoadingPriority priority)
 	{
 		// TODO: Make it really async
+		KFL_UNUSED(priority);
 		return ResLoader::Instance().SyncQueryT<RenderMaterial>(MakeSharedPtr<RenderMaterialLoadingDesc>(mtlml_name));
 	}
 
@@ -1228,11 +1236,14 @@ namespace KlayGE
 			root->AppendNode(two_sided_node);
 		}
 
-		std::ofstream ofs(std::string(mtlml_name).c_str());
+		std::string file_name = mtlml_name;
+		std::ofstream ofs(file_name.c_str());
 		if (!ofs)
 		{
-			ofs.open((ResLoader::Instance().LocalFolder() + mtlml_name).c_str());
+			file_name = ResLoader::Instance().LocalFolder() + mtlml_name;
+			ofs.open(file_name.c_str());
 		}
 		doc.Print(ofs);
+		ResLoader::Instance().NotifyFileWritten(file_name);
 	}
 } // namespace KlayGE
@@ -32,8 +32,25 @@
 #include <KlayGE/RenderMaterial.hpp>
 #include <KlayGE/DeferredRenderingLayer.hpp>
 
+#include <algorithm>
+
 #include <KlayGE/Renderable.hpp>
 
+namespace
+{
+	using namespace KlayGE;
+
+	VertexElement const auto_inst_format[] = {
+		VertexElement(VEU_TextureCoord, 1, EF_ABGR32F),
+		VertexElement(VEU_TextureCoord, 2, EF_ABGR32F),
+		VertexElement(VEU_TextureCoord, 3, EF_ABGR32F),
+		VertexElement(VEU_TextureCoord, 4, EF_ABGR32F),
+		VertexElement(VEU_TextureCoord, 5, EF_ABGR32F),
+		VertexElement(VEU_TextureCoord, 6, EF_ABGR32F)
+	};
+	uint32_t constexpr AUTO_INST_SIZE = sizeof(float4) * 6;
+}
+
 namespace KlayGE
 {
 	Renderable::Renderable()
@@ -144,7 +161,7 @@ namespace KlayGE
 				visible_in_cameras_ = 0;
 				for (uint32_t i = 0; i < num_cameras; ++i)
 				{
-					if ((curr_node_ == nullptr) || (curr_node_->VisibleMark(i) != BoundOverlap::No))
+					if (this->VisibleInCamera(i))
 					{
 						Camera const& camera = *viewport.Camera(i);
 
@@ -296,6 +313,33 @@ namespace KlayGE
 				re.Render(effect, tech, layout);
 				this->OnRenderEnd();
 			}
+			else if (auto_instancing_)
+			{
+				// Everything except the transforms is shared, so the first instance provides it. The cameras come from all the
+				// instances, see VisibleInCamera.
+				this->BindSceneNode(instances_[0]);
+
+				this->OnRenderBegin();
+
+				bool const auto_set_camera_instances = (re.NumCameraInstances() == 0);
+				if (auto_set_camera_instances)
+				{
+					re.NumCameraInstances(visible_in_cameras_);
+				}
+				uint32_t num_camera_instances = auto_set_camera_instances ? visible_in_cameras_ : re.NumCameraInstances();
+				if (num_camera_instances == 0)
+				{
+					// The render engine draws 0 camera instances as all the cameras of the viewport
+					num_camera_instances = re.CurFrameBuffer()->Viewport()->NumCameras();
+				}
+				re.Render(effect, tech, this->UpdateAutoInstanceLayout(lod, num_camera_instances));
+				if (auto_set_camera_instances)
+				{
+					re.NumCameraInstances(0);
+				}
+
+				this->OnRenderEnd();
+			}
 			else
 			{
 				for (auto const * node : instances_)
@@ -378,6 +422,93 @@ namespace KlayGE
 		}
 	}
 
+	void Renderable::AutoInstancing(bool auto_inst)
+	{
+		auto_instancing_ = auto_inst;
+		if (!auto_inst)
+		{
+			auto_inst_rls_.clear();
+			auto_inst_stream_.reset();
+		}
+	}
+
+	// Packs the transforms of all instances into the auto instance stream, and returns the layout that draws them. The layout
+	// is made again only when the geometry of the lod changed.
+	RenderLayout const & Renderable::UpdateAutoInstanceLayout(uint32_t lod, uint32_t num_camera_instances)
+	{
+		RenderFactory& rf = Context::Instance().RenderFactoryInstance();
+
+		uint32_t const num_instances = static_cast<uint32_t>(instances_.size());
+		if (!auto_inst_stream_ || (auto_inst_stream_->Size() < num_instances * AUTO_INST_SIZE))
+		{
+			auto_inst_stream_ = rf.MakeVertexBuffer(BU_Dynamic, EAH_CPU_Write | EAH_GPU_Read,
+				num_instances * AUTO_INST_SIZE, nullptr);
+			auto_inst_rls_.clear();
+		}
+
+		{
+			GraphicsBuffer::Mapper mapper(*auto_inst_stream_, BA_Write_Only);
+			float4* dst = mapper.Pointer<float4>();
+			for (auto const * node : instances_)
+			{
+				float4x4 const mat_t = MathLib::transpose(node->TransformToWorld());
+				float4x4 const prev_mat_t = MathLib::transpose(node->PrevTransformToWorld());
+				dst[0] = mat_t.Row(0);
+				dst[1] = mat_t.Row(1);
+				dst[2] = mat_t.Row(2);
+				dst[3] = prev_mat_t.Row(0);
+				dst[4] = prev_mat_t.Row(1);
+				dst[5] = prev_mat_t.Row(2);
+				dst += 6;
+			}
+		}
+
+		RenderLayout const & src = this->GetRenderLayout(lod);
+		auto_inst_rls_.resize(this->NumLods());
+		auto& rl = auto_inst_rls_[lod];
+
+		bool same_geometry = rl && (rl->TopologyType() == src.TopologyType()) && (rl->NumVertexStreams() == src.NumVertexStreams()) &&
+							 (rl->NumVertices() == src.NumVertices()) && (rl->NumIndices() == src.NumIndices()) &&
+							 (rl->StartVertexLocation() == src.StartVertexLocation()) &&
+							 (rl->StartIndexLocation() == src.StartIndexLocation());
+		for (uint32_t i = 0; same_geometry && (i < src.NumVertexStreams()); ++ i)
+		{
+			same_geometry = (rl->GetVertexStream(i) == src.GetVertexStream(i));
+		}
+		if (same_geometry && src.UseIndices())
+		{
+			same_geometry = (rl->GetIndexStream() == src.GetIndexStream());
+		}
+
+		if (!same_geometry)
+		{
+			rl = rf.MakeRenderLayout();
+			rl->TopologyType(src.TopologyType());
+			for (uint32_t i = 0; i < src.NumVertexStreams(); ++ i)
+			{
+				rl->BindVertexStream(src.GetVertexStream(i), src.VertexStreamFormat(i));
+			}
+			rl->NumVertices(src.NumVertices());
+			rl->StartVertexLocation(src.StartVertexLocation());
+			if (src.UseIndices())
+			{
+				rl->BindIndexStream(src.GetIndexStream(), src.IndexStreamFormat());
+				rl->NumIndices(src.NumIndices());
+				rl->StartIndexLocation(src.StartIndexLocation());
+			}
+			rl->InstanceStream(auto_inst_stream_);
+		}
+
+		// Each instance is drawn once for every camera, the same as the per node draws
+		rl->BindVertexStream(auto_inst_stream_, auto_inst_format, RenderLayout::ST_Instance, num_camera_instances);
+		for (uint32_t i = 0; i < rl->NumVertexStreams(); ++ i)
+		{
+			rl->VertexStreamFrequencyDivider(i, RenderLayout::ST_Geometry, num_instances);
+		}
+
+		return *rl;
+	}
+
 	void Renderable::ModelMatrix(float4x4 const & mat)
 	{
 		if (memcmp(&model_mat_, &mat, sizeof(mat)) != 0)
@@ -405,6 +536,19 @@ namespace KlayGE
 		}
 	}
 
+	bool Renderable::VisibleInCamera(uint32_t camera_index) const
+	{
+		if (auto_instancing_ && !instances_.empty())
+		{
+			return std::any_of(instances_.begin(), instances_.end(),
+				[camera_index](SceneNode const * node) { return node->VisibleMark(camera_index) != BoundOverlap::No; });
+		}
+		else
+		{
+			return (curr_node_ == nullptr) || (curr_node_->VisibleMark(camera_index) != BoundOverlap::No);
+		}
+	}
+
 	void Renderable::BindSceneNode(SceneNode const * node)
 	{
 		curr_node_ = node;
@@ -1312,6 +1312,14 @@ namespace
 			return true;
 		}
 
+		size_t Hash() const override
+		{
+			size_t seed = HashRange(tex_desc_.res_name.begin(), tex_desc_.res_name.end());
+			HashCombine(seed, tex_desc_.access_hint);
+			HashCombine(seed, this->Type());
+			return seed;
+		}
+
 		bool Match(ResLoadingDesc const & rhs) const override
 		{
 			if (this->Type() == rhs.Type())
@@ -2171,13 +2179,40 @@ namespace KlayGE
 			}
 		}
 
+		// A mapped file is referenced in place, the software texture makes its own copy anyway
+		std::span<uint8_t const> const tex_data = tex_res->Data();
 		std::vector<size_t> base;
+		std::vector<bool> in_place;
+		auto read_image = [&tex_res, &tex_data, &data_block, &base, &in_place](size_t index, uint32_t image_size)
+		{
+			if (!tex_data.empty())
+			{
+				int64_t const offset = tex_res->tellg();
+				if ((offset >= 0) && (static_cast<uint64_t>(offset) + image_size <= tex_data.size()))
+				{
+					base[index] = static_cast<size_t>(offset);
+					in_place[index] = true;
+
+					tex_res->seekg(image_size, std::ios_base::cur);
+					return;
+				}
+			}
+
+			// Images beyond the end of a truncated file end up with a short read, mapped or not
+			base[index] = data_block.size();
+			data_block.resize(base[index] + image_size);
+
+			tex_res->read(&data_block[base[index]], static_cast<std::streamsize>(image_size));
+			BOOST_ASSERT(tex_res->gcount() == static_cast<int>(image_size));
+		};
+
 		switch (type)
 		{
 		case Texture::TT_1D:
 			{
 				init_data.resize(array_size * num_mipmaps);
 				base.resize(array_size * num_mipmaps);
+				in_place.resize(array_size * num_mipmaps);
 				for (uint32_t array_index = 0; array_index < array_size; ++ array_index)
 				{
 					uint32_t the_width = width;
@@ -2195,13 +2230,10 @@ namespace KlayGE
 							image_size = (padding ? ((the_width + 3) & ~3) : the_width) * fmt_size;
 						}
 
-						base[index] = data_block.size();
-						data_block.resize(base[index] + image_size);
 						init_data[index].row_pitch = image_size;
 						init_data[index].slice_pitch = image_size;
 
-						tex_res->read(&data_block[base[index]], static_cast<std::streamsize>(image_size));
-						BOOST_ASSERT(tex_res->gcount() == static_cast<int>(image_size));
+						read_image(index, image_size);
 
 						the_width = std::max<uint32_t>(the_width / 2, 1);
 					}
@@ -2213,6 +2245,7 @@ namespace KlayGE
 			{
 				init_data.resize(array_size * num_mipmaps);
 				base.resize(array_size * num_mipmaps);
+				in_place.resize(array_size * num_mipmaps);
 				for (uint32_t array_index = 0; array_index < array_size; ++ array_index)
 				{
 					uint32_t the_width = width;
@@ -2225,23 +2258,17 @@ namespace KlayGE
 							uint32_t const block_size = NumFormatBytes(format) * 4;
 							uint32_t image_size = ((the_width + 3) / 4) * ((the_height + 3) / 4) * block_size;
 
-							base[index] = data_block.size();
-							data_block.resize(base[index] + image_size);
 							init_data[index].row_pitch = (the_width + 3) / 4 * block_size;
 							init_data[index].slice_pitch = image_size;
 
-							tex_res->read(&data_block[base[index]], static_cast<std::streamsize>(image_size));
-							BOOST_ASSERT(tex_res->gcount() == static_cast<int>(image_size));
+							read_image(index, image_size);
 						}
 						else
 						{
 							init_data[index].row_pitch = (padding ? ((the_width + 3) & ~3) : the_width) * fmt_size;
 							init_data[index].slice_pitch = init_data[index].row_pitch * the_height;
-							base[index] = data_block.size();
-							data_block.resize(base[index] + init_data[index].slice_pitch);
 
-							tex_res->read(&data_block[base[index]], static_cast<std::streamsize>(init_data[index].slice_pitch));
-							BOOST_ASSERT(tex_res->gcount() == static_cast<int>(init_data[index].slice_pitch));
+							read_image(index, init_data[index].slice_pitch);
 						}
 
 						the_width = std::max<uint32_t>(the_width / 2, 1);
@@ -2255,6 +2282,7 @@ namespace KlayGE
 			{
 				init_data.resize(array_size * num_mipmaps);
 				base.resize(array_size * num_mipmaps);
+				in_place.resize(array_size * num_mipmaps);
 				for (uint32_t array_index = 0; array_index < array_size; ++ array_index)
 				{
 					uint32_t the_width = width;
@@ -2268,23 +2296,17 @@ namespace KlayGE
 							uint32_t const block_size = NumFormatBytes(format) * 4;
 							uint32_t image_size = ((the_width + 3) / 4) * ((the_height + 3) / 4) * the_depth * block_size;
 
-							base[index] = data_block.size();
-							data_block.resize(base[index] + image_size);
 							init_data[index].row_pitch = (the_width + 3) / 4 * block_size;
 							init_data[index].slice_pitch = ((the_width + 3) / 4) * ((the_height + 3) / 4) * block_size;
 
-							tex_res->read(&data_block[base[index]], static_cast<std::streamsize>(image_size));
-							BOOST_ASSERT(tex_res->gcount() == static_cast<int>(image_size));
+							read_image(index, image_size);
 						}
 						else
 						{
 							init_data[index].row_pitch = (padding ? ((the_width + 3) & ~3) : the_width) * fmt_size;
 							init_data[index].slice_pitch = init_data[index].row_pitch * the_height;
-							base[index] = data_block.size();
-							data_block.resize(base[index] + init_data[index].slice_pitch * the_depth);
 
-							tex_res->read(&data_block[base[index]], static_cast<std::streamsize>(init_data[index].slice_pitch * the_depth));
-							BOOST_ASSERT(tex_res->gcount() == static_cast<int>(init_data[index].slice_pitch * the_depth));
+							read_image(index, init_data[index].slice_pitch * the_depth);
 						}
 
 						the_width = std::max<uint32_t>(the_width / 2, 1);
@@ -2299,6 +2321,7 @@ namespace KlayGE
 			{
 				init_data.resize(array_size * 6 * num_mipmaps);
 				base.resize(array_size * 6 * num_mipmaps);
+				in_place.resize(array_size * 6 * num_mipmaps);
 				for (uint32_t array_index = 0; array_index < array_size; ++ array_index)
 				{
 					for (uint32_t face = Texture::CF_Positive_X; face <= Texture::CF_Negative_Z; ++ face)
@@ -2313,23 +2336,17 @@ namespace KlayGE
 								uint32_t const block_size = NumFormatBytes(format) * 4;
 								uint32_t image_size = ((the_width + 3) / 4) * ((the_height + 3) / 4) * block_size;
 
-								base[index] = data_block.size();
-								data_block.resize(base[index] + image_size);
 								init_data[index].row_pitch = (the_width + 3) / 4 * block_size;
 								init_data[index].slice_pitch = image_size;
 
-								tex_res->read(&data_block[base[index]], static_cast<std::streamsize>(image_size));
-								BOOST_ASSERT(tex_res->gcount() == static_cast<int>(image_size));
+								read_image(index, image_size);
 							}
 							else
 							{
 								init_data[index].row_pitch = (padding ? ((the_width + 3) & ~3) : the_width) * fmt_size;
 								init_data[index].slice_pitch = init_data[index].row_pitch * the_width;
-								base[index] = data_block.size();
-								data_block.resize(base[index] + init_data[index].slice_pitch);
 
-								tex_res->read(&data_block[base[index]], static_cast<std::streamsize>(init_data[index].slice_pitch));
-								BOOST_ASSERT(tex_res->gcount() == static_cast<int>(init_data[index].slice_pitch));
+								read_image(index, init_data[index].slice_pitch);
 							}
 
 							the_width = std::max<uint32_t>(the_width / 2, 1);
@@ -2343,7 +2360,7 @@ namespace KlayGE
 
 		for (size_t i = 0; i < base.size(); ++ i)
 		{
-			init_data[i].data = &data_block[base[i]];
+			init_data[i].data = in_place[i] ? &tex_data[base[i]] : &data_block[base[i]];
 		}
 
 		auto ret = MakeSharedPtr<SoftwareTexture>(type, width, height, depth,
@@ -2357,19 +2374,21 @@ namespace KlayGE
 		return ResLoader::Instance().SyncQueryT<Texture>(MakeSharedPtr<TextureLoadingDesc>(tex_name, access_hint));
 	}
 
-	TexturePtr ASyncLoadTexture(std::string_view tex_name, uint32_t access_hint)
+	TexturePtr ASyncLoadTexture(std::string_view tex_name, uint32_t access_hint, ResLoadingPriority priority)
 	{
-		return ResLoader::Instance().ASyncQueryT<Texture>(MakeSharedPtr<TextureLoadingDesc>(tex_name, access_hint));
+		return ResLoader::Instance().ASyncQueryT<Texture>(MakeSharedPtr<TextureLoadingDesc>(tex_name, access_hint), priority);
 	}
 
 	void SaveTexture(std::string const & tex_name, Texture::TextureType type,
 		uint32_t width, uint32_t height, uint32_t depth, uint32_t numMipMaps, uint32_t array_size,
 		ElementFormat format, std::span<ElementInitData const> init_data)
 	{
-		std::ofstream file(tex_name.c_str(), std::ios_base::binary);
+		std::string file_name = tex_name;
+		std::ofstream file(file_name.c_str(), std::ios_base::binary);
 		if (!file)
 		{
-			file.open((ResLoader::Instance().LocalFolder() + tex_name).c_str(), std::ios_base::binary);
+			file_name = ResLoader::Instance().LocalFolder() + tex_name;
+			file.open(file_name.c_str(), std::ios_base::binary);
 		}
 
 		uint32_t magic = Native2LE(MakeFourCC<'D', 'D', 'S', ' '>::value);
@@ -2884,6 +2903,8 @@ namespace KlayGE
 			}
 			break;
 		}
+
+		ResLoader::Instance().NotifyFileWritten(file_name);
 	}
 
 	// DDSļ
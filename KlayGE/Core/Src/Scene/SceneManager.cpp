@@ -52,13 +52,82 @@
 #include <KlayGE/InputFactory.hpp>
 #include <KlayGE/FrameBuffer.hpp>
 #include <KlayGE/DeferredRenderingLayer.hpp>
+#include <KFL/FrameAllocator.hpp>
 #include <KFL/Hash.hpp>
+#include <KFL/TaskScheduler.hpp>
+#include <KFL/SIMDMath.hpp>
+#include <KlayGE/SoftwareOcclusionCuller.hpp>
 
 #include <map>
 #include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <thread>
 
 #include <KlayGE/SceneManager.hpp>
 
+namespace
+{
+	// Ranges smaller than this are not worth splitting into more tasks of the task scheduler
+	uint32_t constexpr MIN_NODES_PER_CULLING_CHUNK = 512;
+
+	uint32_t constexpr MAX_CACHED_RENDER_TECHS = 4096;
+
+	// Cameras that are used again, e.g. each cascade of a shadow map, keep their own cache
+	uint32_t constexpr MAX_VISIBILITY_CACHES = 16;
+
+	// Subtrees are grouped until a job has at least this many nodes
+	uint32_t constexpr MIN_NODES_PER_SUB_UPDATE_JOB = 64;
+	// Steps the update thread runs back to back to catch up. Older missed steps are dropped.
+	uint32_t constexpr MAX_SUB_UPDATE_CATCH_UP_STEPS = 4;
+
+	// Maps a float to an uint32_t with the same ordering
+	uint32_t OrderedFloatBits(float f)
+	{
+		uint32_t bits;
+		std::memcpy(&bits, &f, sizeof(bits));
+		return (bits & 0x80000000U) ? ~bits : (bits | 0x80000000U);
+	}
+
+	// Stable LSD radix sort on the lowest num_key_bits bits of T::key. Digits that are the same for all items are skipped.
+	template <typename T>
+	void RadixSortByKey(std::vector<T>& items, std::vector<T>& buff, uint32_t num_key_bits)
+	{
+		if (items.size() <= 1)
+		{
+			return;
+		}
+
+		buff.resize(items.size());
+		for (uint32_t shift = 0; shift < num_key_bits; shift += 8)
+		{
+			std::array<uint32_t, 256> offsets{};
+			for (auto const& item : items)
+			{
+				++offsets[(item.key >> shift) & 0xFF];
+			}
+			if (offsets[(items[0].key >> shift) & 0xFF] == items.size())
+			{
+				continue;
+			}
+
+			uint32_t sum = 0;
+			for (auto& offset : offsets)
+			{
+				uint32_t const count = offset;
+				offset = sum;
+				sum += count;
+			}
+			for (auto const& item : items)
+			{
+				buff[offsets[(item.key >> shift) & 0xFF]++] = item;
+			}
+			items.swap(buff);
+		}
+	}
+}
+
 namespace KlayGE
 {
 	// 캯
@@ -73,6 +142,8 @@ namespace KlayGE
 			num_draw_calls_(0), num_dispatch_calls_(0),
 			quit_(false), deferred_mode_(false)
 	{
+		occlusion_culler_ = MakeUniquePtr<SoftwareOcclusionCuller>();
+
 		scene_root_.FillVisibleMark(BoundOverlap::Partial);
 		overlay_root_.FillVisibleMark(BoundOverlap::Partial);
 	}
@@ -103,6 +174,14 @@ namespace KlayGE
 	void SceneManager::SmallObjectThreshold(float area)
 	{
 		small_obj_threshold_ = area;
+		visibility_caches_.clear();
+	}
+
+	void SceneManager::VisibilityCacheThreshold(float move_dist, float rotate_angle)
+	{
+		cache_move_threshold_ = move_dist;
+		cache_cos_rotate_threshold_ = (rotate_angle > 0) ? MathLib::cos(rotate_angle) : 1.0f;
+		visibility_caches_.clear();
 	}
 
 	void SceneManager::SceneUpdateElapse(float elapse)
@@ -110,66 +189,654 @@ namespace KlayGE
 		update_elapse_ = elapse;
 	}
 
+	void SceneManager::ParallelSubThreadUpdate(bool parallel)
+	{
+		std::lock_guard<std::mutex> lock(update_mutex_);
+		parallel_sub_thread_update_ = parallel;
+		sub_update_jobs_dirty_ = true;
+	}
+
+	bool SceneManager::ParallelSubThreadUpdate() const
+	{
+		return parallel_sub_thread_update_;
+	}
+
+	// 0 means using all hardware threads
+	void SceneManager::NumCullingThreads(uint32_t num)
+	{
+		if (0 == num)
+		{
+			num = std::max(std::thread::hardware_concurrency(), 1U);
+		}
+		num_culling_threads_ = num;
+	}
+
+	uint32_t SceneManager::NumCullingThreads() const
+	{
+		return num_culling_threads_;
+	}
+
+	void SceneManager::OcclusionCulling(bool enable)
+	{
+		occlusion_culling_ = enable;
+	}
+
+	bool SceneManager::OcclusionCulling() const
+	{
+		return occlusion_culling_;
+	}
+
+	SoftwareOcclusionCuller& SceneManager::OcclusionCuller()
+	{
+		return *occlusion_culler_;
+	}
+
 	// ü
 	/////////////////////////////////////////////////////////////////////////////////
 	void SceneManager::ClipScene()
 	{
+		if ((num_culling_threads_ > 1) && (node_arrays_.nodes.size() >= MIN_NODES_PER_CULLING_CHUNK * 2))
+		{
+			this->ParallelClipScene();
+			return;
+		}
+
 		auto& re = Context::Instance().RenderFactoryInstance().RenderEngineInstance();
 		auto const& viewport = *re.CurFrameBuffer()->Viewport();
 		uint32_t const num_cameras = viewport.NumCameras();
 
-		for (auto* sn : all_scene_nodes_)
+		this->AcquireVisibilityCaches(viewport);
+		this->RefreshVisibilityCaches(0, node_arrays_.nodes.size(), num_cameras);
+
+		auto& arrays = node_arrays_;
+		for (size_t n = 0; n < arrays.nodes.size(); ++n)
 		{
-			auto& node = *sn;
-			node.FillVisibleMark(BoundOverlap::No);
-			if (node.Visible())
+			auto& marks = arrays.visible_marks[n];
+			marks.fill(BoundOverlap::No);
+
+			uint32_t const attr = arrays.attribs[n];
+			if (!(attr & SceneNode::SOA_Invisible))
 			{
-				if (node.Updated())
+				if (arrays.flags[n] & SceneNodeArrays::F_Updated)
 				{
-					uint32_t const attr = node.Attrib();
-
+					uint32_t const parent = arrays.parents[n];
 					for (uint32_t i = 0; i < num_cameras; ++i)
 					{
-						auto const& camera = *viewport.Camera(i);
-						float4x4 const& view_proj = camera_view_projs_[i];
-
-						auto visible = this->VisibleTestFromParent(node, i);
-						if (BoundOverlap::Partial == visible)
+						auto visible = (parent == SceneNode::InvalidHandle) ? BoundOverlap::Partial : arrays.visible_marks[parent][i];
+						if (visible != BoundOverlap::No)
 						{
 							if (attr & SceneNode::SOA_Cullable)
 							{
-								visible = (small_obj_threshold_ <= 0) ||
-												  ((MathLib::ortho_area(camera.ForwardVec(), node.PosBoundWS()) > small_obj_threshold_) &&
-													  (MathLib::perspective_area(camera.EyePos(), view_proj, node.PosBoundWS()) >
-														  small_obj_threshold_))
-											  ? BoundOverlap::Yes
-											  : BoundOverlap::No;
+								auto const& result = curr_visibility_caches_[i]->results[n];
+								if (result.small_obj)
+								{
+									visible = BoundOverlap::No;
+								}
+								else if (BoundOverlap::Partial == visible)
+								{
+									visible = result.frustum;
+								}
 							}
 							else
 							{
 								visible = BoundOverlap::Yes;
 							}
+						}
+
+						marks[i] = visible;
+					}
+				}
+				else
+				{
+					for (uint32_t i = 0; i < num_cameras; ++i)
+					{
+						marks[i] = BoundOverlap::Yes;
+					}
+				}
+			}
+		}
+
+		this->WriteBackVisibleMarks();
+	}
 
-							if (!camera.OmniDirectionalMode() && (attr & SceneNode::SOA_Cullable) && (BoundOverlap::Yes == visible))
+	// Same result as the serial path of ClipScene. The per-node tests don't depend on the parent, so they run in parallel on
+	// chunks of the node arrays. Only the cheap merge with the parent's marks is serial, in pre-order so parents come first.
+	void SceneManager::ParallelClipScene()
+	{
+		auto& re = Context::Instance().RenderFactoryInstance().RenderEngineInstance();
+		auto const& viewport = *re.CurFrameBuffer()->Viewport();
+		uint32_t const num_cameras = viewport.NumCameras();
+
+		this->AcquireVisibilityCaches(viewport);
+
+		auto& arrays = node_arrays_;
+		size_t const num_nodes = arrays.nodes.size();
+		node_culling_results_.resize(num_nodes);
+		node_small_obj_masks_.resize(num_nodes);
+
+		// Each node only writes its own cache entries, so the caches can be shared by all chunks
+		this->ParallelForNodes(num_nodes, [this, &arrays, num_cameras](size_t begin, size_t end) {
+			this->RefreshVisibilityCaches(begin, end, num_cameras);
+
+			for (size_t n = begin; n < end; ++n)
+			{
+				uint32_t const attr = arrays.attribs[n];
+
+				uint32_t small_mask = 0;
+				if (!(attr & SceneNode::SOA_Invisible) && (arrays.flags[n] & SceneNodeArrays::F_Updated))
+				{
+					auto& results = node_culling_results_[n];
+					for (uint32_t i = 0; i < num_cameras; ++i)
+					{
+						BoundOverlap visible = BoundOverlap::Yes;
+						if (attr & SceneNode::SOA_Cullable)
+						{
+							auto const& result = curr_visibility_caches_[i]->results[n];
+							if (result.small_obj)
+							{
+								small_mask |= 1UL << i;
+								visible = BoundOverlap::No;
+							}
+							else
 							{
-								visible = camera_frustums_[i]->Intersect(node.PosBoundWS());
+								visible = result.frustum;
 							}
 						}
+						results[i] = visible;
+					}
+				}
+				node_small_obj_masks_[n] = small_mask;
+			}
+		});
+
+		for (size_t n = 0; n < num_nodes; ++n)
+		{
+			auto& marks = arrays.visible_marks[n];
+			marks.fill(BoundOverlap::No);
 
-						node.VisibleMark(i, visible);
+			if (!(arrays.attribs[n] & SceneNode::SOA_Invisible))
+			{
+				if (arrays.flags[n] & SceneNodeArrays::F_Updated)
+				{
+					auto const& results = node_culling_results_[n];
+					uint32_t const small_mask = node_small_obj_masks_[n];
+					uint32_t const parent = arrays.parents[n];
+					for (uint32_t i = 0; i < num_cameras; ++i)
+					{
+						BoundOverlap const parent_bo =
+							(parent == SceneNode::InvalidHandle) ? BoundOverlap::Partial : arrays.visible_marks[parent][i];
+
+						BoundOverlap visible;
+						if ((BoundOverlap::No == parent_bo) || (small_mask & (1UL << i)))
+						{
+							visible = BoundOverlap::No;
+						}
+						else if (BoundOverlap::Yes == parent_bo)
+						{
+							visible = BoundOverlap::Yes;
+						}
+						else
+						{
+							visible = results[i];
+						}
+						marks[i] = visible;
 					}
 				}
 				else
 				{
 					for (uint32_t i = 0; i < num_cameras; ++i)
 					{
-						node.VisibleMark(i, BoundOverlap::Yes);
+						marks[i] = BoundOverlap::Yes;
+					}
+				}
+			}
+		}
+
+		this->WriteBackVisibleMarks();
+	}
+
+	void SceneManager::SceneNodeArrays::Clear()
+	{
+		this->Resize(0);
+	}
+
+	void SceneManager::SceneNodeArrays::Resize(uint32_t num)
+	{
+		nodes.resize(num);
+		serials.resize(num);
+		parents.resize(num);
+		attribs.resize(num);
+		flags.resize(num);
+		xforms_to_parent.resize(num);
+		xforms_to_world.resize(num);
+		component_aabbs_os.resize(num);
+		pos_aabbs_os.resize(num);
+		pos_aabbs_ws.resize(num);
+		visible_marks.resize(num);
+		bound_stamps.resize(num);
+	}
+
+	uint32_t SceneManager::SceneNodeArrays::Append(SceneNode& node)
+	{
+		uint32_t const handle = static_cast<uint32_t>(nodes.size());
+		node.handle_ = handle;
+
+		nodes.push_back(&node);
+		serials.push_back(node.serial_);
+		parents.push_back(node.parent_ ? node.parent_->handle_ : SceneNode::InvalidHandle);
+		attribs.push_back(node.attrib_);
+
+		// New entries always get recomputed by the next Update
+		uint8_t flag = F_XformDirty | F_BoundDirty;
+		if (node.pos_aabb_os_)
+		{
+			flag |= F_HasPosBound;
+			pos_aabbs_os.push_back(*node.pos_aabb_os_);
+			pos_aabbs_ws.push_back(*node.pos_aabb_ws_);
+		}
+		else
+		{
+			pos_aabbs_os.emplace_back();
+			pos_aabbs_ws.emplace_back();
+		}
+		component_aabbs_os.emplace_back(float3(+1e10f, +1e10f, +1e10f), float3(-1e10f, -1e10f, -1e10f));
+		if (node.Updated())
+		{
+			flag |= F_Updated;
+		}
+		flags.push_back(flag);
+
+		xforms_to_parent.push_back(node.xform_to_parent_);
+		xforms_to_world.push_back(node.xform_to_world_);
+		visible_marks.push_back(node.visible_marks_);
+		// A node appended at a handle invalidates the cached results of the one that was there
+		bound_stamps.push_back(stamp);
+
+		return handle;
+	}
+
+	void SceneManager::SceneNodeArrays::Refresh(uint32_t handle)
+	{
+		auto& node = *nodes[handle];
+		node.handle_ = handle;
+		attribs[handle] = node.attrib_;
+		if (node.xform_dirty_)
+		{
+			xforms_to_parent[handle] = node.xform_to_parent_;
+			flags[handle] |= F_XformDirty;
+		}
+		if (node.pos_aabb_dirty_)
+		{
+			flags[handle] |= F_BoundDirty;
+		}
+	}
+
+	// Renderables can change their bounds without telling the node, e.g. when a skinned mesh is animated
+	void SceneManager::SceneNodeArrays::RefreshComponentBound(uint32_t handle)
+	{
+		if (flags[handle] & F_HasPosBound)
+		{
+			AABBox aabb_os(float3(+1e10f, +1e10f, +1e10f), float3(-1e10f, -1e10f, -1e10f));
+			nodes[handle]->ForEachComponentOfType<RenderableComponent>([&aabb_os](RenderableComponent& renderable_comp) {
+				aabb_os |= renderable_comp.BoundRenderable().PosBound();
+			});
+			if (aabb_os != component_aabbs_os[handle])
+			{
+				component_aabbs_os[handle] = aabb_os;
+				flags[handle] |= F_BoundDirty;
+			}
+		}
+	}
+
+	// Streams over the node arrays filled by Update, only touching dirty entries. The arrays are in pre-order, so a forward
+	// pass sees every parent before its children, and a backward pass sees every child before its parent.
+	void SceneManager::UpdateNodeArrays()
+	{
+		auto& arrays = node_arrays_;
+		uint32_t const num_nodes = static_cast<uint32_t>(arrays.nodes.size());
+
+		num_xforms_updated_ = 0;
+		num_bounds_updated_ = 0;
+
+		// A dirty local transform dirties the world transforms of the whole subtree
+		for (uint32_t n = 0; n < num_nodes; ++n)
+		{
+			uint8_t& flag = arrays.flags[n];
+			uint32_t const parent = arrays.parents[n];
+			if (parent == SceneNode::InvalidHandle)
+			{
+				if (flag & SceneNodeArrays::F_XformDirty)
+				{
+					flag |= SceneNodeArrays::F_WorldDirty;
+					arrays.xforms_to_world[n] = arrays.xforms_to_parent[n];
+					++num_xforms_updated_;
+				}
+			}
+			else if ((flag & SceneNodeArrays::F_XformDirty) || (arrays.flags[parent] & SceneNodeArrays::F_WorldDirty))
+			{
+				flag |= SceneNodeArrays::F_WorldDirty;
+				SIMDMathLib::StoreMatrix(arrays.xforms_to_world[n], SIMDMathLib::Multiply(
+					SIMDMathLib::LoadMatrix(arrays.xforms_to_parent[n]), SIMDMathLib::LoadMatrix(arrays.xforms_to_world[parent])));
+				++num_xforms_updated_;
+			}
+		}
+
+		// A changed local transform or bound dirties the object space bounds of all ancestors. The children of a node are
+		// all visited before it, so its flag is final when it is reached.
+		for (uint32_t n = num_nodes; n-- > 0;)
+		{
+			uint8_t const flag = arrays.flags[n];
+			if (flag & SceneNodeArrays::F_BoundDirty)
+			{
+				arrays.pos_aabbs_os[n] = arrays.component_aabbs_os[n];
+			}
+
+			uint32_t const parent = arrays.parents[n];
+			if ((parent != SceneNode::InvalidHandle) && (flag & (SceneNodeArrays::F_XformDirty | SceneNodeArrays::F_BoundDirty)))
+			{
+				arrays.flags[parent] |= SceneNodeArrays::F_BoundDirty;
+			}
+		}
+
+		// Fold the children into the dirty bounds, and refresh the world space bounds that changed
+		for (uint32_t n = num_nodes; n-- > 0;)
+		{
+			uint8_t const flag = arrays.flags[n];
+			if (flag & SceneNodeArrays::F_HasPosBound)
+			{
+				AABBox const& aabb_os = arrays.pos_aabbs_os[n];
+				if (flag & (SceneNodeArrays::F_BoundDirty | SceneNodeArrays::F_WorldDirty))
+				{
+					arrays.pos_aabbs_ws[n] = MathLib::transform_aabb(aabb_os, arrays.xforms_to_world[n]);
+					arrays.bound_stamps[n] = arrays.stamp;
+					++num_bounds_updated_;
+				}
+
+				uint32_t const parent = arrays.parents[n];
+				if ((parent != SceneNode::InvalidHandle) &&
+					((arrays.flags[parent] & (SceneNodeArrays::F_HasPosBound | SceneNodeArrays::F_BoundDirty)) ==
+						(SceneNodeArrays::F_HasPosBound | SceneNodeArrays::F_BoundDirty)))
+				{
+					if ((aabb_os.Min().x() < aabb_os.Max().x()) || (aabb_os.Min().y() < aabb_os.Max().y()) ||
+						(aabb_os.Min().z() < aabb_os.Max().z()))
+					{
+						arrays.pos_aabbs_os[parent] |= MathLib::transform_aabb(aabb_os, arrays.xforms_to_parent[n]);
+					}
+				}
+			}
+		}
+
+		uint8_t constexpr any_dirty = SceneNodeArrays::F_XformDirty | SceneNodeArrays::F_BoundDirty | SceneNodeArrays::F_WorldDirty |
+									  SceneNodeArrays::F_PrevDirty;
+		for (uint32_t n = 0; n < num_nodes; ++n)
+		{
+			uint8_t& flag = arrays.flags[n];
+			if (flag & any_dirty)
+			{
+				auto& node = *arrays.nodes[n];
+				if (flag & SceneNodeArrays::F_WorldDirty)
+				{
+					node.prev_xform_to_world_ = node.xform_to_world_;
+					node.xform_to_world_ = arrays.xforms_to_world[n];
+					node.inv_xform_to_world_ = MathLib::inverse(node.xform_to_world_);
+					// Catch up the previous transform on the next frame, even if the node stays still
+					flag |= SceneNodeArrays::F_PrevDirty;
+				}
+				else if (flag & SceneNodeArrays::F_PrevDirty)
+				{
+					node.prev_xform_to_world_ = node.xform_to_world_;
+					flag &= ~SceneNodeArrays::F_PrevDirty;
+				}
+				if ((flag & SceneNodeArrays::F_HasPosBound) && (flag & (SceneNodeArrays::F_BoundDirty | SceneNodeArrays::F_WorldDirty)))
+				{
+					*node.pos_aabb_os_ = arrays.pos_aabbs_os[n];
+					*node.pos_aabb_ws_ = arrays.pos_aabbs_ws[n];
+				}
+				node.xform_dirty_ = false;
+				node.pos_aabb_dirty_ = false;
+
+				flag &= ~(SceneNodeArrays::F_XformDirty | SceneNodeArrays::F_BoundDirty | SceneNodeArrays::F_WorldDirty);
+			}
+		}
+	}
+
+	// The scene can be edited between Update and the flushes of each pass, and attributes like visibility change per pass.
+	// Keep the arrays in step with all_scene_nodes_ before culling reads them.
+	void SceneManager::SyncNodeArrays()
+	{
+		auto& arrays = node_arrays_;
+		if (arrays.nodes == all_scene_nodes_)
+		{
+			for (size_t n = 0; n < all_scene_nodes_.size(); ++n)
+			{
+				auto const& node = *all_scene_nodes_[n];
+				arrays.attribs[n] = node.Attrib();
+				if (node.Updated())
+				{
+					arrays.flags[n] |= SceneNodeArrays::F_Updated;
+				}
+				else
+				{
+					arrays.flags[n] &= ~SceneNodeArrays::F_Updated;
+				}
+			}
+		}
+		else
+		{
+			arrays.Clear();
+			for (auto* node : all_scene_nodes_)
+			{
+				arrays.Append(*node);
+			}
+		}
+	}
+
+	// Finds the visibility cache of each camera in the viewport. A cache starts over when the projection changed, or the camera
+	// moved beyond the thresholds. The least recently used one is recycled when there are too many.
+	void SceneManager::AcquireVisibilityCaches(Viewport const & viewport)
+	{
+		uint32_t const stamp = ++node_arrays_.stamp;
+		size_t const num_nodes = node_arrays_.nodes.size();
+
+		int32_t cascade_index = -1;
+		float4x4 crop = float4x4::Identity();
+		auto drl = Context::Instance().DeferredRenderingLayerInstance();
+		if (drl)
+		{
+			cascade_index = drl->CurrCascadeIndex();
+			if (cascade_index >= 0)
+			{
+				crop = drl->GetCascadedShadowLayer().CascadeCropMatrix(cascade_index);
+			}
+		}
+
+		uint32_t const num_cameras = viewport.NumCameras();
+		curr_visibility_caches_.resize(num_cameras);
+		for (uint32_t i = 0; i < num_cameras; ++i)
+		{
+			auto const& camera = *viewport.Camera(i);
+
+			VisibilityCache* cache = nullptr;
+			for (auto const& vc : visibility_caches_)
+			{
+				if ((vc->camera == &camera) && (vc->cascade_index == cascade_index))
+				{
+					cache = vc.get();
+					break;
+				}
+			}
+			if (cache == nullptr)
+			{
+				if (visibility_caches_.size() < MAX_VISIBILITY_CACHES)
+				{
+					visibility_caches_.push_back(MakeUniquePtr<VisibilityCache>());
+					cache = visibility_caches_.back().get();
+				}
+				else
+				{
+					cache = std::min_element(visibility_caches_.begin(), visibility_caches_.end(),
+						[](std::unique_ptr<VisibilityCache> const& lhs, std::unique_ptr<VisibilityCache> const& rhs) {
+							return lhs->last_used < rhs->last_used;
+						})->get();
+				}
+				cache->camera = &camera;
+				cache->cascade_index = cascade_index;
+				cache->results.clear();
+			}
+
+			bool reset = cache->results.empty() || (cache->omni_directional != camera.OmniDirectionalMode()) ||
+						 !(cache->proj == camera.ProjMatrix()) || !(cache->crop == crop);
+			cache->exact = !reset && (cache->view_proj == camera_view_projs_[i]);
+			if (!reset && !cache->exact)
+			{
+				reset = (MathLib::length(camera.EyePos() - cache->eye_pos) > cache_move_threshold_) ||
+						(MathLib::dot(camera.ForwardVec(), cache->forward_vec) < cache_cos_rotate_threshold_) ||
+						(MathLib::dot(camera.UpVec(), cache->up_vec) < cache_cos_rotate_threshold_);
+			}
+			if (reset)
+			{
+				cache->omni_directional = camera.OmniDirectionalMode();
+				cache->proj = camera.ProjMatrix();
+				cache->crop = crop;
+				cache->view_proj = camera_view_projs_[i];
+				cache->eye_pos = camera.EyePos();
+				cache->forward_vec = camera.ForwardVec();
+				cache->up_vec = camera.UpVec();
+				cache->exact = true;
+				cache->results.assign(num_nodes, CachedCullingResult{BoundOverlap::No, false, 0});
+			}
+			else
+			{
+				cache->results.resize(num_nodes, CachedCullingResult{BoundOverlap::No, false, 0});
+			}
+			cache->last_used = stamp;
+
+			curr_visibility_caches_[i] = cache;
+		}
+	}
+
+	// Own tests of the cullable nodes in [begin, end), without their parents. A test is only done again when the bound changed,
+	// the result is missing, or the result was partial and the camera moved. The frustum tests are collected for each camera
+	// and run on 4 boxes at a time.
+	void SceneManager::RefreshVisibilityCaches(size_t begin, size_t end, uint32_t num_cameras)
+	{
+		uint32_t const BATCH_SIZE = 64;
+
+		auto& arrays = node_arrays_;
+		for (uint32_t i = 0; i < num_cameras; ++i)
+		{
+			auto& cache = *curr_visibility_caches_[i];
+			auto const& camera = *cache.camera;
+			auto const& frustum = *camera_frustums_[i];
+
+			uint32_t batch_nodes[BATCH_SIZE];
+			float batch_bounds[6][BATCH_SIZE];
+			BoundOverlap batch_results[BATCH_SIZE];
+			uint32_t num_batched = 0;
+			auto flush_batch = [&] {
+				MathLib::intersect_aabbs_frustum(batch_bounds[0], batch_bounds[1], batch_bounds[2], batch_bounds[3],
+					batch_bounds[4], batch_bounds[5], num_batched, frustum, batch_results);
+				for (uint32_t j = 0; j < num_batched; ++j)
+				{
+					cache.results[batch_nodes[j]].frustum = batch_results[j];
+				}
+				num_batched = 0;
+			};
+
+			for (size_t n = begin; n < end; ++n)
+			{
+				uint32_t const attr = arrays.attribs[n];
+				if ((attr & SceneNode::SOA_Invisible) || !(attr & SceneNode::SOA_Cullable) ||
+					!(arrays.flags[n] & SceneNodeArrays::F_Updated))
+				{
+					continue;
+				}
+
+				auto& result = cache.results[n];
+				if ((result.stamp > arrays.bound_stamps[n]) && (cache.exact || (result.frustum != BoundOverlap::Partial)))
+				{
+					continue;
+				}
+
+				AABBox const& aabb_ws = arrays.pos_aabbs_ws[n];
+				result.small_obj = (small_obj_threshold_ > 0) &&
+								   ((MathLib::ortho_area(camera.ForwardVec(), aabb_ws) <= small_obj_threshold_) ||
+									   (MathLib::perspective_area(camera.EyePos(), camera_view_projs_[i], aabb_ws) <=
+										   small_obj_threshold_));
+				result.stamp = arrays.stamp;
+				if (result.small_obj)
+				{
+					result.frustum = BoundOverlap::No;
+				}
+				else if (camera.OmniDirectionalMode())
+				{
+					result.frustum = BoundOverlap::Yes;
+				}
+				else
+				{
+					batch_nodes[num_batched] = static_cast<uint32_t>(n);
+					for (uint32_t k = 0; k < 3; ++k)
+					{
+						batch_bounds[k][num_batched] = aabb_ws.Min()[k];
+						batch_bounds[k + 3][num_batched] = aabb_ws.Max()[k];
+					}
+					++num_batched;
+					if (num_batched == BATCH_SIZE)
+					{
+						flush_batch();
 					}
 				}
 			}
+			if (num_batched > 0)
+			{
+				flush_batch();
+			}
 		}
 	}
 
+	// Runs after ClipScene. Nodes that passed frustum culling but are completely behind the occluders are marked invisible.
+	void SceneManager::OcclusionCullScene()
+	{
+		auto& culler = *occlusion_culler_;
+		culler.Render(camera_view_projs_[0], 0);
+		if (culler.NumTrianglesRasterized() == 0)
+		{
+			return;
+		}
+
+		auto& arrays = node_arrays_;
+		for (size_t n = 1; n < arrays.nodes.size(); ++n)
+		{
+			auto& node = *arrays.nodes[n];
+			uint32_t const required_flags = SceneNodeArrays::F_HasPosBound | SceneNodeArrays::F_Updated;
+			if ((arrays.attribs[n] & SceneNode::SOA_Cullable) && ((arrays.flags[n] & required_flags) == required_flags)
+				&& (node.VisibleMark(0) != BoundOverlap::No) && culler.IsOccluded(arrays.pos_aabbs_ws[n]))
+			{
+				node.VisibleMark(0, BoundOverlap::No);
+				++ num_objects_occluded_;
+			}
+		}
+	}
+
+	void SceneManager::WriteBackVisibleMarks()
+	{
+		auto& arrays = node_arrays_;
+		for (size_t n = 0; n < arrays.nodes.size(); ++n)
+		{
+			arrays.nodes[n]->visible_marks_ = arrays.visible_marks[n];
+		}
+	}
+
+	void SceneManager::ParallelForNodes(size_t num_nodes, std::function<void(size_t begin, size_t end)> const & func)
+	{
+		// The scheduler splits the range down to the grain size, and idle workers steal the rest. So unbalanced chunks no longer
+		// hold the frame back.
+		uint32_t const grain_size = std::max(MIN_NODES_PER_CULLING_CHUNK,
+			static_cast<uint32_t>((num_nodes + num_culling_threads_ - 1) / num_culling_threads_));
+		Context::Instance().TaskScheduler().parallel_for(0, static_cast<uint32_t>(num_nodes), grain_size,
+			[&func](uint32_t begin, uint32_t end) { func(begin, end); });
+	}
+
 	uint32_t SceneManager::NumFrameCameras() const
 	{
 		return static_cast<uint32_t>(frame_cameras_.size());
@@ -254,20 +921,22 @@ namespace KlayGE
 			{
 				RenderTechnique const * obj_tech = obj->GetRenderTechnique();
 				BOOST_ASSERT(obj_tech);
-				bool found = false;
-				for (auto& items : render_queue_)
+
+				auto iter = render_tech_slot_map_.find(obj_tech);
+				if (iter == render_tech_slot_map_.end())
 				{
-					if (items.first == obj_tech)
-					{
-						items.second.push_back(obj);
-						found = true;
-						break;
-					}
+					iter = render_tech_slot_map_.emplace(obj_tech, static_cast<uint32_t>(render_techs_.size())).first;
+					render_techs_.push_back({obj_tech, 0, false});
 				}
-				if (!found)
+				uint32_t const slot = iter->second;
+				if (!render_techs_[slot].active)
 				{
-					render_queue_.emplace_back(obj_tech, std::vector<Renderable*>(1, obj));
+					render_techs_[slot].active = true;
+					active_render_tech_slots_.push_back(slot);
 				}
+
+				// The key holds the technique slot until Flush builds the real sort key
+				render_queue_.push_back({slot, obj});
 			}
 		}
 	}
@@ -281,15 +950,11 @@ namespace KlayGE
 		}
 		else
 		{
-			ret = BoundOverlap::No;
-			for (auto const* camera_frustum : camera_frustums_)
-			{
-				ret = std::max(ret, camera_frustum->Intersect(aabb));
-				if (ret == BoundOverlap::Yes)
-				{
-					break;
-				}
-			}
+			BOOST_ASSERT(camera_frustums_.size() <= RenderEngine::PredefinedCameraCBuffer::max_num_cameras);
+
+			std::array<BoundOverlap, RenderEngine::PredefinedCameraCBuffer::max_num_cameras> results;
+			MathLib::intersect_aabb_frustums(aabb, camera_frustums_.data(), camera_frustums_.size(), results.data());
+			ret = *std::max_element(results.begin(), results.begin() + camera_frustums_.size());
 		}
 		return ret;
 	}
@@ -389,9 +1054,31 @@ namespace KlayGE
 		{
 			std::lock_guard<std::mutex> lock(update_mutex_);
 
-			scene_root_.Traverse([this, app_time, frame_time](SceneNode& node) {
+			// The arrays persist across frames. They are only rebuilt from the first node where the tree structure differs.
+			uint32_t num_nodes = 0;
+			bool same_structure = true;
+			scene_root_.Traverse([this, app_time, frame_time, &num_nodes, &same_structure](SceneNode& node) {
 				node.MainThreadUpdate(app_time, frame_time);
-				node.UpdateTransforms();
+
+				uint32_t const handle = num_nodes;
+				++num_nodes;
+
+				uint32_t const parent = node.Parent() ? node.Parent()->Handle() : SceneNode::InvalidHandle;
+				if (same_structure && (handle < node_arrays_.nodes.size()) && (node_arrays_.serials[handle] == node.serial_) &&
+					(node_arrays_.parents[handle] == parent))
+				{
+					node_arrays_.Refresh(handle);
+				}
+				else
+				{
+					if (same_structure)
+					{
+						node_arrays_.Resize(handle);
+						same_structure = false;
+					}
+					node_arrays_.Append(node);
+				}
+				node_arrays_.RefreshComponentBound(handle);
 
 				if (node.Visible())
 				{
@@ -406,7 +1093,20 @@ namespace KlayGE
 
 				return true;
 			});
-			scene_root_.UpdatePosBoundSubtree();
+			if (!same_structure || (node_arrays_.nodes.size() != num_nodes))
+			{
+				sub_update_jobs_dirty_ = true;
+			}
+			if (same_structure)
+			{
+				node_arrays_.Resize(num_nodes);
+			}
+			this->UpdateNodeArrays();
+
+			if (parallel_sub_thread_update_ && sub_update_jobs_dirty_)
+			{
+				this->BuildSubThreadUpdateJobs();
+			}
 
 			overlay_root_.ClearChildren();
 		}
@@ -448,6 +1148,7 @@ namespace KlayGE
 		float const frame_time = app.FrameTime();
 
 		num_objects_rendered_ = 0;
+		num_objects_occluded_ = 0;
 		num_renderables_rendered_ = 0;
 		num_primitives_rendered_ = 0;
 		num_vertices_rendered_ = 0;
@@ -462,6 +1163,7 @@ namespace KlayGE
 				all_overlay_nodes_.push_back(&node);
 				return true;
 			});
+		this->SyncNodeArrays();
 
 		auto& scene_nodes = (urt & App3DFramework::URV_Overlay) ? all_overlay_nodes_ : all_scene_nodes_;
 
@@ -493,7 +1195,7 @@ namespace KlayGE
 				camera_frustums_[i] = &viewport.Camera(i)->ViewFrustum();
 			}
 
-			std::vector<uint32_t> visible_list((scene_nodes.size() + 31) / 32, 0);
+			frame_vector<uint32_t> visible_list((scene_nodes.size() + 31) / 32, 0);
 			for (size_t i = 0; i < scene_nodes.size(); ++ i)
 			{
 				if (scene_nodes[i]->Visible())
@@ -533,6 +1235,11 @@ namespace KlayGE
 				}
 
 				this->ClipScene();
+				if (occlusion_culling_ && !(urt & App3DFramework::URV_Overlay) && (num_cameras == 1)
+					&& !viewport.Camera(0)->OmniDirectionalMode())
+				{
+					this->OcclusionCullScene();
+				}
 
 				auto visible_marks =
 					MakeUniquePtr<std::array<BoundOverlap, RenderEngine::PredefinedCameraCBuffer::max_num_cameras>[]>(scene_nodes.size());
@@ -569,7 +1276,7 @@ namespace KlayGE
 			}
 		}
 
-		auto node_visible = MakeUniquePtr<bool[]>(scene_nodes.size());
+		bool* node_visible = frame_arena::thread_instance().allocate<bool>(scene_nodes.size());
 		for (size_t i = 0; i < scene_nodes.size(); ++i)
 		{
 			node_visible[i] = false;
@@ -613,65 +1320,92 @@ namespace KlayGE
 			}
 		}
 
-		std::sort(render_queue_.begin(), render_queue_.end(),
-			[](std::pair<RenderTechnique const *, std::vector<Renderable*>> const & lhs,
-				std::pair<RenderTechnique const *, std::vector<Renderable*>> const & rhs)
-			{
-				BOOST_ASSERT(lhs.first);
-				BOOST_ASSERT(rhs.first);
-
-				return lhs.first->Weight() < rhs.first->Weight();
-			});
+		// Techniques are ranked by weight, ties keep the order they were first queued
+		for (uint32_t i = 0; i < active_render_tech_slots_.size(); ++i)
+		{
+			render_techs_[active_render_tech_slots_[i]].rank = i;
+		}
+		std::sort(active_render_tech_slots_.begin(), active_render_tech_slots_.end(), [this](uint32_t lhs, uint32_t rhs) {
+			auto const& lhs_tech = render_techs_[lhs];
+			auto const& rhs_tech = render_techs_[rhs];
+			BOOST_ASSERT(lhs_tech.tech);
+			BOOST_ASSERT(rhs_tech.tech);
+
+			float const lhs_weight = lhs_tech.tech->Weight();
+			float const rhs_weight = rhs_tech.tech->Weight();
+			return (lhs_weight < rhs_weight) || ((lhs_weight == rhs_weight) && (lhs_tech.rank < rhs_tech.rank));
+		});
+		for (uint32_t i = 0; i < active_render_tech_slots_.size(); ++i)
+		{
+			render_techs_[active_render_tech_slots_[i]].rank = i;
+		}
 
 		float4 view_mat_z;
 		if (viewport.NumCameras() == 1)
 		{
 			view_mat_z = viewport.Camera(0)->ViewMatrix().Col(2);
 		}
-		for (auto& items : render_queue_)
+		for (auto& item : render_queue_)
 		{
-			if ((viewport.NumCameras() == 1) && !items.first->Transparent() && !items.first->HasDiscard() && (items.second.size() > 1))
+			auto const& tech_slot = render_techs_[static_cast<uint32_t>(item.key)];
+			RenderTechnique const& tech = *tech_slot.tech;
+
+			// Opaque goes front-to-back, transparent goes back-to-front, the rest keeps the queued order
+			uint32_t depth_bits = 0;
+			if (viewport.NumCameras() == 1)
 			{
-				std::vector<std::pair<float, uint32_t>> min_depths(items.second.size());
-				for (size_t j = 0; j < min_depths.size(); ++ j)
+				bool const front_to_back = !tech.Transparent() && !tech.HasDiscard();
+				bool const back_to_front = tech.Transparent();
+				if (front_to_back || back_to_front)
 				{
-					Renderable const * renderable = items.second[j];
-					AABBox const & box = renderable->PosBound();
-					uint32_t const num = renderable->NumInstances();
-					float md = 1e10f;
-					for (uint32_t i = 0; i < num; ++ i)
+					Renderable const& renderable = *item.renderable;
+					AABBox const& box = renderable.PosBound();
+					uint32_t const num = renderable.NumInstances();
+					float md = front_to_back ? 1e10f : -1e10f;
+					for (uint32_t i = 0; i < num; ++i)
 					{
-						float4x4 const & mat = renderable->GetInstance(i)->TransformToWorld();
-						float4 const zvec(MathLib::dot(mat.Row(0), view_mat_z),
-							MathLib::dot(mat.Row(1), view_mat_z), MathLib::dot(mat.Row(2), view_mat_z),
-							MathLib::dot(mat.Row(3), view_mat_z));
-						for (int k = 0; k < 8; ++ k)
+						float4x4 const& mat = renderable.GetInstance(i)->TransformToWorld();
+						float4 const zvec(MathLib::dot(mat.Row(0), view_mat_z), MathLib::dot(mat.Row(1), view_mat_z),
+							MathLib::dot(mat.Row(2), view_mat_z), MathLib::dot(mat.Row(3), view_mat_z));
+						for (int k = 0; k < 8; ++k)
 						{
 							float3 const v = box.Corner(k);
-							md = std::min(md, v.x() * zvec.x() + v.y() * zvec.y() + v.z() * zvec.z() + zvec.w());
+							float const d = v.x() * zvec.x() + v.y() * zvec.y() + v.z() * zvec.z() + zvec.w();
+							md = front_to_back ? std::min(md, d) : std::max(md, d);
 						}
 					}
 
-					min_depths[j] = std::make_pair(md, static_cast<uint32_t>(j));
+					depth_bits = OrderedFloatBits(md);
+					if (back_to_front)
+					{
+						depth_bits = ~depth_bits;
+					}
 				}
+			}
 
-				std::sort(min_depths.begin(), min_depths.end());
+			item.key = (static_cast<uint64_t>(tech_slot.rank) << 32) | depth_bits;
+		}
 
-				std::vector<Renderable*> sorted_items(min_depths.size());
-				for (size_t j = 0; j < min_depths.size(); ++ j)
-				{
-					sorted_items[j] = items.second[min_depths[j].second];
-				}
-				items.second.swap(sorted_items);
-			}
+		RadixSortByKey(render_queue_, render_queue_sort_buff_, 48);
 
-			for (auto const & item : items.second)
-			{
-				item->Render();
-			}
-			num_renderables_rendered_ += static_cast<uint32_t>(items.second.size());
+		for (auto const& item : render_queue_)
+		{
+			item.renderable->Render();
+		}
+		num_renderables_rendered_ += static_cast<uint32_t>(render_queue_.size());
+
+		render_queue_.clear();
+		for (uint32_t slot : active_render_tech_slots_)
+		{
+			render_techs_[slot].active = false;
+		}
+		active_render_tech_slots_.clear();
+		if (render_techs_.size() > MAX_CACHED_RENDER_TECHS)
+		{
+			// Techniques that were destroyed stay in the table, start over once in a while
+			render_tech_slot_map_.clear();
+			render_techs_.clear();
 		}
-		render_queue_.resize(0);
 
 		num_primitives_rendered_ += re.NumPrimitivesJustRendered();
 		num_vertices_rendered_ += re.NumVerticesJustRendered();
@@ -689,6 +1423,11 @@ namespace KlayGE
 		return num_objects_rendered_;
 	}
 
+	uint32_t SceneManager::NumObjectsOccluded() const
+	{
+		return num_objects_occluded_;
+	}
+
 	// ȡȾĿȾ
 	/////////////////////////////////////////////////////////////////////////////////
 	uint32_t SceneManager::NumRenderablesRendered() const
@@ -720,6 +1459,18 @@ namespace KlayGE
 		return num_dispatch_calls_;
 	}
 
+	// Nodes whose world transform was recomputed in the last Update
+	uint32_t SceneManager::NumTransformsUpdated() const
+	{
+		return num_xforms_updated_;
+	}
+
+	// Nodes whose world space bound was recomputed in the last Update
+	uint32_t SceneManager::NumBoundsUpdated() const
+	{
+		return num_bounds_updated_;
+	}
+
 	void SceneManager::FlushScene()
 	{
 		RenderEngine& re = Context::Instance().RenderFactoryInstance().RenderEngineInstance();
@@ -762,37 +1513,151 @@ namespace KlayGE
 		num_dispatch_calls_ = re.NumDispatchesJustCalled();
 	}
 
+	// Fixed timestep. Every step advances the sub thread time by exactly update_elapse_. Steps missed by a slow update are caught
+	// up, up to a limit, instead of being merged into a longer one.
 	void SceneManager::UpdateThreadFunc()
 	{
-		Timer timer;
+		using clock = std::chrono::steady_clock;
+
 		float app_time = 0;
+		auto next_tick = clock::now();
 		while (!quit_)
 		{
-			float const frame_time = static_cast<float>(timer.elapsed());
-			timer.restart();
-			app_time += frame_time;
+			float const elapse = update_elapse_;
+			auto const step = std::chrono::duration_cast<clock::duration>(std::chrono::duration<float>(elapse));
 
+			bool active = false;
 			if (Context::Instance().AppValid())
 			{
 				WindowPtr const & win = Context::Instance().AppInstance().MainWnd();
-				if (win && win->Active())
-				{
-					std::lock_guard<std::mutex> lock(update_mutex_);
+				active = win && win->Active();
+			}
 
-					auto updater = [app_time, frame_time](SceneNode& node) {
-						node.SubThreadUpdate(app_time, frame_time);
-						return true;
-					};
-					scene_root_.Traverse(updater);
-					overlay_root_.Traverse(updater);
+			auto const now = clock::now();
+			if (active)
+			{
+				for (uint32_t i = 0; (i < MAX_SUB_UPDATE_CATCH_UP_STEPS) && (next_tick <= now); ++i)
+				{
+					app_time += elapse;
+					this->SubThreadUpdateStep(app_time, elapse);
+					next_tick += step;
 				}
+			}
+			if (next_tick <= now)
+			{
+				// Too far behind, or inactive. The time doesn't advance for the missed steps.
+				next_tick = now + step;
+			}
+
+			std::this_thread::sleep_until(next_tick);
+		}
+	}
+
+	// Called by the update thread. In parallel mode, the handlers run without update_mutex_. The nodes are snapshotted before
+	// the pass and the transforms written by the handlers are published after it, both under short locks.
+	void SceneManager::SubThreadUpdateStep(float app_time, float elapsed_time)
+	{
+		auto updater = [app_time, elapsed_time](SceneNode& node) {
+			node.SubThreadUpdate(app_time, elapsed_time);
+			return true;
+		};
+
+		std::unique_lock<std::mutex> lock(update_mutex_);
+
+		if (!parallel_sub_thread_update_)
+		{
+			scene_root_.Traverse(updater);
+			overlay_root_.Traverse(updater);
+			return;
+		}
+
+		if (sub_update_jobs_pending_)
+		{
+			sub_update_jobs_.nodes.swap(pending_sub_update_jobs_.nodes);
+			sub_update_jobs_.job_begins.swap(pending_sub_update_jobs_.job_begins);
+			sub_update_jobs_pending_ = false;
+		}
+
+		auto const& jobs = sub_update_jobs_;
+		scene_root_.BeginSubThreadState();
+		for (auto const& node : jobs.nodes)
+		{
+			node->BeginSubThreadState();
+		}
+
+		lock.unlock();
+
+		struct SubThreadStateScope
+		{
+			SubThreadStateScope()
+			{
+				SceneNode::UseSubThreadState(true);
+			}
+			~SubThreadStateScope()
+			{
+				SceneNode::UseSubThreadState(false);
+			}
+		};
 
-				if (frame_time < update_elapse_)
+		{
+			SubThreadStateScope scope;
+			scene_root_.SubThreadUpdate(app_time, elapsed_time);
+		}
+
+		uint32_t const num_jobs = jobs.job_begins.empty() ? 0 : static_cast<uint32_t>(jobs.job_begins.size() - 1);
+		Context::Instance().TaskScheduler().parallel_for(0, num_jobs, 1,
+			[&jobs, app_time, elapsed_time](uint32_t begin, uint32_t end) {
+				SubThreadStateScope scope;
+				for (uint32_t i = jobs.job_begins[begin]; i < jobs.job_begins[end]; ++i)
 				{
-					Sleep(static_cast<uint32_t>((update_elapse_ - frame_time) * 1000));
+					jobs.nodes[i]->SubThreadUpdate(app_time, elapsed_time);
 				}
+			});
+
+		lock.lock();
+
+		scene_root_.EndSubThreadState();
+		for (auto const& node : jobs.nodes)
+		{
+			node->EndSubThreadState();
+		}
+
+		// Overlay nodes are replaced every frame, so they are updated directly
+		overlay_root_.Traverse(updater);
+	}
+
+	// Splits the nodes under the scene root into jobs by the sizes of the top level subtrees, read from the node arrays.
+	// Called by Update after the arrays are refreshed.
+	void SceneManager::BuildSubThreadUpdateJobs()
+	{
+		auto& arrays = node_arrays_;
+		uint32_t const num_nodes = static_cast<uint32_t>(arrays.nodes.size());
+		uint32_t const num_threads = std::max(std::thread::hardware_concurrency(), 1U);
+		uint32_t const job_size = std::max((num_nodes + num_threads - 1) / num_threads, MIN_NODES_PER_SUB_UPDATE_JOB);
+
+		auto& jobs = pending_sub_update_jobs_;
+		jobs.nodes.clear();
+		jobs.job_begins.assign(1, 0);
+
+		for (uint32_t n = 1; n < num_nodes; ++n)
+		{
+			if ((arrays.parents[n] == 0) && (jobs.nodes.size() - jobs.job_begins.back() >= job_size))
+			{
+				jobs.job_begins.push_back(static_cast<uint32_t>(jobs.nodes.size()));
 			}
+			jobs.nodes.push_back(arrays.nodes[n]->shared_from_this());
 		}
+		if (!jobs.nodes.empty())
+		{
+			jobs.job_begins.push_back(static_cast<uint32_t>(jobs.nodes.size()));
+		}
+		else
+		{
+			jobs.job_begins.clear();
+		}
+
+		sub_update_jobs_pending_ = true;
+		sub_update_jobs_dirty_ = false;
 	}
 
 	BoundOverlap SceneManager::VisibleTestFromParent(SceneNode const & node, uint32_t camera_index)
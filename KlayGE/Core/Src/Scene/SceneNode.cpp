@@ -33,15 +33,43 @@
 #include <KlayGE/SceneManager.hpp>
 #include <KlayGE/Context.hpp>
 #include <KFL/Math.hpp>
+#include <KFL/SIMDMath.hpp>
+
+#include <atomic>
 
 #include <boost/assert.hpp>
 
 #include <KlayGE/SceneNode.hpp>
 
+namespace
+{
+	// Set on the threads running a parallel sub thread update pass
+	thread_local bool use_sub_thread_state = false;
+
+	std::atomic<uint64_t> next_node_serial(0);
+}
+
 namespace KlayGE
 {
+	// The node as the handlers of a parallel sub thread update pass see it. The transforms of the parent are the ones when
+	// the pass began, so the pass never reads another node.
+	struct SceneNode::SubThreadState
+	{
+		std::vector<SceneComponentPtr> components;
+		uint32_t components_version = 0;
+
+		float4x4 xform_to_parent;
+		float4x4 inv_xform_to_parent;
+		float4x4 xform_to_world;
+		float4x4 inv_xform_to_world;
+		float4x4 prev_xform_to_world;
+		float4x4 parent_xform_to_world;
+		float4x4 inv_parent_xform_to_world;
+		bool written = false;
+	};
+
 	SceneNode::SceneNode(uint32_t attrib)
-		: attrib_(attrib)
+		: attrib_(attrib), serial_(next_node_serial.fetch_add(1, std::memory_order_relaxed))
 	{
 		if (!(attrib & SOA_Overlay) && (attrib & (SOA_Cullable | SOA_Moveable)))
 		{
@@ -161,6 +189,7 @@ namespace KlayGE
 		parent_ = so;
 
 		pos_aabb_dirty_ = true;
+		xform_dirty_ = true;
 		updated_ = false;
 	}
 
@@ -260,6 +289,7 @@ namespace KlayGE
 		components_.push_back(component);
 		component->BindSceneNode(this);
 		pos_aabb_dirty_ = true;
+		++components_version_;
 	}
 
 	void SceneNode::RemoveComponent(SceneComponentPtr const& component)
@@ -276,6 +306,7 @@ namespace KlayGE
 			components_.erase(iter);
 			component->BindSceneNode(nullptr);
 			pos_aabb_dirty_ = true;
+			++components_version_;
 		}
 	}
 
@@ -283,6 +314,7 @@ namespace KlayGE
 	{
 		components_.clear();
 		pos_aabb_dirty_ = true;
+		++components_version_;
 	}
 
 	void SceneNode::ReplaceComponent(uint32_t index, SceneComponentPtr const& component)
@@ -303,6 +335,7 @@ namespace KlayGE
 		component->BindSceneNode(this);
 		components_[index] = component;
 		pos_aabb_dirty_ = true;
+		++components_version_;
 	}
 
 	void SceneNode::ForEachComponent(std::function<void(SceneComponent&)> const& callback) const
@@ -318,13 +351,34 @@ namespace KlayGE
 
 	void SceneNode::TransformToParent(float4x4 const& mat)
 	{
+		if (auto* state = this->ActiveSubThreadState())
+		{
+			state->xform_to_parent = mat;
+			state->inv_xform_to_parent = MathLib::inverse(mat);
+			state->xform_to_world = mat * state->parent_xform_to_world;
+			state->inv_xform_to_world = MathLib::inverse(state->xform_to_world);
+			state->written = true;
+			return;
+		}
+
 		xform_to_parent_ = mat;
 		inv_xform_to_parent_ = MathLib::inverse(mat);
 		pos_aabb_dirty_ = true;
+		xform_dirty_ = true;
 	}
 
 	void SceneNode::TransformToWorld(float4x4 const& mat)
 	{
+		if (auto* state = this->ActiveSubThreadState())
+		{
+			state->xform_to_parent = mat * state->inv_parent_xform_to_world;
+			state->inv_xform_to_parent = MathLib::inverse(state->xform_to_parent);
+			state->xform_to_world = mat;
+			state->inv_xform_to_world = MathLib::inverse(mat);
+			state->written = true;
+			return;
+		}
+
 		if (parent_)
 		{
 			xform_to_parent_ = mat * parent_->InverseTransformToWorld();
@@ -336,20 +390,34 @@ namespace KlayGE
 		inv_xform_to_parent_ = MathLib::inverse(mat);
 
 		pos_aabb_dirty_ = true;
+		xform_dirty_ = true;
 	}
 
 	float4x4 const& SceneNode::TransformToParent() const
 	{
+		if (auto const* state = this->ActiveSubThreadState())
+		{
+			return state->xform_to_parent;
+		}
 		return xform_to_parent_;
 	}
 
 	float4x4 const& SceneNode::InverseTransformToParent() const
 	{
+		if (auto const* state = this->ActiveSubThreadState())
+		{
+			return state->inv_xform_to_parent;
+		}
 		return inv_xform_to_parent_;
 	}
 
 	float4x4 const& SceneNode::TransformToWorld() const
 	{
+		if (auto const* state = this->ActiveSubThreadState())
+		{
+			return state->xform_to_world;
+		}
+
 		if (parent_ == nullptr)
 		{
 			return xform_to_parent_;
@@ -373,11 +441,20 @@ namespace KlayGE
 
 	float4x4 const& SceneNode::PrevTransformToWorld() const
 	{
+		if (auto const* state = this->ActiveSubThreadState())
+		{
+			return state->prev_xform_to_world;
+		}
 		return prev_xform_to_world_;
 	}
 
 	float4x4 const& SceneNode::InverseTransformToWorld() const
 	{
+		if (auto const* state = this->ActiveSubThreadState())
+		{
+			return state->inv_xform_to_world;
+		}
+
 		if (parent_ == nullptr)
 		{
 			return inv_xform_to_parent_;
@@ -408,7 +485,8 @@ namespace KlayGE
 		prev_xform_to_world_ = xform_to_world_;
 		if (parent_)
 		{
-			xform_to_world_ = xform_to_parent_ * parent_->TransformToWorld();
+			SIMDMathLib::StoreMatrix(xform_to_world_,
+				SIMDMathLib::Multiply(SIMDMathLib::LoadMatrix(xform_to_parent_), SIMDMathLib::LoadMatrix(parent_->TransformToWorld())));
 		}
 		else
 		{
@@ -424,6 +502,11 @@ namespace KlayGE
 		return updated_ && !pos_aabb_dirty_;
 	}
 
+	uint32_t SceneNode::Handle() const
+	{
+		return handle_;
+	}
+
 	void SceneNode::FillVisibleMark(BoundOverlap vm)
 	{
 		visible_marks_.fill(vm);
@@ -445,12 +528,66 @@ namespace KlayGE
 	{
 		sub_thread_update_event_(*this, app_time, elapsed_time);
 
-		for (auto const& component : components_)
+		auto const* state = this->ActiveSubThreadState();
+		for (auto const& component : state ? state->components : components_)
 		{
 			component->SubThreadUpdate(app_time, elapsed_time);
 		}
 	}
 
+	void SceneNode::UseSubThreadState(bool use)
+	{
+		use_sub_thread_state = use;
+	}
+
+	SceneNode::SubThreadState* SceneNode::ActiveSubThreadState() const
+	{
+		return use_sub_thread_state ? sub_state_.get() : nullptr;
+	}
+
+	// Called under the update mutex before a parallel pass
+	void SceneNode::BeginSubThreadState()
+	{
+		if (!sub_state_)
+		{
+			sub_state_ = MakeUniquePtr<SubThreadState>();
+		}
+
+		auto& state = *sub_state_;
+		if (state.components_version != components_version_)
+		{
+			state.components = components_;
+			state.components_version = components_version_;
+		}
+
+		state.xform_to_parent = xform_to_parent_;
+		state.inv_xform_to_parent = inv_xform_to_parent_;
+		state.xform_to_world = this->TransformToWorld();
+		state.inv_xform_to_world = this->InverseTransformToWorld();
+		state.prev_xform_to_world = prev_xform_to_world_;
+		if (parent_)
+		{
+			state.parent_xform_to_world = parent_->TransformToWorld();
+			state.inv_parent_xform_to_world = parent_->InverseTransformToWorld();
+		}
+		else
+		{
+			state.parent_xform_to_world = float4x4::Identity();
+			state.inv_parent_xform_to_world = float4x4::Identity();
+		}
+		state.written = false;
+	}
+
+	// Called under the update mutex after a parallel pass. Publishes what the handlers wrote.
+	void SceneNode::EndSubThreadState()
+	{
+		if (sub_state_ && sub_state_->written)
+		{
+			sub_state_->written = false;
+			this->TransformToParent(sub_state_->xform_to_parent);
+		}
+	}
+
 	void SceneNode::MainThreadUpdate(float app_time, float elapsed_time)
 	{
 		main_thread_update_event_(*this, app_time, elapsed_time);
@@ -0,0 +1,438 @@
+/**
+ * @file SoftwareOcclusionCuller.cpp
+ * @author Minmin Gong
+ *
+ * @section DESCRIPTION
+ *
+ * This source file is part of KlayGE
+ * For the latest info, see http://www.klayge.org
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * You may alternatively use this source under the terms of
+ * the KlayGE Proprietary License (KPL). You can obtained such a license
+ * from http://www.klayge.org/licensing/.
+ */
+
+#include <KlayGE/KlayGE.hpp>
+#include <KFL/Math.hpp>
+#include <KFL/SIMDMath.hpp>
+#include <KFL/SIMDVector.hpp>
+#include <KlayGE/SceneNode.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+#include <KlayGE/SoftwareOcclusionCuller.hpp>
+
+namespace
+{
+	using namespace KlayGE;
+
+	// Nearer than this in clip space w is treated as crossing the eye
+	float constexpr MIN_CLIP_W = 1e-5f;
+}
+
+namespace KlayGE
+{
+	SoftwareOcclusionCuller::SoftwareOcclusionCuller()
+		: width_(0), height_(0), view_proj_(float4x4::Identity()), num_tris_rasterized_(0)
+	{
+		this->Resize(256, 128);
+	}
+
+	void SoftwareOcclusionCuller::Resize(uint32_t width, uint32_t height)
+	{
+		BOOST_ASSERT((width > 0) && (height > 0));
+
+		width_ = width;
+		height_ = height;
+
+		depth_levels_.clear();
+		uint32_t level_width = width;
+		uint32_t level_height = height;
+		for (;;)
+		{
+			depth_levels_.emplace_back(level_width * level_height, 1.0f);
+			if ((1 == level_width) && (1 == level_height))
+			{
+				break;
+			}
+			level_width = (level_width + 1) / 2;
+			level_height = (level_height + 1) / 2;
+		}
+
+		num_tris_rasterized_ = 0;
+	}
+
+	uint32_t SoftwareOcclusionCuller::Width() const
+	{
+		return width_;
+	}
+
+	uint32_t SoftwareOcclusionCuller::Height() const
+	{
+		return height_;
+	}
+
+	void SoftwareOcclusionCuller::AddOccluder(
+		SceneNodePtr const & node, std::span<float3 const> positions, std::span<uint32_t const> indices)
+	{
+		BOOST_ASSERT(node);
+		BOOST_ASSERT(indices.size() % 3 == 0);
+
+		Occluder occluder;
+		occluder.node = node;
+		occluder.positions.assign(positions.begin(), positions.end());
+		occluder.indices.assign(indices.begin(), indices.end());
+		occluders_.push_back(std::move(occluder));
+	}
+
+	void SoftwareOcclusionCuller::RemoveOccluder(SceneNode const & node)
+	{
+		occluders_.erase(std::remove_if(occluders_.begin(), occluders_.end(),
+							 [&node](Occluder const & occluder) { return occluder.node.lock().get() == &node; }),
+			occluders_.end());
+	}
+
+	void SoftwareOcclusionCuller::ClearOccluders()
+	{
+		occluders_.clear();
+	}
+
+	uint32_t SoftwareOcclusionCuller::NumOccluders() const
+	{
+		return static_cast<uint32_t>(occluders_.size());
+	}
+
+	void SoftwareOcclusionCuller::Render(float4x4 const & view_proj, uint32_t camera_index)
+	{
+		view_proj_ = view_proj;
+		num_tris_rasterized_ = 0;
+
+		std::fill(depth_levels_[0].begin(), depth_levels_[0].end(), 1.0f);
+
+		// Occluders of removed nodes go away by themselves
+		occluders_.erase(std::remove_if(occluders_.begin(), occluders_.end(),
+							 [](Occluder const & occluder) { return occluder.node.expired(); }),
+			occluders_.end());
+
+		for (auto const & occluder : occluders_)
+		{
+			auto node = occluder.node.lock();
+			if (!node->Visible() || (node->VisibleMark(camera_index) == BoundOverlap::No))
+			{
+				continue;
+			}
+
+			float4x4 const mvp = node->TransformToWorld() * view_proj;
+			clip_positions_.resize(occluder.positions.size());
+			for (size_t i = 0; i < occluder.positions.size(); ++ i)
+			{
+				float3 const & pos = occluder.positions[i];
+				clip_positions_[i] = MathLib::transform(float4(pos.x(), pos.y(), pos.z(), 1), mvp);
+			}
+
+			for (size_t i = 0; i < occluder.indices.size(); i += 3)
+			{
+				this->RasterizeTriangle(clip_positions_[occluder.indices[i + 0]], clip_positions_[occluder.indices[i + 1]],
+					clip_positions_[occluder.indices[i + 2]]);
+			}
+		}
+
+		this->BuildDepthPyramid();
+	}
+
+	bool SoftwareOcclusionCuller::IsOccluded(AABBox const & aabb_ws) const
+	{
+		if (0 == num_tris_rasterized_)
+		{
+			return false;
+		}
+
+		float min_x = +1e10f;
+		float min_y = +1e10f;
+		float max_x = -1e10f;
+		float max_y = -1e10f;
+		float min_z = +1e10f;
+		for (int i = 0; i < 8; ++ i)
+		{
+			float3 const corner = aabb_ws.Corner(i);
+			float4 const clip = MathLib::transform(float4(corner.x(), corner.y(), corner.z(), 1), view_proj_);
+			if ((clip.w() < MIN_CLIP_W) || (clip.z() < 0))
+			{
+				// Crosses the near plane, can't be behind anything
+				return false;
+			}
+
+			float const inv_w = 1 / clip.w();
+			float const x = (clip.x() * inv_w * 0.5f + 0.5f) * width_;
+			float const y = (0.5f - clip.y() * inv_w * 0.5f) * height_;
+			min_x = std::min(min_x, x);
+			min_y = std::min(min_y, y);
+			max_x = std::max(max_x, x);
+			max_y = std::max(max_y, y);
+			min_z = std::min(min_z, clip.z() * inv_w);
+		}
+
+		if ((max_x < 0) || (max_y < 0) || (min_x >= width_) || (min_y >= height_))
+		{
+			// Outside of the screen is the business of frustum culling
+			return false;
+		}
+
+		uint32_t const x0 = static_cast<uint32_t>(std::max(min_x, 0.0f));
+		uint32_t const y0 = static_cast<uint32_t>(std::max(min_y, 0.0f));
+		uint32_t const x1 = std::min(static_cast<uint32_t>(max_x), width_ - 1);
+		uint32_t const y1 = std::min(static_cast<uint32_t>(max_y), height_ - 1);
+
+		// Go up until the rectangle covers at most 2x2 texels
+		uint32_t level = 0;
+		while ((level + 1 < depth_levels_.size()) && (((x1 >> level) - (x0 >> level) > 1) || ((y1 >> level) - (y0 >> level) > 1)))
+		{
+			++ level;
+		}
+
+		auto const & depths = depth_levels_[level];
+		uint32_t const level_width = ((width_ - 1) >> level) + 1;
+		for (uint32_t y = y0 >> level; y <= (y1 >> level); ++ y)
+		{
+			for (uint32_t x = x0 >> level; x <= (x1 >> level); ++ x)
+			{
+				if (min_z <= depths[y * level_width + x])
+				{
+					return false;
+				}
+			}
+		}
+
+		return true;
+	}
+
+	uint32_t SoftwareOcclusionCuller::NumTrianglesRasterized() const
+	{
+		return num_tris_rasterized_;
+	}
+
+	// Clips the triangle against the near plane (z >= 0 in clip space), then rasterizes the 1 or 2 triangles left
+	void SoftwareOcclusionCuller::RasterizeTriangle(float4 const & v0, float4 const & v1, float4 const & v2)
+	{
+		float4 const in_verts[] = { v0, v1, v2 };
+		float4 out_verts[4];
+		uint32_t num_out_verts = 0;
+		for (uint32_t i = 0; i < 3; ++ i)
+		{
+			float4 const & curr = in_verts[i];
+			float4 const & next = in_verts[(i + 1) % 3];
+			bool const curr_in = (curr.z() >= 0);
+			bool const next_in = (next.z() >= 0);
+			if (curr_in)
+			{
+				out_verts[num_out_verts] = curr;
+				++ num_out_verts;
+			}
+			if (curr_in != next_in)
+			{
+				// Always goes from the inner vertex, so an edge shared by 2 triangles is cut at exactly the same point
+				float4 const & in_vert = curr_in ? curr : next;
+				float4 const & out_vert = curr_in ? next : curr;
+				float const t = in_vert.z() / (in_vert.z() - out_vert.z());
+				out_verts[num_out_verts] = in_vert + (out_vert - in_vert) * t;
+				++ num_out_verts;
+			}
+		}
+
+		if (num_out_verts < 3)
+		{
+			return;
+		}
+
+		float3 screen_verts[4];
+		for (uint32_t i = 0; i < num_out_verts; ++ i)
+		{
+			float4 const & v = out_verts[i];
+			if (v.w() < MIN_CLIP_W)
+			{
+				return;
+			}
+
+			float const inv_w = 1 / v.w();
+			screen_verts[i] = float3((v.x() * inv_w * 0.5f + 0.5f) * width_, (0.5f - v.y() * inv_w * 0.5f) * height_,
+				std::min(v.z() * inv_w, 1.0f));
+		}
+
+		this->RasterizeScreenTriangle(screen_verts[0], screen_verts[1], screen_verts[2]);
+		if (4 == num_out_verts)
+		{
+			this->RasterizeScreenTriangle(screen_verts[0], screen_verts[2], screen_verts[3]);
+		}
+	}
+
+	// Edge functions, depth test and depth write are done 4 pixels at a time. Only pixel centers inside or exactly on an edge are written,
+	// so the occluders never cover more than they really do. The edge functions of a shared edge are exact negations of each
+	// other, so neighboring triangles leave no cracks.
+	void SoftwareOcclusionCuller::RasterizeScreenTriangle(float3 const & s0, float3 const & s1, float3 const & s2)
+	{
+		float3 v0 = s0;
+		float3 v1 = s1;
+		float3 v2 = s2;
+		float area = (v1.x() - v0.x()) * (v2.y() - v0.y()) - (v1.y() - v0.y()) * (v2.x() - v0.x());
+		if (std::abs(area) < 1e-6f)
+		{
+			return;
+		}
+		if (area < 0)
+		{
+			std::swap(v1, v2);
+			area = -area;
+		}
+
+		int const min_x = std::max(static_cast<int>(std::floor(std::min({ v0.x(), v1.x(), v2.x() }))), 0);
+		int const min_y = std::max(static_cast<int>(std::floor(std::min({ v0.y(), v1.y(), v2.y() }))), 0);
+		int const max_x = std::min(static_cast<int>(std::ceil(std::max({ v0.x(), v1.x(), v2.x() }))), static_cast<int>(width_) - 1);
+		int const max_y = std::min(static_cast<int>(std::ceil(std::max({ v0.y(), v1.y(), v2.y() }))), static_cast<int>(height_) - 1);
+		if ((min_x > max_x) || (min_y > max_y))
+		{
+			return;
+		}
+
+		++ num_tris_rasterized_;
+
+		// e(x, y) = a * x + b * y + c, positive on the inner side of each edge
+		float3 const * const verts[] = { &v0, &v1, &v2 };
+		float a[3];
+		float b[3];
+		float c[3];
+		for (uint32_t i = 0; i < 3; ++ i)
+		{
+			float3 const & p0 = *verts[(i + 1) % 3];
+			float3 const & p1 = *verts[(i + 2) % 3];
+			a[i] = p0.y() - p1.y();
+			b[i] = p1.x() - p0.x();
+			c[i] = p0.x() * p1.y() - p1.x() * p0.y();
+		}
+
+		// Edge i is opposite to vertex i, so e_i / area is the barycentric coordinate of vertex i
+		float const inv_area = 1 / area;
+		float const za = (a[0] * v0.z() + a[1] * v1.z() + a[2] * v2.z()) * inv_area;
+		float const zb = (b[0] * v0.z() + b[1] * v1.z() + b[2] * v2.z()) * inv_area;
+		float const zc = (c[0] * v0.z() + c[1] * v1.z() + c[2] * v2.z()) * inv_area;
+
+		SIMDVectorF4 const offsets = SIMDMathLib::SetVector(0.5f, 1.5f, 2.5f, 3.5f);
+		SIMDVectorF4 const e0_step = SIMDMathLib::SetVector(a[0] * 4);
+		SIMDVectorF4 const e1_step = SIMDMathLib::SetVector(a[1] * 4);
+		SIMDVectorF4 const e2_step = SIMDMathLib::SetVector(a[2] * 4);
+		SIMDVectorF4 const z_step = SIMDMathLib::SetVector(za * 4);
+		SIMDVectorF4 const zero = SIMDMathLib::SetVector(0.0f);
+
+		auto& depths = depth_levels_[0];
+		for (int y = min_y; y <= max_y; ++ y)
+		{
+			float const fy = y + 0.5f;
+			float const fx = static_cast<float>(min_x);
+			SIMDVectorF4 e0 = offsets * a[0] + (a[0] * fx + b[0] * fy + c[0]);
+			SIMDVectorF4 e1 = offsets * a[1] + (a[1] * fx + b[1] * fy + c[1]);
+			SIMDVectorF4 e2 = offsets * a[2] + (a[2] * fx + b[2] * fy + c[2]);
+			SIMDVectorF4 z = offsets * za + (za * fx + zb * fy + zc);
+
+			float* row = &depths[y * width_];
+			int x = min_x;
+			for (; x + 3 <= max_x; x += 4)
+			{
+				// A pixel is inside when none of its edge functions is negative
+				SIMDVectorF4 const e = SIMDMathLib::Minimize(SIMDMathLib::Minimize(e0, e1), e2);
+				if (SIMDMathLib::LessMask(e, zero) != 0xF)
+				{
+					SIMDVectorF4 const old_z = SIMDMathLib::LoadVector4(row + x);
+					SIMDVectorF4 const new_z = SIMDMathLib::Minimize(old_z, SIMDMathLib::Maximize(z, zero));
+					SIMDMathLib::StoreVector4(row + x, SIMDMathLib::SelectGreaterEqual(e, zero, new_z, old_z));
+				}
+
+				e0 += e0_step;
+				e1 += e1_step;
+				e2 += e2_step;
+				z += z_step;
+			}
+			if (x <= max_x)
+			{
+				// The last pixels of the row can't be loaded 4 at a time
+				float4 e0s;
+				float4 e1s;
+				float4 e2s;
+				float4 zs;
+				SIMDMathLib::StoreVector4(e0s, e0);
+				SIMDMathLib::StoreVector4(e1s, e1);
+				SIMDMathLib::StoreVector4(e2s, e2);
+				SIMDMathLib::StoreVector4(zs, z);
+
+				for (int i = 0; i <= max_x - x; ++ i)
+				{
+					if ((e0s[i] >= 0) && (e1s[i] >= 0) && (e2s[i] >= 0))
+					{
+						row[x + i] = std::min(row[x + i], std::max(zs[i], 0.0f));
+					}
+				}
+			}
+		}
+	}
+
+	void SoftwareOcclusionCuller::BuildDepthPyramid()
+	{
+		uint32_t src_width = width_;
+		uint32_t src_height = height_;
+		for (size_t level = 1; level < depth_levels_.size(); ++ level)
+		{
+			auto const & src = depth_levels_[level - 1];
+			auto& dst = depth_levels_[level];
+			uint32_t const dst_width = (src_width + 1) / 2;
+			uint32_t const dst_height = (src_height + 1) / 2;
+			for (uint32_t y = 0; y < dst_height; ++ y)
+			{
+				uint32_t const sy0 = y * 2;
+				uint32_t const sy1 = std::min(sy0 + 1, src_height - 1);
+				float const * src_row0 = &src[sy0 * src_width];
+				float const * src_row1 = &src[sy1 * src_width];
+
+				// 4 texels from 8 columns of the 2 rows. The rows are merged 4 wide, then the column pairs.
+				uint32_t x = 0;
+				for (; x * 2 + 8 <= src_width; x += 4)
+				{
+					float4 lo;
+					float4 hi;
+					SIMDMathLib::StoreVector4(lo,
+						SIMDMathLib::Maximize(SIMDMathLib::LoadVector4(src_row0 + x * 2), SIMDMathLib::LoadVector4(src_row1 + x * 2)));
+					SIMDMathLib::StoreVector4(hi,
+						SIMDMathLib::Maximize(SIMDMathLib::LoadVector4(src_row0 + x * 2 + 4), SIMDMathLib::LoadVector4(src_row1 + x * 2 + 4)));
+					dst[y * dst_width + x + 0] = std::max(lo[0], lo[1]);
+					dst[y * dst_width + x + 1] = std::max(lo[2], lo[3]);
+					dst[y * dst_width + x + 2] = std::max(hi[0], hi[1]);
+					dst[y * dst_width + x + 3] = std::max(hi[2], hi[3]);
+				}
+				for (; x < dst_width; ++ x)
+				{
+					uint32_t const sx0 = x * 2;
+					uint32_t const sx1 = std::min(sx0 + 1, src_width - 1);
+					dst[y * dst_width + x] = std::max(std::max(src[sy0 * src_width + sx0], src[sy0 * src_width + sx1]),
+						std::max(src[sy1 * src_width + sx0], src[sy1 * src_width + sx1]));
+				}
+			}
+
+			src_width = dst_width;
+			src_height = dst_height;
+		}
+	}
+} // namespace KlayGE
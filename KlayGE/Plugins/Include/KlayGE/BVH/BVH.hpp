@@ -0,0 +1,135 @@
+/**
+ * @file BVH.hpp
+ * @author Minmin Gong
+ *
+ * @section DESCRIPTION
+ *
+ * This source file is part of KlayGE
+ * For the latest info, see http://www.klayge.org
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * You may alternatively use this source under the terms of
+ * the KlayGE Proprietary License (KPL). You can obtained such a license
+ * from http://www.klayge.org/licensing/.
+ */
+
+#ifndef KLAYGE_PLUGINS_BVH_HPP
+#define KLAYGE_PLUGINS_BVH_HPP
+
+#pragma once
+
+#include <KlayGE/PreDeclare.hpp>
+#include <KlayGE/SceneNode.hpp>
+#include <KlayGE/SceneManager.hpp>
+#include <KFL/SIMDVector.hpp>
+
+#include <vector>
+
+namespace KlayGE
+{
+	// Bounding volume hierarchy over the world space bounds of cullable nodes. It's built with binned SAH, and refitted
+	// when nodes move. A full rebuild only happens when the scene structure changes, or the refitted tree gets too loose.
+	class BVH final : public SceneManager
+	{
+	public:
+		BVH();
+
+		void MaxLeafSize(uint32_t max_leaf_size);
+		uint32_t MaxLeafSize() const;
+
+		void ClipScene() override;
+
+		void ClearObject() override;
+
+		void OnSceneChanged() override;
+
+	private:
+		void DoSuspend() override;
+		void DoResume() override;
+
+		bool NeedRebuild() const;
+		void BuildTree();
+		uint32_t BuildNode(uint32_t begin, uint32_t end);
+		void RefitTree();
+		void CullTree(Viewport const & viewport, uint32_t num_cameras);
+		void CullPrimitives(Viewport const & viewport, uint32_t node_index, uint32_t partial_mask, uint32_t yes_mask,
+			uint32_t small_mask);
+		uint32_t SmallObjectMask(Viewport const & viewport, float3 const & min_pt, float3 const & max_pt, uint32_t camera_mask) const;
+		void IntersectFrustums(float3 const & min_pt, float3 const & max_pt, uint32_t camera_mask,
+			uint32_t& partial_mask, uint32_t& yes_mask) const;
+
+	private:
+		BVH(BVH const & rhs);
+		BVH& operator=(BVH const & rhs);
+
+	private:
+		// Internal nodes have num_prims == 0. Their left child follows them, and first is the right child.
+		// Leaves hold the primitives [first, first + num_prims).
+		struct bvh_node_t
+		{
+			float3 min_pt;
+			uint32_t first;
+			float3 max_pt;
+			uint32_t num_prims;
+		};
+
+		struct bvh_prim_t
+		{
+			float3 min_pt;
+			uint32_t scene_node;
+			float3 max_pt;
+			uint32_t leaf;
+		};
+
+		// Frustum planes of one camera, 4 planes per SIMD vector. The last 2 planes are padding that never culls.
+		struct frustum_planes_t
+		{
+			SIMDVectorF4 a[2];
+			SIMDVectorF4 b[2];
+			SIMDVectorF4 c[2];
+			SIMDVectorF4 d[2];
+			SIMDVectorF4 abs_a[2];
+			SIMDVectorF4 abs_b[2];
+			SIMDVectorF4 abs_c[2];
+		};
+
+		std::vector<bvh_node_t> nodes_;
+		std::vector<uint32_t> node_parents_;
+		std::vector<uint8_t> node_dirties_;
+		std::vector<bvh_prim_t> prims_;
+
+		// Culling results of the primitives themselves, indexed the same as prims_
+		std::vector<std::array<BoundOverlap, RenderEngine::PredefinedCameraCBuffer::max_num_cameras>> prim_visible_marks_;
+		std::vector<uint32_t> prim_small_obj_masks_;
+
+		// Indexed the same as all_scene_nodes_
+		std::vector<SceneNode*> bvh_scene_nodes_;
+		std::vector<uint32_t> scene_node_prims_;
+
+		std::vector<frustum_planes_t> frustum_planes_;
+		uint32_t omni_directional_mask_;
+
+		uint32_t max_leaf_size_;
+		float build_area_;
+		float curr_area_;
+
+		bool rebuild_tree_;
+	};
+}
+
+#endif		// KLAYGE_PLUGINS_BVH_HPP
@@ -41,6 +41,11 @@ namespace KlayGE
 		void MaxTreeDepth(uint32_t max_tree_depth);
 		uint32_t MaxTreeDepth() const;
 
+		// Loose mode keeps the tree across frames and relocates nodes one by one when their bounds change. Moveable nodes are
+		// put in the tree too, instead of being tested against the frustums every frame.
+		void LooseMode(bool loose);
+		bool LooseMode() const;
+
 		void ClipScene() override;
 
 		BoundOverlap AABBVisible(AABBox const & aabb) const override;
@@ -57,9 +62,16 @@ namespace KlayGE
 		void DoResume() override;
 
 		void DivideNode(size_t index, uint32_t curr_depth);
-		void NodeVisible(size_t index);
+		void NodeVisible(size_t index, BoundOverlap visible);
 		void MarkNodeObjs(size_t index, bool force);
 
+		void UpdateLooseTree();
+		void RebuildLooseTree();
+		void LooseInsert(size_t n);
+		void LooseRemove(size_t n);
+		size_t LooseTargetNode(AABBox const & aabb, bool& outside);
+		void LooseDivideNode(size_t index, float3 const & center, float half_size);
+
 		BoundOverlap BoundVisible(size_t index, AABBox const & aabb) const;
 		BoundOverlap BoundVisible(size_t index, OBBox const & obb) const;
 		BoundOverlap BoundVisible(size_t index, Sphere const & sphere) const;
@@ -85,6 +97,22 @@ namespace KlayGE
 
 		bool rebuild_tree_;
 
+		// Where each scene node lives in the loose tree, indexed the same as all_scene_nodes_
+		struct loose_entry_t
+		{
+			int node_index;
+			bool outside;
+			bool reached;
+			AABBox aabb;
+		};
+
+		bool loose_mode_;
+		AABBox loose_root_bb_;
+		std::vector<SceneNode*> loose_scene_nodes_;
+		std::vector<loose_entry_t> loose_entries_;
+		size_t loose_num_objs_;
+		size_t loose_num_outside_;
+
 #ifdef KLAYGE_DRAW_NODES
 		RenderablePtr node_renderable_;
 #endif
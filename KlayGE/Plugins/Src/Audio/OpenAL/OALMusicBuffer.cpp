@@ -74,6 +74,8 @@ namespace KlayGE
 		}
 		played_ = false;
 
+		// One buffer for all the refills of this play
+		std::vector<uint8_t> data(READ_SIZE);
 		while (!stopped_)
 		{
 			ALint processed;
@@ -87,7 +89,7 @@ namespace KlayGE
 					ALuint buf;
 					alSourceUnqueueBuffers(source_, 1, &buf);
 
-					std::vector<uint8_t> data(READ_SIZE);
+					data.resize(READ_SIZE);
 					data.resize(data_source_->Read(data.data(), data.size()));
 					if (data.empty())
 					{
@@ -233,19 +233,19 @@ namespace
 		void LoadFromAssimp(std::string_view input_name, MeshMetadata const & metadata);
 
 		// From MeshML
-		void CompileMaterialsChunk(XMLNodePtr const & materials_chunk);
-		void CompileMeshBoundingBox(XMLNodePtr const & mesh_node, uint32_t mesh_index,
+		void CompileMaterialsChunk(XMLNodeHandle materials_chunk);
+		void CompileMeshBoundingBox(XMLNodeHandle mesh_node, uint32_t mesh_index,
 			bool& recompute_pos_bb, bool& recompute_tc_bb);
-		void CompileMeshesChunk(XMLNodePtr const & meshes_chunk);
-		void CompileMeshLodChunk(XMLNodePtr const & lod_node, uint32_t mesh_index, uint32_t lod,
+		void CompileMeshesChunk(XMLNodeHandle meshes_chunk);
+		void CompileMeshLodChunk(XMLNodeHandle lod_node, uint32_t mesh_index, uint32_t lod,
 			bool recompute_pos_bb, bool recompute_tc_bb);
-		void CompileMeshesVerticesChunk(XMLNodePtr const & vertices_chunk, uint32_t mesh_index, uint32_t lod,
+		void CompileMeshesVerticesChunk(XMLNodeHandle vertices_chunk, uint32_t mesh_index, uint32_t lod,
 			bool recompute_pos_bb, bool recompute_tc_bb);
-		void CompileMeshesTrianglesChunk(XMLNodePtr const & triangles_chunk, uint32_t mesh_index, uint32_t lod);
-		void CompileBonesChunk(XMLNodePtr const & bones_chunk);
-		void CompileKeyFramesChunk(XMLNodePtr const & key_frames_chunk);
-		void CompileBBKeyFramesChunk(XMLNodePtr const & bb_kfs_chunk, uint32_t mesh_index);
-		void CompileActionsChunk(XMLNodePtr const & animations_chunk);
+		void CompileMeshesTrianglesChunk(XMLNodeHandle triangles_chunk, uint32_t mesh_index, uint32_t lod);
+		void CompileBonesChunk(XMLNodeHandle bones_chunk);
+		void CompileKeyFramesChunk(XMLNodeHandle key_frames_chunk);
+		void CompileBBKeyFramesChunk(XMLNodeHandle bb_kfs_chunk, uint32_t mesh_index);
+		void CompileActionsChunk(XMLNodeHandle animations_chunk);
 		void LoadFromMeshML(std::string_view input_name, MeshMetadata const & metadata);
 
 	private:
@@ -1926,10 +1926,10 @@ namespace
 		}
 	}
 
-	void MeshLoader::CompileMaterialsChunk(XMLNodePtr const & materials_chunk)
+	void MeshLoader::CompileMaterialsChunk(XMLNodeHandle materials_chunk)
 	{
 		uint32_t num_mtls = 0;
-		for (XMLNodePtr mtl_node = materials_chunk->FirstNode("material"); mtl_node;
+		for (XMLNodeHandle mtl_node = materials_chunk->FirstNode("material"); mtl_node;
 			mtl_node = mtl_node->NextSibling("material"))
 		{
 			++ num_mtls;
@@ -1938,7 +1938,7 @@ namespace
 		render_model_->NumMaterials(num_mtls);
 
 		uint32_t mtl_index = 0;
-		for (XMLNodePtr mtl_node = materials_chunk->FirstNode("material"); mtl_node;
+		for (XMLNodeHandle mtl_node = materials_chunk->FirstNode("material"); mtl_node;
 			mtl_node = mtl_node->NextSibling("material"), ++ mtl_index)
 		{
 			render_model_->GetMaterial(mtl_index) = MakeSharedPtr<RenderMaterial>();
@@ -1964,17 +1964,17 @@ namespace
 			mtl.MaxTessFactor(9);
 
 			{
-				XMLAttributePtr attr = mtl_node->Attrib("name");
+				XMLAttributeHandle attr = mtl_node->Attrib("name");
 				if (attr)
 				{
 					mtl.Name(attr->ValueString());
 				}
 			}
 
-			XMLNodePtr albedo_node = mtl_node->FirstNode("albedo");
+			XMLNodeHandle albedo_node = mtl_node->FirstNode("albedo");
 			if (albedo_node)
 			{
-				XMLAttributePtr attr = albedo_node->Attrib("color");
+				XMLAttributeHandle attr = albedo_node->Attrib("color");
 				if (attr)
 				{
 					float4 albedo;
@@ -1991,7 +1991,7 @@ namespace
 			{
 				float4 albedo(0, 0, 0, 1);
 
-				XMLAttributePtr attr = mtl_node->Attrib("diffuse");
+				XMLAttributeHandle attr = mtl_node->Attrib("diffuse");
 				if (attr)
 				{
 					ExtractFVector<3>(attr->ValueString(), &albedo[0]);
@@ -2024,10 +2024,10 @@ namespace
 				mtl.Albedo(albedo);
 			}
 
-			XMLNodePtr metalness_glossiness_node = mtl_node->FirstNode("metalness_glossiness");
+			XMLNodeHandle metalness_glossiness_node = mtl_node->FirstNode("metalness_glossiness");
 			if (metalness_glossiness_node)
 			{
-				XMLAttributePtr attr = metalness_glossiness_node->Attrib("metalness");
+				XMLAttributeHandle attr = metalness_glossiness_node->Attrib("metalness");
 				if (attr)
 				{
 					mtl.Metalness(attr->ValueFloat());
@@ -2045,10 +2045,10 @@ namespace
 			}
 			else
 			{
-				XMLNodePtr metalness_node = mtl_node->FirstNode("metalness");
+				XMLNodeHandle metalness_node = mtl_node->FirstNode("metalness");
 				if (metalness_node)
 				{
-					XMLAttributePtr attr = metalness_node->Attrib("value");
+					XMLAttributeHandle attr = metalness_node->Attrib("value");
 					if (attr)
 					{
 						mtl.Metalness(attr->ValueFloat());
@@ -2060,10 +2060,10 @@ namespace
 					}
 				}
 
-				XMLNodePtr glossiness_node = mtl_node->FirstNode("glossiness");
+				XMLNodeHandle glossiness_node = mtl_node->FirstNode("glossiness");
 				if (glossiness_node)
 				{
-					XMLAttributePtr attr = glossiness_node->Attrib("value");
+					XMLAttributeHandle attr = glossiness_node->Attrib("value");
 					if (attr)
 					{
 						mtl.Glossiness(attr->ValueFloat());
@@ -2076,7 +2076,7 @@ namespace
 				}
 				else
 				{
-					XMLAttributePtr attr = mtl_node->Attrib("shininess");
+					XMLAttributeHandle attr = mtl_node->Attrib("shininess");
 					if (attr)
 					{
 						float shininess = mtl_node->Attrib("shininess")->ValueFloat();
@@ -2086,10 +2086,10 @@ namespace
 				}
 			}
 
-			XMLNodePtr emissive_node = mtl_node->FirstNode("emissive");
+			XMLNodeHandle emissive_node = mtl_node->FirstNode("emissive");
 			if (emissive_node)
 			{
-				XMLAttributePtr attr = emissive_node->Attrib("color");
+				XMLAttributeHandle attr = emissive_node->Attrib("color");
 				if (attr)
 				{
 					float3 emissive;
@@ -2106,7 +2106,7 @@ namespace
 			{
 				float3 emissive(0, 0, 0);
 
-				XMLAttributePtr attr = mtl_node->Attrib("emit");
+				XMLAttributeHandle attr = mtl_node->Attrib("emit");
 				if (attr)
 				{
 					ExtractFVector<3>(attr->ValueString(), &emissive[0]);
@@ -2133,24 +2133,24 @@ namespace
 				mtl.Emissive(emissive);
 			}
 			
-			XMLNodePtr normal_node = mtl_node->FirstNode("normal");
+			XMLNodeHandle normal_node = mtl_node->FirstNode("normal");
 			if (normal_node)
 			{
-				XMLAttributePtr attr = normal_node->Attrib("texture");
+				XMLAttributeHandle attr = normal_node->Attrib("texture");
 				if (attr)
 				{
 					mtl.TextureName(RenderMaterial::TS_Normal, std::string(attr->ValueString()));
 				}
 			}
 
-			XMLNodePtr height_node = mtl_node->FirstNode("height");
+			XMLNodeHandle height_node = mtl_node->FirstNode("height");
 			if (!height_node)
 			{
 				height_node = mtl_node->FirstNode("bump");
 			}
 			if (height_node)
 			{
-				XMLAttributePtr attr = height_node->Attrib("texture");
+				XMLAttributeHandle attr = height_node->Attrib("texture");
 				if (attr)
 				{
 					mtl.TextureName(RenderMaterial::TS_Height, std::string(attr->ValueString()));
@@ -2169,10 +2169,10 @@ namespace
 				}
 			}
 
-			XMLNodePtr detail_node = mtl_node->FirstNode("detail");
+			XMLNodeHandle detail_node = mtl_node->FirstNode("detail");
 			if (detail_node)
 			{
-				XMLAttributePtr attr = detail_node->Attrib("mode");
+				XMLAttributeHandle attr = detail_node->Attrib("mode");
 				if (attr)
 				{
 					std::string_view const mode_str = attr->ValueString();
@@ -2203,7 +2203,7 @@ namespace
 					mtl.HeightScale(attr->ValueFloat());
 				}
 
-				XMLNodePtr tess_node = detail_node->FirstNode("tess");
+				XMLNodeHandle tess_node = detail_node->FirstNode("tess");
 				if (tess_node)
 				{
 					attr = tess_node->Attrib("edge_hint");
@@ -2252,30 +2252,30 @@ namespace
 				}
 			}
 
-			XMLNodePtr transparent_node = mtl_node->FirstNode("transparent");
+			XMLNodeHandle transparent_node = mtl_node->FirstNode("transparent");
 			if (transparent_node)
 			{
-				XMLAttributePtr attr = transparent_node->Attrib("value");
+				XMLAttributeHandle attr = transparent_node->Attrib("value");
 				if (attr)
 				{
 					mtl.Transparent(attr->ValueInt() ? true : false);
 				}
 			}
 
-			XMLNodePtr alpha_test_node = mtl_node->FirstNode("alpha_test");
+			XMLNodeHandle alpha_test_node = mtl_node->FirstNode("alpha_test");
 			if (alpha_test_node)
 			{
-				XMLAttributePtr attr = alpha_test_node->Attrib("value");
+				XMLAttributeHandle attr = alpha_test_node->Attrib("value");
 				if (attr)
 				{
 					mtl.AlphaTestThreshold(attr->ValueFloat());
 				}
 			}
 
-			XMLNodePtr sss_node = mtl_node->FirstNode("sss");
+			XMLNodeHandle sss_node = mtl_node->FirstNode("sss");
 			if (sss_node)
 			{
-				XMLAttributePtr attr = sss_node->Attrib("value");
+				XMLAttributeHandle attr = sss_node->Attrib("value");
 				if (attr)
 				{
 					mtl.Sss(attr->ValueInt() ? true : false);
@@ -2283,27 +2283,27 @@ namespace
 			}
 			else
 			{
-				XMLAttributePtr attr = mtl_node->Attrib("sss");
+				XMLAttributeHandle attr = mtl_node->Attrib("sss");
 				if (attr)
 				{
 					mtl.Sss(attr->ValueInt() ? true : false);
 				}
 			}
 
-			XMLNodePtr two_sided_node = mtl_node->FirstNode("two_sided");
+			XMLNodeHandle two_sided_node = mtl_node->FirstNode("two_sided");
 			if (two_sided_node)
 			{
-				XMLAttributePtr attr = two_sided_node->Attrib("value");
+				XMLAttributeHandle attr = two_sided_node->Attrib("value");
 				if (attr)
 				{
 					mtl.TwoSided(attr->ValueInt() ? true : false);
 				}
 			}
 
-			XMLNodePtr tex_node = mtl_node->FirstNode("texture");
+			XMLNodeHandle tex_node = mtl_node->FirstNode("texture");
 			if (!tex_node)
 			{
-				XMLNodePtr textures_chunk = mtl_node->FirstNode("textures_chunk");
+				XMLNodeHandle textures_chunk = mtl_node->FirstNode("textures_chunk");
 				if (textures_chunk)
 				{
 					tex_node = textures_chunk->FirstNode("texture");
@@ -2347,36 +2347,36 @@ namespace
 		}
 	}
 
-	void MeshLoader::CompileMeshBoundingBox(XMLNodePtr const & mesh_node, uint32_t mesh_index,
+	void MeshLoader::CompileMeshBoundingBox(XMLNodeHandle mesh_node, uint32_t mesh_index,
 		bool& recompute_pos_bb, bool& recompute_tc_bb)
 	{
-		XMLNodePtr pos_bb_node = mesh_node->FirstNode("pos_bb");
+		XMLNodeHandle pos_bb_node = mesh_node->FirstNode("pos_bb");
 		if (pos_bb_node)
 		{
 			float3 pos_min_bb, pos_max_bb;
 			{
-				XMLAttributePtr attr = pos_bb_node->Attrib("min");
+				XMLAttributeHandle attr = pos_bb_node->Attrib("min");
 				if (attr)
 				{
 					ExtractFVector<3>(attr->ValueString(), &pos_min_bb[0]);
 				}
 				else
 				{
-					XMLNodePtr pos_min_node = pos_bb_node->FirstNode("min");
+					XMLNodeHandle pos_min_node = pos_bb_node->FirstNode("min");
 					pos_min_bb.x() = pos_min_node->Attrib("x")->ValueFloat();
 					pos_min_bb.y() = pos_min_node->Attrib("y")->ValueFloat();
 					pos_min_bb.z() = pos_min_node->Attrib("z")->ValueFloat();
 				}
 			}
 			{
-				XMLAttributePtr attr = pos_bb_node->Attrib("max");
+				XMLAttributeHandle attr = pos_bb_node->Attrib("max");
 				if (attr)
 				{
 					ExtractFVector<3>(attr->ValueString(), &pos_max_bb[0]);
 				}
 				else
 				{
-					XMLNodePtr pos_max_node = pos_bb_node->FirstNode("max");
+					XMLNodeHandle pos_max_node = pos_bb_node->FirstNode("max");
 					pos_max_bb.x() = pos_max_node->Attrib("x")->ValueFloat();
 					pos_max_bb.y() = pos_max_node->Attrib("y")->ValueFloat();
 					pos_max_bb.z() = pos_max_node->Attrib("z")->ValueFloat();
@@ -2391,32 +2391,32 @@ namespace
 			recompute_pos_bb = true;
 		}
 
-		XMLNodePtr tc_bb_node = mesh_node->FirstNode("tc_bb");
+		XMLNodeHandle tc_bb_node = mesh_node->FirstNode("tc_bb");
 		if (tc_bb_node)
 		{
 			float3 tc_min_bb, tc_max_bb;
 			{
-				XMLAttributePtr attr = tc_bb_node->Attrib("min");
+				XMLAttributeHandle attr = tc_bb_node->Attrib("min");
 				if (attr)
 				{
 					ExtractFVector<2>(attr->ValueString(), &tc_min_bb[0]);
 				}
 				else
 				{
-					XMLNodePtr tc_min_node = tc_bb_node->FirstNode("min");
+					XMLNodeHandle tc_min_node = tc_bb_node->FirstNode("min");
 					tc_min_bb.x() = tc_min_node->Attrib("x")->ValueFloat();
 					tc_min_bb.y() = tc_min_node->Attrib("y")->ValueFloat();
 				}
 			}
 			{
-				XMLAttributePtr attr = tc_bb_node->Attrib("max");
+				XMLAttributeHandle attr = tc_bb_node->Attrib("max");
 				if (attr)
 				{
 					ExtractFVector<2>(attr->ValueString(), &tc_max_bb[0]);
 				}
 				else
 				{
-					XMLNodePtr tc_max_node = tc_bb_node->FirstNode("max");
+					XMLNodeHandle tc_max_node = tc_bb_node->FirstNode("max");
 					tc_max_bb.x() = tc_max_node->Attrib("x")->ValueFloat();
 					tc_max_bb.y() = tc_max_node->Attrib("y")->ValueFloat();
 				}
@@ -2434,10 +2434,10 @@ namespace
 		}
 	}
 
-	void MeshLoader::CompileMeshesChunk(XMLNodePtr const & meshes_chunk)
+	void MeshLoader::CompileMeshesChunk(XMLNodeHandle meshes_chunk)
 	{
 		uint32_t num_meshes = 0;
-		for (XMLNodePtr mesh_node = meshes_chunk->FirstNode("mesh"); mesh_node; mesh_node = mesh_node->NextSibling("mesh"))
+		for (XMLNodeHandle mesh_node = meshes_chunk->FirstNode("mesh"); mesh_node; mesh_node = mesh_node->NextSibling("mesh"))
 		{
 			++ num_meshes;
 		}
@@ -2445,7 +2445,7 @@ namespace
 		nodes_.resize(num_meshes);
 
 		uint32_t mesh_index = 0;
-		for (XMLNodePtr mesh_node = meshes_chunk->FirstNode("mesh"); mesh_node; mesh_node = mesh_node->NextSibling("mesh"), ++ mesh_index)
+		for (XMLNodeHandle mesh_node = meshes_chunk->FirstNode("mesh"); mesh_node; mesh_node = mesh_node->NextSibling("mesh"), ++ mesh_index)
 		{
 			auto const name = std::string(mesh_node->Attrib("name")->ValueString());
 			std::wstring wname;
@@ -2471,14 +2471,14 @@ namespace
 			this->CompileMeshBoundingBox(mesh_node, mesh_index, recompute_pos_bb, recompute_tc_bb);
 			if (recompute_pos_bb && recompute_tc_bb)
 			{
-				XMLNodePtr vertices_chunk = mesh_node->FirstNode("vertices_chunk");
+				XMLNodeHandle vertices_chunk = mesh_node->FirstNode("vertices_chunk");
 				if (vertices_chunk)
 				{
 					this->CompileMeshBoundingBox(vertices_chunk, mesh_index, recompute_pos_bb, recompute_tc_bb);
 				}
 			}
 
-			XMLNodePtr lod_node = mesh_node->FirstNode("lod");
+			XMLNodeHandle lod_node = mesh_node->FirstNode("lod");
 			if (lod_node)
 			{
 				uint32_t mesh_lod = 0;
@@ -2487,7 +2487,7 @@ namespace
 					++ mesh_lod;
 				}
 
-				std::vector<XMLNodePtr> lod_nodes(mesh_lod);
+				std::vector<XMLNodeHandle> lod_nodes(mesh_lod);
 				for (lod_node = mesh_node->FirstNode("lod"); lod_node; lod_node = lod_node->NextSibling("lod"))
 				{
 					uint32_t const lod = lod_node->Attrib("value")->ValueUInt();
@@ -2516,24 +2516,24 @@ namespace
 		}
 	}
 
-	void MeshLoader::CompileMeshLodChunk(XMLNodePtr const & lod_node, uint32_t mesh_index, uint32_t lod,
+	void MeshLoader::CompileMeshLodChunk(XMLNodeHandle lod_node, uint32_t mesh_index, uint32_t lod,
 		bool recompute_pos_bb, bool recompute_tc_bb)
 	{
-		XMLNodePtr vertices_chunk = lod_node->FirstNode("vertices_chunk");
+		XMLNodeHandle vertices_chunk = lod_node->FirstNode("vertices_chunk");
 		if (vertices_chunk)
 		{
 			this->CompileMeshesVerticesChunk(vertices_chunk, mesh_index, lod,
 				recompute_pos_bb, recompute_tc_bb);
 		}
 
-		XMLNodePtr triangles_chunk = lod_node->FirstNode("triangles_chunk");
+		XMLNodeHandle triangles_chunk = lod_node->FirstNode("triangles_chunk");
 		if (triangles_chunk)
 		{
 			CompileMeshesTrianglesChunk(triangles_chunk, mesh_index, lod);
 		}
 	}
 
-	void MeshLoader::CompileMeshesVerticesChunk(XMLNodePtr const & vertices_chunk, uint32_t mesh_index, uint32_t lod,
+	void MeshLoader::CompileMeshesVerticesChunk(XMLNodeHandle vertices_chunk, uint32_t mesh_index, uint32_t lod,
 		bool recompute_pos_bb, bool recompute_tc_bb)
 	{
 		auto& mesh = meshes_[mesh_index];
@@ -2550,11 +2550,11 @@ namespace
 		bool has_binormal = false;
 		bool has_tangent_quat = false;
 
-		for (XMLNodePtr vertex_node = vertices_chunk->FirstNode("vertex"); vertex_node; vertex_node = vertex_node->NextSibling("vertex"))
+		for (XMLNodeHandle vertex_node = vertices_chunk->FirstNode("vertex"); vertex_node; vertex_node = vertex_node->NextSibling("vertex"))
 		{
 			{
 				float3 pos;
-				XMLAttributePtr attr = vertex_node->Attrib("x");
+				XMLAttributeHandle attr = vertex_node->Attrib("x");
 				if (attr)
 				{
 					pos.x() = vertex_node->Attrib("x")->ValueFloat();
@@ -2578,13 +2578,13 @@ namespace
 				mesh_lod.positions.push_back(pos);
 			}
 
-			XMLNodePtr diffuse_node = vertex_node->FirstNode("diffuse");
+			XMLNodeHandle diffuse_node = vertex_node->FirstNode("diffuse");
 			if (diffuse_node)
 			{
 				has_diffuse = true;
 
 				float4 diffuse;
-				XMLAttributePtr attr = diffuse_node->Attrib("v");
+				XMLAttributeHandle attr = diffuse_node->Attrib("v");
 				if (attr)
 				{
 					ExtractFVector<4>(attr->ValueString(), &diffuse[0]);
@@ -2599,13 +2599,13 @@ namespace
 				mesh_lod.diffuses.push_back(Color(diffuse.x(), diffuse.y(), diffuse.z(), diffuse.w()));
 			}
 
-			XMLNodePtr specular_node = vertex_node->FirstNode("specular");
+			XMLNodeHandle specular_node = vertex_node->FirstNode("specular");
 			if (specular_node)
 			{
 				has_specular = true;
 
 				float3 specular;
-				XMLAttributePtr attr = specular_node->Attrib("v");
+				XMLAttributeHandle attr = specular_node->Attrib("v");
 				if (attr)
 				{
 					ExtractFVector<3>(attr->ValueString(), &specular[0]);
@@ -2621,13 +2621,13 @@ namespace
 
 			if (!vertex_node->Attrib("u"))
 			{
-				XMLNodePtr tex_coord_node = vertex_node->FirstNode("tex_coord");
+				XMLNodeHandle tex_coord_node = vertex_node->FirstNode("tex_coord");
 				if (tex_coord_node)
 				{
 					has_tex_coord = true;
 
 					float3 tex_coord;
-					XMLAttributePtr attr = tex_coord_node->Attrib("u");
+					XMLAttributeHandle attr = tex_coord_node->Attrib("u");
 					if (attr)
 					{
 						tex_coord.x() = tex_coord_node->Attrib("u")->ValueFloat();
@@ -2642,19 +2642,19 @@ namespace
 				}
 			}
 
-			XMLNodePtr weight_node = vertex_node->FirstNode("weight");
+			XMLNodeHandle weight_node = vertex_node->FirstNode("weight");
 			if (weight_node)
 			{
 				std::vector<std::pair<uint32_t, float>> binding;
 
-				XMLAttributePtr attr = weight_node->Attrib("joint");
+				XMLAttributeHandle attr = weight_node->Attrib("joint");
 				if (!attr)
 				{
 					attr = weight_node->Attrib("bone_index");
 				}
 				if (attr)
 				{
-					XMLAttributePtr weight_attr = weight_node->Attrib("weight");
+					XMLAttributeHandle weight_attr = weight_node->Attrib("weight");
 
 					std::string_view const index_str = attr->ValueString();
 					std::string_view const weight_str = weight_attr->ValueString();
@@ -2681,13 +2681,13 @@ namespace
 				mesh_lod.joint_bindings.emplace_back(std::move(binding));
 			}
 						
-			XMLNodePtr normal_node = vertex_node->FirstNode("normal");
+			XMLNodeHandle normal_node = vertex_node->FirstNode("normal");
 			if (normal_node)
 			{
 				has_normal = true;
 
 				float3 normal;
-				XMLAttributePtr attr = normal_node->Attrib("v");
+				XMLAttributeHandle attr = normal_node->Attrib("v");
 				if (attr)
 				{
 					ExtractFVector<3>(attr->ValueString(), &normal[0]);
@@ -2701,13 +2701,13 @@ namespace
 				mesh_lod.normals.push_back(normal);
 			}
 
-			XMLNodePtr tangent_node = vertex_node->FirstNode("tangent");
+			XMLNodeHandle tangent_node = vertex_node->FirstNode("tangent");
 			if (tangent_node)
 			{
 				has_tangent = true;
 
 				float4 tangent;
-				XMLAttributePtr attr = tangent_node->Attrib("v");
+				XMLAttributeHandle attr = tangent_node->Attrib("v");
 				if (attr)
 				{
 					ExtractFVector<4>(attr->ValueString(), &tangent[0]);
@@ -2730,13 +2730,13 @@ namespace
 				mesh_tangents.push_back(tangent);
 			}
 
-			XMLNodePtr binormal_node = vertex_node->FirstNode("binormal");
+			XMLNodeHandle binormal_node = vertex_node->FirstNode("binormal");
 			if (binormal_node)
 			{
 				has_binormal = true;
 
 				float3 binormal;
-				XMLAttributePtr attr = binormal_node->Attrib("v");
+				XMLAttributeHandle attr = binormal_node->Attrib("v");
 				if (attr)
 				{
 					ExtractFVector<3>(attr->ValueString(), &binormal[0]);
@@ -2750,13 +2750,13 @@ namespace
 				mesh_binormals.push_back(binormal);
 			}
 
-			XMLNodePtr tangent_quat_node = vertex_node->FirstNode("tangent_quat");
+			XMLNodeHandle tangent_quat_node = vertex_node->FirstNode("tangent_quat");
 			if (tangent_quat_node)
 			{
 				has_tangent_quat = true;
 
 				Quaternion tangent_quat;
-				XMLAttributePtr const & attr = tangent_quat_node->Attrib("v");
+				XMLAttributeHandle const attr = tangent_quat_node->Attrib("v");
 				if (attr)
 				{
 					ExtractFVector<4>(attr->ValueString(), &tangent_quat[0]);
@@ -2892,15 +2892,15 @@ namespace
 		}
 	}
 
-	void MeshLoader::CompileMeshesTrianglesChunk(XMLNodePtr const & triangles_chunk, uint32_t mesh_index, uint32_t lod)
+	void MeshLoader::CompileMeshesTrianglesChunk(XMLNodeHandle triangles_chunk, uint32_t mesh_index, uint32_t lod)
 	{
 		auto& mesh = meshes_[mesh_index];
 		auto& mesh_lod = mesh.lods[lod];
 
-		for (XMLNodePtr tri_node = triangles_chunk->FirstNode("triangle"); tri_node; tri_node = tri_node->NextSibling("triangle"))
+		for (XMLNodeHandle tri_node = triangles_chunk->FirstNode("triangle"); tri_node; tri_node = tri_node->NextSibling("triangle"))
 		{
 			uint32_t ind[3];
-			XMLAttributePtr attr = tri_node->Attrib("index");
+			XMLAttributeHandle attr = tri_node->Attrib("index");
 			if (attr)
 			{
 				ExtractUIVector<3>(attr->ValueString(), &ind[0]);
@@ -2917,9 +2917,9 @@ namespace
 		}
 	}
 
-	void MeshLoader::CompileBonesChunk(XMLNodePtr const & bones_chunk)
+	void MeshLoader::CompileBonesChunk(XMLNodeHandle bones_chunk)
 	{
-		for (XMLNodePtr bone_node = bones_chunk->FirstNode("bone"); bone_node; bone_node = bone_node->NextSibling("bone"))
+		for (XMLNodeHandle bone_node = bones_chunk->FirstNode("bone"); bone_node; bone_node = bone_node->NextSibling("bone"))
 		{
 			auto joint = MakeSharedPtr<JointComponent>();
 
@@ -2929,13 +2929,13 @@ namespace
 			Quaternion joint_bind_real, joint_bind_dual;
 			float joint_bind_scale;
 
-			XMLNodePtr bind_pos_node = bone_node->FirstNode("bind_pos");
+			XMLNodeHandle bind_pos_node = bone_node->FirstNode("bind_pos");
 			if (bind_pos_node)
 			{
 				float3 bind_pos(bind_pos_node->Attrib("x")->ValueFloat(), bind_pos_node->Attrib("y")->ValueFloat(),
 					bind_pos_node->Attrib("z")->ValueFloat());
 
-				XMLNodePtr bind_quat_node = bone_node->FirstNode("bind_quat");
+				XMLNodeHandle bind_quat_node = bone_node->FirstNode("bind_quat");
 				Quaternion bind_quat(bind_quat_node->Attrib("x")->ValueFloat(), bind_quat_node->Attrib("y")->ValueFloat(),
 					bind_quat_node->Attrib("z")->ValueFloat(), bind_quat_node->Attrib("w")->ValueFloat());
 
@@ -2948,12 +2948,12 @@ namespace
 			}
 			else
 			{
-				XMLNodePtr bind_real_node = bone_node->FirstNode("real");
+				XMLNodeHandle bind_real_node = bone_node->FirstNode("real");
 				if (!bind_real_node)
 				{
 					bind_real_node = bone_node->FirstNode("bind_real");
 				}
-				XMLAttributePtr attr = bind_real_node->Attrib("v");
+				XMLAttributeHandle attr = bind_real_node->Attrib("v");
 				if (attr)
 				{
 					ExtractFVector<4>(attr->ValueString(), &joint_bind_real[0]);
@@ -2966,7 +2966,7 @@ namespace
 					joint_bind_real.w() = bind_real_node->Attrib("w")->ValueFloat();
 				}
 
-				XMLNodePtr bind_dual_node = bone_node->FirstNode("dual");
+				XMLNodeHandle bind_dual_node = bone_node->FirstNode("dual");
 				if (!bind_dual_node)
 				{
 					bind_dual_node = bone_node->FirstNode("bind_dual");
@@ -3004,11 +3004,11 @@ namespace
 		}
 	}
 
-	void MeshLoader::CompileKeyFramesChunk(XMLNodePtr const & key_frames_chunk)
+	void MeshLoader::CompileKeyFramesChunk(XMLNodeHandle key_frames_chunk)
 	{
 		auto& skinned_model = checked_cast<SkinnedModel&>(*render_model_);
 
-		XMLAttributePtr nf_attr = key_frames_chunk->Attrib("num_frames");
+		XMLAttributeHandle nf_attr = key_frames_chunk->Attrib("num_frames");
 		if (nf_attr)
 		{
 			skinned_model.NumFrames(nf_attr->ValueUInt());
@@ -3024,9 +3024,9 @@ namespace
 		auto kfss = MakeSharedPtr<std::vector<KeyFrameSet>>();
 		kfss->resize(joints_.size());
 		uint32_t joint_id = 0;
-		for (XMLNodePtr kf_node = key_frames_chunk->FirstNode("key_frame"); kf_node; kf_node = kf_node->NextSibling("key_frame"))
+		for (XMLNodeHandle kf_node = key_frames_chunk->FirstNode("key_frame"); kf_node; kf_node = kf_node->NextSibling("key_frame"))
 		{
-			XMLAttributePtr joint_attr = kf_node->Attrib("joint");
+			XMLAttributeHandle joint_attr = kf_node->Attrib("joint");
 			if (joint_attr)
 			{
 				joint_id = joint_attr->ValueUInt();
@@ -3038,9 +3038,9 @@ namespace
 			KeyFrameSet& kfs = (*kfss)[joint_id];
 
 			int32_t frame_id = -1;
-			for (XMLNodePtr key_node = kf_node->FirstNode("key"); key_node; key_node = key_node->NextSibling("key"))
+			for (XMLNodeHandle key_node = kf_node->FirstNode("key"); key_node; key_node = key_node->NextSibling("key"))
 			{
-				XMLAttributePtr id_attr = key_node->Attrib("id");
+				XMLAttributeHandle id_attr = key_node->Attrib("id");
 				if (id_attr)
 				{
 					frame_id = id_attr->ValueInt();
@@ -3053,13 +3053,13 @@ namespace
 
 				Quaternion bind_real, bind_dual;
 				float bind_scale;
-				XMLNodePtr pos_node = key_node->FirstNode("pos");
+				XMLNodeHandle pos_node = key_node->FirstNode("pos");
 				if (pos_node)
 				{
 					float3 bind_pos(pos_node->Attrib("x")->ValueFloat(), pos_node->Attrib("y")->ValueFloat(),
 						pos_node->Attrib("z")->ValueFloat());
 
-					XMLNodePtr quat_node = key_node->FirstNode("quat");
+					XMLNodeHandle quat_node = key_node->FirstNode("quat");
 					bind_real = Quaternion(quat_node->Attrib("x")->ValueFloat(), quat_node->Attrib("y")->ValueFloat(),
 						quat_node->Attrib("z")->ValueFloat(), quat_node->Attrib("w")->ValueFloat());
 
@@ -3070,12 +3070,12 @@ namespace
 				}
 				else
 				{
-					XMLNodePtr bind_real_node = key_node->FirstNode("real");
+					XMLNodeHandle bind_real_node = key_node->FirstNode("real");
 					if (!bind_real_node)
 					{
 						bind_real_node = key_node->FirstNode("bind_real");
 					}
-					XMLAttributePtr attr = bind_real_node->Attrib("v");
+					XMLAttributeHandle attr = bind_real_node->Attrib("v");
 					if (attr)
 					{
 						ExtractFVector<4>(attr->ValueString(), &bind_real[0]);
@@ -3088,7 +3088,7 @@ namespace
 						bind_real.w() = bind_real_node->Attrib("w")->ValueFloat();
 					}
 
-					XMLNodePtr bind_dual_node = key_node->FirstNode("dual");
+					XMLNodeHandle bind_dual_node = key_node->FirstNode("dual");
 					if (!bind_dual_node)
 					{
 						bind_dual_node = key_node->FirstNode("bind_dual");
@@ -3126,7 +3126,7 @@ namespace
 		skinned_model.AttachKeyFrameSets(kfss);
 	}
 
-	void MeshLoader::CompileBBKeyFramesChunk(XMLNodePtr const & bb_kfs_chunk, uint32_t mesh_index)
+	void MeshLoader::CompileBBKeyFramesChunk(XMLNodeHandle bb_kfs_chunk, uint32_t mesh_index)
 	{
 		auto& skinned_model = checked_cast<SkinnedModel&>(*render_model_);
 		auto& skinned_mesh = checked_cast<SkinnedMesh&>(*skinned_model.Mesh(mesh_index));
@@ -3134,16 +3134,16 @@ namespace
 		auto bb_kfs = MakeSharedPtr<AABBKeyFrameSet>();
 		if (bb_kfs_chunk)
 		{
-			for (XMLNodePtr bb_kf_node = bb_kfs_chunk->FirstNode("bb_key_frame"); bb_kf_node;
+			for (XMLNodeHandle bb_kf_node = bb_kfs_chunk->FirstNode("bb_key_frame"); bb_kf_node;
 				bb_kf_node = bb_kf_node->NextSibling("bb_key_frame"))
 			{
 				bb_kfs->frame_id.clear();
 				bb_kfs->bb.clear();
 
 				int32_t frame_id = -1;
-				for (XMLNodePtr key_node = bb_kf_node->FirstNode("key"); key_node; key_node = key_node->NextSibling("key"))
+				for (XMLNodeHandle key_node = bb_kf_node->FirstNode("key"); key_node; key_node = key_node->NextSibling("key"))
 				{
-					XMLAttributePtr id_attr = key_node->Attrib("id");
+					XMLAttributeHandle id_attr = key_node->Attrib("id");
 					if (id_attr)
 					{
 						frame_id = id_attr->ValueInt();
@@ -3155,14 +3155,14 @@ namespace
 					bb_kfs->frame_id.push_back(frame_id);
 
 					float3 bb_min, bb_max;
-					XMLAttributePtr attr = key_node->Attrib("min");
+					XMLAttributeHandle attr = key_node->Attrib("min");
 					if (attr)
 					{
 						ExtractFVector<3>(attr->ValueString(), &bb_min[0]);
 					}
 					else
 					{
-						XMLNodePtr min_node = key_node->FirstNode("min");
+						XMLNodeHandle min_node = key_node->FirstNode("min");
 						bb_min.x() = min_node->Attrib("x")->ValueFloat();
 						bb_min.y() = min_node->Attrib("y")->ValueFloat();
 						bb_min.z() = min_node->Attrib("z")->ValueFloat();
@@ -3174,7 +3174,7 @@ namespace
 					}
 					else
 					{
-						XMLNodePtr max_node = key_node->FirstNode("max");
+						XMLNodeHandle max_node = key_node->FirstNode("max");
 						bb_max.x() = max_node->Attrib("x")->ValueFloat();
 						bb_max.y() = max_node->Attrib("y")->ValueFloat();
 						bb_max.z() = max_node->Attrib("z")->ValueFloat();
@@ -3198,11 +3198,11 @@ namespace
 		skinned_mesh.AttachFramePosBounds(bb_kfs);
 	}
 
-	void MeshLoader::CompileActionsChunk(XMLNodePtr const & actions_chunk)
+	void MeshLoader::CompileActionsChunk(XMLNodeHandle actions_chunk)
 	{
 		auto& skinned_model = checked_cast<SkinnedModel&>(*render_model_);
 
-		XMLNodePtr action_node;
+		XMLNodeHandle action_node;
 		if (actions_chunk)
 		{
 			action_node = actions_chunk->FirstNode("action");
@@ -3241,11 +3241,11 @@ namespace
 
 		ResIdentifierPtr file = ResLoader::Instance().Open(input_name);
 		KlayGE::XMLDocument doc;
-		XMLNodePtr root = doc.Parse(*file);
+		XMLNodeHandle const root = doc.Parse(*file)->Handle();
 
 		BOOST_ASSERT(root->Attrib("version") && (root->Attrib("version")->ValueInt() >= 1));
 
-		XMLNodePtr bones_chunk = root->FirstNode("bones_chunk");
+		XMLNodeHandle bones_chunk = root->FirstNode("bones_chunk");
 		if (bones_chunk)
 		{
 			this->CompileBonesChunk(bones_chunk);
@@ -3253,7 +3253,7 @@ namespace
 
 		bool const skinned = !joints_.empty();
 
-		XMLNodePtr meshes_chunk = root->FirstNode("meshes_chunk");
+		XMLNodeHandle meshes_chunk = root->FirstNode("meshes_chunk");
 		if (meshes_chunk)
 		{
 			this->CompileMeshesChunk(meshes_chunk);
@@ -3306,13 +3306,13 @@ namespace
 			render_model_ = MakeSharedPtr<RenderModel>(nodes_[0].node);
 		}
 
-		XMLNodePtr materials_chunk = root->FirstNode("materials_chunk");
+		XMLNodeHandle materials_chunk = root->FirstNode("materials_chunk");
 		if (materials_chunk)
 		{
 			this->CompileMaterialsChunk(materials_chunk);
 		}
 
-		XMLNodePtr key_frames_chunk = root->FirstNode("key_frames_chunk");
+		XMLNodeHandle key_frames_chunk = root->FirstNode("key_frames_chunk");
 		if (key_frames_chunk)
 		{
 			this->CompileKeyFramesChunk(key_frames_chunk);
@@ -3351,14 +3351,14 @@ namespace
 				}
 			}
 
-			XMLNodePtr bb_kfs_chunk = root->FirstNode("bb_key_frames_chunk");
+			XMLNodeHandle bb_kfs_chunk = root->FirstNode("bb_key_frames_chunk");
 			for (uint32_t mesh_index = 0; mesh_index < skinned_model.NumMeshes(); ++ mesh_index)
 			{
 				this->CompileBBKeyFramesChunk(bb_kfs_chunk, mesh_index);
 			}
 		}
 
-		XMLNodePtr actions_chunk = root->FirstNode("actions_chunk");
+		XMLNodeHandle actions_chunk = root->FirstNode("actions_chunk");
 		if (actions_chunk)
 		{
 			this->CompileActionsChunk(actions_chunk);
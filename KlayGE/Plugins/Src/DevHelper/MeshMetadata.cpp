@@ -364,6 +364,7 @@ namespace KlayGE
 		document.Accept(writer);
 		std::ofstream ofs(name);
 		ofs << sb.GetString();
+		ResLoader::Instance().NotifyFileWritten(name);
 	}
 
 	uint32_t MeshMetadata::NumLods() const
@@ -617,6 +617,7 @@ namespace KlayGE
 		document.Accept(writer);
 		std::ofstream ofs(name);
 		ofs << sb.GetString();
+		ResLoader::Instance().NotifyFileWritten(name);
 	}
 
 	void TexMetadata::DeviceDependentAdjustment(RenderDeviceCaps const & caps)
@@ -0,0 +1,663 @@
+/**
+ * @file BVH.cpp
+ * @author Minmin Gong
+ *
+ * @section DESCRIPTION
+ *
+ * This source file is part of KlayGE
+ * For the latest info, see http://www.klayge.org
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * You may alternatively use this source under the terms of
+ * the KlayGE Proprietary License (KPL). You can obtained such a license
+ * from http://www.klayge.org/licensing/.
+ */
+
+#include <KlayGE/KlayGE.hpp>
+#include <KFL/Math.hpp>
+#include <KFL/SIMDMath.hpp>
+#include <KFL/SIMDVector.hpp>
+#include <KlayGE/Camera.hpp>
+#include <KlayGE/Context.hpp>
+#include <KlayGE/FrameBuffer.hpp>
+#include <KlayGE/RenderEngine.hpp>
+#include <KlayGE/RenderFactory.hpp>
+#include <KlayGE/SceneNode.hpp>
+
+#include <algorithm>
+#include <boost/assert.hpp>
+
+#include <KlayGE/BVH/BVH.hpp>
+
+namespace
+{
+	using namespace KlayGE;
+
+	uint32_t constexpr INVALID_INDEX = 0xFFFFFFFFU;
+	uint32_t constexpr NUM_SAH_BINS = 16;
+
+	// Rebuild when refitting has made the tree this much larger than when it was built
+	float constexpr MAX_REFIT_AREA_RATIO = 2.0f;
+
+	float HalfSurfaceArea(float3 const & min_pt, float3 const & max_pt)
+	{
+		float3 const size = max_pt - min_pt;
+		return std::max(size.x() * size.y() + size.y() * size.z() + size.z() * size.x(), 0.0f);
+	}
+}
+
+namespace KlayGE
+{
+	BVH::BVH()
+		: omni_directional_mask_(0), max_leaf_size_(4), build_area_(0), curr_area_(0), rebuild_tree_(true)
+	{
+	}
+
+	void BVH::MaxLeafSize(uint32_t max_leaf_size)
+	{
+		max_leaf_size_ = std::max(max_leaf_size, 1U);
+		rebuild_tree_ = true;
+	}
+
+	uint32_t BVH::MaxLeafSize() const
+	{
+		return max_leaf_size_;
+	}
+
+	void BVH::ClipScene()
+	{
+		auto& re = Context::Instance().RenderFactoryInstance().RenderEngineInstance();
+		auto const& viewport = *re.CurFrameBuffer()->Viewport();
+		uint32_t const num_cameras = viewport.NumCameras();
+
+		if (this->NeedRebuild())
+		{
+			this->BuildTree();
+		}
+		else
+		{
+			this->RefitTree();
+			if (curr_area_ > build_area_ * MAX_REFIT_AREA_RATIO)
+			{
+				this->BuildTree();
+			}
+		}
+
+		omni_directional_mask_ = 0;
+		frustum_planes_.resize(num_cameras);
+		for (uint32_t i = 0; i < num_cameras; ++i)
+		{
+			auto const& camera = *viewport.Camera(i);
+			if (camera.OmniDirectionalMode())
+			{
+				omni_directional_mask_ |= 1U << i;
+			}
+
+			auto const& frustum = *camera_frustums_[i];
+			auto& planes = frustum_planes_[i];
+			for (uint32_t g = 0; g < 2; ++g)
+			{
+				float4 a, b, c, d;
+				for (uint32_t j = 0; j < 4; ++j)
+				{
+					uint32_t const p = g * 4 + j;
+					if (p < 6)
+					{
+						Plane const& plane = frustum.FrustumPlane(p);
+						a[j] = plane.a();
+						b[j] = plane.b();
+						c[j] = plane.c();
+						d[j] = plane.d();
+					}
+					else
+					{
+						a[j] = 0;
+						b[j] = 0;
+						c[j] = 0;
+						d[j] = 1;
+					}
+				}
+
+				planes.a[g] = SIMDMathLib::LoadVector4(a);
+				planes.b[g] = SIMDMathLib::LoadVector4(b);
+				planes.c[g] = SIMDMathLib::LoadVector4(c);
+				planes.d[g] = SIMDMathLib::LoadVector4(d);
+				planes.abs_a[g] = SIMDMathLib::Abs(planes.a[g]);
+				planes.abs_b[g] = SIMDMathLib::Abs(planes.b[g]);
+				planes.abs_c[g] = SIMDMathLib::Abs(planes.c[g]);
+			}
+		}
+
+		this->CullTree(viewport, num_cameras);
+
+		// Same rules as SceneManager::ClipScene, only the own tests of cullable nodes come from the tree walk.
+		// The arrays are in pre-order, so parents are merged before their children.
+		auto& arrays = node_arrays_;
+		for (size_t n = 0; n < arrays.nodes.size(); ++n)
+		{
+			auto& marks = arrays.visible_marks[n];
+			marks.fill(BoundOverlap::No);
+
+			if (!(arrays.attribs[n] & SceneNode::SOA_Invisible))
+			{
+				if (arrays.flags[n] & SceneNodeArrays::F_Updated)
+				{
+					uint32_t const parent = arrays.parents[n];
+					uint32_t const prim = scene_node_prims_[n];
+					for (uint32_t i = 0; i < num_cameras; ++i)
+					{
+						auto visible = (parent == SceneNode::InvalidHandle) ? BoundOverlap::Partial : arrays.visible_marks[parent][i];
+						if (visible != BoundOverlap::No)
+						{
+							if (prim != INVALID_INDEX)
+							{
+								if (prim_small_obj_masks_[prim] & (1U << i))
+								{
+									visible = BoundOverlap::No;
+								}
+								else if (BoundOverlap::Partial == visible)
+								{
+									visible = prim_visible_marks_[prim][i];
+								}
+							}
+							else if (BoundOverlap::Partial == visible)
+							{
+								visible = BoundOverlap::Yes;
+							}
+						}
+
+						marks[i] = visible;
+					}
+				}
+				else
+				{
+					for (uint32_t i = 0; i < num_cameras; ++i)
+					{
+						marks[i] = BoundOverlap::Yes;
+					}
+				}
+			}
+		}
+
+		this->WriteBackVisibleMarks();
+	}
+
+	void BVH::ClearObject()
+	{
+		SceneManager::ClearObject();
+
+		nodes_.clear();
+		node_parents_.clear();
+		node_dirties_.clear();
+		prims_.clear();
+		bvh_scene_nodes_.clear();
+		scene_node_prims_.clear();
+		rebuild_tree_ = true;
+	}
+
+	void BVH::OnSceneChanged()
+	{
+		rebuild_tree_ = true;
+	}
+
+	void BVH::DoSuspend()
+	{
+		// TODO
+	}
+
+	void BVH::DoResume()
+	{
+		// TODO
+	}
+
+	bool BVH::NeedRebuild() const
+	{
+		auto const& arrays = node_arrays_;
+		if (rebuild_tree_ || (bvh_scene_nodes_ != arrays.nodes))
+		{
+			return true;
+		}
+
+		uint8_t constexpr in_tree_flags = SceneNodeArrays::F_HasPosBound | SceneNodeArrays::F_Updated;
+		for (size_t n = 0; n < arrays.nodes.size(); ++n)
+		{
+			bool const in_tree = (arrays.attribs[n] & SceneNode::SOA_Cullable) && ((arrays.flags[n] & in_tree_flags) == in_tree_flags);
+			if (in_tree != (scene_node_prims_[n] != INVALID_INDEX))
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	void BVH::BuildTree()
+	{
+		auto const& arrays = node_arrays_;
+		uint8_t constexpr in_tree_flags = SceneNodeArrays::F_HasPosBound | SceneNodeArrays::F_Updated;
+
+		bvh_scene_nodes_ = arrays.nodes;
+		scene_node_prims_.assign(bvh_scene_nodes_.size(), INVALID_INDEX);
+
+		prims_.clear();
+		for (size_t n = 0; n < arrays.nodes.size(); ++n)
+		{
+			if ((arrays.attribs[n] & SceneNode::SOA_Cullable) && ((arrays.flags[n] & in_tree_flags) == in_tree_flags))
+			{
+				AABBox const& aabb = arrays.pos_aabbs_ws[n];
+				prims_.push_back({ aabb.Min(), static_cast<uint32_t>(n), aabb.Max(), 0 });
+			}
+		}
+
+		nodes_.clear();
+		node_parents_.clear();
+		if (!prims_.empty())
+		{
+			nodes_.reserve(prims_.size() * 2);
+			node_parents_.reserve(prims_.size() * 2);
+			this->BuildNode(0, static_cast<uint32_t>(prims_.size()));
+		}
+		node_dirties_.assign(nodes_.size(), 0);
+
+		// Primitives are reordered by the build
+		for (size_t p = 0; p < prims_.size(); ++p)
+		{
+			scene_node_prims_[prims_[p].scene_node] = static_cast<uint32_t>(p);
+		}
+		prim_visible_marks_.resize(prims_.size());
+		prim_small_obj_masks_.resize(prims_.size());
+
+		build_area_ = 0;
+		for (auto const& node : nodes_)
+		{
+			build_area_ += HalfSurfaceArea(node.min_pt, node.max_pt);
+		}
+		curr_area_ = build_area_;
+
+		rebuild_tree_ = false;
+	}
+
+	uint32_t BVH::BuildNode(uint32_t begin, uint32_t end)
+	{
+		uint32_t const index = static_cast<uint32_t>(nodes_.size());
+		nodes_.emplace_back();
+		node_parents_.push_back(INVALID_INDEX);
+
+		float3 min_pt = prims_[begin].min_pt;
+		float3 max_pt = prims_[begin].max_pt;
+		float3 min_center = (prims_[begin].min_pt + prims_[begin].max_pt) * 0.5f;
+		float3 max_center = min_center;
+		for (uint32_t p = begin + 1; p < end; ++p)
+		{
+			auto const& prim = prims_[p];
+			float3 const center = (prim.min_pt + prim.max_pt) * 0.5f;
+			min_pt = MathLib::minimize(min_pt, prim.min_pt);
+			max_pt = MathLib::maximize(max_pt, prim.max_pt);
+			min_center = MathLib::minimize(min_center, center);
+			max_center = MathLib::maximize(max_center, center);
+		}
+		nodes_[index].min_pt = min_pt;
+		nodes_[index].max_pt = max_pt;
+
+		uint32_t const num_prims = end - begin;
+		if (num_prims <= max_leaf_size_)
+		{
+			nodes_[index].first = begin;
+			nodes_[index].num_prims = num_prims;
+			for (uint32_t p = begin; p < end; ++p)
+			{
+				prims_[p].leaf = index;
+			}
+			return index;
+		}
+
+		float3 const center_extent = max_center - min_center;
+		uint32_t axis = 0;
+		if (center_extent.y() > center_extent[axis])
+		{
+			axis = 1;
+		}
+		if (center_extent.z() > center_extent[axis])
+		{
+			axis = 2;
+		}
+
+		uint32_t mid = begin + num_prims / 2;
+		if (center_extent[axis] > 0)
+		{
+			// Binned SAH. Choose the bin boundary with the lowest cost of count * area on both sides.
+			struct bin_t
+			{
+				float3 min_pt;
+				float3 max_pt;
+				uint32_t count;
+			};
+			bin_t bins[NUM_SAH_BINS];
+			for (auto& bin : bins)
+			{
+				bin.min_pt = float3(+1e10f, +1e10f, +1e10f);
+				bin.max_pt = float3(-1e10f, -1e10f, -1e10f);
+				bin.count = 0;
+			}
+
+			float const bin_scale = NUM_SAH_BINS / center_extent[axis];
+			auto bin_index = [&min_center, axis, bin_scale](bvh_prim_t const & prim)
+			{
+				float const center = (prim.min_pt[axis] + prim.max_pt[axis]) * 0.5f;
+				return std::min(static_cast<uint32_t>((center - min_center[axis]) * bin_scale), NUM_SAH_BINS - 1);
+			};
+
+			for (uint32_t p = begin; p < end; ++p)
+			{
+				auto& bin = bins[bin_index(prims_[p])];
+				bin.min_pt = MathLib::minimize(bin.min_pt, prims_[p].min_pt);
+				bin.max_pt = MathLib::maximize(bin.max_pt, prims_[p].max_pt);
+				++bin.count;
+			}
+
+			float right_areas[NUM_SAH_BINS];
+			uint32_t right_counts[NUM_SAH_BINS];
+			{
+				float3 right_min = bins[NUM_SAH_BINS - 1].min_pt;
+				float3 right_max = bins[NUM_SAH_BINS - 1].max_pt;
+				uint32_t right_count = 0;
+				for (uint32_t b = NUM_SAH_BINS - 1; b > 0; --b)
+				{
+					right_min = MathLib::minimize(right_min, bins[b].min_pt);
+					right_max = MathLib::maximize(right_max, bins[b].max_pt);
+					right_count += bins[b].count;
+					right_areas[b] = HalfSurfaceArea(right_min, right_max);
+					right_counts[b] = right_count;
+				}
+			}
+
+			float best_cost = std::numeric_limits<float>::max();
+			uint32_t best_split = 0;
+			float3 left_min = bins[0].min_pt;
+			float3 left_max = bins[0].max_pt;
+			uint32_t left_count = 0;
+			for (uint32_t b = 0; b < NUM_SAH_BINS - 1; ++b)
+			{
+				left_min = MathLib::minimize(left_min, bins[b].min_pt);
+				left_max = MathLib::maximize(left_max, bins[b].max_pt);
+				left_count += bins[b].count;
+				if ((left_count > 0) && (right_counts[b + 1] > 0))
+				{
+					float const cost = left_count * HalfSurfaceArea(left_min, left_max) + right_counts[b + 1] * right_areas[b + 1];
+					if (cost < best_cost)
+					{
+						best_cost = cost;
+						best_split = b;
+					}
+				}
+			}
+
+			auto const split_iter = std::partition(prims_.begin() + begin, prims_.begin() + end,
+				[&bin_index, best_split](bvh_prim_t const & prim) { return bin_index(prim) <= best_split; });
+			mid = static_cast<uint32_t>(split_iter - prims_.begin());
+		}
+		if ((mid == begin) || (mid == end))
+		{
+			// All centers are in the same place. Any split is as good as the others.
+			mid = begin + num_prims / 2;
+		}
+
+		uint32_t const left = this->BuildNode(begin, mid);
+		uint32_t const right = this->BuildNode(mid, end);
+		BOOST_ASSERT(left == index + 1);
+		KFL_UNUSED(left);
+
+		nodes_[index].first = right;
+		nodes_[index].num_prims = 0;
+		node_parents_[index + 1] = index;
+		node_parents_[right] = index;
+
+		return index;
+	}
+
+	// Moved nodes only dirty their leaves. Walking backward visits every child before its parent, so the dirty flags
+	// propagate to the root in one pass.
+	void BVH::RefitTree()
+	{
+		auto const& arrays = node_arrays_;
+
+		bool any_dirty = false;
+		for (auto& prim : prims_)
+		{
+			AABBox const& aabb = arrays.pos_aabbs_ws[prim.scene_node];
+			if ((aabb.Min() != prim.min_pt) || (aabb.Max() != prim.max_pt))
+			{
+				prim.min_pt = aabb.Min();
+				prim.max_pt = aabb.Max();
+				node_dirties_[prim.leaf] = 1;
+				any_dirty = true;
+			}
+		}
+
+		if (any_dirty)
+		{
+			for (size_t i = nodes_.size(); i-- > 0;)
+			{
+				if (node_dirties_[i])
+				{
+					auto& node = nodes_[i];
+					curr_area_ -= HalfSurfaceArea(node.min_pt, node.max_pt);
+					if (node.num_prims > 0)
+					{
+						node.min_pt = prims_[node.first].min_pt;
+						node.max_pt = prims_[node.first].max_pt;
+						for (uint32_t p = node.first + 1; p < node.first + node.num_prims; ++p)
+						{
+							node.min_pt = MathLib::minimize(node.min_pt, prims_[p].min_pt);
+							node.max_pt = MathLib::maximize(node.max_pt, prims_[p].max_pt);
+						}
+					}
+					else
+					{
+						auto const& left = nodes_[i + 1];
+						auto const& right = nodes_[node.first];
+						node.min_pt = MathLib::minimize(left.min_pt, right.min_pt);
+						node.max_pt = MathLib::maximize(left.max_pt, right.max_pt);
+					}
+					curr_area_ += HalfSurfaceArea(node.min_pt, node.max_pt);
+
+					node_dirties_[i] = 0;
+					if (node_parents_[i] != INVALID_INDEX)
+					{
+						node_dirties_[node_parents_[i]] = 1;
+					}
+				}
+			}
+		}
+	}
+
+	void BVH::CullTree(Viewport const & viewport, uint32_t num_cameras)
+	{
+		for (auto& marks : prim_visible_marks_)
+		{
+			marks.fill(BoundOverlap::No);
+		}
+		std::fill(prim_small_obj_masks_.begin(), prim_small_obj_masks_.end(), 0);
+
+		if (nodes_.empty())
+		{
+			return;
+		}
+
+		// Each camera is in one of 3 states for a subtree: culled, partially inside (tested further), or fully inside.
+		// Cameras culled for being too small are remembered, they also hide the node if its parent is fully inside.
+		struct stack_item_t
+		{
+			uint32_t node_index;
+			uint32_t partial_mask;
+			uint32_t yes_mask;
+			uint32_t small_mask;
+		};
+		std::vector<stack_item_t> stack;
+		stack.reserve(64);
+
+		uint32_t const all_cameras = (1U << num_cameras) - 1;
+		stack.push_back({ 0, all_cameras & ~omni_directional_mask_, all_cameras & omni_directional_mask_, 0 });
+		while (!stack.empty())
+		{
+			stack_item_t item = stack.back();
+			stack.pop_back();
+
+			auto const& node = nodes_[item.node_index];
+
+			uint32_t const small_mask = this->SmallObjectMask(viewport, node.min_pt, node.max_pt, item.partial_mask | item.yes_mask);
+			item.partial_mask &= ~small_mask;
+			item.yes_mask &= ~small_mask;
+			item.small_mask |= small_mask;
+
+			if (item.partial_mask != 0)
+			{
+				uint32_t partial_mask;
+				uint32_t yes_mask;
+				this->IntersectFrustums(node.min_pt, node.max_pt, item.partial_mask, partial_mask, yes_mask);
+				item.partial_mask = partial_mask;
+				item.yes_mask |= yes_mask;
+			}
+
+			if ((item.partial_mask | item.yes_mask | item.small_mask) != 0)
+			{
+				if (node.num_prims > 0)
+				{
+					this->CullPrimitives(viewport, item.node_index, item.partial_mask, item.yes_mask, item.small_mask);
+				}
+				else
+				{
+					// With only the small mask left, no more tests are done. It's just passed down to the primitives.
+					stack.push_back({ node.first, item.partial_mask, item.yes_mask, item.small_mask });
+					stack.push_back({ item.node_index + 1, item.partial_mask, item.yes_mask, item.small_mask });
+				}
+			}
+		}
+	}
+
+	void BVH::CullPrimitives(Viewport const & viewport, uint32_t node_index, uint32_t partial_mask, uint32_t yes_mask,
+		uint32_t small_mask)
+	{
+		auto const& node = nodes_[node_index];
+		for (uint32_t p = node.first; p < node.first + node.num_prims; ++p)
+		{
+			auto const& prim = prims_[p];
+
+			uint32_t const prim_small_mask = this->SmallObjectMask(viewport, prim.min_pt, prim.max_pt, partial_mask | yes_mask);
+			uint32_t prim_partial_mask = 0;
+			uint32_t prim_yes_mask = yes_mask & ~prim_small_mask;
+			if ((partial_mask & ~prim_small_mask) != 0)
+			{
+				uint32_t tested_yes_mask;
+				this->IntersectFrustums(prim.min_pt, prim.max_pt, partial_mask & ~prim_small_mask, prim_partial_mask, tested_yes_mask);
+				prim_yes_mask |= tested_yes_mask;
+			}
+
+			auto& marks = prim_visible_marks_[p];
+			for (uint32_t i = 0; (prim_partial_mask | prim_yes_mask) >> i; ++i)
+			{
+				if (prim_yes_mask & (1U << i))
+				{
+					marks[i] = BoundOverlap::Yes;
+				}
+				else if (prim_partial_mask & (1U << i))
+				{
+					marks[i] = BoundOverlap::Partial;
+				}
+			}
+			prim_small_obj_masks_[p] = small_mask | prim_small_mask;
+		}
+	}
+
+	uint32_t BVH::SmallObjectMask(Viewport const & viewport, float3 const & min_pt, float3 const & max_pt, uint32_t camera_mask) const
+	{
+		uint32_t mask = 0;
+		if (small_obj_threshold_ > 0)
+		{
+			AABBox const aabb(min_pt, max_pt);
+			for (uint32_t i = 0; camera_mask >> i; ++i)
+			{
+				if (camera_mask & (1U << i))
+				{
+					auto const& camera = *viewport.Camera(i);
+					float4x4 const& view_proj = camera_view_projs_[i];
+					if ((MathLib::ortho_area(camera.ForwardVec(), aabb) <= small_obj_threshold_) ||
+						(MathLib::perspective_area(camera.EyePos(), view_proj, aabb) <= small_obj_threshold_))
+					{
+						mask |= 1U << i;
+					}
+				}
+			}
+		}
+		return mask;
+	}
+
+	// Center-extent form of MathLib::intersect_aabb_frustum. 4 planes of a camera are tested at a time.
+	void BVH::IntersectFrustums(float3 const & min_pt, float3 const & max_pt, uint32_t camera_mask,
+		uint32_t& partial_mask, uint32_t& yes_mask) const
+	{
+		float3 const center = (min_pt + max_pt) * 0.5f;
+		float3 const extent = (max_pt - min_pt) * 0.5f;
+		SIMDVectorF4 const cx = SIMDMathLib::SetVector(center.x());
+		SIMDVectorF4 const cy = SIMDMathLib::SetVector(center.y());
+		SIMDVectorF4 const cz = SIMDMathLib::SetVector(center.z());
+		SIMDVectorF4 const ex = SIMDMathLib::SetVector(extent.x());
+		SIMDVectorF4 const ey = SIMDMathLib::SetVector(extent.y());
+		SIMDVectorF4 const ez = SIMDMathLib::SetVector(extent.z());
+
+		partial_mask = 0;
+		yes_mask = 0;
+		for (uint32_t i = 0; camera_mask >> i; ++i)
+		{
+			if (camera_mask & (1U << i))
+			{
+				auto const& planes = frustum_planes_[i];
+
+				bool outside = false;
+				bool intersect = false;
+				for (uint32_t g = 0; (g < 2) && !outside; ++g)
+				{
+					SIMDVectorF4 const dist = planes.a[g] * cx + planes.b[g] * cy + planes.c[g] * cz + planes.d[g];
+					SIMDVectorF4 const radius = planes.abs_a[g] * ex + planes.abs_b[g] * ey + planes.abs_c[g] * ez;
+
+					float4 far_dists;
+					float4 near_dists;
+					SIMDMathLib::StoreVector4(far_dists, dist + radius);
+					SIMDMathLib::StoreVector4(near_dists, dist - radius);
+					for (uint32_t j = 0; j < 4; ++j)
+					{
+						outside |= (far_dists[j] < 0);
+						intersect |= (near_dists[j] < 0);
+					}
+				}
+
+				if (!outside)
+				{
+					if (intersect)
+					{
+						partial_mask |= 1U << i;
+					}
+					else
+					{
+						yes_mask |= 1U << i;
+					}
+				}
+			}
+		}
+	}
+}
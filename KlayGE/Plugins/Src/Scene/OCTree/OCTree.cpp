@@ -38,6 +38,8 @@
 #include <KlayGE/DeferredRenderingLayer.hpp>
 
 #include <algorithm>
+#include <array>
+#include <unordered_map>
 #include <boost/assert.hpp>
 
 #ifdef KLAYGE_DRAW_NODES
@@ -99,7 +101,8 @@ namespace
 namespace KlayGE
 {
 	OCTree::OCTree()
-		: max_tree_depth_(4), rebuild_tree_(false)
+		: max_tree_depth_(4), rebuild_tree_(false),
+			loose_mode_(false), loose_num_objs_(0), loose_num_outside_(0)
 	{
 	}
 
@@ -113,9 +116,33 @@ namespace KlayGE
 		return max_tree_depth_;
 	}
 
+	void OCTree::LooseMode(bool loose)
+	{
+		if (loose_mode_ != loose)
+		{
+			loose_mode_ = loose;
+
+			octree_.clear();
+			loose_scene_nodes_.clear();
+			loose_entries_.clear();
+			loose_num_objs_ = 0;
+			loose_num_outside_ = 0;
+			rebuild_tree_ = true;
+		}
+	}
+
+	bool OCTree::LooseMode() const
+	{
+		return loose_mode_;
+	}
+
 	void OCTree::ClipScene()
 	{
-		if (rebuild_tree_)
+		if (loose_mode_)
+		{
+			this->UpdateLooseTree();
+		}
+		else if (rebuild_tree_)
 		{
 			octree_.resize(1);
 			AABBox bb_root(float3(0, 0, 0), float3(0, 0, 0));
@@ -152,7 +179,7 @@ namespace KlayGE
 
 		if (!octree_.empty())
 		{
-			this->NodeVisible(0);
+			this->NodeVisible(0, SceneManager::AABBVisible(octree_[0].bb));
 		}
 
 		auto& re = Context::Instance().RenderFactoryInstance().RenderEngineInstance();
@@ -232,21 +259,34 @@ namespace KlayGE
 				this->MarkNodeObjs(0, false);
 			}
 
-			for (auto* sn : all_scene_nodes_)
-			{
-				auto& node = *sn;
-				uint32_t const attr = node.Attrib();
-				if (node.Visible() && (attr & SceneNode::SOA_Cullable) && (attr & SceneNode::SOA_Moveable))
+			this->ParallelForNodes(all_scene_nodes_.size(), [this, num_cameras](size_t begin, size_t end) {
+				for (size_t n = begin; n < end; ++n)
 				{
-					for (uint32_t i = 0; i < num_cameras; ++i)
+					auto& node = *all_scene_nodes_[n];
+					uint32_t const attr = node.Attrib();
+					if (node.Visible() && (attr & SceneNode::SOA_Cullable) && (attr & SceneNode::SOA_Moveable))
 					{
-						if (node.VisibleMark(i) == BoundOverlap::Partial)
+						if (loose_mode_ && (loose_entries_[n].node_index >= 0) && !loose_entries_[n].reached)
 						{
-							node.VisibleMark(i, camera_frustums_[i]->Intersect(node.PosBoundWS()));
+							// Lives in an invisible part of the tree
+							for (uint32_t i = 0; i < num_cameras; ++i)
+							{
+								node.VisibleMark(i, BoundOverlap::No);
+							}
+						}
+						else
+						{
+							for (uint32_t i = 0; i < num_cameras; ++i)
+							{
+								if (node.VisibleMark(i) == BoundOverlap::Partial)
+								{
+									node.VisibleMark(i, camera_frustums_[i]->Intersect(node.PosBoundWS()));
+								}
+							}
 						}
 					}
 				}
-			}
+			});
 		}
 
 #ifdef KLAYGE_DRAW_NODES
@@ -259,6 +299,10 @@ namespace KlayGE
 		SceneManager::ClearObject();
 
 		octree_.clear();
+		loose_scene_nodes_.clear();
+		loose_entries_.clear();
+		loose_num_objs_ = 0;
+		loose_num_outside_ = 0;
 		rebuild_tree_ = true;
 	}
 
@@ -331,7 +375,256 @@ namespace KlayGE
 		}
 	}
 
-	void OCTree::NodeVisible(size_t index)
+	// Incremental counterpart of the rebuild in ClipScene. Only nodes whose world bound changed are relocated, which costs
+	// O(depth). Added and removed nodes are picked up by comparing against the node list of the last call.
+	void OCTree::UpdateLooseTree()
+	{
+		auto const & arrays = node_arrays_;
+		if (loose_scene_nodes_ != arrays.nodes)
+		{
+			std::unordered_map<SceneNode*, loose_entry_t> old_entries;
+			for (size_t n = 0; n < loose_scene_nodes_.size(); ++ n)
+			{
+				if (loose_entries_[n].node_index >= 0)
+				{
+					old_entries.emplace(loose_scene_nodes_[n], loose_entries_[n]);
+				}
+			}
+
+			loose_scene_nodes_ = arrays.nodes;
+			loose_entries_.assign(loose_scene_nodes_.size(), loose_entry_t{ -1, false, false, AABBox() });
+			for (size_t n = 0; n < loose_scene_nodes_.size(); ++ n)
+			{
+				auto iter = old_entries.find(loose_scene_nodes_[n]);
+				if (iter != old_entries.end())
+				{
+					loose_entries_[n] = iter->second;
+					old_entries.erase(iter);
+				}
+			}
+
+			// The rest are gone from the scene
+			for (auto const & old_entry : old_entries)
+			{
+				auto& node_ptrs = octree_[old_entry.second.node_index].node_ptrs;
+				auto iter = std::find(node_ptrs.begin(), node_ptrs.end(), old_entry.first);
+				BOOST_ASSERT(iter != node_ptrs.end());
+				*iter = node_ptrs.back();
+				node_ptrs.pop_back();
+
+				-- loose_num_objs_;
+				if (old_entry.second.outside)
+				{
+					-- loose_num_outside_;
+				}
+			}
+		}
+
+		if (octree_.empty())
+		{
+			this->RebuildLooseTree();
+			return;
+		}
+
+		for (size_t n = 0; n < loose_scene_nodes_.size(); ++ n)
+		{
+			auto& entry = loose_entries_[n];
+			entry.reached = false;
+
+			uint8_t constexpr in_tree_flags = SceneNodeArrays::F_HasPosBound | SceneNodeArrays::F_Updated;
+			if ((arrays.attribs[n] & SceneNode::SOA_Cullable) && ((arrays.flags[n] & in_tree_flags) == in_tree_flags))
+			{
+				if (entry.node_index < 0)
+				{
+					this->LooseInsert(n);
+				}
+				else if (arrays.pos_aabbs_ws[n] != entry.aabb)
+				{
+					bool outside;
+					size_t const target = this->LooseTargetNode(arrays.pos_aabbs_ws[n], outside);
+					if ((target != static_cast<size_t>(entry.node_index)) || (0 == target))
+					{
+						this->LooseRemove(n);
+						this->LooseInsert(n);
+					}
+					else
+					{
+						entry.aabb = arrays.pos_aabbs_ws[n];
+					}
+				}
+			}
+			else if (entry.node_index >= 0)
+			{
+				this->LooseRemove(n);
+			}
+		}
+
+		// Too many nodes have left the root bound. Grow the tree to hold them again.
+		if (loose_num_outside_ > std::max<size_t>(32, loose_num_objs_ / 8))
+		{
+			this->RebuildLooseTree();
+		}
+	}
+
+	void OCTree::RebuildLooseTree()
+	{
+		auto const & arrays = node_arrays_;
+		uint8_t constexpr in_tree_flags = SceneNodeArrays::F_HasPosBound | SceneNodeArrays::F_Updated;
+
+		octree_.clear();
+		loose_scene_nodes_ = arrays.nodes;
+		loose_entries_.assign(loose_scene_nodes_.size(), loose_entry_t{ -1, false, false, AABBox() });
+		loose_num_objs_ = 0;
+		loose_num_outside_ = 0;
+
+		bool has_obj = false;
+		AABBox bb_root(float3(0, 0, 0), float3(0, 0, 0));
+		for (size_t n = 0; n < loose_scene_nodes_.size(); ++ n)
+		{
+			if ((arrays.attribs[n] & SceneNode::SOA_Cullable) && ((arrays.flags[n] & in_tree_flags) == in_tree_flags))
+			{
+				if (has_obj)
+				{
+					bb_root |= arrays.pos_aabbs_ws[n];
+				}
+				else
+				{
+					bb_root = arrays.pos_aabbs_ws[n];
+					has_obj = true;
+				}
+			}
+		}
+
+		if (has_obj)
+		{
+			float3 const & center = bb_root.Center();
+			float3 const & extent = bb_root.HalfSize();
+			float longest_dim = std::max(std::max(extent.x(), extent.y()), extent.z());
+			float3 new_extent(longest_dim, longest_dim, longest_dim);
+			loose_root_bb_ = AABBox(center - new_extent, center + new_extent);
+
+			octree_.resize(1);
+			octree_[0].bb = loose_root_bb_;
+			octree_[0].first_child_index = -1;
+			octree_[0].visible = BoundOverlap::No;
+
+			for (size_t n = 0; n < loose_scene_nodes_.size(); ++ n)
+			{
+				if ((arrays.attribs[n] & SceneNode::SOA_Cullable) && ((arrays.flags[n] & in_tree_flags) == in_tree_flags))
+				{
+					this->LooseInsert(n);
+				}
+			}
+		}
+
+		rebuild_tree_ = false;
+	}
+
+	void OCTree::LooseInsert(size_t n)
+	{
+		AABBox const & aabb = node_arrays_.pos_aabbs_ws[n];
+
+		bool outside;
+		size_t const index = this->LooseTargetNode(aabb, outside);
+		octree_[index].node_ptrs.push_back(loose_scene_nodes_[n]);
+		if (0 == index)
+		{
+			// The root is the only node that can hold bounds larger than its loose bound
+			octree_[0].bb |= aabb;
+		}
+
+		auto& entry = loose_entries_[n];
+		entry.node_index = static_cast<int>(index);
+		entry.outside = outside;
+		entry.aabb = aabb;
+
+		++ loose_num_objs_;
+		if (outside)
+		{
+			++ loose_num_outside_;
+		}
+	}
+
+	void OCTree::LooseRemove(size_t n)
+	{
+		auto& entry = loose_entries_[n];
+		BOOST_ASSERT(entry.node_index >= 0);
+
+		auto& node_ptrs = octree_[entry.node_index].node_ptrs;
+		auto iter = std::find(node_ptrs.begin(), node_ptrs.end(), loose_scene_nodes_[n]);
+		BOOST_ASSERT(iter != node_ptrs.end());
+		*iter = node_ptrs.back();
+		node_ptrs.pop_back();
+
+		-- loose_num_objs_;
+		if (entry.outside)
+		{
+			-- loose_num_outside_;
+		}
+		entry.node_index = -1;
+		entry.outside = false;
+	}
+
+	// The loose bound of a node is twice its size. So a bound can go down to a child as long as its center is in the
+	// child and it is no larger than the child.
+	size_t OCTree::LooseTargetNode(AABBox const & aabb, bool& outside)
+	{
+		float3 const center = aabb.Center();
+		float3 const half_size = aabb.HalfSize();
+		float const obj_half_size = std::max(std::max(half_size.x(), half_size.y()), half_size.z());
+
+		outside = !MathLib::intersect_point_aabb(center, loose_root_bb_);
+
+		size_t index = 0;
+		if (!outside)
+		{
+			float3 node_center = loose_root_bb_.Center();
+			float node_half_size = loose_root_bb_.HalfSize().x();
+			for (uint32_t curr_depth = 1; (curr_depth <= max_tree_depth_) && (obj_half_size <= node_half_size * 0.5f); ++ curr_depth)
+			{
+				if (-1 == octree_[index].first_child_index)
+				{
+					this->LooseDivideNode(index, node_center, node_half_size);
+				}
+
+				int const j = (center.x() >= node_center.x() ? 1 : 0)
+					+ (center.y() >= node_center.y() ? 2 : 0)
+					+ (center.z() >= node_center.z() ? 4 : 0);
+				index = octree_[index].first_child_index + j;
+
+				node_half_size *= 0.5f;
+				node_center += float3((j & 1) ? node_half_size : -node_half_size,
+					(j & 2) ? node_half_size : -node_half_size,
+					(j & 4) ? node_half_size : -node_half_size);
+			}
+		}
+
+		return index;
+	}
+
+	void OCTree::LooseDivideNode(size_t index, float3 const & center, float half_size)
+	{
+		size_t const this_size = octree_.size();
+		octree_[index].first_child_index = static_cast<int>(this_size);
+
+		octree_.resize(this_size + 8);
+		float const child_half_size = half_size * 0.5f;
+		float3 const loose_extent(half_size, half_size, half_size);
+		for (size_t j = 0; j < 8; ++ j)
+		{
+			float3 const child_center = center + float3((j & 1) ? child_half_size : -child_half_size,
+				(j & 2) ? child_half_size : -child_half_size,
+				(j & 4) ? child_half_size : -child_half_size);
+
+			octree_node_t& new_node = octree_[this_size + j];
+			new_node.bb = AABBox(child_center - loose_extent, child_center + loose_extent);
+			new_node.first_child_index = -1;
+			new_node.visible = BoundOverlap::No;
+		}
+	}
+
+	// visible is the result of the node's bound against the camera frustums
+	void OCTree::NodeVisible(size_t index, BoundOverlap visible)
 	{
 		BOOST_ASSERT(index < octree_.size());
 
@@ -363,14 +656,33 @@ namespace KlayGE
 
 		if (large_enough)
 		{
-			octree_node.visible = SceneManager::AABBVisible(octree_node.bb);
+			octree_node.visible = visible;
 			if (BoundOverlap::Partial == octree_node.visible)
 			{
 				if (octree_node.first_child_index != -1)
 				{
+					// The 8 children are tested against each frustum in one batch
+					std::array<AABBox, 8> child_bbs;
+					std::array<BoundOverlap, 8> child_visibles;
+					for (int i = 0; i < 8; ++ i)
+					{
+						child_bbs[i] = octree_[octree_node.first_child_index + i].bb;
+					}
+					child_visibles.fill(camera_frustums_.empty() ? BoundOverlap::Yes : BoundOverlap::No);
+					for (auto const* camera_frustum : camera_frustums_)
+					{
+						std::array<BoundOverlap, 8> results;
+						MathLib::intersect_aabbs_frustum(child_bbs.data(), child_bbs.size(), *camera_frustum, results.data());
+						for (int i = 0; i < 8; ++ i)
+						{
+							child_visibles[i] = std::max(child_visibles[i], results[i]);
+						}
+					}
+
+					int const first_child_index = octree_node.first_child_index;
 					for (int i = 0; i < 8; ++ i)
 					{
-						this->NodeVisible(octree_node.first_child_index + i);
+						this->NodeVisible(first_child_index + i, child_visibles[i]);
 					}
 				}
 			}
@@ -402,7 +714,12 @@ namespace KlayGE
 		{
 			for (auto* node : octree_node.node_ptrs)
 			{
-				if (node->Visible())
+				if (loose_mode_ && (node->Attrib() & SceneNode::SOA_Moveable))
+				{
+					// Moveable nodes are tested against the frustums after the tree walk
+					loose_entries_[node->Handle()].reached = true;
+				}
+				else if (node->Visible())
 				{
 					if (node->Updated())
 					{
@@ -590,9 +907,10 @@ namespace KlayGE
 					mark[5] = aabb.Max().z() >= center.z() ? 4 : 0;
 					for (int j = 0; j < 8; ++ j)
 					{
-						if (j == ((j & 1) ? mark[3] : mark[0])
+						// Loose children overlap, so every child could hold the bound
+						if (loose_mode_ || (j == ((j & 1) ? mark[3] : mark[0])
 							+ ((j & 2) ? mark[4] : mark[1])
-							+ ((j & 4) ? mark[5] : mark[2]))
+							+ ((j & 4) ? mark[5] : mark[2])))
 						{
 							BoundOverlap const bo = this->BoundVisible(node.first_child_index + j, aabb);
 							if (bo != BoundOverlap::No)
@@ -1,12 +1,58 @@
 #include <KlayGE/KlayGE.hpp>
 #include <KFL/Util.hpp>
 #include <KFL/Hash.hpp>
+#include <KFL/Timer.hpp>
+#include <KFL/XMLDom.hpp>
+#include <KFL/CXX17/filesystem.hpp>
+#include <KlayGE/ResLoader.hpp>
 
 #include "KlayGETests.hpp"
 
+#include <deque>
+#include <iostream>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
 using namespace std;
 using namespace KlayGE;
 
+namespace
+{
+	void GatherNames(XMLNodeHandle node, set<string>& names)
+	{
+		if (XMLAttributeHandle const attr = node.Attrib("name"))
+		{
+			names.emplace(attr.ValueString());
+		}
+		for (auto const & child : node.Children())
+		{
+			GatherNames(child, names);
+		}
+	}
+
+	// Every name attribute in the shipped .fxml files
+	set<string> RenderFXNames()
+	{
+		set<string> names;
+		string const blitter_path = ResLoader::Instance().Locate("Blitter.fxml");
+		if (!blitter_path.empty())
+		{
+			for (auto const & entry : filesystem::directory_iterator(filesystem::path(blitter_path).parent_path()))
+			{
+				if (entry.path().extension() == ".fxml")
+				{
+					XMLDocument doc;
+					XMLNodePtr const root = doc.Parse(*ResLoader::Instance().Open(entry.path().string()));
+					GatherNames(root->Handle(), names);
+				}
+			}
+		}
+		return names;
+	}
+}
+
 TEST(CTHashTest, Basic)
 {
 	EXPECT_EQ(CT_HASH("ABCD"), RT_HASH("ABCD"));
@@ -14,3 +60,148 @@ TEST(CTHashTest, Basic)
 	EXPECT_EQ(CT_HASH("Test"), RT_HASH("Test"));
 	EXPECT_EQ(CT_HASH("min_linear_mag_point_mip_linear"), RT_HASH("min_linear_mag_point_mip_linear"));
 }
+
+TEST(CTHashTest, CompileTime)
+{
+	static_assert(CT_HASH("KlayGE") != CT_HASH("KlayGF"), "CT_HASH must be a constant expression");
+
+	size_t hash;
+	switch (RT_HASH("depth_tex"))
+	{
+	case CT_HASH("color_tex"):
+		hash = 1;
+		break;
+
+	case CT_HASH("depth_tex"):
+		hash = 2;
+		break;
+
+	default:
+		hash = 0;
+		break;
+	}
+	EXPECT_EQ(hash, 2U);
+}
+
+TEST(CTHashTest, AllLengths)
+{
+	// Covers the 8 byte, 4 byte and 1 byte steps, and every mix of them
+	char const str[] = "The quick brown fox jumps over the lazy dog";
+	size_t const len = sizeof(str) - 1;
+	for (size_t i = 0; i <= len; ++ i)
+	{
+		string const sub(str, i);
+		size_t const hash = RT_HASH(sub.c_str());
+		EXPECT_EQ(hash, CTHashImpl(sub.c_str()));
+		EXPECT_EQ(hash, HashRange(sub.begin(), sub.end()));
+		EXPECT_EQ(hash, HashRange(sub.c_str(), sub.c_str() + sub.size()));
+		EXPECT_EQ(hash, HashString(sub.data(), sub.size()));
+
+		string_view const sub_view(sub);
+		EXPECT_EQ(hash, HashRange(sub_view.begin(), sub_view.end()));
+
+		if (i > 0)
+		{
+			EXPECT_NE(hash, RT_HASH(string(str, i - 1).c_str()));
+		}
+	}
+
+	// The seed chains ranges
+	string const lhs = "position";
+	string const rhs = "normal";
+	size_t seed = 0;
+	HashRange(seed, lhs.begin(), lhs.end());
+	HashRange(seed, rhs.begin(), rhs.end());
+	EXPECT_EQ(seed, HashString(rhs.data(), rhs.size(), HashString(lhs.data(), lhs.size())));
+	EXPECT_NE(seed, HashRange(rhs.begin(), rhs.end()));
+
+	// Non-char ranges still combine element by element
+	vector<uint32_t> const values = { 1, 2, 3 };
+	size_t value_seed = 0;
+	for (auto const value : values)
+	{
+		HashCombine(value_seed, value);
+	}
+	EXPECT_EQ(HashRange(values.begin(), values.end()), value_seed);
+}
+
+TEST(CTHashTest, NonContiguousCharRanges)
+{
+	// Random access but not contiguous. They combine char by char.
+	string const str = "position";
+	size_t seed = 0;
+	for (auto const ch : str)
+	{
+		HashCombine(seed, ch);
+	}
+
+	deque<char> const chars(str.begin(), str.end());
+	EXPECT_EQ(HashRange(chars.begin(), chars.end()), seed);
+
+	string const reversed(str.rbegin(), str.rend());
+	EXPECT_EQ(HashRange(reversed.rbegin(), reversed.rend()), seed);
+}
+
+TEST(CTHashTest, RenderFXNames)
+{
+	set<string> const names = RenderFXNames();
+	ASSERT_FALSE(names.empty());
+
+	map<size_t, string> hashes;
+	for (auto const & name : names)
+	{
+		auto const result = hashes.emplace(HashRange(name.begin(), name.end()), name);
+		EXPECT_TRUE(result.second) << name << " collides with " << result.first->second;
+	}
+}
+
+// Disabled by default. Run it with --gtest_also_run_disabled_tests.
+TEST(CTHashTest, DISABLED_Benchmark)
+{
+	uint32_t constexpr NUM_ROUNDS = 10000;
+
+	set<string> const name_set = RenderFXNames();
+	ASSERT_FALSE(name_set.empty());
+	vector<string> const names(name_set.begin(), name_set.end());
+	size_t total_len = 0;
+	for (auto const & name : names)
+	{
+		total_len += name.size();
+	}
+
+	// The hash before the word-at-a-time one combined a byte at a time
+	size_t bytewise_sink = 0;
+	Timer timer;
+	for (uint32_t round = 0; round < NUM_ROUNDS; ++ round)
+	{
+		for (auto const & name : names)
+		{
+			size_t seed = 0;
+			for (auto const ch : name)
+			{
+				HashCombine(seed, ch);
+			}
+			bytewise_sink += seed;
+		}
+	}
+	double const bytewise_time = timer.elapsed();
+
+	size_t word_sink = 0;
+	timer.restart();
+	for (uint32_t round = 0; round < NUM_ROUNDS; ++ round)
+	{
+		for (auto const & name : names)
+		{
+			word_sink += HashRange(name.begin(), name.end());
+		}
+	}
+	double const word_time = timer.elapsed();
+
+	double const num_bytes = static_cast<double>(total_len) * NUM_ROUNDS;
+	cout << names.size() << " RenderFX names, " << static_cast<double>(total_len) / names.size() << " chars on average" << endl;
+	cout << "Byte at a time: " << bytewise_time * 1e9 / num_bytes << " ns per char" << endl;
+	cout << "Word at a time: " << word_time * 1e9 / num_bytes << " ns per char, " << bytewise_time / word_time << "x" << endl;
+
+	// Uses the results, so the loops can't be optimized away
+	EXPECT_NE(bytewise_sink, word_sink);
+}
@@ -0,0 +1,87 @@
+#include <KlayGE/KlayGE.hpp>
+#include <KFL/FrameAllocator.hpp>
+
+#include "KlayGETests.hpp"
+
+#include <cstdint>
+#include <numeric>
+
+using namespace std;
+using namespace KlayGE;
+
+TEST(FrameAllocatorTest, Alignment)
+{
+	frame_arena arena(256);
+
+	void* p1 = arena.allocate(3, 1);
+	void* p16 = arena.allocate(16, 16);
+	void* p64 = arena.allocate(8, 64);
+	EXPECT_EQ(reinterpret_cast<uintptr_t>(p16) % 16, 0U);
+	EXPECT_EQ(reinterpret_cast<uintptr_t>(p64) % 64, 0U);
+	EXPECT_LT(static_cast<uint8_t*>(p1), static_cast<uint8_t*>(p16));
+	EXPECT_LT(static_cast<uint8_t*>(p16), static_cast<uint8_t*>(p64));
+}
+
+TEST(FrameAllocatorTest, DeallocateNewest)
+{
+	frame_arena arena(256);
+
+	uint32_t* a = arena.allocate<uint32_t>(4);
+	size_t const used = arena.bytes_used();
+	uint32_t* b = arena.allocate<uint32_t>(4);
+	EXPECT_EQ(arena.bytes_used(), used + 16);
+
+	// Not the newest one, nothing comes back
+	arena.deallocate(a, 16);
+	EXPECT_EQ(arena.bytes_used(), used + 16);
+
+	arena.deallocate(b, 16);
+	EXPECT_EQ(arena.bytes_used(), used);
+	EXPECT_EQ(arena.allocate<uint32_t>(4), b);
+}
+
+TEST(FrameAllocatorTest, GrowAndMerge)
+{
+	frame_arena arena(256);
+
+	for (uint32_t frame = 0; frame < 3; ++ frame)
+	{
+		size_t peak;
+		{
+			frame_vector<uint32_t> v{ frame_allocator<uint32_t>(arena) };
+			for (uint32_t i = 0; i < 1000; ++ i)
+			{
+				v.push_back(i);
+			}
+			EXPECT_EQ(accumulate(v.begin(), v.end(), 0U), 999U * 1000 / 2);
+
+			frame_vector<uint8_t> bytes(5000, 1, frame_allocator<uint8_t>(arena));
+			EXPECT_EQ(accumulate(bytes.begin(), bytes.end(), 0U), 5000U);
+
+			peak = arena.bytes_used();
+			EXPECT_GE(peak, 1000 * sizeof(uint32_t) + 5000);
+		}
+
+		arena.reset();
+		EXPECT_EQ(arena.bytes_used(), 0U);
+		EXPECT_GE(arena.last_frame_peak(), peak);
+		EXPECT_GE(arena.high_water_mark(), arena.last_frame_peak());
+
+		// After the first frame, everything fits in one block
+		EXPECT_GE(arena.capacity(), arena.last_frame_peak());
+	}
+
+	size_t const capacity = arena.capacity();
+	arena.allocate(arena.last_frame_peak(), 1);
+	EXPECT_EQ(arena.capacity(), capacity);
+}
+
+TEST(FrameAllocatorTest, ThreadInstance)
+{
+	frame_vector<int> v(10, 7);
+	EXPECT_EQ(&v.get_allocator().arena(), &frame_arena::thread_instance());
+	EXPECT_EQ(frame_allocator<int>(), frame_allocator<char>());
+
+	frame_arena other;
+	EXPECT_NE(frame_allocator<int>(other), frame_allocator<int>());
+}
@@ -0,0 +1,83 @@
+#include <KlayGE/KlayGE.hpp>
+#include <KFL/Half.hpp>
+
+#include "KlayGETests.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace std;
+using namespace KlayGE;
+
+namespace
+{
+	uint16_t HalfBits(half h)
+	{
+		uint16_t bits;
+		memcpy(&bits, &h, sizeof(bits));
+		return bits;
+	}
+}
+
+TEST(HalfTest, BulkHalfToFloat)
+{
+	// Every bit pattern, widening is exact. half has no bits constructor, so they are viewed as halfs.
+	vector<uint16_t> bits(65536);
+	for (uint32_t i = 0; i < bits.size(); ++ i)
+	{
+		bits[i] = static_cast<uint16_t>(i);
+	}
+	static_assert(sizeof(half) == sizeof(uint16_t), "half must be a bare uint16_t");
+	std::span<half const> const halfs(reinterpret_cast<half const *>(bits.data()), bits.size());
+
+	vector<float> floats(halfs.size());
+	HalfToFloat(halfs, floats);
+	for (uint32_t i = 0; i < halfs.size(); ++ i)
+	{
+		float const expected = halfs[i];
+		if (std::isnan(expected))
+		{
+			EXPECT_TRUE(std::isnan(floats[i])) << i;
+		}
+		else
+		{
+			EXPECT_EQ(floats[i], expected) << i;
+		}
+	}
+}
+
+TEST(HalfTest, BulkFloatToHalf)
+{
+	mt19937 gen;
+	uniform_real_distribution<float> dis(-HALF_MAX, HALF_MAX);
+
+	// All lengths, so every mix of the wide steps and the tail is covered
+	for (uint32_t num = 0; num < 20; ++ num)
+	{
+		vector<float> floats(num);
+		for (auto& f : floats)
+		{
+			f = dis(gen) / (1U << (gen() % 24));
+		}
+
+		vector<half> halfs(num);
+		FloatToHalf(floats, halfs);
+		for (uint32_t i = 0; i < num; ++ i)
+		{
+			// Only rounding of exact ties can differ from the scalar conversion
+			int const diff = static_cast<int>(HalfBits(halfs[i])) - static_cast<int>(HalfBits(half(floats[i])));
+			EXPECT_LE(std::abs(diff), 1) << floats[i];
+			EXPECT_NEAR(static_cast<float>(halfs[i]), floats[i], std::abs(floats[i]) * HALF_EPSILON + HALF_MIN);
+		}
+	}
+
+	// Values that are exact in half survive the round trip
+	vector<float> const exact = { 0.0f, -0.0f, 1.0f, -2.5f, 0.125f, 1024.0f, HALF_MAX, -HALF_MAX, HALF_NRM_MIN, HALF_MIN };
+	vector<half> halfs(exact.size());
+	vector<float> floats(exact.size());
+	FloatToHalf(exact, halfs);
+	HalfToFloat(halfs, floats);
+	EXPECT_EQ(floats, exact);
+}
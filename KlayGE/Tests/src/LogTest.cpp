@@ -0,0 +1,65 @@
+#include <KlayGE/KlayGE.hpp>
+#include <KFL/Log.hpp>
+
+#include "KlayGETests.hpp"
+
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace KlayGE;
+
+TEST(LogTest, RecordsFromManyThreads)
+{
+	uint32_t const num_threads = 4;
+	uint32_t const num_records = 1000;
+
+	// Nothing of the other tests should end up in the captured text
+	FlushLog();
+	stringstream captured;
+	streambuf* const clog_buff = clog.rdbuf(captured.rdbuf());
+
+	vector<thread> threads;
+	for (uint32_t t = 0; t < num_threads; ++ t)
+	{
+		threads.emplace_back([t, num_records] {
+			for (uint32_t i = 0; i < num_records; ++ i)
+			{
+				LogInfo() << "record " << t << ' ' << i << endl;
+			}
+		});
+	}
+	for (auto& th : threads)
+	{
+		th.join();
+	}
+	FlushLog();
+
+	clog.rdbuf(clog_buff);
+
+	// Every record is a whole line of its own, with the time and the thread in front
+	set<string> records;
+	string line;
+	while (getline(captured, line))
+	{
+		EXPECT_EQ(line.find('['), 0U);
+		size_t const text = line.find("(INFO) KlayGE: record ");
+		ASSERT_NE(text, string::npos) << line;
+		EXPECT_TRUE(records.insert(line.substr(text)).second) << line;
+	}
+	EXPECT_EQ(records.size(), num_threads * num_records);
+}
+
+TEST(LogTest, LevelFiltering)
+{
+	// Filtered records skip the formatting
+	EXPECT_TRUE(EmptyLog().bad());
+	EmptyLog() << "dropped " << 1.5f << endl;
+#if KLAYGE_LOG_LEVEL > 0
+	EXPECT_EQ(&LogDebug(), &EmptyLog());
+#endif
+}
@@ -6,6 +6,7 @@
 #include <vector>
 #include <string>
 #include <iostream>
+#include <random>
 
 using namespace std;
 using namespace KlayGE;
@@ -30,3 +31,79 @@ TEST(MathTest, NormalizeFloat4)
 	v = MathLib::normalize(v);
 	EXPECT_LT(MathLib::abs(MathLib::length(v) - 1.0f), 1e-5f);
 }
+
+namespace
+{
+	Frustum TestFrustum(float3 const & eye)
+	{
+		float4x4 const view_proj = MathLib::look_at_lh(eye, float3(0, 0, 0)) * MathLib::perspective_fov_lh(1.2f, 1.5f, 1.0f, 50.0f);
+		Frustum frustum;
+		frustum.ClipMatrix(view_proj, MathLib::inverse(view_proj));
+		return frustum;
+	}
+
+	std::vector<AABBox> TestAABBs(size_t num)
+	{
+		std::mt19937 gen(42);
+		std::uniform_real_distribution<float> pos_dist(-40, 40);
+		std::uniform_real_distribution<float> size_dist(0.1f, 10);
+
+		std::vector<AABBox> aabbs;
+		for (size_t i = 0; i < num; ++ i)
+		{
+			float3 const min_pt(pos_dist(gen), pos_dist(gen), pos_dist(gen));
+			aabbs.emplace_back(min_pt, min_pt + float3(size_dist(gen), size_dist(gen), size_dist(gen)));
+		}
+		return aabbs;
+	}
+}
+
+TEST(MathTest, IntersectAABBsFrustum)
+{
+	Frustum const frustum = TestFrustum(float3(3, 5, -20));
+	std::vector<AABBox> const aabbs = TestAABBs(1023);
+
+	std::vector<float> bounds[6];
+	for (auto const & aabb : aabbs)
+	{
+		for (size_t i = 0; i < 3; ++ i)
+		{
+			bounds[i].push_back(aabb.Min()[i]);
+			bounds[i + 3].push_back(aabb.Max()[i]);
+		}
+	}
+
+	std::vector<BoundOverlap> soa_results(aabbs.size());
+	MathLib::intersect_aabbs_frustum(bounds[0].data(), bounds[1].data(), bounds[2].data(), bounds[3].data(), bounds[4].data(),
+		bounds[5].data(), aabbs.size(), frustum, soa_results.data());
+	std::vector<BoundOverlap> aos_results(aabbs.size());
+	MathLib::intersect_aabbs_frustum(aabbs.data(), aabbs.size(), frustum, aos_results.data());
+
+	uint32_t counts[3] = { 0, 0, 0 };
+	for (size_t i = 0; i < aabbs.size(); ++ i)
+	{
+		BoundOverlap const expected = MathLib::intersect_aabb_frustum(aabbs[i], frustum);
+		EXPECT_EQ(soa_results[i], expected);
+		EXPECT_EQ(aos_results[i], expected);
+		++ counts[static_cast<int>(expected)];
+	}
+	EXPECT_GT(counts[0], 0U);
+	EXPECT_GT(counts[1], 0U);
+	EXPECT_GT(counts[2], 0U);
+}
+
+TEST(MathTest, IntersectAABBFrustums)
+{
+	Frustum const frustums[] = { TestFrustum(float3(3, 5, -20)), TestFrustum(float3(-20, 2, 1)), TestFrustum(float3(0, 30, 4)) };
+	Frustum const * const frustum_ptrs[] = { &frustums[0], &frustums[1], &frustums[2] };
+
+	for (auto const & aabb : TestAABBs(256))
+	{
+		BoundOverlap results[3];
+		MathLib::intersect_aabb_frustums(aabb, frustum_ptrs, 3, results);
+		for (size_t i = 0; i < 3; ++ i)
+		{
+			EXPECT_EQ(results[i], MathLib::intersect_aabb_frustum(aabb, frustums[i]));
+		}
+	}
+}
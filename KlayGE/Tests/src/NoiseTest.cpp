@@ -0,0 +1,135 @@
+#include <KlayGE/KlayGE.hpp>
+#include <KFL/Noise.hpp>
+#include <KFL/TaskScheduler.hpp>
+
+#include "KlayGETests.hpp"
+
+#include <random>
+#include <vector>
+
+using namespace std;
+using namespace KlayGE;
+
+namespace
+{
+	// Up to 2 full sets of AVX lanes and a tail. Integers hit the cell boundaries.
+	void GenCoords(uint32_t num, vector<float>& xs, vector<float>& ys)
+	{
+		mt19937 gen(num);
+		uniform_real_distribution<float> dis(-40, 40);
+		xs.resize(num);
+		ys.resize(num);
+		for (uint32_t i = 0; i < num; ++ i)
+		{
+			if (i % 5 == 4)
+			{
+				xs[i] = static_cast<float>(static_cast<int>(dis(gen)));
+				ys[i] = 0;
+			}
+			else
+			{
+				xs[i] = dis(gen);
+				ys[i] = dis(gen);
+			}
+		}
+	}
+}
+
+TEST(NoiseTest, BatchNoise)
+{
+	auto& noiser = MathLib::SimplexNoise<float>::Instance();
+	for (uint32_t num = 0; num <= 19; ++ num)
+	{
+		vector<float> xs;
+		vector<float> ys;
+		GenCoords(num, xs, ys);
+
+		vector<float> result(num);
+		noiser.noise(xs, ys, result);
+		for (uint32_t i = 0; i < num; ++ i)
+		{
+			// Only rounding differs, such as the compiler fusing multiply-adds in one of them
+			EXPECT_NEAR(result[i], noiser.noise(xs[i], ys[i]), 1e-4f);
+		}
+
+		noiser.tileable_noise(xs, ys, 7.5f, 5, result);
+		for (uint32_t i = 0; i < num; ++ i)
+		{
+			EXPECT_NEAR(result[i], noiser.tileable_noise(xs[i], ys[i], 7.5f, 5), 1e-3f);
+		}
+	}
+}
+
+TEST(NoiseTest, BatchOctaves)
+{
+	auto& noiser = MathLib::SimplexNoise<float>::Instance();
+
+	vector<float> xs;
+	vector<float> ys;
+	GenCoords(1000, xs, ys);
+	for (auto& x : xs)
+	{
+		x = abs(x) / 5;
+	}
+	for (auto& y : ys)
+	{
+		y = abs(y) / 5;
+	}
+
+	vector<float> result(xs.size());
+	noiser.fBm(xs, ys, result, 5, 2.1f, 0.45f);
+	for (uint32_t i = 0; i < xs.size(); ++ i)
+	{
+		EXPECT_NEAR(result[i], noiser.fBm(xs[i], ys[i], 5, 2.1f, 0.45f), 1e-5f);
+	}
+
+	noiser.turbulence(xs, ys, result, 4);
+	for (uint32_t i = 0; i < xs.size(); ++ i)
+	{
+		EXPECT_NEAR(result[i], noiser.turbulence(xs[i], ys[i], 4), 1e-5f);
+	}
+
+	noiser.tileable_fBm(xs, ys, 8, 8, result, 5);
+	for (uint32_t i = 0; i < xs.size(); ++ i)
+	{
+		EXPECT_NEAR(result[i], noiser.tileable_fBm(xs[i], ys[i], 8, 8, 5), 1e-4f);
+	}
+
+	noiser.tileable_turbulence(xs, ys, 8, 8, result, 3);
+	for (uint32_t i = 0; i < xs.size(); ++ i)
+	{
+		EXPECT_NEAR(result[i], noiser.tileable_turbulence(xs[i], ys[i], 8, 8, 3), 1e-4f);
+	}
+}
+
+TEST(NoiseTest, FillImage)
+{
+	uint32_t const WIDTH = 67;
+	uint32_t const HEIGHT = 300;
+	float const STRIDE = 8;
+
+	auto& noiser = MathLib::SimplexNoise<float>::Instance();
+	task_scheduler scheduler(3);
+
+	vector<float> image(WIDTH * HEIGHT);
+	noiser.fill_tileable_fBm(scheduler, image, WIDTH, HEIGHT, STRIDE, STRIDE, 5);
+	for (uint32_t y = 0; y < HEIGHT; ++ y)
+	{
+		for (uint32_t x = 0; x < WIDTH; ++ x)
+		{
+			float const expected =
+				noiser.tileable_fBm((x + 0.5f) / WIDTH * STRIDE, (y + 0.5f) / HEIGHT * STRIDE, STRIDE, STRIDE, 5);
+			EXPECT_NEAR(image[y * WIDTH + x], expected, 1e-4f);
+		}
+	}
+
+	noiser.fill_turbulence(scheduler, image, WIDTH, HEIGHT, STRIDE, STRIDE / 2, 3);
+	for (uint32_t y = 0; y < HEIGHT; ++ y)
+	{
+		for (uint32_t x = 0; x < WIDTH; ++ x)
+		{
+			float const expected = noiser.turbulence((x + 0.5f) / WIDTH * STRIDE, (y + 0.5f) / HEIGHT * STRIDE / 2, 3);
+			EXPECT_NEAR(image[y * WIDTH + x], expected, 1e-5f);
+		}
+	}
+}
@@ -0,0 +1,102 @@
+/**
+ * @file OcclusionCullerTest.cpp
+ * @author Minmin Gong
+ *
+ * @section DESCRIPTION
+ *
+ * This source file is part of KlayGE
+ * For the latest info, see http://www.klayge.org
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * You may alternatively use this source under the terms of
+ * the KlayGE Proprietary License (KPL). You can obtained such a license
+ * from http://www.klayge.org/licensing/.
+ */
+
+#include <KlayGE/KlayGE.hpp>
+
+#include <KFL/Math.hpp>
+#include <KlayGE/SceneNode.hpp>
+#include <KlayGE/SoftwareOcclusionCuller.hpp>
+
+#include "KlayGETests.hpp"
+
+using namespace std;
+using namespace KlayGE;
+
+namespace
+{
+	float4x4 ViewProj()
+	{
+		return MathLib::look_at_lh(float3(0, 0, 0), float3(0, 0, 1)) * MathLib::perspective_fov_lh(PI / 3, 2.0f, 0.1f, 100.0f);
+	}
+
+	SceneNodePtr WallNode(SoftwareOcclusionCuller& culler, float half_width, float z_bottom, float z_top)
+	{
+		auto node = MakeSharedPtr<SceneNode>(L"Wall", SceneNode::SOA_Cullable);
+		node->FillVisibleMark(BoundOverlap::Partial);
+
+		float3 const positions[] = { float3(-half_width, -half_width, z_bottom), float3(+half_width, -half_width, z_bottom),
+			float3(+half_width, +half_width, z_top), float3(-half_width, +half_width, z_top) };
+		uint32_t const indices[] = { 0, 1, 2, 0, 2, 3 };
+		culler.AddOccluder(node, positions, indices);
+		return node;
+	}
+}
+
+TEST(OcclusionCullerTest, Wall)
+{
+	SoftwareOcclusionCuller culler;
+	auto wall = WallNode(culler, 10, 20, 20);
+	culler.Render(ViewProj(), 0);
+	EXPECT_EQ(culler.NumTrianglesRasterized(), 2U);
+
+	EXPECT_TRUE(culler.IsOccluded(AABBox(float3(-1, -1, 30), float3(1, 1, 32))));
+	EXPECT_FALSE(culler.IsOccluded(AABBox(float3(-1, -1, 10), float3(1, 1, 12))));
+	EXPECT_FALSE(culler.IsOccluded(AABBox(float3(-1, -1, 19), float3(1, 1, 21))));
+	EXPECT_FALSE(culler.IsOccluded(AABBox(float3(-30, -1, 50), float3(30, 1, 52))));
+	EXPECT_FALSE(culler.IsOccluded(AABBox(float3(20, -1, 50), float3(22, 1, 52))));
+
+	wall->Visible(false);
+	culler.Render(ViewProj(), 0);
+	EXPECT_FALSE(culler.IsOccluded(AABBox(float3(-1, -1, 30), float3(1, 1, 32))));
+}
+
+TEST(OcclusionCullerTest, NearClippedOccluder)
+{
+	SoftwareOcclusionCuller culler;
+	auto floor = WallNode(culler, 50, -10, 30);
+	culler.Render(ViewProj(), 0);
+
+	// The occluder is split into triangles that share edges. There should be no crack between them.
+	for (float y = -5; y <= 5; y += 0.5f)
+	{
+		EXPECT_TRUE(culler.IsOccluded(AABBox(float3(-0.1f, y - 0.1f, 60), float3(0.1f, y + 0.1f, 60.2f))));
+	}
+}
+
+TEST(OcclusionCullerTest, ExpiredOccluder)
+{
+	SoftwareOcclusionCuller culler;
+	WallNode(culler, 10, 20, 20);
+	EXPECT_EQ(culler.NumOccluders(), 1U);
+
+	culler.Render(ViewProj(), 0);
+	EXPECT_EQ(culler.NumOccluders(), 0U);
+	EXPECT_FALSE(culler.IsOccluded(AABBox(float3(-1, -1, 30), float3(1, 1, 32))));
+}
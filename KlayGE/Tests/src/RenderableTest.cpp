@@ -0,0 +1,36 @@
+#include <KlayGE/KlayGE.hpp>
+#include <KlayGE/Renderable.hpp>
+#include <KlayGE/SceneNode.hpp>
+
+#include "KlayGETests.hpp"
+
+using namespace std;
+using namespace KlayGE;
+
+TEST(RenderableTest, AutoInstancingCameras)
+{
+	// Instance 0 is only visible in camera 0, instance 1 only in camera 1. Nothing is visible in camera 2.
+	auto const node0 = MakeSharedPtr<SceneNode>(SceneNode::SOA_Cullable);
+	node0->VisibleMark(0, BoundOverlap::Yes);
+	auto const node1 = MakeSharedPtr<SceneNode>(SceneNode::SOA_Cullable);
+	node1->VisibleMark(1, BoundOverlap::Partial);
+
+	auto const renderable = MakeSharedPtr<Renderable>(L"RenderableTest");
+	renderable->AddInstance(node0.get());
+	renderable->AddInstance(node1.get());
+
+	// One draw per node, each one only goes to the cameras of its node
+	renderable->BindSceneNode(node0.get());
+	EXPECT_TRUE(renderable->VisibleInCamera(0));
+	EXPECT_FALSE(renderable->VisibleInCamera(1));
+	renderable->BindSceneNode(node1.get());
+	EXPECT_FALSE(renderable->VisibleInCamera(0));
+	EXPECT_TRUE(renderable->VisibleInCamera(1));
+
+	// One draw for both, bound to the first instance. It has to go to the cameras of both.
+	renderable->AutoInstancing(true);
+	renderable->BindSceneNode(node0.get());
+	EXPECT_TRUE(renderable->VisibleInCamera(0));
+	EXPECT_TRUE(renderable->VisibleInCamera(1));
+	EXPECT_FALSE(renderable->VisibleInCamera(2));
+}
@@ -1,8 +1,18 @@
 #include <KlayGE/KlayGE.hpp>
+#include <KFL/Hash.hpp>
 #include <KlayGE/ResLoader.hpp>
+#include <KFL/CXX17/filesystem.hpp>
 
 #include "KlayGETests.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <future>
+#include <mutex>
+#include <string>
+#include <vector>
+
 using namespace KlayGE;
 
 std::string const sanity_string = "This is a test for ResLoader.";
@@ -17,6 +27,109 @@ std::string ReadWholeFile(ResIdentifierPtr const & res)
 	return str;
 }
 
+// Each log gets its own run number, so the resources loaded by an earlier run (e.g. under --gtest_repeat) are never matched
+struct ResLoaderTestLog
+{
+	uint32_t const run = next_run++;
+
+	std::mutex mutex;
+	std::vector<std::string> order;
+
+	std::shared_future<void> gate;
+	std::atomic<bool> gate_entered{false};
+
+	static std::atomic<uint32_t> next_run;
+};
+
+std::atomic<uint32_t> ResLoaderTestLog::next_run{0};
+
+// Records the order of the sub thread stages. The one named "Gate" blocks the loading thread until the gate opens.
+class ResLoaderTestDesc : public ResLoadingDesc
+{
+public:
+	ResLoaderTestDesc(std::string_view name, ResLoaderTestLog& log)
+		: name_(name), run_(log.run), log_(log)
+	{
+	}
+
+	uint64_t Type() const override
+	{
+		return CT_HASH("ResLoaderTestDesc");
+	}
+
+	bool StateLess() const override
+	{
+		return true;
+	}
+
+	std::shared_ptr<void> CreateResource() override
+	{
+		res_ = MakeSharedPtr<std::string>(name_);
+		return res_;
+	}
+
+	void SubThreadStage() override
+	{
+		if (name_ == "Gate")
+		{
+			log_.gate_entered = true;
+			log_.gate.wait();
+		}
+
+		std::lock_guard<std::mutex> lock(log_.mutex);
+		log_.order.push_back(name_);
+	}
+
+	void MainThreadStage() override
+	{
+	}
+
+	bool HasSubThreadStage() const override
+	{
+		return true;
+	}
+
+	size_t Hash() const override
+	{
+		size_t seed = HashRange(name_.begin(), name_.end());
+		HashCombine(seed, run_);
+		HashCombine(seed, this->Type());
+		return seed;
+	}
+
+	bool Match(ResLoadingDesc const & rhs) const override
+	{
+		if (this->Type() != rhs.Type())
+		{
+			return false;
+		}
+
+		auto const & test_rhs = static_cast<ResLoaderTestDesc const &>(rhs);
+		return (name_ == test_rhs.name_) && (run_ == test_rhs.run_);
+	}
+
+	void CopyDataFrom(ResLoadingDesc const & rhs) override
+	{
+		res_ = static_cast<ResLoaderTestDesc const &>(rhs).res_;
+	}
+
+	std::shared_ptr<void> CloneResourceFrom(std::shared_ptr<void> const & resource) override
+	{
+		return resource;
+	}
+
+	std::shared_ptr<void> Resource() const override
+	{
+		return res_;
+	}
+
+private:
+	std::string name_;
+	uint32_t run_;
+	ResLoaderTestLog& log_;
+	std::shared_ptr<std::string> res_;
+};
+
 TEST(ResLoaderTest, AddDelPath)
 {
 	EXPECT_TRUE(ResLoader::Instance().Locate("Test.txt").empty());
@@ -95,3 +208,197 @@ TEST(ResLoaderTest, MountUnmountInsideEncrypt7zPath)
 	ResLoader::Instance().Unmount("ResLoaderTestData", "../../Tests/media/ResLoader/TestPassword.7z|1234/ResLoader");
 	EXPECT_TRUE(ResLoader::Instance().Locate("ResLoaderTestData/Test.txt").empty());
 }
+
+TEST(ResLoaderTest, IndexedLocate)
+{
+	auto const folder = std::filesystem::temp_directory_path() / "KlayGETestsResLoader";
+	std::error_code ec;
+	std::filesystem::create_directories(folder, ec);
+	auto const file_path = folder / "NewFile.txt";
+	std::filesystem::remove(file_path, ec);
+
+	ResLoader::Instance().AddPath(folder.string());
+
+	// Lists the folder
+	EXPECT_TRUE(ResLoader::Instance().Locate("NewFile.txt").empty());
+
+	// Created after the listing without being reported
+	{
+		std::ofstream ofs(file_path.string().c_str(), std::ios_base::binary);
+		ofs << sanity_string;
+	}
+	EXPECT_FALSE(ResLoader::Instance().Locate("NewFile.txt").empty());
+
+	// Created after the listing and reported
+	auto const reported_path = folder / "ReportedFile.txt";
+	std::filesystem::remove(reported_path, ec);
+	EXPECT_TRUE(ResLoader::Instance().Locate("ReportedFile.txt").empty());
+	{
+		std::ofstream ofs(reported_path.string().c_str(), std::ios_base::binary);
+		ofs << sanity_string;
+	}
+	ResLoader::Instance().NotifyFileWritten(reported_path.string());
+	EXPECT_FALSE(ResLoader::Instance().Locate("ReportedFile.txt").empty());
+	std::filesystem::remove(reported_path, ec);
+
+	EXPECT_NE(ResLoader::Instance().Timestamp("NewFile.txt"), 0U);
+	auto res = ResLoader::Instance().Open("NewFile.txt");
+	EXPECT_TRUE(res);
+	auto const data = res->Data();
+	EXPECT_EQ(std::string(reinterpret_cast<char const *>(data.data()), data.size()), sanity_string);
+	EXPECT_EQ(ReadWholeFile(res), sanity_string);
+	res.reset();
+
+	// Removed after the listing, gone from there once the index is invalidated
+	std::filesystem::remove(file_path, ec);
+	EXPECT_EQ(ResLoader::Instance().Timestamp("NewFile.txt"), 0U);
+	EXPECT_FALSE(ResLoader::Instance().Open("NewFile.txt"));
+	ResLoader::Instance().InvalidateIndex();
+	EXPECT_TRUE(ResLoader::Instance().Locate("NewFile.txt").empty());
+
+	ResLoader::Instance().DelPath(folder.string());
+	std::filesystem::remove_all(folder, ec);
+}
+
+TEST(ResLoaderTest, InMemoryResIdentifier)
+{
+	auto const content = MakeSharedPtr<std::string>(sanity_string);
+	auto const res = MakeSharedPtr<ResIdentifier>("InMemory", 0,
+		MakeSpan(reinterpret_cast<uint8_t const *>(content->data()), reinterpret_cast<uint8_t const *>(content->data() + content->size())),
+		content);
+	EXPECT_EQ(res->Data().size(), sanity_string.size());
+	EXPECT_EQ(ReadWholeFile(res), sanity_string);
+
+	char c;
+	res->seekg(-4, std::ios_base::end);
+	res->read(&c, 1);
+	EXPECT_EQ(c, 'd');
+	res->seekg(-2, std::ios_base::cur);
+	res->read(&c, 1);
+	EXPECT_EQ(c, 'a');
+
+	// Reading over the end stops at the end
+	std::string str(8, '\0');
+	res->read(&str[0], str.size());
+	EXPECT_EQ(res->gcount(), 4);
+	EXPECT_EQ(str.substr(0, 4), "der.");
+}
+
+TEST(ResLoaderTest, ASyncQueryPriority)
+{
+	auto& rl = ResLoader::Instance();
+	uint32_t const num_loading_threads = rl.NumLoadingThreads();
+	rl.NumLoadingThreads(1);
+
+	ResLoaderTestLog log;
+	std::promise<void> gate;
+	log.gate = gate.get_future().share();
+
+	auto const gate_res = rl.ASyncQuery(MakeSharedPtr<ResLoaderTestDesc>("Gate", log), ResLoadingPriority::VisibleNow);
+	while (!log.gate_entered)
+	{
+		Sleep(1);
+	}
+
+	auto const background = rl.ASyncQueryT<std::string>(MakeSharedPtr<ResLoaderTestDesc>("Background", log),
+		ResLoadingPriority::Background);
+	auto const prefetch = rl.ASyncQuery(MakeSharedPtr<ResLoaderTestDesc>("Prefetch", log), ResLoadingPriority::Prefetch);
+	auto const prefetch_again = rl.ASyncQuery(MakeSharedPtr<ResLoaderTestDesc>("Prefetch", log), ResLoadingPriority::Background);
+	auto cancelled = rl.ASyncQuery(MakeSharedPtr<ResLoaderTestDesc>("Cancelled", log), ResLoadingPriority::VisibleNow);
+	EXPECT_EQ(*background, "Background");
+	EXPECT_EQ(prefetch.get(), prefetch_again.get());
+
+	cancelled.reset();
+	rl.Reprioritize(background, ResLoadingPriority::VisibleNow);
+
+	gate.set_value();
+	while (rl.NumLoadingResources() > 0)
+	{
+		rl.Update();
+		Sleep(1);
+	}
+
+	EXPECT_EQ(log.order, (std::vector<std::string>{ "Gate", "Background", "Prefetch" }));
+
+	rl.NumLoadingThreads(num_loading_threads);
+}
+
+TEST(ResLoaderTest, LoadingThreadPool)
+{
+	auto& rl = ResLoader::Instance();
+	uint32_t const num_loading_threads = rl.NumLoadingThreads();
+	rl.NumLoadingThreads(4);
+	EXPECT_EQ(rl.NumLoadingThreads(), 4U);
+
+	ResLoaderTestLog log;
+	std::vector<std::string> names;
+	std::vector<std::shared_ptr<std::string>> res;
+	for (uint32_t i = 0; i < 32; ++ i)
+	{
+		names.push_back("Pool" + std::to_string(i));
+		res.push_back(rl.ASyncQueryT<std::string>(MakeSharedPtr<ResLoaderTestDesc>(names.back(), log)));
+	}
+
+	// Races with the loading threads for the same job
+	auto const sync_res = rl.SyncQueryT<std::string>(MakeSharedPtr<ResLoaderTestDesc>("Pool7", log));
+	EXPECT_EQ(*sync_res, "Pool7");
+
+	while (rl.NumLoadingResources() > 0)
+	{
+		rl.Update();
+		Sleep(1);
+	}
+
+	// Every sub thread stage ran. Only the synchronously queried one could run again after its loading thread was done.
+	for (uint32_t i = 0; i < names.size(); ++ i)
+	{
+		EXPECT_EQ(*res[i], names[i]);
+
+		auto const count = std::count(log.order.begin(), log.order.end(), names[i]);
+		if (names[i] == "Pool7")
+		{
+			EXPECT_TRUE((count == 1) || (count == 2));
+		}
+		else
+		{
+			EXPECT_EQ(count, 1);
+		}
+	}
+
+	rl.NumLoadingThreads(num_loading_threads);
+}
+
+TEST(ResLoaderTest, MainThreadStageBudget)
+{
+	auto& rl = ResLoader::Instance();
+	double const budget = rl.MainThreadStageBudget();
+	rl.MainThreadStageBudget(1e-9);
+
+	ResLoaderTestLog log;
+	std::vector<std::shared_ptr<void>> res;
+	for (auto const & name : { "Budget0", "Budget1", "Budget2" })
+	{
+		res.push_back(rl.ASyncQuery(MakeSharedPtr<ResLoaderTestDesc>(name, log)));
+	}
+	for (;;)
+	{
+		{
+			std::lock_guard<std::mutex> lock(log.mutex);
+			if (log.order.size() == res.size())
+			{
+				break;
+			}
+		}
+		Sleep(1);
+	}
+
+	// One main thread stage a frame, since each one is over the budget
+	for (uint32_t i = 0; i < res.size(); ++ i)
+	{
+		EXPECT_EQ(rl.NumLoadingResources(), res.size() - i);
+		rl.Update();
+	}
+	EXPECT_EQ(rl.NumLoadingResources(), 0U);
+
+	rl.MainThreadStageBudget(budget);
+}
@@ -1,9 +1,11 @@
 #include <KlayGE/KlayGE.hpp>
 #include <KFL/Math.hpp>
 #include <KFL/SIMDMath.hpp>
+#include <KFL/Timer.hpp>
 
 #include "KlayGETests.hpp"
 
+#include <cmath>
 #include <vector>
 #include <string>
 #include <iostream>
@@ -31,3 +33,196 @@ TEST(SIMDMathTest, NormalizeVector4)
 	v = SIMDMathLib::NormalizeVector4(v);
 	EXPECT_LT(MathLib::abs(SIMDMathLib::GetX(SIMDMathLib::LengthVector4(v)) - 1.0f), 1e-3f);
 }
+
+namespace
+{
+	float4x4 TestMatrix()
+	{
+		return MathLib::scaling(1.5f, 0.5f, 2.0f) * MathLib::to_matrix(MathLib::rotation_axis(float3(1, 2, 3), 0.7f))
+			* MathLib::translation(3.0f, -4.0f, 5.0f);
+	}
+
+	void ExpectNear(float4x4 const & lhs, float4x4 const & rhs)
+	{
+		for (size_t i = 0; i < 16; ++ i)
+		{
+			EXPECT_NEAR(lhs[i], rhs[i], 1e-4f);
+		}
+	}
+}
+
+TEST(SIMDMathTest, LoadStoreMatrix)
+{
+	float4x4 const mat = TestMatrix();
+	float4x4 ret;
+	SIMDMathLib::StoreMatrix(ret, SIMDMathLib::LoadMatrix(mat));
+	EXPECT_EQ(ret, mat);
+
+	// Loads and stores don't need 16-byte alignment
+	float buffer[5] = { 0, 1, 2, 3, 4 };
+	float4 v;
+	SIMDMathLib::StoreVector4(v, SIMDMathLib::LoadVector4(&buffer[1]));
+	EXPECT_EQ(v, float4(1, 2, 3, 4));
+}
+
+TEST(SIMDMathTest, SelectGreaterEqual)
+{
+	SIMDVectorF4 const lhs = SIMDMathLib::SetVector(-1, 0, 1, -0.0f);
+	SIMDVectorF4 const zero = SIMDMathLib::SetVector(0.0f);
+	float buffer[5] = { 0, 0, 0, 0, 0 };
+	SIMDMathLib::StoreVector4(&buffer[1],
+		SIMDMathLib::SelectGreaterEqual(lhs, zero, SIMDMathLib::SetVector(1.0f), SIMDMathLib::SetVector(2.0f)));
+	EXPECT_EQ(buffer[0], 0);
+	EXPECT_EQ(buffer[1], 2);
+	EXPECT_EQ(buffer[2], 1);
+	EXPECT_EQ(buffer[3], 1);
+	EXPECT_EQ(buffer[4], 1);
+}
+
+TEST(SIMDMathTest, MultiplyMatrix)
+{
+	float4x4 const lhs = TestMatrix();
+	float4x4 const rhs = MathLib::look_at_lh(float3(1, 2, -3), float3(0, 0, 0)) * MathLib::perspective_fov_lh(1.0f, 1.5f, 0.1f, 100.0f);
+
+	float4x4 ret;
+	SIMDMathLib::StoreMatrix(ret, SIMDMathLib::Multiply(SIMDMathLib::LoadMatrix(lhs), SIMDMathLib::LoadMatrix(rhs)));
+	ExpectNear(ret, lhs * rhs);
+
+	SIMDMathLib::StoreMatrix(ret, SIMDMathLib::Transpose(SIMDMathLib::LoadMatrix(lhs)));
+	EXPECT_EQ(ret, MathLib::transpose(lhs));
+}
+
+TEST(SIMDMathTest, TransformVector)
+{
+	float4x4 const mat = TestMatrix() * MathLib::perspective_fov_lh(1.0f, 1.5f, 0.1f, 100.0f);
+	SIMDMatrixF4 const simd_mat = SIMDMathLib::LoadMatrix(mat);
+	float3 const v(0.3f, -2.0f, 7.0f);
+
+	float3 ret;
+	SIMDMathLib::StoreVector3(ret, SIMDMathLib::TransformCoordVector3(SIMDMathLib::LoadVector3(v), simd_mat));
+	float3 const expected = MathLib::transform_coord(v, mat);
+	for (size_t i = 0; i < 3; ++ i)
+	{
+		EXPECT_NEAR(ret[i], expected[i], 1e-5f);
+	}
+
+	float4 ret4;
+	SIMDMathLib::StoreVector4(ret4, SIMDMathLib::TransformVector4(SIMDMathLib::SetVector(v.x(), v.y(), v.z(), 1), simd_mat));
+	float4 const expected4 = MathLib::transform(float4(v.x(), v.y(), v.z(), 1), mat);
+	for (size_t i = 0; i < 4; ++ i)
+	{
+		EXPECT_NEAR(ret4[i], expected4[i], 1e-4f);
+	}
+}
+
+TEST(SIMDMathTest, MultiplyQuat)
+{
+	Quaternion const lhs = MathLib::rotation_axis(float3(1, 2, 3), 0.7f);
+	Quaternion const rhs = MathLib::rotation_axis(float3(-2, 1, 0.5f), 2.1f);
+
+	Quaternion ret;
+	SIMDMathLib::StoreQuaternion(ret, SIMDMathLib::MultiplyQuat(SIMDMathLib::LoadQuaternion(lhs), SIMDMathLib::LoadQuaternion(rhs)));
+	Quaternion const expected = MathLib::mul(lhs, rhs);
+	for (size_t i = 0; i < 4; ++ i)
+	{
+		EXPECT_NEAR(ret[i], expected[i], 1e-6f);
+	}
+}
+
+TEST(SIMDMathTest, TransformAABB)
+{
+	AABBox const aabb(float3(-1, -2, -3), float3(4, 5, 6));
+	float4x4 const mat = TestMatrix();
+
+	float3 min = MathLib::transform_coord(aabb.Corner(0), mat);
+	float3 max = min;
+	for (size_t i = 1; i < 8; ++ i)
+	{
+		float3 const corner = MathLib::transform_coord(aabb.Corner(i), mat);
+		min = MathLib::minimize(min, corner);
+		max = MathLib::maximize(max, corner);
+	}
+
+	AABBox const ret = MathLib::transform_aabb(aabb, mat);
+	for (size_t i = 0; i < 3; ++ i)
+	{
+		EXPECT_NEAR(ret.Min()[i], min[i], 1e-4f);
+		EXPECT_NEAR(ret.Max()[i], max[i], 1e-4f);
+	}
+}
+
+namespace
+{
+	// Seconds per call. The inputs cycle through a small table, and every result goes into the sink.
+	template <typename Func>
+	double TimePerCall(uint32_t num_calls, Func const & func)
+	{
+		Timer timer;
+		for (uint32_t i = 0; i < num_calls; ++ i)
+		{
+			func(i & 1023);
+		}
+		return timer.elapsed() / num_calls;
+	}
+
+	void ReportSpeedup(char const * name, double scalar_time, double simd_time)
+	{
+		cout << name << ": MathLib " << scalar_time * 1e9 << " ns, SIMDMathLib " << simd_time * 1e9 << " ns, "
+			 << scalar_time / simd_time << "x" << endl;
+	}
+}
+
+// Disabled by default. Run it with --gtest_also_run_disabled_tests.
+TEST(SIMDMathTest, DISABLED_Benchmark)
+{
+	uint32_t constexpr NUM_CALLS = 10000000;
+
+	vector<float4x4> mats(1024);
+	vector<float4> vecs(1024);
+	vector<AABBox> aabbs(1024);
+	for (uint32_t i = 0; i < 1024; ++ i)
+	{
+		float const f = static_cast<float>(i);
+		mats[i] = MathLib::to_matrix(MathLib::rotation_axis(float3(1, f, 3), f * 0.01f)) * MathLib::translation(f, -f, 1.0f);
+		vecs[i] = float4(f, 1, -f, 1);
+		aabbs[i] = AABBox(float3(-f, -1, -2), float3(f + 1, 2, 3));
+	}
+
+	float sink = 0;
+
+	double const scalar_mul = TimePerCall(NUM_CALLS, [&](uint32_t i) { sink += MathLib::mul(mats[i], mats[1023 - i])(3, 0); });
+	double const simd_mul = TimePerCall(NUM_CALLS, [&](uint32_t i) {
+		float4x4 ret;
+		SIMDMathLib::StoreMatrix(ret, SIMDMathLib::Multiply(SIMDMathLib::LoadMatrix(mats[i]), SIMDMathLib::LoadMatrix(mats[1023 - i])));
+		sink += ret(3, 0);
+	});
+	ReportSpeedup("Matrix multiply", scalar_mul, simd_mul);
+
+	double const scalar_xform = TimePerCall(NUM_CALLS, [&](uint32_t i) { sink += MathLib::transform(vecs[i], mats[i]).x(); });
+	double const simd_xform = TimePerCall(NUM_CALLS, [&](uint32_t i) {
+		float4 ret;
+		SIMDMathLib::StoreVector4(ret, SIMDMathLib::TransformVector4(SIMDMathLib::LoadVector4(vecs[i]), SIMDMathLib::LoadMatrix(mats[i])));
+		sink += ret.x();
+	});
+	ReportSpeedup("Vector transform", scalar_xform, simd_xform);
+
+	// transform_aabb is built on SIMDMathLib now. The scalar side is its old per-corner code.
+	double const scalar_aabb = TimePerCall(NUM_CALLS, [&](uint32_t i) {
+		float3 min = MathLib::transform_coord(aabbs[i].Corner(0), mats[i]);
+		float3 max = min;
+		for (size_t j = 1; j < 8; ++ j)
+		{
+			float3 const corner = MathLib::transform_coord(aabbs[i].Corner(j), mats[i]);
+			min = MathLib::minimize(min, corner);
+			max = MathLib::maximize(max, corner);
+		}
+		sink += min.x() + max.x();
+	});
+	double const simd_aabb = TimePerCall(NUM_CALLS, [&](uint32_t i) {
+		AABBox const ret = MathLib::transform_aabb(aabbs[i], mats[i]);
+		sink += ret.Min().x() + ret.Max().x();
+	});
+	ReportSpeedup("AABB transform", scalar_aabb, simd_aabb);
+
+	EXPECT_FALSE(std::isnan(sink));
+}
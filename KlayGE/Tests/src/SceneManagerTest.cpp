@@ -0,0 +1,163 @@
+#include <KlayGE/KlayGE.hpp>
+#include <KFL/Math.hpp>
+#include <KFL/Timer.hpp>
+#include <KlayGE/App3D.hpp>
+#include <KlayGE/Camera.hpp>
+#include <KlayGE/Context.hpp>
+#include <KlayGE/Renderable.hpp>
+#include <KlayGE/RenderableHelper.hpp>
+#include <KlayGE/SceneManager.hpp>
+#include <KlayGE/SceneNode.hpp>
+
+#include "KlayGETests.hpp"
+
+#include <cmath>
+#include <iostream>
+#include <mutex>
+#include <vector>
+
+using namespace std;
+using namespace KlayGE;
+
+// The benchmarks are disabled by default. Run them with --gtest_also_run_disabled_tests.
+
+namespace
+{
+	void LookAt(float3 const & eye, float3 const & at)
+	{
+		auto& camera = Context::Instance().AppInstance().ActiveCamera();
+		camera.BoundSceneNode()->TransformToWorld(MathLib::inverse(MathLib::look_at_lh(eye, at)));
+	}
+
+	// Boxes on a grid in the xz plane under one group node, all sharing a renderable. Every tenth box moves.
+	class BoxGrid
+	{
+	public:
+		BoxGrid(SceneManager& sm, uint32_t num_boxes)
+			: sm_(sm), group_(MakeSharedPtr<SceneNode>(L"BoxGrid", SceneNode::SOA_Cullable))
+		{
+			auto const box = MakeSharedPtr<RenderableTriBox>(
+				MathLib::convert_to_obbox(AABBox(float3(-0.4f, -0.4f, -0.4f), float3(0.4f, 0.4f, 0.4f))), Color(1, 1, 1, 1));
+			auto const box_comp = MakeSharedPtr<RenderableComponent>(box);
+
+			uint32_t const side = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<float>(num_boxes))));
+			for (uint32_t i = 0; i < num_boxes; ++ i)
+			{
+				bool const moving = (i % 10 == 0);
+				auto node = MakeSharedPtr<SceneNode>(box_comp->Clone(), SceneNode::SOA_Cullable | (moving ? SceneNode::SOA_Moveable : 0));
+				node->TransformToParent(MathLib::translation(static_cast<float>(i % side), 0.0f, static_cast<float>(i / side)));
+				group_->AddChild(node);
+				if (moving)
+				{
+					moving_.push_back(node);
+				}
+			}
+
+			std::lock_guard<std::mutex> lock(sm_.MutexForUpdate());
+			sm_.SceneRootNode().AddChild(group_);
+		}
+
+		~BoxGrid()
+		{
+			std::lock_guard<std::mutex> lock(sm_.MutexForUpdate());
+			sm_.SceneRootNode().RemoveChild(group_);
+		}
+
+		SceneNode& Group()
+		{
+			return *group_;
+		}
+
+		void Move(uint32_t frame)
+		{
+			float const dy = (frame & 1) ? -0.5f : 0.5f;
+			for (auto const& node : moving_)
+			{
+				node->TransformToParent(node->TransformToParent() * MathLib::translation(0.0f, dy, 0.0f));
+			}
+		}
+
+	private:
+		SceneManager& sm_;
+		SceneNodePtr group_;
+		std::vector<SceneNodePtr> moving_;
+	};
+}
+
+TEST(SceneManagerTest, DISABLED_UpdateBenchmark)
+{
+	uint32_t constexpr NUM_BOXES = 100000;
+	uint32_t constexpr NUM_FRAMES = 100;
+
+	auto& sm = Context::Instance().SceneManagerInstance();
+	LookAt(float3(-10, 20, -10), float3(0, 0, 0));
+
+	BoxGrid grid(sm, NUM_BOXES);
+	sm.Update();
+
+	Timer timer;
+	for (uint32_t i = 0; i < NUM_FRAMES; ++ i)
+	{
+		grid.Move(i);
+		sm.Update();
+	}
+	double const frame_time = timer.elapsed() / NUM_FRAMES;
+	uint32_t const num_xforms_updated = sm.NumTransformsUpdated();
+	uint32_t const num_bounds_updated = sm.NumBoundsUpdated();
+
+	// Updating every node in place by walking the tree, as the scene manager did before the node arrays
+	timer.restart();
+	for (uint32_t i = 0; i < NUM_FRAMES; ++ i)
+	{
+		grid.Move(i);
+		grid.Group().Traverse([](SceneNode& node) {
+			node.UpdateTransforms();
+			return true;
+		});
+		grid.Group().UpdatePosBoundSubtree();
+	}
+	double const tree_walk_time = timer.elapsed() / NUM_FRAMES;
+
+	cout << NUM_BOXES << " boxes, " << num_xforms_updated << " transforms and " << num_bounds_updated
+		 << " bounds updated per frame" << endl;
+	cout << "SceneManager::Update: " << frame_time * 1000 << " ms per frame" << endl;
+	cout << "Tree walk transform and bound update: " << tree_walk_time * 1000 << " ms per frame" << endl;
+
+	EXPECT_GT(num_xforms_updated, 0U);
+}
+
+TEST(SceneManagerTest, DISABLED_CullingBenchmark)
+{
+	uint32_t constexpr NUM_BOXES = 100000;
+	uint32_t constexpr NUM_FRAMES = 100;
+
+	auto& context = Context::Instance();
+	for (char const * sm_name : { "OCTree", "BVH" })
+	{
+		context.LoadSceneManager(sm_name);
+		auto& sm = context.SceneManagerInstance();
+
+		BoxGrid grid(sm, NUM_BOXES);
+		LookAt(float3(-10, 20, -10), float3(0, 0, 0));
+		sm.Update();
+
+		// The camera orbits, so the cached culling results can't be reused
+		uint32_t num_objects_rendered = 0;
+		Timer timer;
+		for (uint32_t i = 0; i < NUM_FRAMES; ++ i)
+		{
+			float const angle = i * 2 * PI / NUM_FRAMES;
+			LookAt(float3(150 + 200 * std::cos(angle), 50, 150 + 200 * std::sin(angle)), float3(150, 0, 150));
+			grid.Move(i);
+			sm.Update();
+			num_objects_rendered += sm.NumObjectsRendered();
+		}
+		double const frame_time = timer.elapsed() / NUM_FRAMES;
+
+		cout << sm_name << ": " << frame_time * 1000 << " ms per frame, " << num_objects_rendered / NUM_FRAMES
+			 << " objects rendered per frame" << endl;
+		EXPECT_GT(num_objects_rendered, 0U);
+	}
+
+	context.LoadSceneManager(context.Config().scene_manager_name);
+}
@@ -0,0 +1,209 @@
+/**
+ * @file TaskSchedulerTest.cpp
+ * @author Minmin Gong
+ *
+ * @section DESCRIPTION
+ *
+ * This source file is part of KlayGE
+ * For the latest info, see http://www.klayge.org
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ * You may alternatively use this source under the terms of
+ * the KlayGE Proprietary License (KPL). You can obtained such a license
+ * from http://www.klayge.org/licensing/.
+ */
+
+#include <KlayGE/KlayGE.hpp>
+
+#include <KFL/TaskScheduler.hpp>
+
+#include <atomic>
+#include <future>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "KlayGETests.hpp"
+
+using namespace std;
+using namespace KlayGE;
+
+TEST(TaskSchedulerTest, ParallelForCoversRange)
+{
+	task_scheduler scheduler(3);
+
+	std::vector<std::atomic<uint32_t>> hits(10007);
+	for (auto& hit : hits)
+	{
+		hit = 0;
+	}
+
+	scheduler.parallel_for(0, static_cast<uint32_t>(hits.size()), 16, [&hits](uint32_t begin, uint32_t end) {
+		EXPECT_LT(begin, end);
+		EXPECT_LE(end - begin, 16U);
+		for (uint32_t i = begin; i < end; ++ i)
+		{
+			++ hits[i];
+		}
+	});
+
+	for (auto const & hit : hits)
+	{
+		EXPECT_EQ(hit, 1U);
+	}
+}
+
+TEST(TaskSchedulerTest, ParallelReduce)
+{
+	task_scheduler scheduler(3);
+
+	uint64_t const sum = scheduler.parallel_reduce(1, 100001, 64, uint64_t(0),
+		[](uint32_t begin, uint32_t end) {
+			uint64_t sub_sum = 0;
+			for (uint32_t i = begin; i < end; ++ i)
+			{
+				sub_sum += i;
+			}
+			return sub_sum;
+		},
+		[](uint64_t lhs, uint64_t rhs) { return lhs + rhs; });
+	EXPECT_EQ(sum, 100000ULL * 100001 / 2);
+
+	EXPECT_EQ(scheduler.parallel_reduce(5, 5, 1, 42, [](uint32_t, uint32_t) { return 0; }, [](int lhs, int rhs) { return lhs + rhs; }),
+		42);
+}
+
+TEST(TaskSchedulerTest, NestedWait)
+{
+	task_scheduler scheduler(2);
+
+	// Each outer task waits for inner tasks, so the waits have to run them instead of blocking the workers
+	std::atomic<uint32_t> num_inner(0);
+	auto inner = [&num_inner] { ++ num_inner; };
+	auto outer = [&scheduler, &inner] {
+		task_counter counter;
+		for (uint32_t i = 0; i < 8; ++ i)
+		{
+			scheduler.run(counter, inner);
+		}
+		scheduler.wait(counter);
+	};
+
+	task_counter counter;
+	for (uint32_t i = 0; i < 16; ++ i)
+	{
+		scheduler.run(counter, outer);
+	}
+	scheduler.wait(counter);
+
+	EXPECT_TRUE(counter.done());
+	EXPECT_EQ(num_inner, 16U * 8);
+}
+
+TEST(TaskSchedulerTest, WaitOnlyRunsItsOwnTasks)
+{
+	task_scheduler scheduler(1);
+
+	// Keeps the only worker busy, so nothing else runs the queued tasks
+	std::promise<void> release;
+	std::shared_future<void> const released = release.get_future().share();
+	std::atomic<bool> blocked(false);
+	auto blocker = [&released, &blocked] {
+		blocked = true;
+		released.wait();
+	};
+	task_counter blocker_counter;
+	scheduler.run(blocker_counter, blocker);
+	while (!blocked)
+	{
+		std::this_thread::yield();
+	}
+
+	// The other task is the newest one in this thread's queue
+	std::atomic<bool> mine_ran(false);
+	auto mine = [&mine_ran] { mine_ran = true; };
+	task_counter mine_counter;
+	scheduler.run(mine_counter, mine);
+
+	std::atomic<bool> other_ran(false);
+	auto other = [&other_ran] { other_ran = true; };
+	task_counter other_counter;
+	scheduler.run(other_counter, other);
+
+	scheduler.wait(mine_counter);
+
+	EXPECT_TRUE(mine_ran);
+	EXPECT_FALSE(other_ran);
+
+	release.set_value();
+	scheduler.wait(blocker_counter);
+	scheduler.wait(other_counter);
+	EXPECT_TRUE(other_ran);
+}
+
+TEST(TaskSchedulerTest, ExceptionsAreRethrownByWait)
+{
+	task_scheduler scheduler(3);
+
+	// The first piece runs on this thread, the last one most likely on a worker. All the others still run.
+	std::atomic<uint32_t> num_done(0);
+	auto const throwing_piece = [&num_done](uint32_t begin, uint32_t end) {
+		num_done += end - begin;
+		if ((begin == 0) || (end == 1024))
+		{
+			throw runtime_error("piece");
+		}
+	};
+	EXPECT_THROW(scheduler.parallel_for(0, 1024, 1, throwing_piece), runtime_error);
+	EXPECT_EQ(num_done, 1024U);
+
+	task_counter counter;
+	auto thrower = [] { throw runtime_error("task"); };
+	scheduler.run(counter, thrower);
+	EXPECT_THROW(scheduler.wait(counter), runtime_error);
+	EXPECT_TRUE(counter.done());
+
+	// The exception is only rethrown once, and the scheduler keeps working
+	EXPECT_NO_THROW(scheduler.wait(counter));
+	uint32_t const sum = scheduler.parallel_reduce(0, 1000, 10, 0U,
+		[](uint32_t begin, uint32_t end) {
+			uint32_t sub_sum = 0;
+			for (uint32_t i = begin; i < end; ++ i)
+			{
+				sub_sum += i;
+			}
+			return sub_sum;
+		},
+		[](uint32_t lhs, uint32_t rhs) { return lhs + rhs; });
+	EXPECT_EQ(sum, 499500U);
+}
+
+TEST(TaskSchedulerTest, SmallRangeRunsInline)
+{
+	task_scheduler scheduler(1);
+	EXPECT_EQ(scheduler.num_workers(), 1U);
+
+	uint32_t sum = 0;
+	scheduler.parallel_for(0, 100, 1000, [&sum](uint32_t begin, uint32_t end) {
+		for (uint32_t i = begin; i < end; ++ i)
+		{
+			sum += i;
+		}
+	});
+	EXPECT_EQ(sum, 4950U);
+}
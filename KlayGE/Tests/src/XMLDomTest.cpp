@@ -0,0 +1,240 @@
+#include <KlayGE/KlayGE.hpp>
+#include <KFL/ResIdentifier.hpp>
+#include <KFL/XMLDom.hpp>
+#include <KFL/CXX17/filesystem.hpp>
+#include <KFL/Timer.hpp>
+#include <KlayGE/ResLoader.hpp>
+
+#include "KlayGETests.hpp"
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace KlayGE;
+
+namespace
+{
+	char const test_xml[] =
+		"<?xml version='1.0'?>"
+		"<effect version='2'>"
+		"<parameter type='float' name='a' value='1.5'/>"
+		"<cbuffer name='cb'>"
+		"<parameter type='int' name='b' value='-3'/>"
+		"<parameter type='uint' name='c' value='7'/>"
+		"</cbuffer>"
+		"<parameter type='float4' name='d'/>"
+		"<shader>text</shader>"
+		"</effect>";
+
+	XMLNodePtr ParseTestXML(XMLDocument& doc, char const * xml = test_xml, uint64_t timestamp = 0)
+	{
+		ResIdentifier res("test.xml", timestamp, MakeSharedPtr<stringstream>(xml));
+		return doc.Parse(res);
+	}
+
+	void ExpectSameTree(XMLNodeHandle lhs, XMLNodeHandle rhs)
+	{
+		EXPECT_EQ(lhs.Type(), rhs.Type());
+		EXPECT_EQ(lhs.Name(), rhs.Name());
+		EXPECT_EQ(lhs.ValueString(), rhs.ValueString());
+
+		vector<pair<string_view, string_view>> lhs_attrs;
+		for (auto const & attr : lhs.Attribs())
+		{
+			lhs_attrs.emplace_back(attr.Name(), attr.ValueString());
+		}
+		vector<pair<string_view, string_view>> rhs_attrs;
+		for (auto const & attr : rhs.Attribs())
+		{
+			rhs_attrs.emplace_back(attr.Name(), attr.ValueString());
+		}
+		EXPECT_EQ(lhs_attrs, rhs_attrs);
+
+		XMLNodeHandle lhs_child = lhs.FirstNode();
+		XMLNodeHandle rhs_child = rhs.FirstNode();
+		for (; lhs_child && rhs_child; lhs_child = lhs_child.NextSibling(), rhs_child = rhs_child.NextSibling())
+		{
+			ExpectSameTree(lhs_child, rhs_child);
+		}
+		EXPECT_FALSE(lhs_child);
+		EXPECT_FALSE(rhs_child);
+	}
+
+	// Each walk visits every element and attribute, and adds up the lengths of their names
+	size_t WalkShared(XMLNodePtr const & node)
+	{
+		size_t ret = node->Name().size();
+		for (XMLAttributePtr attr = node->FirstAttrib(); attr; attr = attr->NextAttrib())
+		{
+			ret += attr->Name().size();
+		}
+		for (XMLNodePtr child = node->FirstNode(); child; child = child->NextSibling())
+		{
+			ret += WalkShared(child);
+		}
+		return ret;
+	}
+
+	size_t WalkHandle(XMLNodeHandle node)
+	{
+		size_t ret = node.Name().size();
+		for (auto const & attr : node.Attribs())
+		{
+			ret += attr.Name().size();
+		}
+		for (auto const & child : node.Children())
+		{
+			ret += WalkHandle(child);
+		}
+		return ret;
+	}
+}
+
+TEST(XMLDomTest, HandleNavigation)
+{
+	XMLDocument doc;
+	XMLNodePtr const root = ParseTestXML(doc);
+	XMLNodeHandle const root_handle = root->Handle();
+
+	EXPECT_TRUE(root_handle);
+	EXPECT_EQ(root_handle.Name(), "effect");
+	EXPECT_EQ(root_handle.Type(), XNT_Element);
+	EXPECT_EQ(root_handle.AttribInt("version", 0), 2);
+	EXPECT_EQ(root_handle.AttribInt("no_such_attrib", 5), 5);
+
+	XMLNodeHandle const param = root_handle.FirstNode("parameter");
+	EXPECT_EQ(param.AttribString("name", ""), "a");
+	EXPECT_EQ(param.AttribFloat("value", 0), 1.5f);
+	EXPECT_EQ(param.Parent(), root_handle);
+
+	XMLNodeHandle const cbuffer = param.NextSibling("cbuffer");
+	EXPECT_EQ(cbuffer.FirstNode().AttribInt("value", 0), -3);
+	EXPECT_EQ(cbuffer.LastNode().AttribUInt("value", 0), 7U);
+	EXPECT_EQ(cbuffer.FirstNode().NextSibling(), cbuffer.LastNode());
+	EXPECT_FALSE(cbuffer.LastNode().NextSibling());
+
+	EXPECT_EQ(root_handle.FirstNode("shader").ValueString(), "text");
+	EXPECT_FALSE(root_handle.FirstNode("technique"));
+
+	// Handles and the shared nodes see the same document
+	EXPECT_EQ(root->FirstNode("parameter")->Handle(), param);
+	EXPECT_EQ(root->LastNode("parameter")->AttribString("name", ""), root_handle.LastNode("parameter")->AttribString("name", ""));
+}
+
+TEST(XMLDomTest, HandleRanges)
+{
+	XMLDocument doc;
+	XMLNodeHandle const root = ParseTestXML(doc)->Handle();
+
+	vector<string_view> names;
+	for (auto const & node : root.Children())
+	{
+		names.push_back(node.Name());
+	}
+	EXPECT_EQ(names, (vector<string_view>{ "parameter", "cbuffer", "parameter", "shader" }));
+
+	names.clear();
+	for (auto const & node : root.Children("parameter"))
+	{
+		names.push_back(node.AttribString("name", ""));
+	}
+	EXPECT_EQ(names, (vector<string_view>{ "a", "d" }));
+
+	names.clear();
+	for (auto const & attr : root.FirstNode("parameter").Attribs())
+	{
+		names.push_back(attr.Name());
+	}
+	EXPECT_EQ(names, (vector<string_view>{ "type", "name", "value" }));
+
+	EXPECT_TRUE(root.Children("technique").empty());
+	EXPECT_TRUE(root.FirstNode("shader").Attribs().empty());
+}
+
+TEST(XMLDomTest, BinaryCache)
+{
+	auto const cache_folder = filesystem::temp_directory_path() / "KlayGETestsXMLCache";
+	XMLDocument::CacheFolder(cache_folder.string());
+
+	// The documents are closed before the cache is removed, the cached one maps its copy
+	{
+		XMLDocument text_doc;
+		XMLNodeHandle const text_root = ParseTestXML(text_doc)->Handle();
+
+		// The first parse writes the cache
+		XMLDocument first_doc;
+		ExpectSameTree(ParseTestXML(first_doc, test_xml, 1)->Handle(), text_root);
+
+		// The second one doesn't even look at the text
+		XMLDocument cached_doc;
+		XMLNodeHandle const cached_root = ParseTestXML(cached_doc, "<broken", 1)->Handle();
+		ExpectSameTree(cached_root, text_root);
+		EXPECT_EQ(cached_root.FirstNode("cbuffer").LastNode().AttribUInt("value", 0), 7U);
+
+		// A new timestamp means the cache is stale
+		XMLDocument new_doc;
+		XMLNodeHandle const new_root = ParseTestXML(new_doc, "<effect version='3'/>", 2)->Handle();
+		EXPECT_EQ(new_root.AttribInt("version", 0), 3);
+		EXPECT_FALSE(new_root.FirstNode());
+	}
+
+	XMLDocument::CacheFolder("");
+	error_code ec;
+	filesystem::remove_all(cache_folder, ec);
+}
+
+// Disabled by default. Run it with --gtest_also_run_disabled_tests.
+TEST(XMLDomTest, DISABLED_ParseAndWalkBenchmark)
+{
+	uint32_t constexpr NUM_ROUNDS = 10;
+
+	string const blitter_path = ResLoader::Instance().Locate("Blitter.fxml");
+	ASSERT_FALSE(blitter_path.empty());
+
+	vector<string> contents;
+	for (auto const & entry : filesystem::directory_iterator(filesystem::path(blitter_path).parent_path()))
+	{
+		if (entry.path().extension() == ".fxml")
+		{
+			auto const res = ResLoader::Instance().Open(entry.path().string());
+			stringstream ss;
+			ss << res->input_stream().rdbuf();
+			contents.push_back(ss.str());
+		}
+	}
+	ASSERT_FALSE(contents.empty());
+
+	double parse_time = 0;
+	double shared_walk_time = 0;
+	double handle_walk_time = 0;
+	size_t shared_sum = 0;
+	size_t handle_sum = 0;
+	for (uint32_t round = 0; round < NUM_ROUNDS; ++ round)
+	{
+		for (auto const & content : contents)
+		{
+			Timer timer;
+			XMLDocument doc;
+			XMLNodePtr const root = ParseTestXML(doc, content.c_str());
+			parse_time += timer.elapsed();
+
+			timer.restart();
+			shared_sum += WalkShared(root);
+			shared_walk_time += timer.elapsed();
+
+			timer.restart();
+			handle_sum += WalkHandle(root->Handle());
+			handle_walk_time += timer.elapsed();
+		}
+	}
+
+	cout << contents.size() << " RenderFX files, " << NUM_ROUNDS << " rounds" << endl;
+	cout << "Parse: " << parse_time * 1000 / NUM_ROUNDS << " ms per round" << endl;
+	cout << "Walk with XMLNodePtr: " << shared_walk_time * 1000 / NUM_ROUNDS << " ms per round" << endl;
+	cout << "Walk with XMLNodeHandle: " << handle_walk_time * 1000 / NUM_ROUNDS << " ms per round" << endl;
+
+	EXPECT_EQ(shared_sum, handle_sum);
+}
@@ -1,4 +1,5 @@
 #include <KlayGE/KlayGE.hpp>
+#include <KlayGE/Context.hpp>
 #include <KlayGE/Texture.hpp>
 #include <KlayGE/TexCompression.hpp>
 #include <KFL/Noise.hpp>
@@ -233,17 +234,13 @@ void GenfBmTexs()
 	MathLib::SimplexNoise<float> noiser = MathLib::SimplexNoise<float>::Instance();
 
 	std::vector<float> fdata(TEX_SIZE * TEX_SIZE);
+	noiser.fill_tileable_fBm(Context::Instance().TaskScheduler(), fdata, TEX_SIZE, TEX_SIZE, STRIDE, STRIDE, 5, 2, 0.5f);
 	float min_v = +1e10f;
 	float max_v = -1e10f;
-	for (uint32_t y = 0; y < TEX_SIZE; ++ y)
+	for (float v : fdata)
 	{
-		for (uint32_t x = 0; x < TEX_SIZE; ++ x)
-		{
-			float v = noiser.tileable_fBm((x + 0.5f) / TEX_SIZE * STRIDE, (y + 0.5f) / TEX_SIZE * STRIDE, STRIDE, STRIDE, 5, 2, 0.5f);
-			fdata[y * TEX_SIZE + x] = v;
-			min_v = std::min(min_v, v);
-			max_v = std::max(max_v, v);
-		}
+		min_v = std::min(min_v, v);
+		max_v = std::max(max_v, v);
 	}
 
 	{
@@ -279,16 +276,31 @@ void GenfBmTexs()
 	}
 
 	{
+		float const d = 2;
+		std::vector<float> xs(TEX_SIZE);
+		std::vector<float> xs_d(TEX_SIZE);
+		for (uint32_t x = 0; x < TEX_SIZE; ++ x)
+		{
+			xs[x] = (x + 0.5f) / TEX_SIZE * STRIDE;
+			xs_d[x] = (x + d + 0.5f) / TEX_SIZE * STRIDE;
+		}
+
+		std::vector<float> ys(TEX_SIZE);
+		std::vector<float> ys_d(TEX_SIZE);
+		std::vector<float> fx(TEX_SIZE);
+		std::vector<float> fy(TEX_SIZE);
 		std::vector<float3> fdata3(TEX_SIZE * TEX_SIZE);
 		for (uint32_t y = 0; y < TEX_SIZE; ++ y)
 		{
+			std::fill(ys.begin(), ys.end(), (y + 0.5f) / TEX_SIZE * STRIDE);
+			std::fill(ys_d.begin(), ys_d.end(), (y + d + 0.5f) / TEX_SIZE * STRIDE);
+			noiser.tileable_fBm(xs_d, ys, STRIDE, STRIDE, fx, 5, 2, 0.5f);
+			noiser.tileable_fBm(xs, ys_d, STRIDE, STRIDE, fy, 5, 2, 0.5f);
+
 			for (uint32_t x = 0; x < TEX_SIZE; ++ x)
 			{
 				float f0 = fdata[y * TEX_SIZE + x];
-				float d = 2;
-				float fx = noiser.tileable_fBm((x + d + 0.5f) / TEX_SIZE * STRIDE, (y + 0.5f) / TEX_SIZE * STRIDE, STRIDE, STRIDE, 5, 2, 0.5f);
-				float fy = noiser.tileable_fBm((x + 0.5f) / TEX_SIZE * STRIDE, (y + d + 0.5f) / TEX_SIZE * STRIDE, STRIDE, STRIDE, 5, 2, 0.5f);
-				fdata3[y * TEX_SIZE + x] = MathLib::normalize(float3(fx - f0, fy - f0, STRIDE * 16 / TEX_SIZE)) * 0.5f + 0.5f;
+				fdata3[y * TEX_SIZE + x] = MathLib::normalize(float3(fx[x] - f0, fy[x] - f0, STRIDE * 16 / TEX_SIZE)) * 0.5f + 0.5f;
 			}
 		}
 		std::vector<uint8_t> rg_data(TEX_SIZE * TEX_SIZE * 2);